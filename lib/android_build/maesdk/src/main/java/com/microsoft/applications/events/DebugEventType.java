@@ -85,6 +85,10 @@ public enum DebugEventType {
 
   /// <summary>Ticket Expired</summary>
   EVT_TICKET_EXPIRED(0x0F000000L),
+  /// <summary>Upload controller changed package size, upload interval or uploads in flight.</summary>
+  EVT_UPLOAD_TUNED(0x10000000L),
+  /// <summary>Per-stage pipeline latencies, raised at teardown.</summary>
+  EVT_PIPELINE_STATS(0x11000000L),
   /// <summary>Unknown error.</summary>
   EVT_UNKNOWN(0xDEADBEEFL);
 
@@ -36,21 +36,211 @@ namespace MAT_NS_BEGIN
 
     ContextFieldsProvider& ContextFieldsProvider::operator=(ContextFieldsProvider const& copy)
     {
+        LOCKGUARD(m_lock);
         m_parent = copy.m_parent;
         m_commonContextFields = copy.m_commonContextFields;
         m_customContextFields = copy.m_customContextFields;
         m_commonContextEventToConfigIds = copy.m_commonContextEventToConfigIds;
         m_ticketsMap = copy.m_ticketsMap;
+        m_generation++;
         return *this;
     }
 
-    void ContextFieldsProvider::writeToRecord(::CsProtocol::Record& record, bool commonOnly)
+    static ::CsProtocol::Value toCsValue(EventProperty const& property)
+    {
+        CsProtocol::Value temp;
+        if (property.piiKind != PiiKind_None)
+        {
+            CsProtocol::PII pii;
+            pii.Kind = static_cast<CsProtocol::PIIKind>(property.piiKind);
+            CsProtocol::Attributes attrib;
+            attrib.pii.push_back(pii);
+            temp.attributes.push_back(attrib);
+            temp.stringValue = property.to_string();
+            return temp;
+        }
+
+        switch (property.type)
+        {
+        case EventProperty::TYPE_INT64:
+            temp.type = ::CsProtocol::ValueKind::ValueInt64;
+            temp.longValue = property.as_int64;
+            break;
+        case EventProperty::TYPE_DOUBLE:
+            temp.type = ::CsProtocol::ValueKind::ValueDouble;
+            temp.doubleValue = property.as_double;
+            break;
+        case EventProperty::TYPE_TIME:
+            temp.type = ::CsProtocol::ValueKind::ValueDateTime;
+            temp.longValue = property.as_time_ticks.ticks;
+            break;
+        case EventProperty::TYPE_BOOLEAN:
+            temp.type = ::CsProtocol::ValueKind::ValueBool;
+            temp.longValue = property.as_bool;
+            break;
+        case EventProperty::TYPE_GUID:
+        {
+            uint8_t guid_bytes[16] = { 0 };
+            property.as_guid.to_bytes(guid_bytes);
+            temp.type = ::CsProtocol::ValueKind::ValueGuid;
+            temp.guidValue.push_back(std::vector<uint8_t>(guid_bytes, guid_bytes + sizeof(guid_bytes)));
+            break;
+        }
+        default:
+            // Strings, and all unknown types converted to string
+            temp.stringValue = property.to_string();
+            break;
+        }
+        return temp;
+    }
+
+    static std::string toDeviceLocalId(const char* deviceId)
     {
-        // Append parent scope context variables if not detached from parent
-        if (m_parent)
+        // Use "c:" prefix
+        std::string temp("c:");
+        if (deviceId != nullptr)
         {
-            m_parent->writeToRecord(record);
+            size_t len = strlen(deviceId);
+            if (len >= 2 && deviceId[1] == ':' && (
+                deviceId[0] == 'c' || // c: Custom identifier
+                deviceId[0] == 'r' || // r: Randomized identifier
+                deviceId[0] == 'u' || // u: Mac OS X UUID
+                deviceId[0] == 'a' || // a: Android ID
+                deviceId[0] == 's' || // s: SQM ID
+                deviceId[0] == 'x' || // x: XBox One hardware ID
+                deviceId[0] == 'i'))  // i: iOS ID
+            {
+                // Remove "c:" prefix
+                temp = "";
+            }
+            // Strip curly braces from GUID while populating localId.
+            // Otherwise 1DS collector would not strip the prefix.
+            if ((len != 0) && (deviceId[0] == '{') && (deviceId[len - 1] == '}'))
+            {
+                temp.append(deviceId + 1, len - 2);
+            }
+            else
+            {
+                temp.append(deviceId);
+            }
         }
+        return temp;
+    }
+
+    std::shared_ptr<const ContextFieldsProvider::Snapshot> ContextFieldsProvider::getSnapshot()
+    {
+        // Parent scopes first: a change anywhere up the chain gives the
+        // parent a new snapshot, which in turn invalidates ours.
+        ContextFieldsProvider* parent = m_parent;
+        std::shared_ptr<const Snapshot> parentSnapshot = (parent != nullptr) ? parent->getSnapshot() : nullptr;
+
+        std::shared_ptr<const Snapshot> snapshot = std::atomic_load(&m_snapshot);
+        if (snapshot && !m_fieldsExposed.load(std::memory_order_acquire) &&
+            snapshot->generation == m_generation.load(std::memory_order_acquire) && snapshot->parent == parentSnapshot)
+        {
+            return snapshot;
+        }
+
+        snapshot = buildSnapshot(parentSnapshot);
+        std::atomic_store(&m_snapshot, snapshot);
+        return snapshot;
+    }
+
+    std::shared_ptr<const ContextFieldsProvider::Snapshot> ContextFieldsProvider::buildSnapshot(std::shared_ptr<const Snapshot> const& parent)
+    {
+        std::shared_ptr<Snapshot> snapshot = parent ? std::make_shared<Snapshot>(*parent) : std::make_shared<Snapshot>();
+        snapshot->parent = parent;
+        snapshot->inheritedCustomProperties = snapshot->customProperties;
+
+        LOCKGUARD(m_lock);
+        snapshot->generation = m_generation.load(std::memory_order_relaxed);
+
+        auto iter = m_commonContextFields.find(COMMONFIELDS_APP_EXPERIMENTIDS);
+        if (iter != m_commonContextFields.end() && iter->second.as_string != nullptr && iter->second.as_string[0] != 0)
+        {
+            snapshot->experimentIds = iter->second.as_string;
+            snapshot->eventToConfigIds = m_commonContextEventToConfigIds;
+        }
+
+        for (const char* name : { SESSION_IMPRESSION_ID, COMMONFIELDS_APP_EXPERIMENTETAG })
+        {
+            iter = m_commonContextFields.find(name);
+            if (iter != m_commonContextFields.end())
+            {
+                CsProtocol::Value temp;
+                temp.stringValue = iter->second.as_string;
+                snapshot->commonProperties[name] = temp;
+            }
+        }
+
+        auto set = [&snapshot](Snapshot::PartAField field, std::string const& value)
+        {
+            snapshot->isSet[field] = true;
+            snapshot->partA[field] = value;
+        };
+        static const std::pair<const char*, Snapshot::PartAField> stringFields[] =
+        {
+            { COMMONFIELDS_APP_ID, Snapshot::AppId },
+            { COMMONFIELDS_APP_ENV, Snapshot::AppEnv },
+            { COMMONFIELDS_APP_NAME, Snapshot::AppName },
+            { COMMONFIELDS_APP_VERSION, Snapshot::AppVersion },
+            { COMMONFIELDS_APP_LANGUAGE, Snapshot::AppLocale },
+            { COMMONFIELDS_DEVICE_ORGID, Snapshot::DeviceOrgId },
+            { COMMONFIELDS_DEVICE_MAKE, Snapshot::DeviceMake },
+            { COMMONFIELDS_DEVICE_MODEL, Snapshot::DeviceModel },
+            { COMMONFIELDS_DEVICE_CLASS, Snapshot::DeviceClass },
+            { COMMONFIELDS_COMMERCIAL_ID, Snapshot::CommercialId },
+            { COMMONFIELDS_OS_NAME, Snapshot::OsName },
+            { COMMONFIELDS_OS_BUILD, Snapshot::OsBuild },
+            { COMMONFIELDS_USER_ID, Snapshot::UserId },
+            { COMMONFIELDS_USER_LANGUAGE, Snapshot::UserLocale },
+            { COMMONFIELDS_USER_TIMEZONE, Snapshot::UserTimeZone },
+            { COMMONFIELDS_NETWORK_COST, Snapshot::NetworkCost },
+            { COMMONFIELDS_NETWORK_PROVIDER, Snapshot::NetworkProvider },
+            { COMMONFIELDS_NETWORK_TYPE, Snapshot::NetworkType },
+        };
+        for (auto const& field : stringFields)
+        {
+            iter = m_commonContextFields.find(field.first);
+            if (iter != m_commonContextFields.end())
+            {
+                set(field.second, iter->second.as_string);
+            }
+        }
+        if (m_commonContextFields.count(COMMONFIELDS_APP_NAME) == 0 && m_commonContextFields.count(COMMONFIELDS_APP_ID) != 0)
+        {
+            // Backwards-compat: legacy Aria exporter maps CS3.0 ext.app.name to AppInfo.Id
+            // TODO:
+            // - consider resolving that protocol "wrinkle" backend-side
+            // - consider parsing ext.app.id if it contains app hash!name:ver information
+            set(Snapshot::AppName, snapshot->partA[Snapshot::AppId]);
+        }
+        iter = m_commonContextFields.find(COMMONFIELDS_DEVICE_ID);
+        if (iter != m_commonContextFields.end())
+        {
+            set(Snapshot::DeviceLocalId, toDeviceLocalId(iter->second.as_string));
+        }
+
+        if (m_ticketsMap.size() > 0)
+        {
+            std::vector<std::string> tickets;
+            for (auto const& field : m_ticketsMap)
+            {
+                tickets.push_back(field.second);
+            }
+            snapshot->tickets.push_back(std::move(tickets));
+        }
+
+        for (auto const& field : m_customContextFields)
+        {
+            snapshot->customProperties[field.first] = toCsValue(field.second);
+        }
+        return snapshot;
+    }
+
+    void ContextFieldsProvider::writeToRecord(::CsProtocol::Record& record, bool commonOnly)
+    {
+        std::shared_ptr<const Snapshot> snapshot = getSnapshot();
 
         if (record.data.size() == 0)
         {
@@ -105,302 +295,70 @@ namespace MAT_NS_BEGIN
             record.extM365a.push_back(m365a);
         }
 
+        if (!snapshot->experimentIds.empty())
+        {// for ECS set event specific config ids
+            const auto& iter = record.name.empty() ? snapshot->eventToConfigIds.end() : snapshot->eventToConfigIds.find(record.name);
+            record.extApp[0].expId = (iter != snapshot->eventToConfigIds.end()) ? iter->second : snapshot->experimentIds;
+        }
+
         std::map<std::string, ::CsProtocol::Value>& ext = record.data[0].properties;
+        for (auto const& field : snapshot->commonProperties)
         {
-            LOCKGUARD(m_lock);
-
-            std::string value = m_commonContextFields[COMMONFIELDS_APP_EXPERIMENTIDS].as_string;
-            if (!value.empty())
-            {// for ECS set event specific config ids
-                std::string eventName = record.name;
-                if (!eventName.empty())
-                {
-                    const auto& iter = m_commonContextEventToConfigIds.find(eventName);
-                    if (iter != m_commonContextEventToConfigIds.end())
-                    {
-                        value = iter->second;
-                    }
-                }
-
-                record.extApp[0].expId = value;
-            }
+            ext[field.first] = field.second;
+        }
 
-            if (!m_commonContextFields.empty())
+        struct Target
+        {
+            Snapshot::PartAField field;
+            std::string&         value;
+        } const targets[] =
+        {
+            { Snapshot::AppId, record.extApp[0].id },
+            { Snapshot::AppEnv, record.extApp[0].env },
+            { Snapshot::AppName, record.extApp[0].name },
+            { Snapshot::AppVersion, record.extApp[0].ver },
+            { Snapshot::AppLocale, record.extApp[0].locale },
+            { Snapshot::DeviceLocalId, record.extDevice[0].localId },
+            { Snapshot::DeviceOrgId, record.extDevice[0].orgId },
+            { Snapshot::DeviceMake, record.extProtocol[0].devMake },
+            { Snapshot::DeviceModel, record.extProtocol[0].devModel },
+            { Snapshot::DeviceClass, record.extDevice[0].deviceClass },
+            { Snapshot::CommercialId, record.extM365a[0].enrolledTenantId },
+            { Snapshot::OsName, record.extOs[0].name },
+            { Snapshot::OsBuild, record.extOs[0].ver },
+            { Snapshot::UserId, record.extUser[0].localId },
+            { Snapshot::UserLocale, record.extUser[0].locale },
+            { Snapshot::UserTimeZone, record.extLoc[0].timezone },
+            { Snapshot::NetworkCost, record.extNet[0].cost },
+            { Snapshot::NetworkProvider, record.extNet[0].provider },
+            { Snapshot::NetworkType, record.extNet[0].type },
+        };
+        for (auto const& target : targets)
+        {
+            if (snapshot->isSet[target.field])
             {
-                if (m_commonContextFields.find(SESSION_IMPRESSION_ID) != m_commonContextFields.end())
-                {
-                    CsProtocol::Value temp;
-                    EventProperty prop = m_commonContextFields[SESSION_IMPRESSION_ID];
-                    temp.stringValue = prop.as_string;
-
-                    ext[SESSION_IMPRESSION_ID] = temp;
-                }
-
-                if (m_commonContextFields.find(COMMONFIELDS_APP_EXPERIMENTETAG) != m_commonContextFields.end())
-                {
-                    CsProtocol::Value temp;
-                    EventProperty prop = m_commonContextFields[COMMONFIELDS_APP_EXPERIMENTETAG];
-                    temp.stringValue = prop.as_string;
-
-                    ext[COMMONFIELDS_APP_EXPERIMENTETAG] = temp;
-                }
-
-                auto iter = m_commonContextFields.find(COMMONFIELDS_APP_ID);
-                bool hasAppId = (iter != m_commonContextFields.end());
-                if (hasAppId)
-                {
-                    record.extApp[0].id = iter->second.as_string;
-                }
-
-                iter = m_commonContextFields.find(COMMONFIELDS_APP_ENV);
-                bool hasAppEnv = (iter != m_commonContextFields.end());
-                if (hasAppEnv)
-                {
-                    record.extApp[0].env = iter->second.as_string;
-                }
-
-                iter = m_commonContextFields.find(COMMONFIELDS_APP_NAME);
-                if (iter != m_commonContextFields.end())
-                {
-                    record.extApp[0].name = iter->second.as_string;
-                }
-                else if (hasAppId)
-                {
-                    // Backwards-compat: legacy Aria exporter maps CS3.0 ext.app.name to AppInfo.Id
-                    // TODO:
-                    // - consider resolving that protocol "wrinkle" backend-side
-                    // - consider parsing ext.app.id if it contains app hash!name:ver information
-                    record.extApp[0].name = record.extApp[0].id;
-                }
-
-                iter = m_commonContextFields.find(COMMONFIELDS_APP_VERSION);
-                if (iter != m_commonContextFields.end())
-                {
-                    record.extApp[0].ver = iter->second.as_string;
-                }
-
-                iter = m_commonContextFields.find(COMMONFIELDS_APP_LANGUAGE);
-                if (iter != m_commonContextFields.end())
-                {
-                    record.extApp[0].locale = iter->second.as_string;
-                }
-
-                iter = m_commonContextFields.find(COMMONFIELDS_DEVICE_ID);
-                if (iter != m_commonContextFields.end())
-                {
-                    // Use "c:" prefix
-                    std::string temp("c:");
-                    const char *deviceId = iter->second.as_string;
-                    if (deviceId != nullptr)
-                    {
-                        size_t len = strlen(deviceId);
-                        if (len >= 2 && deviceId[1] == ':' && (
-                            deviceId[0] == 'c' || // c: Custom identifier
-                            deviceId[0] == 'r' || // r: Randomized identifier
-                            deviceId[0] == 'u' || // u: Mac OS X UUID
-                            deviceId[0] == 'a' || // a: Android ID
-                            deviceId[0] == 's' || // s: SQM ID
-                            deviceId[0] == 'x' || // x: XBox One hardware ID
-                            deviceId[0] == 'i'))  // i: iOS ID
-                        {
-                            // Remove "c:" prefix
-                            temp = "";
-                        }
-                        // Strip curly braces from GUID while populating localId.
-                        // Otherwise 1DS collector would not strip the prefix.
-                        if ((deviceId[0] == '{') && (deviceId[len - 1] == '}'))
-                        {
-                            temp.append(deviceId + 1, len - 2);
-                        }
-                        else
-                        {
-                            temp.append(deviceId);
-                        }
-                    }
-                    record.extDevice[0].localId = temp;
-                }
-
-                iter = m_commonContextFields.find(COMMONFIELDS_DEVICE_ORGID);
-                if (iter != m_commonContextFields.end())
-                {
-                    record.extDevice[0].orgId = iter->second.as_string;
-                }
-
-                iter = m_commonContextFields.find(COMMONFIELDS_DEVICE_MAKE);
-                if (iter != m_commonContextFields.end())
-                {
-                    record.extProtocol[0].devMake = iter->second.as_string;
-                }
-
-                iter = m_commonContextFields.find(COMMONFIELDS_DEVICE_MODEL);
-                if (iter != m_commonContextFields.end())
-                {
-                    record.extProtocol[0].devModel = iter->second.as_string;
-                }
-
-                iter = m_commonContextFields.find(COMMONFIELDS_DEVICE_CLASS);
-                if (iter != m_commonContextFields.end())
-                {
-                    record.extDevice[0].deviceClass = iter->second.as_string;
-                }
-
-                iter = m_commonContextFields.find(COMMONFIELDS_COMMERCIAL_ID);
-                if (iter != m_commonContextFields.end())
-                {
-                    record.extM365a[0].enrolledTenantId = iter->second.as_string;
-                }
-
-                iter = m_commonContextFields.find(COMMONFIELDS_OS_NAME);
-                if (iter != m_commonContextFields.end())
-                {
-                    record.extOs[0].name = iter->second.as_string;
-                }
-
-                iter = m_commonContextFields.find(COMMONFIELDS_OS_BUILD);
-                if (iter != m_commonContextFields.end())
-                {
-                    //EventProperty prop = (*m_commonContextFieldsP)[COMMONFIELDS_OS_VERSION];
-                    record.extOs[0].ver = iter->second.as_string;
-                }
-
-                iter = m_commonContextFields.find(COMMONFIELDS_USER_ID);
-                if (iter != m_commonContextFields.end())
-                {
-                    record.extUser[0].localId = iter->second.as_string;
-                }
-
-                iter = m_commonContextFields.find(COMMONFIELDS_USER_LANGUAGE);
-                if (iter != m_commonContextFields.end())
-                {
-                    record.extUser[0].locale = iter->second.as_string;
-                }
-
-                iter = m_commonContextFields.find(COMMONFIELDS_USER_TIMEZONE);
-                if (iter != m_commonContextFields.end())
-                {
-                    record.extLoc[0].timezone = iter->second.as_string;
-                }
-
-                iter = m_commonContextFields.find(COMMONFIELDS_NETWORK_COST);
-                if (iter != m_commonContextFields.end())
-                {
-                    record.extNet[0].cost = iter->second.as_string;
-                }
-
-                iter = m_commonContextFields.find(COMMONFIELDS_NETWORK_PROVIDER);
-                if (iter != m_commonContextFields.end())
-                {
-                    record.extNet[0].provider = iter->second.as_string;
-                }
-
-                iter = m_commonContextFields.find(COMMONFIELDS_NETWORK_TYPE);
-                if (iter != m_commonContextFields.end())
-                {
-                    record.extNet[0].type = iter->second.as_string;
-                }
+                target.value = snapshot->partA[target.field];
             }
+        }
 
-            if (m_ticketsMap.size() > 0)
-            {
-                std::vector<std::string> tickets;
-                for (auto const& field : m_ticketsMap)
-                {
-                    tickets.push_back(field.second);
-                }
-                CsProtocol::Protocol temp;
-                temp.ticketKeys.push_back(tickets);
-                record.extProtocol.push_back(temp);
-            }
+        for (auto const& tickets : snapshot->tickets)
+        {
+            CsProtocol::Protocol temp;
+            temp.ticketKeys.push_back(tickets);
+            record.extProtocol.push_back(temp);
+        }
 
-            if (!commonOnly)
-            {
-                for (auto const& field : m_customContextFields)
-                {
-                    if (field.second.piiKind != PiiKind_None)
-                    {
-                        CsProtocol::PII pii;
-                        pii.Kind = static_cast<CsProtocol::PIIKind>(field.second.piiKind);
-                        CsProtocol::Value temp;
-                        CsProtocol::Attributes attrib;
-                        attrib.pii.push_back(pii);
-
-
-                        temp.attributes.push_back(attrib);
-
-                        temp.stringValue = field.second.to_string();
-                        record.data[0].properties[field.first] = temp;
-                    }
-                    else
-                    {
-                        std::vector<uint8_t> guid;
-                        uint8_t guid_bytes[16] = { 0 };
-
-                        switch (field.second.type)
-                        {
-                        case EventProperty::TYPE_STRING:
-                        {
-                            CsProtocol::Value temp;
-                            temp.stringValue = field.second.to_string();
-                            record.data[0].properties[field.first] = temp;
-                            break;
-                        }
-                        case EventProperty::TYPE_INT64:
-                        {
-                            CsProtocol::Value temp;
-                            temp.type = ::CsProtocol::ValueKind::ValueInt64;
-                            temp.longValue = field.second.as_int64;
-                            record.data[0].properties[field.first] = temp;
-                            break;
-                        }
-                        case EventProperty::TYPE_DOUBLE:
-                        {
-                            CsProtocol::Value temp;
-                            temp.type = ::CsProtocol::ValueKind::ValueDouble;
-                            temp.doubleValue = field.second.as_double;
-                            record.data[0].properties[field.first] = temp;
-                            break;
-                        }
-                        case EventProperty::TYPE_TIME:
-                        {
-                            CsProtocol::Value temp;
-                            temp.type = ::CsProtocol::ValueKind::ValueDateTime;
-                            temp.longValue = field.second.as_time_ticks.ticks;
-                            record.data[0].properties[field.first] = temp;
-                            break;
-                        }
-                        case EventProperty::TYPE_BOOLEAN:
-                        {
-                            CsProtocol::Value temp;
-                            temp.type = ::CsProtocol::ValueKind::ValueBool;
-                            temp.longValue = field.second.as_bool;
-                            record.data[0].properties[field.first] = temp;
-                            break;
-                        }
-                        case EventProperty::TYPE_GUID:
-                        {
-                            GUID_t temp = field.second.as_guid;
-                            temp.to_bytes(guid_bytes);
-                            guid = std::vector<uint8_t>(guid_bytes, guid_bytes + sizeof(guid_bytes) / sizeof(guid_bytes[0]));
-
-                            CsProtocol::Value tempValue;
-                            tempValue.type = ::CsProtocol::ValueKind::ValueGuid;
-                            tempValue.guidValue.push_back(guid);
-                            record.data[0].properties[field.first] = tempValue;
-                            break;
-                        }
-                        default:
-                        {
-                            // Convert all unknown types to string
-                            CsProtocol::Value temp;
-                            temp.stringValue = field.second.to_string();
-                            record.data[0].properties[field.first] = temp;
-                        }
-                        }
-                    }
-                }
-            }
-            LOG_TRACE("Record=%p decorated with SemanticContext=%p", &record, this);
+        // Context is applied before the event's own properties, so the map
+        // is usually empty here and every insert lands at the end.
+        auto const& custom = commonOnly ? snapshot->inheritedCustomProperties : snapshot->customProperties;
+        auto hint = ext.begin();
+        for (auto const& field : custom)
+        {
+            hint = ext.emplace_hint(hint, field.first, ::CsProtocol::Value());
+            hint->second = field.second;
+            ++hint;
         }
+        LOG_TRACE("Record=%p decorated with SemanticContext=%p", &record, this);
     }
 
     void ContextFieldsProvider::ClearExperimentIds()
@@ -409,7 +367,9 @@ namespace MAT_NS_BEGIN
         SetCommonField(COMMONFIELDS_APP_EXPERIMENTIDS, "");
 
         // Clear the map of all ExperimentsIds (that's associated with event)
+        LOCKGUARD(m_lock);
         m_commonContextEventToConfigIds.clear();
+        m_generation++;
     }
 
     void ContextFieldsProvider::SetEventExperimentIds(std::string const& eventName, std::string const& experimentIds)
@@ -420,6 +380,8 @@ namespace MAT_NS_BEGIN
         }
 
         std::string eventNameNormalized = toLower(eventName);
+        LOCKGUARD(m_lock);
+        m_generation++;
         if (!experimentIds.empty())
         {
             m_commonContextEventToConfigIds[eventNameNormalized] = experimentIds;
@@ -434,12 +396,14 @@ namespace MAT_NS_BEGIN
     {
         LOCKGUARD(m_lock);
         m_commonContextFields[name] = value;
+        m_generation++;
     }
 
     void ContextFieldsProvider::SetCustomField(const std::string& name, const EventProperty& value)
     {
         LOCKGUARD(m_lock);
         m_customContextFields[name] = value;
+        m_generation++;
     }
 
     void ContextFieldsProvider::SetTicket(TicketType type, const std::string& ticketValue)
@@ -448,21 +412,28 @@ namespace MAT_NS_BEGIN
         if (!ticketValue.empty())
         {
             m_ticketsMap[type] = ticketValue;
+            m_generation++;
         }
     }
 
     void ContextFieldsProvider::SetParentContext(ContextFieldsProvider* parent)
     {
         m_parent = parent;
+        // The next snapshot is built on top of the new parent's one
+        m_generation++;
     }
 
+    // Callers may change the fields through the returned map at any later
+    // time, so snapshots of this scope can no longer be trusted.
     std::map<std::string, EventProperty>& ContextFieldsProvider::GetCommonFields()
     {
+        m_fieldsExposed.store(true, std::memory_order_release);
         return m_commonContextFields;
     }
 
     std::map<std::string, EventProperty>& ContextFieldsProvider::GetCustomFields()
     {
+        m_fieldsExposed.store(true, std::memory_order_release);
         return m_customContextFields;
     }
 
@@ -10,9 +10,12 @@
 
 #include "utils/Utils.hpp"
 
+#include <atomic>
+#include <memory>
 #include <mutex>
 #include <set>
 #include <string>
+#include <vector>
 #include <cassert>
 
 namespace MAT_NS_BEGIN
@@ -42,9 +45,82 @@ namespace MAT_NS_BEGIN
 
     protected:
 
+        /// <summary>
+        /// Immutable, fully resolved view of the context: the parent chain
+        /// merged in, Part A strings picked out of the common fields and
+        /// custom fields already converted to CsProtocol values. It is built
+        /// once per generation and shared by pointer between events, so
+        /// decorating an event takes neither the lock nor a map lookup.
+        /// </summary>
+        struct Snapshot
+        {
+            enum PartAField
+            {
+                AppId,
+                AppEnv,
+                AppName,
+                AppVersion,
+                AppLocale,
+                DeviceLocalId,
+                DeviceOrgId,
+                DeviceMake,
+                DeviceModel,
+                DeviceClass,
+                CommercialId,
+                OsName,
+                OsBuild,
+                UserId,
+                UserLocale,
+                UserTimeZone,
+                NetworkCost,
+                NetworkProvider,
+                NetworkType,
+                PartAFieldCount
+            };
+
+            uint64_t                                    generation = 0;
+            std::shared_ptr<const Snapshot>             parent;
+
+            // Fields left unset keep whatever the record already holds
+            bool                                        isSet[PartAFieldCount] = {};
+            std::string                                 partA[PartAFieldCount];
+
+            // Experiment IDs of the innermost scope that has any, with its
+            // per-event overrides
+            std::string                                 experimentIds;
+            std::map<std::string, std::string>          eventToConfigIds;
+
+            // Session.ImpressionId and AppInfo.ETag
+            std::map<std::string, ::CsProtocol::Value>  commonProperties;
+
+            // One ticket group per scope that has tickets, outermost first
+            std::vector<std::vector<std::string>>       tickets;
+
+            // Own custom fields over the inherited ones, and the inherited
+            // ones alone for commonOnly
+            std::map<std::string, ::CsProtocol::Value>  customProperties;
+            std::map<std::string, ::CsProtocol::Value>  inheritedCustomProperties;
+        };
+
+        /// <summary>
+        /// Current snapshot, rebuilt first if this scope or a parent changed.
+        /// </summary>
+        std::shared_ptr<const Snapshot> getSnapshot();
+        std::shared_ptr<const Snapshot> buildSnapshot(std::shared_ptr<const Snapshot> const& parent);
+
         std::mutex              m_lock;
         ContextFieldsProvider*  m_parent;
 
+        // Bumped under m_lock by every change. m_snapshot is only accessed
+        // with std::atomic_load / std::atomic_store.
+        std::atomic<uint64_t>           m_generation { 1 };
+        std::shared_ptr<const Snapshot> m_snapshot;
+
+        // Set once GetCommonFields() or GetCustomFields() handed out a map.
+        // Writes through it do not bump m_generation, so from then on every
+        // getSnapshot() rebuilds.
+        std::atomic<bool>               m_fieldsExposed { false };
+
         std::map<std::string, EventProperty> m_commonContextFields;
         std::map<std::string, EventProperty> m_customContextFields;
 
@@ -18,6 +18,7 @@
 #include "TransmitProfiles.hpp"
 #include "http/HttpClientFactory.hpp"
 #include "pal/TaskDispatcher.hpp"
+#include "pal/WorkStealingTaskDispatcher.hpp"
 #include "utils/Utils.hpp"
 
 #ifdef HAVE_MAT_UTC
@@ -248,7 +249,16 @@ namespace MAT_NS_BEGIN
 
         if (m_taskDispatcher == nullptr)
         {
-            m_taskDispatcher = PAL::getDefaultTaskDispatcher();
+            const uint32_t poolThreads = m_logConfiguration[CFG_MAP_TASK_POOL][CFG_INT_TASK_POOL_THREADS];
+            if (poolThreads > 1)
+            {
+                m_taskDispatcher = PAL::WorkStealingTaskDispatcherFactory::Create(poolThreads);
+                LOG_TRACE("TaskDispatcher: task pool with %u threads", poolThreads);
+            }
+            else
+            {
+                m_taskDispatcher = PAL::getDefaultTaskDispatcher();
+            }
         }
         else
         {
@@ -351,6 +361,8 @@ namespace MAT_NS_BEGIN
         LOG_INFO("Initializing Modules");
         InitializeModules();
 
+        InitializeIngestionQueue();
+
         LOG_INFO("Started up and running");
         m_alive = true;
     }
@@ -383,9 +395,17 @@ namespace MAT_NS_BEGIN
         PauseActivity();
         WaitPause();
         LOG_INFO("Shutting down...");
+        // Pipeline threads take m_lock while handling events, so the ingestion
+        // queue has to be drained before this thread acquires it. Events logged
+        // from here on are spilled to the logging thread.
+        if (m_ingestionQueue)
+        {
+            m_ingestionQueue->Stop();
+        }
         LOCKGUARD(m_lock);
         if (m_alive)
         {
+            m_loggerCache.Clear();
             if (m_logConfiguration[CFG_BOOL_DISABLE_ZOMBIE_LOGGERS])
             {
                 m_loggers.clear();
@@ -411,6 +431,8 @@ namespace MAT_NS_BEGIN
                 assert(m_loggers.empty());
             }
 
+            m_ingestionQueue.reset();
+
             LOG_INFO("Tearing down modules");
             TeardownModules();
 
@@ -443,6 +465,10 @@ namespace MAT_NS_BEGIN
     status_t LogManagerImpl::Flush()
     {
         LOG_INFO("Flush()");
+        if (m_ingestionQueue)
+        {
+            m_ingestionQueue->Drain();
+        }
         if (m_offlineStorage)
             m_offlineStorage->Flush();
         return STATUS_SUCCESS;
@@ -647,38 +673,50 @@ namespace MAT_NS_BEGIN
 
     ILogger* LogManagerImpl::GetLogger(const std::string& tenantToken, const std::string& source, const std::string& scope)
     {
+        LOG_TRACE("GetLogger(tenantId=\"%s\", source=\"%s\")", tenantTokenToId(tenantToken).c_str(), source.c_str());
+
+        // Loggers handed out before are found without locking or allocating.
+        // The cache is emptied on teardown, so misses take the locked path
+        // that checks m_alive.
+        LoggerCache::Entry* entry = m_loggerCache.Find(tenantToken, source);
+        if (entry == nullptr)
         {
+            std::string normalizedTenantToken = toLower(tenantToken);
+            std::string normalizedSource = toLower(source);
+            std::string hash = normalizedTenantToken + "/" + normalizedSource;
+
             LOCKGUARD(m_lock);
             if (!m_alive)
             {
                 return nullptr;
             }
+            auto it = m_loggers.find(hash);
+            if (it == std::end(m_loggers))
+            {
+                it = m_loggers.emplace(hash, std::make_unique<Logger>(
+                    normalizedTenantToken, normalizedSource, scope,
+                    *this, m_context, *m_config)).first;
+            }
+            entry = m_loggerCache.Add(normalizedTenantToken, normalizedSource, it->second.get());
         }
-        //
-        LOG_TRACE("GetLogger(tenantId=\"%s\", source=\"%s\")", tenantTokenToId(tenantToken).c_str(), source.c_str());
-
-        std::string normalizedTenantToken = toLower(tenantToken);
-        std::string normalizedSource = toLower(source);
-        std::string hash = normalizedTenantToken + "/" + normalizedSource;
 
-        LOCKGUARD(m_lock);
-        if (!m_alive)
-        {
-            return nullptr;
-        }
-        auto it = m_loggers.find(hash);
-        if (it == std::end(m_loggers))
-        {
-            m_loggers[hash] = std::make_unique<Logger>(
-                normalizedTenantToken, normalizedSource, scope,
-                *this, m_context, *m_config);
-        }
+        // Apply the default level when it changes, not on every lookup. It is
+        // applied under the lock, as Logger::SetLevel is not thread-safe.
         uint8_t level = m_diagLevelFilter.GetDefaultLevel();
-        if (level != DIAG_LEVEL_DEFAULT)
+        if ((level != DIAG_LEVEL_DEFAULT) && (entry->level.load(std::memory_order_relaxed) != level))
         {
-            m_loggers[hash]->SetLevel(level);
+            LOCKGUARD(m_lock);
+            if (!m_alive)
+            {
+                return nullptr;
+            }
+            if (entry->level.load(std::memory_order_relaxed) != level)
+            {
+                entry->logger->SetLevel(level);
+                entry->level.store(level, std::memory_order_relaxed);
+            }
         }
-        return m_loggers[hash].get();
+        return entry->logger;
     }
 
     /// <summary>
@@ -711,6 +749,11 @@ namespace MAT_NS_BEGIN
         return m_debugEventSource.DispatchEvent(std::move(evt));
     }
 
+    bool LogManagerImpl::HasListeners(DebugEventType type) const
+    {
+        return m_debugEventSource.HasListeners(type);
+    }
+
     /// <summary>Attach cascaded DebugEventSource to forward all events to</summary>
     bool LogManagerImpl::AttachEventSource(DebugEventSource& other)
     {
@@ -725,12 +768,37 @@ namespace MAT_NS_BEGIN
 
     void LogManagerImpl::sendEvent(IncomingEventContextPtr const& event)
     {
+        if (m_ingestionQueue)
+        {
+            // The record lives on the Logger's stack: take ownership of it
+            // before handing the event to the pipeline threads.
+            std::unique_ptr<IncomingEventContext> queued(new QueuedEventContext(*event));
+            queued->pipelineTimes.queued = PipelineTimes::Now();
+            switch (m_ingestionQueue->Push(queued))
+            {
+            case EventIngestionQueue::PushResult::Queued:
+                return;
+            case EventIngestionQueue::PushResult::Dropped:
+                DispatchEvent(DebugEvent(DebugEventType::EVT_DROPPED, 1u, static_cast<size_t>(DROPPED_REASON_INGESTION_QUEUE_FULL)));
+                LOG_INFO("Event %s dropped: ingestion queue full", queued->record.id.c_str());
+                return;
+            case EventIngestionQueue::PushResult::Spilled:
+                processEvent(*queued);
+                return;
+            }
+        }
+        processEvent(*event);
+    }
+
+    void LogManagerImpl::processEvent(IncomingEventContext& event)
+    {
+        event.pipelineTimes.dispatched = PipelineTimes::Now();
         LOCKGUARD(m_lock);
         if (GetSystem())
         {
             if (m_customDecorator)
             {
-                m_customDecorator->decorate(*(event->source));
+                m_customDecorator->decorate(*(event.source));
             }
 
             {
@@ -738,18 +806,53 @@ namespace MAT_NS_BEGIN
 
                 for (const auto& dataInspector : m_dataInspectors)
                 {
-                    dataInspector->InspectRecord(*(event->source));
+                    dataInspector->InspectRecord(*(event.source));
                 }
             }
-            GetSystem()->sendEvent(event);
+            GetSystem()->sendEvent(&event);
         }
     }
 
+    void LogManagerImpl::InitializeIngestionQueue()
+    {
+        if (!m_system || !static_cast<bool>(m_logConfiguration[CFG_MAP_INGESTION][CFG_BOOL_INGESTION_ENABLED]))
+        {
+            return;
+        }
+        const uint32_t queueSize = m_logConfiguration[CFG_MAP_INGESTION][CFG_INT_INGESTION_QUEUE_SIZE];
+        const uint32_t threads = m_logConfiguration[CFG_MAP_INGESTION][CFG_INT_INGESTION_THREADS];
+        const char* backpressure = m_logConfiguration[CFG_MAP_INGESTION][CFG_STR_INGESTION_BACKPRESSURE];
+        const auto policy = EventIngestionQueue::ParsePolicy((backpressure != nullptr) ? backpressure : "");
+        m_ingestionQueue.reset(new EventIngestionQueue(queueSize, threads, policy,
+            [this](IncomingEventContext& event) { processEvent(event); }));
+        LOG_INFO("Ingestion queue enabled: size=%u, threads=%u, backpressure=%s",
+                 queueSize, threads, (backpressure != nullptr) ? backpressure : "block");
+    }
+
     ILogController* LogManagerImpl::GetLogController()
     {
         return this;
     }
 
+    status_t LogManagerImpl::GetPipelineStats(PipelineStats& stats, bool reset)
+    {
+        LOCKGUARD(m_lock);
+        stats = PipelineStats();
+        if (!m_system || !m_system->getPipelineStats(stats, reset))
+        {
+            return STATUS_ENOSYS;
+        }
+        if (m_ingestionQueue)
+        {
+            PipelineQueueStats ingestion;
+            ingestion.name = "ingestion";
+            ingestion.depth = m_ingestionQueue->GetQueuedCount();
+            ingestion.maxDepth = m_ingestionQueue->GetMaxQueuedCount();
+            stats.queues.insert(stats.queues.begin(), ingestion);
+        }
+        return STATUS_SUCCESS;
+    }
+
     IAuthTokensController* LogManagerImpl::GetAuthTokensController()
     {
         return &m_authTokensController;
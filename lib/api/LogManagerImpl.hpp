@@ -18,6 +18,7 @@
 
 #include "api/ContextFieldsProvider.hpp"
 #include "api/Logger.hpp"
+#include "api/LoggerCache.hpp"
 
 #include "DebugEvents.hpp"
 #include <memory>
@@ -31,6 +32,7 @@
 
 #include "IDataInspector.hpp"
 #include "offline/LogSessionDataProvider.hpp"
+#include "system/EventIngestionQueue.hpp"
 
 #include <condition_variable>
 #include <mutex>
@@ -234,6 +236,8 @@ namespace MAT_NS_BEGIN
 
         ILogController* GetLogController(void) override;
 
+        status_t GetPipelineStats(PipelineStats& stats, bool reset = false) override;
+
         IAuthTokensController* GetAuthTokensController() override;
 
         IEventFilterCollection& GetEventFilters() noexcept override;
@@ -261,6 +265,8 @@ namespace MAT_NS_BEGIN
         /// <returns></returns>
         virtual bool DispatchEvent(DebugEvent evt) override;
 
+        virtual bool HasListeners(DebugEventType type) const override;
+
         ///
         virtual bool AttachEventSource(DebugEventSource& other) override;
 
@@ -312,12 +318,20 @@ namespace MAT_NS_BEGIN
         std::unique_ptr<ITelemetrySystem>& GetSystem();
         void InitializeModules() noexcept;
         void TeardownModules() noexcept;
+        void InitializeIngestionQueue();
+
+        /// <summary>
+        /// Runs the decorator, data inspectors and telemetry system for one event.
+        /// Called on the logging thread, or on a pipeline thread in ingestion mode.
+        /// </summary>
+        void processEvent(IncomingEventContext& event);
 
         MATSDK_LOG_DECL_COMPONENT_CLASS();
 
         static DeadLoggers s_deadLoggers;
         std::recursive_mutex m_lock;
         LoggerMap m_loggers;
+        LoggerCache m_loggerCache;
         ContextFieldsProvider m_context;
 
         std::shared_ptr<IHttpClient> m_httpClient;
@@ -339,6 +353,8 @@ namespace MAT_NS_BEGIN
 
         bool m_alive;
 
+        std::unique_ptr<EventIngestionQueue> m_ingestionQueue;
+
         DebugEventSource m_debugEventSource;
         DiagLevelFilter m_diagLevelFilter;
 
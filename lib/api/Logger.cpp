@@ -7,6 +7,8 @@
 #include "CommonFields.h"
 #include "LogSessionData.hpp"
 #include "NullObjects.hpp"
+#include "utils/PropertyNameTable.hpp"
+#include "utils/RecordIdAllocator.hpp"
 #include "utils/Utils.hpp"
 
 #include <algorithm>
@@ -155,7 +157,7 @@ namespace MAT_NS_BEGIN
         LOG_TRACE("%p: SetContext( properties.name=\"%s\", properties.value=\"%s\", PII=%u, ...)",
                   this, name.c_str(), prop.to_string().c_str(), prop.piiKind);
 
-        const EventRejectedReason isValidPropertyName = validatePropertyName(name);
+        const EventRejectedReason isValidPropertyName = PropertyNameTable::GetInstance().Validate(name);
         if (isValidPropertyName != REJECTED_REASON_OK)
         {
             LOG_ERROR("Context name is invalid: %s", name.c_str());
@@ -270,7 +272,7 @@ namespace MAT_NS_BEGIN
             return;
         }
 
-        submit(record, properties);
+        submit(record, properties, DebugEventType::EVT_LOG_LIFECYCLE);
         DispatchEvent(DebugEvent(DebugEventType::EVT_LOG_LIFECYCLE, size_t(latency), size_t(0), static_cast<void*>(&record), sizeof(record)));
     }
 
@@ -330,7 +332,7 @@ namespace MAT_NS_BEGIN
             return;
         }
 
-        submit(record, properties);
+        submit(record, properties, DebugEventType::EVT_LOG_EVENT);
         DispatchEvent(DebugEvent(DebugEventType::EVT_LOG_EVENT, size_t(latency), size_t(0), static_cast<void*>(&record), sizeof(record)));
     }
 
@@ -380,7 +382,7 @@ namespace MAT_NS_BEGIN
             return;
         }
 
-        submit(record, properties);
+        submit(record, properties, DebugEventType::EVT_LOG_FAILURE);
         DispatchEvent(DebugEvent(DebugEventType::EVT_LOG_FAILURE, size_t(latency), size_t(0), static_cast<void*>(&record), sizeof(record)));
     }
 
@@ -430,7 +432,7 @@ namespace MAT_NS_BEGIN
             return;
         }
 
-        submit(record, properties);
+        submit(record, properties, DebugEventType::EVT_LOG_PAGEVIEW);
         DispatchEvent(DebugEvent(DebugEventType::EVT_LOG_PAGEVIEW, size_t(latency), size_t(0), (void*)(&record), sizeof(record)));
     }
 
@@ -483,7 +485,7 @@ namespace MAT_NS_BEGIN
             return;
         }
 
-        submit(record, properties);
+        submit(record, properties, DebugEventType::EVT_LOG_PAGEACTION);
         DispatchEvent(DebugEvent(DebugEventType::EVT_LOG_PAGEACTION, size_t(latency), size_t(0), (void*)(&record), sizeof(record)));
     }
 
@@ -528,8 +530,9 @@ namespace MAT_NS_BEGIN
         return m_baseDecorator.decorate(record) && m_semanticContextDecorator.decorate(record) && m_eventPropertiesDecorator.decorate(record, latency, properties);
     }
 
-    void Logger::submit(::CsProtocol::Record& record, const EventProperties& props)
+    void Logger::submit(::CsProtocol::Record& record, const EventProperties& props, DebugEventType logEventType)
     {
+        const int64_t submitted = PipelineTimes::Now();
         ActiveLoggerCall active(*this);
         if (active.LoggerIsDead())
         {
@@ -542,8 +545,9 @@ namespace MAT_NS_BEGIN
         auto levelFilter = m_logManager.GetLevelFilter();
         if (levelFilter.IsLevelFilterEnabled())
         {
-            const auto& m_props = props.GetProperties();
-            const auto it = m_props.find(COMMONFIELDS_EVENT_LEVEL);
+            bool hasLevel;
+            uint8_t propertyLevel;
+            std::tie(hasLevel, propertyLevel) = props.TryGetLevel();
             //
             // Level policy:
             // * get level from the COMMONFIELDS_EVENT_LEVEL property if set
@@ -553,7 +557,7 @@ namespace MAT_NS_BEGIN
             // then prefer to drop. This is user error: user set the range
             // restrition, but didn't specify the defaults.
             //
-            uint8_t level = (it != m_props.cend()) ? static_cast<uint8_t>(it->second.as_int64) : m_level;
+            uint8_t level = hasLevel ? propertyLevel : m_level;
             if (level == DIAG_LEVEL_DEFAULT)
             {
                 level = levelFilter.GetDefaultLevel();
@@ -583,9 +587,10 @@ namespace MAT_NS_BEGIN
             return;
         }
 
-        // TODO: [MG] - check if optimization is possible in generateUuidString
-        IncomingEventContext event(PAL::generateUuidString(), m_tenantToken, latency, persistence, &record);
+        IncomingEventContext event(RecordIdAllocator::GetInstance().Next(), m_tenantToken, latency, persistence, &record);
         event.policyBitFlags = policyBitFlags;
+        event.pipelineTimes.submitted = submitted;
+        event.keepSource = m_logManager.HasListeners(logEventType);
 
         m_logManager.sendEvent(&event);
     }
@@ -639,7 +644,7 @@ namespace MAT_NS_BEGIN
             return;
         }
 
-        submit(record, properties);
+        submit(record, properties, DebugEventType::EVT_LOG_SAMPLEMETR);
         DispatchEvent(DebugEvent(DebugEventType::EVT_LOG_SAMPLEMETR, size_t(latency), size_t(0), (void*)(&record), sizeof(record)));
     }
 
@@ -695,7 +700,7 @@ namespace MAT_NS_BEGIN
             return;
         }
 
-        submit(record, properties);
+        submit(record, properties, DebugEventType::EVT_LOG_AGGRMETR);
         DispatchEvent(DebugEvent(DebugEventType::EVT_LOG_AGGRMETR, size_t(latency), size_t(0), (void*)(&record), sizeof(record)));
     }
 
@@ -733,7 +738,7 @@ namespace MAT_NS_BEGIN
             return;
         }
 
-        submit(record, properties);
+        submit(record, properties, DebugEventType::EVT_LOG_TRACE);
         DispatchEvent(DebugEvent(DebugEventType::EVT_LOG_TRACE, size_t(latency), size_t(0), (void*)(&record), sizeof(record)));
     }
 
@@ -771,7 +776,7 @@ namespace MAT_NS_BEGIN
             return;
         }
 
-        submit(record, properties);
+        submit(record, properties, DebugEventType::EVT_LOG_USERSTATE);
         DispatchEvent(DebugEvent(DebugEventType::EVT_LOG_USERSTATE, size_t(latency), size_t(0), (void*)(&record), sizeof(record)));
     }
 
@@ -873,7 +878,7 @@ namespace MAT_NS_BEGIN
             return;
         }
 
-        submit(record, props);
+        submit(record, props, DebugEventType::EVT_LOG_SESSION);
         DispatchEvent(DebugEvent(DebugEventType::EVT_LOG_SESSION, size_t(latency), size_t(0), (void*)(&record), sizeof(record)));
     }
 
@@ -231,8 +231,10 @@ namespace MAT_NS_BEGIN
                                    EventProperties const& properties,
                                    MAT::EventLatency& latency);
 
+        /// <summary>Hands the record to the pipeline. The record is moved out
+        /// unless logEventType has listeners, which get it once submit returns.</summary>
         virtual void
-        submit(::CsProtocol::Record& record, const EventProperties& props);
+        submit(::CsProtocol::Record& record, const EventProperties& props, DebugEventType logEventType);
 
         bool
         CanEventPropertiesBeSent(EventProperties const& properties) const noexcept;
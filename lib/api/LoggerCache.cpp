@@ -0,0 +1,175 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "LoggerCache.hpp"
+#include "CommonFields.h"
+
+#include <cctype>
+
+namespace MAT_NS_BEGIN
+{
+    namespace
+    {
+        constexpr size_t kInitialCapacity = 16;
+
+        inline char foldCase(char c) noexcept
+        {
+            // Same folding as toLower, which normalizes the keys of LogManagerImpl
+            return static_cast<char>(::tolower(static_cast<unsigned char>(c)));
+        }
+
+        inline uint64_t hashAppend(uint64_t hash, const std::string& str) noexcept
+        {
+            for (char c : str)
+            {
+                hash ^= static_cast<unsigned char>(foldCase(c));
+                hash *= 0x100000001b3ULL;
+            }
+            return hash;
+        }
+
+        inline bool equalsFolded(const std::string& normalized, const std::string& str) noexcept
+        {
+            if (normalized.size() != str.size())
+            {
+                return false;
+            }
+            for (size_t i = 0; i < str.size(); i++)
+            {
+                if (normalized[i] != foldCase(str[i]))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+    }
+
+    LoggerCache::Table::Table(size_t capacity) :
+        mask(capacity - 1),
+        count(0),
+        slots(new std::atomic<Entry*>[capacity])
+    {
+        for (size_t i = 0; i < capacity; i++)
+        {
+            slots[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    LoggerCache::LoggerCache() noexcept :
+        m_table(nullptr)
+    {
+    }
+
+    LoggerCache::~LoggerCache() = default;
+
+    uint64_t LoggerCache::Hash(const std::string& tenantToken, const std::string& source) noexcept
+    {
+        // FNV-1a of the lower-cased "token/source"
+        uint64_t hash = hashAppend(0xcbf29ce484222325ULL, tenantToken);
+        hash ^= static_cast<unsigned char>('/');
+        hash *= 0x100000001b3ULL;
+        return hashAppend(hash, source);
+    }
+
+    LoggerCache::Entry* LoggerCache::Find(const std::string& tenantToken, const std::string& source) const noexcept
+    {
+        const Table* table = m_table.load(std::memory_order_acquire);
+        if (table == nullptr)
+        {
+            return nullptr;
+        }
+
+        const uint64_t hash = Hash(tenantToken, source);
+        // The table is never more than half full, so probing ends on an empty slot
+        for (size_t i = static_cast<size_t>(hash) & table->mask;; i = (i + 1) & table->mask)
+        {
+            Entry* entry = table->slots[i].load(std::memory_order_acquire);
+            if (entry == nullptr)
+            {
+                return nullptr;
+            }
+            if ((entry->hash == hash) && equalsFolded(entry->tenantToken, tenantToken) && equalsFolded(entry->source, source))
+            {
+                return entry;
+            }
+        }
+    }
+
+    void LoggerCache::insert(Table& table, Entry* entry) noexcept
+    {
+        size_t i = static_cast<size_t>(entry->hash) & table.mask;
+        while (table.slots[i].load(std::memory_order_relaxed) != nullptr)
+        {
+            i = (i + 1) & table.mask;
+        }
+        table.slots[i].store(entry, std::memory_order_release);
+        table.count++;
+    }
+
+    LoggerCache::Entry* LoggerCache::Add(const std::string& normalizedTenantToken, const std::string& normalizedSource, ILogger* logger)
+    {
+        Entry* existing = Find(normalizedTenantToken, normalizedSource);
+        if (existing != nullptr)
+        {
+            return existing;
+        }
+
+        // Keep the entry alive before any table can point at it
+        m_entries.push_back(std::unique_ptr<Entry>(new Entry()));
+        Entry* entry = m_entries.back().get();
+        entry->hash = Hash(normalizedTenantToken, normalizedSource);
+        entry->tenantToken = normalizedTenantToken;
+        entry->source = normalizedSource;
+        entry->logger = logger;
+        entry->level.store(DIAG_LEVEL_DEFAULT, std::memory_order_relaxed);
+
+        Table* table = m_table.load(std::memory_order_relaxed);
+        if ((table == nullptr) || ((table->count + 1) * 2 > table->mask + 1))
+        {
+            // Publish a larger copy. Readers still probing the old table
+            // either find their entry there or fall back to the caller's lock.
+            m_tables.push_back(std::unique_ptr<Table>(new Table((table == nullptr) ? kInitialCapacity : (table->mask + 1) * 2)));
+            Table* grown = m_tables.back().get();
+            if (table != nullptr)
+            {
+                for (size_t i = 0; i <= table->mask; i++)
+                {
+                    Entry* moved = table->slots[i].load(std::memory_order_relaxed);
+                    if (moved != nullptr)
+                    {
+                        insert(*grown, moved);
+                    }
+                }
+            }
+            insert(*grown, entry);
+            m_table.store(grown, std::memory_order_release);
+        }
+        else
+        {
+            insert(*table, entry);
+        }
+        return entry;
+    }
+
+    void LoggerCache::Clear()
+    {
+        m_table.store(nullptr, std::memory_order_release);
+        // A concurrent Find may still hold what is dropped now, so it is kept
+        // until the next Clear. What the previous Clear dropped is freed: Clear
+        // only runs on teardown, and no Find spans two of them.
+        m_clearedTables.swap(m_tables);
+        m_clearedEntries.swap(m_entries);
+        m_tables.clear();
+        m_entries.clear();
+    }
+
+    size_t LoggerCache::GetSize() const noexcept
+    {
+        const Table* table = m_table.load(std::memory_order_acquire);
+        return (table == nullptr) ? 0 : table->count;
+    }
+
+} MAT_NS_END
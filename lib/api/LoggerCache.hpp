@@ -0,0 +1,98 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef LOGGERCACHE_HPP
+#define LOGGERCACHE_HPP
+
+#include "ctmacros.hpp"
+#include "ILogger.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace MAT_NS_BEGIN
+{
+
+    /// <summary>
+    /// Read-mostly lookup of loggers by tenant token and source, compared
+    /// case-insensitively. Find hashes the key in place and probes an
+    /// open-addressing table without locking or allocating. Add and Clear
+    /// must be serialized by the caller. They fill free slots of the
+    /// published table, or publish a table twice as large once half of it
+    /// is used. Replaced tables stay allocated until the next Clear, and
+    /// what a Clear drops stays allocated until the Clear after it, so a
+    /// concurrent Find never reads freed memory.
+    /// </summary>
+    class LoggerCache
+    {
+    public:
+        struct Entry
+        {
+            uint64_t             hash;
+            std::string          tenantToken;
+            std::string          source;
+            ILogger*             logger;
+            // Last diagnostic level applied to the logger
+            std::atomic<uint8_t> level;
+        };
+
+        LoggerCache() noexcept;
+        ~LoggerCache();
+
+        LoggerCache(const LoggerCache&) = delete;
+        LoggerCache& operator=(const LoggerCache&) = delete;
+
+        /// <summary>
+        /// Find the entry for the token and source. Safe to call concurrently
+        /// with Add and Clear.
+        /// </summary>
+        Entry* Find(const std::string& tenantToken, const std::string& source) const noexcept;
+
+        /// <summary>
+        /// Add a logger for the lower-cased token and source, or return the
+        /// entry already cached for them.
+        /// </summary>
+        Entry* Add(const std::string& normalizedTenantToken, const std::string& normalizedSource, ILogger* logger);
+
+        /// <summary>
+        /// Drop all entries, and free the ones dropped by the previous Clear.
+        /// A Find must not span two calls. Loggers are not owned by the cache.
+        /// </summary>
+        void Clear();
+
+        /// <summary>
+        /// Number of cached loggers. Must be serialized with Add and Clear.
+        /// </summary>
+        size_t GetSize() const noexcept;
+
+        static uint64_t Hash(const std::string& tenantToken, const std::string& source) noexcept;
+
+    private:
+        struct Table
+        {
+            explicit Table(size_t capacity);
+
+            size_t                                mask;
+            size_t                                count;
+            std::unique_ptr<std::atomic<Entry*>[]> slots;
+        };
+
+        static void insert(Table& table, Entry* entry) noexcept;
+
+        std::atomic<Table*>                  m_table;
+        // Published and replaced tables, and every entry published since
+        // the last Clear
+        std::vector<std::unique_ptr<Table>>  m_tables;
+        std::vector<std::unique_ptr<Entry>>  m_entries;
+        // What the last Clear dropped
+        std::vector<std::unique_ptr<Table>>  m_clearedTables;
+        std::vector<std::unique_ptr<Entry>>  m_clearedEntries;
+    };
+
+} MAT_NS_END
+
+#endif // LOGGERCACHE_HPP
@@ -17,9 +17,13 @@
 
 #include "CommonFields.h"
 
+#include <algorithm>
 #include <mutex>
 #include <map>
+#include <memory>
+#include <vector>
 #include <cstdint>
+#include <cstring>
 
 static const char * libSemver = TELEMETRY_EVENTS_VERSION;
 
@@ -28,6 +32,29 @@ using namespace MAT;
 static std::mutex mtx;
 static std::map<evt_handle_t, capi_client> clients;
 
+/// <summary>
+/// Per-client state of the C API loggers, kept out of capi_client.
+///
+/// scope      - context scope of the loggers, resolved from config on open
+/// lock       - guards generation and loggers, and is held while a batch
+///              logs through a logger handle
+/// generation - bumped whenever the table is cleared
+/// loggers    - loggers handed out by evt_get_logger
+///
+/// A logger handle carries the generation in its upper 32 bits and the table
+/// index + 1 in its lower 32 bits, so handles issued before a teardown are
+/// rejected rather than resolved to a logger that has been destroyed.
+/// </summary>
+struct capi_loggers
+{
+    std::string           scope;
+    std::mutex            lock;
+    uint32_t              generation = 1;
+    std::vector<ILogger*> loggers;
+};
+
+static std::map<evt_handle_t, std::shared_ptr<capi_loggers>> clientLoggers;
+
 /// <summary>
 /// Convert from C API handle to internal C API client struct.
 ///
@@ -53,6 +80,17 @@ static void remove_client(evt_handle_t handle)
 {
     LOCKGUARD(mtx);
     clients.erase(handle);
+    clientLoggers.erase(handle);
+}
+
+/// <summary>
+/// Get the logger table of a C API handle, or nullptr if it is not open.
+/// </summary>
+static std::shared_ptr<capi_loggers> get_loggers(evt_handle_t handle)
+{
+    LOCKGUARD(mtx);
+    const auto it = clientLoggers.find(handle);
+    return (it != clientLoggers.cend()) ? it->second : nullptr;
 }
 
 #define VERIFY_CLIENT_HANDLE(client, ctx)                       \
@@ -66,6 +104,32 @@ static void remove_client(evt_handle_t handle)
         return ENOENT;                                          \
     };
 
+/// <summary>
+/// Resolve the context scope of C API loggers from configuration.
+/// </summary>
+static std::string get_context_scope(ILogConfiguration& config)
+{
+    // Privacy feature for OTEL C API client:
+    //
+    // C API customer that does not explicitly pass down JSON
+    //   config["config]["scope"] = COMMONFIELDS_SCOPE_ALL;
+    //
+    // should not be able to capture the host's context vars.
+    std::string scope = CONTEXT_SCOPE_NONE;
+    MAT::VariantMap &config_map = config[CFG_MAP_FACTORY_CONFIG];
+    const auto & it = config_map.find(CFG_STR_CONTEXT_SCOPE);
+    if (it != config_map.cend())
+    {
+        scope = static_cast<const char *>(it->second);
+        // Specifying "*" in JSON config allows Guest C API logger to capture Host context variables
+        if (scope == CONTEXT_SCOPE_ALL)
+        {
+            scope = CONTEXT_SCOPE_EMPTY;
+        }
+    }
+    return scope;
+}
+
 static evt_status_t mat_open_core(
     evt_context_t *ctx,
     const char* config,
@@ -139,6 +203,12 @@ static evt_status_t mat_open_core(
 
     // Remember the original config string. Needed to avoid hash code collisions
     clients[code].ctx_data = config;
+    {
+        auto loggers = std::make_shared<capi_loggers>();
+        loggers->scope = get_context_scope(clients[code].config);
+        LOCKGUARD(mtx);
+        clientLoggers[code] = std::move(loggers);
+    }
 
 #if !defined (ANDROID) || defined(ENABLE_CAPI_HTTP_CLIENT)
     // Create custom HttpClient
@@ -249,6 +319,43 @@ static evt_status_t mat_open_with_params(evt_context_t *ctx)
     return mat_open_core(ctx, data->config, httpSendFn, httpCancelFn, taskDispatcherQueueFn, taskDispatcherCancelFn, taskDispatcherJoinFn);
 }
 
+/// <summary>
+/// Unpack C event properties, moving the iKey and event source out of the
+/// property bag into token and source. Both are read from the packed array,
+/// so the property map is never materialized.
+/// </summary>
+static void unpack_event(const evt_prop* evt, uint32_t size, EventProperties& props, std::string& token, std::string& source)
+{
+    token.clear();
+    source.clear();
+    bool hasIKey = false;
+    if (evt != nullptr)
+    {
+        // Same bounds as EventProperties::unpack, the last occurrence wins
+        const size_t count = (size == 0) ? SIZE_MAX : size;
+        for (size_t i = 0; (i < count) && (evt[i].type != TYPE_NULL); i++)
+        {
+            const evt_prop& prop = evt[i];
+            const bool isString = (prop.type == TYPE_STRING) && (prop.value.as_string != nullptr);
+            if (std::strcmp(prop.name, COMMONFIELDS_IKEY) == 0)
+            {
+                hasIKey = true;
+                token = isString ? prop.value.as_string : "";
+            }
+            else if (std::strcmp(prop.name, COMMONFIELDS_EVENT_SOURCE) == 0)
+            {
+                source = isString ? prop.value.as_string : "";
+            }
+        }
+    }
+
+    props.unpack(evt, size);
+    if (hasIKey)
+    {
+        props.erase(COMMONFIELDS_IKEY);
+    }
+}
+
 /**
  * Marshal C struct to C++ API
  */
@@ -256,41 +363,18 @@ static evt_status_t mat_log(evt_context_t *ctx)
 {
     VERIFY_CLIENT_HANDLE(client, ctx);
 
-    ILogConfiguration & config = client->config;
     const evt_prop *evt = static_cast<evt_prop*>(ctx->data);
     EventProperties props;
-    props.unpack(evt, ctx->size);
+    std::string token;
+    std::string source;
+    unpack_event(evt, ctx->size, props, token, source);
 
-    auto m = props.GetProperties();
-    EventProperty &prop = m[COMMONFIELDS_IKEY];
-    std::string token = prop.as_string;
-    props.erase(COMMONFIELDS_IKEY);
-
-    // Privacy feature for OTEL C API client:
-    //
-    // C API customer that does not explicitly pass down JSON
-    //   config["config]["scope"] = COMMONFIELDS_SCOPE_ALL;
-    //
-    // should not be able to capture the host's context vars.
-    std::string scope = CONTEXT_SCOPE_NONE;
+    const auto loggers = get_loggers(ctx->handle);
+    if (loggers == nullptr)
     {
-        MAT::VariantMap &config_map = config[CFG_MAP_FACTORY_CONFIG];
-        const auto & it = config_map.find(CFG_STR_CONTEXT_SCOPE);
-        if (it != config_map.cend())
-        {
-            scope = static_cast<const char *>(it->second);
-            // Specifying "*" in JSON config allows Guest C API logger to capture Host context variables
-            if (scope == CONTEXT_SCOPE_ALL)
-            {
-                scope = CONTEXT_SCOPE_EMPTY;
-            }
-        }
+        return ENOENT;
     }
-
-    const auto & it = m.find(COMMONFIELDS_EVENT_SOURCE);
-    std::string source = ((it != m.cend()) && (it->second.type == EventProperty::TYPE_STRING)) ? it->second.as_string : "";
-
-    ILogger *logger = client->logmanager->GetLogger(token, source, scope);
+    ILogger *logger = client->logmanager->GetLogger(token, source, loggers->scope);
     if (logger == nullptr)
     {
         ctx->result = EFAULT; /* invalid address */
@@ -304,6 +388,143 @@ static evt_status_t mat_log(evt_context_t *ctx)
     return ctx->result;
 }
 
+/**
+ * Resolve a logger once and hand out a handle to it
+ */
+static evt_status_t mat_get_logger(evt_context_t *ctx)
+{
+    VERIFY_CLIENT_HANDLE(client, ctx);
+
+    evt_logger_data_t *data = static_cast<evt_logger_data_t*>(ctx->data);
+    if (data == nullptr)
+    {
+        ctx->result = EFAULT;
+        return EFAULT;
+    }
+    data->logger = 0;
+
+    const auto loggers = get_loggers(ctx->handle);
+    if (loggers == nullptr)
+    {
+        return ENOENT;
+    }
+
+    const std::string token = (data->token != nullptr) ? data->token : "";
+    const std::string source = (data->source != nullptr) ? data->source : "";
+    // Resolved under the table lock, so that a concurrent teardown cannot
+    // destroy the logger before it is in the table it clears.
+    LOCKGUARD(loggers->lock);
+    ILogger *logger = client->logmanager->GetLogger(token, source, loggers->scope);
+    if (logger == nullptr)
+    {
+        ctx->result = EFAULT; /* invalid address */
+        return EFAULT;
+    }
+    logger->SetParentContext(nullptr);
+
+    // The log manager returns the same logger for the same token and source,
+    // so handing it out again keeps the table bounded.
+    auto it = std::find(loggers->loggers.cbegin(), loggers->loggers.cend(), logger);
+    if (it == loggers->loggers.cend())
+    {
+        it = loggers->loggers.insert(loggers->loggers.cend(), logger);
+    }
+    const uint64_t index = static_cast<uint64_t>(it - loggers->loggers.cbegin()) + 1;
+    data->logger = static_cast<evt_logger_t>((static_cast<uint64_t>(loggers->generation) << 32) | index);
+    ctx->result = EOK;
+    return EOK;
+}
+
+/**
+ * Log ctx->size events in one call. On return ctx->size holds the number of
+ * events that were logged.
+ */
+static evt_status_t mat_log_batch(evt_context_t *ctx)
+{
+    VERIFY_CLIENT_HANDLE(client, ctx);
+
+    const evt_log_batch_data_t *data = static_cast<evt_log_batch_data_t*>(ctx->data);
+    if ((data == nullptr) || ((data->events == nullptr) && (ctx->size != 0)))
+    {
+        ctx->result = EFAULT;
+        return EFAULT;
+    }
+
+    const auto loggers = get_loggers(ctx->handle);
+    if (loggers == nullptr)
+    {
+        return ENOENT;
+    }
+
+    // Teardown clears the table under this lock, so a logger from the table
+    // stays alive until the batch is done.
+    std::unique_lock<std::mutex> loggersLock(loggers->lock, std::defer_lock);
+    ILogger *logger = nullptr;
+    if (data->logger != 0)
+    {
+        loggersLock.lock();
+        const uint64_t value = static_cast<uint64_t>(data->logger);
+        const uint64_t index = value & 0xFFFFFFFFull;
+        if (((value >> 32) != loggers->generation) || (index == 0) || (index > loggers->loggers.size()))
+        {
+            ctx->result = ENOENT;
+            return ENOENT;
+        }
+        logger = loggers->loggers[static_cast<size_t>(index - 1)];
+    }
+
+    // Without a logger handle, consecutive events for the same iKey and
+    // source reuse the logger of the previous event.
+    std::string lastToken;
+    std::string lastSource;
+    ILogger *lastLogger = nullptr;
+
+    uint32_t logged = 0;
+    evt_status_t result = EOK;
+    for (uint32_t i = 0; i < ctx->size; i++)
+    {
+        const evt_prop *evt = data->events[i];
+        if (evt == nullptr)
+        {
+            result = EFAULT;
+            continue;
+        }
+
+        EventProperties props;
+        std::string token;
+        std::string source;
+        unpack_event(evt, 0, props, token, source);
+
+        ILogger *target = logger;
+        if (target == nullptr)
+        {
+            if ((lastLogger == nullptr) || (token != lastToken) || (source != lastSource))
+            {
+                lastLogger = client->logmanager->GetLogger(token, source, loggers->scope);
+                if (lastLogger != nullptr)
+                {
+                    lastLogger->SetParentContext(nullptr);
+                }
+                lastToken = token;
+                lastSource = source;
+            }
+            target = lastLogger;
+        }
+
+        if (target == nullptr)
+        {
+            result = EFAULT; /* invalid address */
+            continue;
+        }
+        target->LogEvent(props);
+        logged++;
+    }
+
+    ctx->size = logged;
+    ctx->result = result;
+    return result;
+}
+
 static evt_status_t mat_close(evt_context_t *ctx)
 {
     VERIFY_CLIENT_HANDLE(client, ctx);
@@ -351,6 +572,16 @@ static evt_status_t mat_upload(evt_context_t *ctx)
 static evt_status_t mat_flushAndTeardown(evt_context_t *ctx)
 {
     VERIFY_CLIENT_HANDLE(client, ctx);
+    // Teardown destroys the loggers: invalidate every handle to them first,
+    // and keep new handles from being issued until it is done.
+    const auto loggers = get_loggers(ctx->handle);
+    std::unique_lock<std::mutex> loggersLock;
+    if (loggers != nullptr)
+    {
+        loggersLock = std::unique_lock<std::mutex>(loggers->lock);
+        loggers->loggers.clear();
+        loggers->generation++;
+    }
     client->logmanager->FlushAndTeardown();
     ctx->result = STATUS_SUCCESS;
     return STATUS_SUCCESS;
@@ -441,6 +672,14 @@ extern "C" {
             case EVT_OP_FLUSHANDTEARDOWN:
                 result = mat_flushAndTeardown(ctx);
                 break;
+
+            case EVT_OP_GET_LOGGER:
+                result = mat_get_logger(ctx);
+                break;
+
+            case EVT_OP_LOG_BATCH:
+                result = mat_log_batch(ctx);
+                break;
                 // Add more OPs here
 
             default:
@@ -13,12 +13,28 @@
 
 namespace MAT_NS_BEGIN {
 
+    /* Scratch buffers that grew past this size are released rather than kept for the next event. */
+    static constexpr size_t MAX_RETAINED_SCRATCH_BYTES = 64 * 1024;
+
     bool BondSerializer::handleSerialize(IncomingEventContextPtr const& ctx)
     {
         OACR_USE_PTR(this);
         {
-            bond_lite::CompactBinaryProtocolWriter writer(ctx->record.blob);
-            bond_lite::Serialize(writer, *ctx->source);
+            // Serialize into a per-thread buffer that keeps its capacity between
+            // events, then copy the result into an exactly sized blob. This
+            // replaces the chain of reallocations a fresh vector goes through
+            // while the writer appends to it.
+            thread_local std::vector<uint8_t> scratch;
+            scratch.clear();
+            {
+                bond_lite::CompactBinaryProtocolWriter writer(scratch);
+                bond_lite::Serialize(writer, *ctx->source);
+            }
+            ctx->record.blob.assign(scratch.begin(), scratch.end());
+            if (scratch.capacity() > MAX_RETAINED_SCRATCH_BYTES)
+            {
+                std::vector<uint8_t>().swap(scratch);
+            }
         }
 
         LOG_TRACE("Event %s/%s submitted, priority %u (%s), serialized size %u bytes, ID %s",
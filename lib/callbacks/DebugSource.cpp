@@ -8,81 +8,677 @@
 #include "pal/PAL.hpp"
 
 #include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <thread>
 
 namespace MAT_NS_BEGIN {
 
+    namespace {
+
+        /// <summary>
+        /// Bounded queue in front of a listener, drained by a thread of its own.
+        /// </summary>
+        class DebugEventQueue : public std::enable_shared_from_this<DebugEventQueue>
+        {
+        public:
+            DebugEventQueue(DebugEventListener& listener, size_t capacity, std::shared_ptr<std::atomic<uint64_t>> dropped) :
+                m_listener(listener),
+                m_capacity(capacity),
+                m_dropped(std::move(dropped)),
+                m_stopped(false)
+            {
+            }
+
+            void Start()
+            {
+                // The thread keeps the queue alive, also when it has to be detached
+                m_thread = std::thread(&DebugEventQueue::Run, shared_from_this());
+            }
+
+            void Push(DebugEvent evt)
+            {
+                // Only valid while the event is being raised
+                evt.data = nullptr;
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    if (m_stopped)
+                    {
+                        return;
+                    }
+                    if (m_events.size() >= m_capacity)
+                    {
+                        m_dropped->fetch_add(1);
+                        return;
+                    }
+                    m_events.push_back(evt);
+                }
+                m_ready.notify_one();
+            }
+
+            size_t Capacity() const
+            {
+                return m_capacity;
+            }
+
+            /// <summary>
+            /// Discards the events not delivered yet and waits for the thread,
+            /// unless the listener stops its own queue.
+            /// </summary>
+            void Stop()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    m_stopped = true;
+                    m_dropped->fetch_add(m_events.size());
+                    m_events.clear();
+                }
+                m_ready.notify_all();
+                if (m_thread.joinable())
+                {
+                    if (m_thread.get_id() == std::this_thread::get_id())
+                    {
+                        m_thread.detach();
+                    }
+                    else
+                    {
+                        m_thread.join();
+                    }
+                }
+            }
+
+        protected:
+            void Run()
+            {
+                std::unique_lock<std::mutex> lock(m_lock);
+                for (;;)
+                {
+                    m_ready.wait(lock, [this]() { return m_stopped || !m_events.empty(); });
+                    if (m_stopped)
+                    {
+                        return;
+                    }
+                    DebugEvent evt = m_events.front();
+                    m_events.pop_front();
+                    lock.unlock();
+                    m_listener.OnDebugEvent(evt);
+                    lock.lock();
+                }
+            }
+
+            DebugEventListener&                     m_listener;
+            size_t                                  m_capacity;
+            std::shared_ptr<std::atomic<uint64_t>>  m_dropped;
+            std::mutex                              m_lock;
+            std::condition_variable                 m_ready;
+            std::deque<DebugEvent>                  m_events;
+            bool                                    m_stopped;
+            std::thread                             m_thread;
+        };
+
+        struct Subscriber
+        {
+            DebugEventListener*              listener;
+            std::shared_ptr<DebugEventQueue> queue;
+        };
+
+        /// <summary>
+        /// Immutable copy of the listeners and cascaded sources, read by DispatchEvent.
+        /// </summary>
+        struct Snapshot
+        {
+            std::map<unsigned, std::vector<Subscriber>> listeners;
+            std::vector<DebugEventSource*>              cascaded;
+        };
+
+        // Nesting depth of dispatch calls on this thread, for listeners that
+        // change listeners: they cannot wait for their own dispatch to end.
+        thread_local unsigned t_dispatchDepth = 0;
+
+        /// <summary>
+        /// Readers announce themselves on one of two counters before loading the
+        /// snapshot. A writer swaps the snapshot, then waits for both counters to
+        /// drain before it frees the old one; readers that start meanwhile see the
+        /// new snapshot, and flipping the epoch sends them to the other counter so
+        /// the wait ends even while events keep coming.
+        /// </summary>
+        struct DispatchState
+        {
+            std::atomic<Snapshot*> current;
+            std::atomic<unsigned>  epoch;
+            std::atomic<unsigned>  readers[2];
+            std::atomic<uint64_t>  seq;
+            std::shared_ptr<std::atomic<uint64_t>> dropped;
+
+            // Guarded by stateLock()
+            std::map<std::pair<unsigned, DebugEventListener*>, std::shared_ptr<DebugEventQueue>> queues;
+            std::vector<std::unique_ptr<Snapshot>> retired;
+
+            DispatchState() :
+                current(nullptr),
+                epoch(0),
+                seq(0),
+                dropped(std::make_shared<std::atomic<uint64_t>>(0))
+            {
+                readers[0] = 0;
+                readers[1] = 0;
+            }
+
+            ~DispatchState() noexcept
+            {
+                for (auto& item : queues)
+                {
+                    item.second->Stop();
+                }
+                delete current.load();
+            }
+
+            void waitForReaders()
+            {
+                for (int i = 0; i < 2; i++)
+                {
+                    unsigned const previous = epoch.fetch_add(1);
+                    while (readers[previous & 1].load() != 0)
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+            }
+        };
+
+        class SnapshotReader
+        {
+        public:
+            explicit SnapshotReader(DispatchState& state) noexcept :
+                m_readers(state.readers[state.epoch.load() & 1])
+            {
+                m_readers.fetch_add(1);
+                m_snapshot = state.current.load();
+                t_dispatchDepth++;
+            }
+
+            ~SnapshotReader() noexcept
+            {
+                t_dispatchDepth--;
+                m_readers.fetch_sub(1);
+            }
+
+            SnapshotReader(SnapshotReader const&) = delete;
+            SnapshotReader& operator=(SnapshotReader const&) = delete;
+
+            Snapshot const* get() const noexcept
+            {
+                return m_snapshot;
+            }
+
+        protected:
+            std::atomic<unsigned>& m_readers;
+            Snapshot const*        m_snapshot;
+        };
+
+        /// <summary>
+        /// Dispatch state of the sources built by this library, kept aside so that
+        /// DebugEventSource keeps the layout of its public declaration. A source
+        /// built by inline code of an older header is not in it and dispatches
+        /// under stateLock() like it used to.
+        ///
+        /// Every thread remembers the last few lookups until a source is added or
+        /// removed, so dispatching does not take the registry lock either.
+        /// </summary>
+        class DispatchRegistry
+        {
+        public:
+            static DispatchRegistry& instance()
+            {
+                // Never destroyed: static sources may outlive it
+                static DispatchRegistry* registry = new DispatchRegistry();
+                return *registry;
+            }
+
+            void add(DebugEventSource const* source, DispatchState* state)
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_states[source] = state;
+                m_generation.fetch_add(1);
+            }
+
+            DispatchState* remove(DebugEventSource const* source)
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                auto it = m_states.find(source);
+                if (it == m_states.end())
+                {
+                    return nullptr;
+                }
+                DispatchState* state = it->second;
+                m_states.erase(it);
+                m_generation.fetch_add(1);
+                return state;
+            }
+
+            DispatchState* find(DebugEventSource const* source)
+            {
+                Cache& cache = t_cache;
+                uint64_t const generation = m_generation.load();
+                if (cache.generation != generation)
+                {
+                    cache = Cache();
+                    cache.generation = generation;
+                }
+                for (size_t i = 0; i < CacheSize; i++)
+                {
+                    if (cache.sources[i] == source)
+                    {
+                        return cache.states[i];
+                    }
+                }
+
+                DispatchState* state = nullptr;
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    auto it = m_states.find(source);
+                    if (it != m_states.end())
+                    {
+                        state = it->second;
+                    }
+                }
+                cache.sources[cache.next] = source;
+                cache.states[cache.next] = state;
+                cache.next = (cache.next + 1) % CacheSize;
+                return state;
+            }
+
+        protected:
+            DispatchRegistry() :
+                m_generation(1)
+            {
+            }
+
+            static size_t const CacheSize = 4;
+
+            struct Cache
+            {
+                uint64_t                generation;
+                DebugEventSource const* sources[CacheSize];
+                DispatchState*          states[CacheSize];
+                size_t                  next;
+            };
+
+            static thread_local Cache t_cache;
+
+            std::mutex                                           m_lock;
+            std::map<DebugEventSource const*, DispatchState*>    m_states;
+            std::atomic<uint64_t>                                m_generation;
+        };
+
+        thread_local DispatchRegistry::Cache DispatchRegistry::t_cache;
+
+        DispatchState* findState(DebugEventSource const* source)
+        {
+            return DispatchRegistry::instance().find(source);
+        }
+
+    }
+
+    DebugEventSource::DebugEventSource() :
+        seq(0)
+    {
+        DispatchRegistry::instance().add(this, new DispatchState());
+    }
+
+    DebugEventSource::DebugEventSource(DebugEventSource const& other) :
+        DebugEventDispatcher(other),
+        seq(0)
+    {
+        DispatchRegistry::instance().add(this, new DispatchState());
+        *this = other;
+    }
+
+    DebugEventSource& DebugEventSource::operator=(DebugEventSource const& other)
+    {
+        if (&other == this)
+        {
+            return *this;
+        }
+
+        DispatchState* state = findState(this);
+        DispatchState* source = findState(&other);
+        std::map<std::pair<unsigned, DebugEventListener*>, std::shared_ptr<DebugEventQueue>> replaced;
+        {
+            DE_LOCKGUARD(stateLock());
+            listeners = other.listeners;
+            cascaded = other.cascaded;
+            seq = other.sequence();
+            if (state != nullptr)
+            {
+                state->seq = seq;
+                replaced.swap(state->queues);
+                if (source != nullptr)
+                {
+                    // Queued listeners get a queue of their own on this source too
+                    for (auto const& item : source->queues)
+                    {
+                        auto queue = std::make_shared<DebugEventQueue>(*item.first.second, item.second->Capacity(), state->dropped);
+                        queue->Start();
+                        state->queues[item.first] = std::move(queue);
+                    }
+                }
+                publish();
+            }
+        }
+        synchronize();
+        for (auto& item : replaced)
+        {
+            item.second->Stop();
+        }
+        return *this;
+    }
+
+    DebugEventSource::~DebugEventSource() noexcept
+    {
+        std::unique_ptr<DispatchState> state(DispatchRegistry::instance().remove(this));
+    }
+
     /// <summary>Add event listener for specific debug event type.</summary>
     void DebugEventSource::AddEventListener(DebugEventType type, DebugEventListener &listener)
     {
-        DE_LOCKGUARD(stateLock());
-        auto &v = listeners[type];
-        v.push_back(&listener);
+        {
+            DE_LOCKGUARD(stateLock());
+            auto &v = listeners[type];
+            v.push_back(&listener);
+            publish();
+        }
+        synchronize();
+    }
+
+    /// <summary>Add event listener that is called from a thread of its own.</summary>
+    void DebugEventSource::AddQueuedEventListener(DebugEventType type, DebugEventListener &listener, size_t maxQueuedEvents)
+    {
+        DispatchState* state = findState(this);
+        if (state == nullptr)
+        {
+            // Built by an older inline constructor: there is nowhere to keep the queue
+            AddEventListener(type, listener);
+            return;
+        }
+
+        {
+            DE_LOCKGUARD(stateLock());
+            auto& queue = state->queues[std::make_pair(static_cast<unsigned>(type), &listener)];
+            if (!queue)
+            {
+                queue = std::make_shared<DebugEventQueue>(listener, maxQueuedEvents, state->dropped);
+                queue->Start();
+            }
+            auto &v = listeners[type];
+            v.push_back(&listener);
+            publish();
+        }
+        synchronize();
     }
 
     /// <summary>Remove previously added debug event listener for specific type.</summary>
     void DebugEventSource::RemoveEventListener(DebugEventType type, DebugEventListener &listener)
     {
-        DE_LOCKGUARD(stateLock());
-        auto registeredTypes = listeners.find(type);
-        if (registeredTypes == listeners.end())
-            return;
+        DispatchState* state = findState(this);
+        std::shared_ptr<DebugEventQueue> queue;
+        {
+            DE_LOCKGUARD(stateLock());
+            auto registeredTypes = listeners.find(type);
+            if (registeredTypes == listeners.end())
+                return;
+
+            auto &registeredListeners = (*registeredTypes).second;
+            auto it = std::remove(registeredListeners.begin(), registeredListeners.end(), &listener);
+            registeredListeners.erase(it, registeredListeners.end());
 
-        auto &registeredListeners = (*registeredTypes).second;
-        auto it = std::remove(registeredListeners.begin(), registeredListeners.end(), &listener);
-        registeredListeners.erase(it, registeredListeners.end());
+            if (state != nullptr)
+            {
+                auto queued = state->queues.find(std::make_pair(static_cast<unsigned>(type), &listener));
+                if (queued != state->queues.end())
+                {
+                    queue = std::move(queued->second);
+                    state->queues.erase(queued);
+                }
+            }
+            publish();
+        }
+        synchronize();
+        // No dispatch pushes to the queue any more
+        if (queue)
+        {
+            queue->Stop();
+        }
     }
 
     /// <summary>Microsoft Telemetry SDK invokes this method to dispatch event to client callback</summary>
     bool DebugEventSource::DispatchEvent(DebugEvent evt)
     {
-        evt.ts = PAL::getUtcSystemTime();
-        bool dispatched = false;
-                
+        DispatchState* state = findState(this);
+        if (state == nullptr)
         {
+            // Built by an older inline constructor: dispatch under the lock
+            evt.ts = PAL::getUtcSystemTime();
+            bool dispatched = false;
+
             DE_LOCKGUARD(stateLock());
             seq++;
             evt.seq = seq;
 
-            if (listeners.size()) {
-                // Events filter handlers list
-                auto &v = listeners[evt.type];
-                for (auto listener : v) {
+            auto registered = listeners.find(evt.type);
+            if (registered != listeners.end())
+            {
+                for (auto listener : registered->second)
+                {
                     listener->OnDebugEvent(evt);
                     dispatched = true;
                 }
             }
 
-            if (cascaded.size())
+            for (auto item : cascaded)
+            {
+                item->DispatchEvent(evt);
+            }
+            return dispatched;
+        }
+
+        // Nobody listens: skip the clock and the sequence number too
+        if (state->current.load(std::memory_order_relaxed) == nullptr)
+        {
+            return false;
+        }
+
+        SnapshotReader reader(*state);
+        Snapshot const* snapshot = reader.get();
+        if (snapshot == nullptr)
+        {
+            return false;
+        }
+
+        evt.ts = PAL::getUtcSystemTime();
+        evt.seq = state->seq.fetch_add(1) + 1;
+        bool dispatched = false;
+
+        // Events filter handlers list
+        auto registered = snapshot->listeners.find(evt.type);
+        if (registered != snapshot->listeners.end())
+        {
+            for (auto const& subscriber : registered->second)
             {
-                // Cascade event to all other attached sources
-                for (auto item : cascaded)
+                if (subscriber.queue)
+                {
+                    subscriber.queue->Push(evt);
+                }
+                else
                 {
-                    if (item)
-                        item->DispatchEvent(evt);
+                    subscriber.listener->OnDebugEvent(evt);
                 }
+                dispatched = true;
             }
         }
 
+        // Cascade event to all other attached sources
+        for (auto item : snapshot->cascaded)
+        {
+            item->DispatchEvent(evt);
+        }
+
         return dispatched;
     }
 
+    bool DebugEventSource::HasListeners(DebugEventType type) const
+    {
+        DispatchState* state = findState(this);
+        if (state == nullptr)
+        {
+            DE_LOCKGUARD(stateLock());
+            auto registered = listeners.find(type);
+            if (registered != listeners.end() && !registered->second.empty())
+            {
+                return true;
+            }
+            for (auto item : cascaded)
+            {
+                if (item->HasListeners(type))
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        if (state->current.load(std::memory_order_relaxed) == nullptr)
+        {
+            return false;
+        }
+
+        SnapshotReader reader(*state);
+        Snapshot const* snapshot = reader.get();
+        if (snapshot == nullptr)
+        {
+            return false;
+        }
+        if (snapshot->listeners.find(type) != snapshot->listeners.end())
+        {
+            return true;
+        }
+        for (auto item : snapshot->cascaded)
+        {
+            if (item->HasListeners(type))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
     /// <summary>Attach cascaded DebugEventSource to forward all events to</summary>
     bool DebugEventSource::AttachEventSource(DebugEventSource & other)
     {
         if (&other == this)
            return false;
 
-        DE_LOCKGUARD(stateLock());
-        cascaded.insert(&other);
+        {
+            DE_LOCKGUARD(stateLock());
+            cascaded.insert(&other);
+            publish();
+        }
+        synchronize();
         return true;
     }
 
     /// <summary>Detach cascaded DebugEventSource to forward all events to</summary>
     bool DebugEventSource::DetachEventSource(DebugEventSource & other)
     {
-        DE_LOCKGUARD(stateLock());
-        return (cascaded.erase(&other)!=0);
+        {
+            DE_LOCKGUARD(stateLock());
+            if (cascaded.erase(&other) == 0)
+            {
+                return false;
+            }
+            publish();
+        }
+        synchronize();
+        return true;
     }
 
-} MAT_NS_END
+    uint64_t DebugEventSource::GetDroppedEventCount() const
+    {
+        DispatchState* state = findState(this);
+        return (state != nullptr) ? state->dropped->load() : 0;
+    }
+
+    uint64_t DebugEventSource::sequence() const
+    {
+        DispatchState* state = findState(this);
+        if (state == nullptr)
+        {
+            DE_LOCKGUARD(stateLock());
+            return seq;
+        }
+        return state->seq.load();
+    }
+
+    void DebugEventSource::publish()
+    {
+        DispatchState* state = findState(this);
+        if (state == nullptr)
+        {
+            return;
+        }
+
+        std::unique_ptr<Snapshot> next;
+        for (auto const& registered : listeners)
+        {
+            if (registered.second.empty())
+            {
+                continue;
+            }
+            if (!next)
+            {
+                next.reset(new Snapshot());
+            }
+            auto& subscribers = next->listeners[registered.first];
+            for (auto listener : registered.second)
+            {
+                auto queued = state->queues.find(std::make_pair(registered.first, listener));
+                subscribers.push_back(Subscriber { listener, (queued != state->queues.end()) ? queued->second : nullptr });
+            }
+        }
+        if (!cascaded.empty())
+        {
+            if (!next)
+            {
+                next.reset(new Snapshot());
+            }
+            next->cascaded.assign(cascaded.begin(), cascaded.end());
+        }
 
+        std::unique_ptr<Snapshot> previous(state->current.exchange(next.release()));
+        if (previous)
+        {
+            state->retired.push_back(std::move(previous));
+        }
+    }
+
+    void DebugEventSource::synchronize()
+    {
+        DispatchState* state = findState(this);
+        if (state == nullptr || t_dispatchDepth != 0)
+        {
+            // Called from a listener, possibly of this very source: waiting for
+            // readers would wait for ourselves. A later change frees the snapshots.
+            return;
+        }
+
+        std::vector<std::unique_ptr<Snapshot>> retired;
+        {
+            DE_LOCKGUARD(stateLock());
+            retired.swap(state->retired);
+        }
+        // Outside of stateLock(), which a listener may need to finish
+        state->waitForReaders();
+    }
+
+} MAT_NS_END
@@ -0,0 +1,196 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "mat/config.h"
+
+#include "CompressionCodecs.hpp"
+#include "pal/PAL.hpp"
+#include "utils/ZlibUtils.hpp"
+
+#include <fstream>
+#include <iterator>
+
+#ifdef HAVE_MAT_ZLIB
+#define ZLIB_CONST
+#include <zlib.h>
+#endif
+
+#ifdef HAVE_MAT_ZSTD
+#include <zstd.h>
+#include <zdict.h>
+#endif
+
+namespace MAT_NS_BEGIN {
+
+#ifdef HAVE_MAT_ZLIB
+    DeflateCodec::DeflateCodec(DeflateParameters const& parameters)
+        : m_stream(parameters),
+        m_isGzip(parameters.windowBits > MAX_WBITS)
+    {
+    }
+
+    const char* DeflateCodec::GetContentEncoding() const
+    {
+        return m_isGzip ? "gzip" : "deflate";
+    }
+
+    bool DeflateCodec::Compress(std::vector<uint8_t> const& in, std::vector<uint8_t>& out)
+    {
+        m_stream.reset();
+        bool result = m_stream.write(in.data(), in.size()) && m_stream.finish(out);
+        m_stream.reset();
+        return result;
+    }
+
+    bool DeflateCodec::Decompress(std::vector<uint8_t> const& in, std::vector<uint8_t>& out)
+    {
+        out.clear();
+        return ZlibUtils::InflateVector(in, out, m_isGzip);
+    }
+#endif
+
+#ifdef HAVE_MAT_ZSTD
+    struct ZstdCodec::State
+    {
+        ZSTD_CCtx*  cctx  = nullptr;
+        ZSTD_DCtx*  dctx  = nullptr;
+        ZSTD_CDict* cdict = nullptr;
+        ZSTD_DDict* ddict = nullptr;
+    };
+
+    ZstdCodec::ZstdCodec(int level, std::vector<uint8_t> const& dictionary)
+        : m_state(new State()),
+        m_level(level)
+    {
+        m_state->cctx = ZSTD_createCCtx();
+        m_state->dctx = ZSTD_createDCtx();
+        if (!dictionary.empty()) {
+            // Digested once here instead of on every request
+            m_state->cdict = ZSTD_createCDict(dictionary.data(), dictionary.size(), m_level);
+            m_state->ddict = ZSTD_createDDict(dictionary.data(), dictionary.size());
+            if (m_state->cdict == nullptr || m_state->ddict == nullptr) {
+                LOG_WARN("zstd dictionary of %u bytes could not be loaded", static_cast<unsigned>(dictionary.size()));
+            }
+        }
+    }
+
+    ZstdCodec::~ZstdCodec() noexcept
+    {
+        ZSTD_freeCDict(m_state->cdict);
+        ZSTD_freeDDict(m_state->ddict);
+        ZSTD_freeCCtx(m_state->cctx);
+        ZSTD_freeDCtx(m_state->dctx);
+    }
+
+    bool ZstdCodec::good() const
+    {
+        return m_state->cctx != nullptr && m_state->dctx != nullptr && (m_state->cdict == nullptr) == (m_state->ddict == nullptr);
+    }
+
+    const char* ZstdCodec::GetContentEncoding() const
+    {
+        return "zstd";
+    }
+
+    bool ZstdCodec::Compress(std::vector<uint8_t> const& in, std::vector<uint8_t>& out)
+    {
+        out.resize(ZSTD_compressBound(in.size()));
+        size_t result = (m_state->cdict != nullptr) ?
+            ZSTD_compress_usingCDict(m_state->cctx, out.data(), out.size(), in.data(), in.size(), m_state->cdict) :
+            ZSTD_compressCCtx(m_state->cctx, out.data(), out.size(), in.data(), in.size(), m_level);
+        if (ZSTD_isError(result)) {
+            LOG_WARN("zstd compression failed: %s", ZSTD_getErrorName(result));
+            out.clear();
+            return false;
+        }
+        out.resize(result);
+        return true;
+    }
+
+    bool ZstdCodec::Decompress(std::vector<uint8_t> const& in, std::vector<uint8_t>& out)
+    {
+        // Compress() always records the content size in the frame header.
+        unsigned long long size = ZSTD_getFrameContentSize(in.data(), in.size());
+        if (size == ZSTD_CONTENTSIZE_ERROR || size == ZSTD_CONTENTSIZE_UNKNOWN) {
+            LOG_WARN("zstd frame has no content size");
+            return false;
+        }
+        out.resize(static_cast<size_t>(size));
+        size_t result = (m_state->ddict != nullptr) ?
+            ZSTD_decompress_usingDDict(m_state->dctx, out.data(), out.size(), in.data(), in.size(), m_state->ddict) :
+            ZSTD_decompressDCtx(m_state->dctx, out.data(), out.size(), in.data(), in.size());
+        if (ZSTD_isError(result)) {
+            LOG_WARN("zstd decompression failed: %s", ZSTD_getErrorName(result));
+            out.clear();
+            return false;
+        }
+        out.resize(result);
+        return true;
+    }
+
+    bool ZstdCodec::TrainDictionary(std::vector<std::vector<uint8_t>> const& samples, size_t capacity, std::vector<uint8_t>& dictionary)
+    {
+        std::vector<uint8_t> buffer;
+        std::vector<size_t> sizes;
+        sizes.reserve(samples.size());
+        for (auto const& sample : samples) {
+            buffer.insert(buffer.end(), sample.begin(), sample.end());
+            sizes.push_back(sample.size());
+        }
+
+        dictionary.resize(capacity);
+        size_t result = ZDICT_trainFromBuffer(dictionary.data(), dictionary.size(), buffer.data(), sizes.data(), static_cast<unsigned>(sizes.size()));
+        if (ZDICT_isError(result)) {
+            LOG_WARN("zstd dictionary training failed: %s", ZDICT_getErrorName(result));
+            dictionary.clear();
+            return false;
+        }
+        dictionary.resize(result);
+        return true;
+    }
+#endif
+
+    namespace CompressionCodecFactory {
+
+        std::unique_ptr<ICompressionCodec> Create(std::string const& contentEncoding, int level, std::vector<uint8_t> const& dictionary)
+        {
+            UNREFERENCED_PARAMETER(level);
+            UNREFERENCED_PARAMETER(dictionary);
+#ifdef HAVE_MAT_ZLIB
+            if (contentEncoding == "deflate" || contentEncoding == "gzip") {
+                DeflateParameters parameters { level, (contentEncoding == "gzip") ? (MAX_WBITS | 16) : -MAX_WBITS, Z_DEFAULT_STRATEGY };
+                return std::unique_ptr<ICompressionCodec>(new DeflateCodec(parameters));
+            }
+#endif
+#ifdef HAVE_MAT_ZSTD
+            if (contentEncoding == "zstd") {
+                std::unique_ptr<ZstdCodec> codec(new ZstdCodec(level, dictionary));
+                if (codec->good()) {
+                    return std::unique_ptr<ICompressionCodec>(codec.release());
+                }
+                return nullptr;
+            }
+#endif
+            return nullptr;
+        }
+
+        std::vector<uint8_t> LoadDictionary(const char* path)
+        {
+            std::vector<uint8_t> dictionary;
+            if (path == nullptr || path[0] == '\0') {
+                return dictionary;
+            }
+            std::ifstream file(path, std::ios::binary);
+            if (!file) {
+                LOG_WARN("Compression dictionary %s cannot be read", path);
+                return dictionary;
+            }
+            dictionary.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            return dictionary;
+        }
+
+    }
+
+} MAT_NS_END
+
@@ -0,0 +1,88 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#pragma once
+#include "ctmacros.hpp"
+#include "ICompressionCodec.hpp"
+#include "DeflateStream.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace MAT_NS_BEGIN {
+
+    /// <summary>
+    /// zlib codec for the "deflate" (raw deflate) and "gzip" encodings.
+    /// </summary>
+    class DeflateCodec : public ICompressionCodec
+    {
+    public:
+        explicit DeflateCodec(DeflateParameters const& parameters);
+
+        const char* GetContentEncoding() const override;
+        bool Compress(std::vector<uint8_t> const& in, std::vector<uint8_t>& out) override;
+        bool Decompress(std::vector<uint8_t> const& in, std::vector<uint8_t>& out) override;
+
+    protected:
+        DeflateStream m_stream;
+        bool          m_isGzip;
+    };
+
+#ifdef HAVE_MAT_ZSTD
+    /// <summary>
+    /// zstd codec, optionally primed with a trained dictionary. Telemetry
+    /// bodies repeat the same iKeys, property names and Part A fields, which
+    /// a dictionary lets even a small request compress well. The receiving
+    /// side must hold the same dictionary; zstd frames carry its ID.
+    /// </summary>
+    class ZstdCodec : public ICompressionCodec
+    {
+    public:
+        ZstdCodec(int level, std::vector<uint8_t> const& dictionary);
+        ~ZstdCodec() noexcept;
+
+        ZstdCodec(ZstdCodec const&) = delete;
+        ZstdCodec& operator=(ZstdCodec const&) = delete;
+
+        bool good() const;
+
+        const char* GetContentEncoding() const override;
+        bool Compress(std::vector<uint8_t> const& in, std::vector<uint8_t>& out) override;
+        bool Decompress(std::vector<uint8_t> const& in, std::vector<uint8_t>& out) override;
+
+        /// <summary>
+        /// Trains a dictionary of at most capacity bytes from sample request
+        /// bodies or records. Returns false if zstd could not build one, e.g.
+        /// because there are too few samples.
+        /// </summary>
+        static bool TrainDictionary(std::vector<std::vector<uint8_t>> const& samples, size_t capacity, std::vector<uint8_t>& dictionary);
+
+    protected:
+        struct State;
+        std::unique_ptr<State> m_state;
+        int                    m_level;
+    };
+#endif
+
+    namespace CompressionCodecFactory {
+
+        /// <summary>
+        /// Codec for a Content-Encoding, or nullptr if it is not compiled into
+        /// this build. The level is codec specific; the dictionary is ignored
+        /// by codecs that do not support one.
+        /// </summary>
+        std::unique_ptr<ICompressionCodec> Create(std::string const& contentEncoding, int level, std::vector<uint8_t> const& dictionary);
+
+        /// <summary>
+        /// Reads a dictionary file. Returns an empty vector if the path is
+        /// empty or the file cannot be read.
+        /// </summary>
+        std::vector<uint8_t> LoadDictionary(const char* path);
+
+    }
+
+} MAT_NS_END
+
@@ -0,0 +1,184 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "mat/config.h"
+
+#include "DeflateStream.hpp"
+#include "pal/PAL.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef HAVE_MAT_ZLIB
+#define ZLIB_CONST
+#include <zlib.h>
+
+/* Output grows in steps of at least this many bytes */
+#define MIN_OUTPUT_CHUNK    16384
+
+namespace MAT_NS_BEGIN {
+
+    DeflateParameters DeflateParameters::FromConfig(IRuntimeConfig& runtimeConfig)
+    {
+        DeflateParameters parameters { Z_DEFAULT_COMPRESSION, -MAX_WBITS, Z_DEFAULT_STRATEGY };
+
+        // Plain "deflate": negative -MAX_WBITS argument which makes zlib use "raw deflate"
+        // without zlib header, as required by IIS.
+        // "gzip": Add 16 to windowBits to write a simple gzip header
+        if (runtimeConfig.GetHttpRequestContentEncoding() == "gzip") {
+            parameters.windowBits = MAX_WBITS | 16;
+        }
+
+        Variant& level = runtimeConfig[CFG_MAP_HTTP][CFG_INT_HTTP_COMPRESSION_LEVEL];
+        if (level.type == Variant::TYPE_INT) {
+            int value = static_cast<int>(static_cast<int64_t>(level));
+            if (value >= Z_DEFAULT_COMPRESSION && value <= Z_BEST_COMPRESSION) {
+                parameters.level = value;
+            }
+            else {
+                LOG_WARN("Ignoring invalid HTTP compression level %d", value);
+            }
+        }
+
+        const char* strategy = runtimeConfig[CFG_MAP_HTTP][CFG_STR_HTTP_COMPRESSION_STRATEGY];
+        if (strategy != nullptr && strategy[0] != '\0') {
+            if (strcmp(strategy, "filtered") == 0) {
+                parameters.strategy = Z_FILTERED;
+            }
+            else if (strcmp(strategy, "huffman") == 0) {
+                parameters.strategy = Z_HUFFMAN_ONLY;
+            }
+            else if (strcmp(strategy, "rle") == 0) {
+                parameters.strategy = Z_RLE;
+            }
+            else if (strcmp(strategy, "fixed") == 0) {
+                parameters.strategy = Z_FIXED;
+            }
+            else if (strcmp(strategy, "default") != 0) {
+                LOG_WARN("Ignoring unknown HTTP compression strategy \"%s\"", strategy);
+            }
+        }
+
+        return parameters;
+    }
+
+    const char* DeflateParameters::GetContentEncoding() const
+    {
+        return (windowBits > MAX_WBITS) ? "gzip" : "deflate";
+    }
+
+    struct DeflateStream::State
+    {
+        z_stream stream;
+    };
+
+    DeflateStream::DeflateStream(DeflateParameters const& parameters)
+        : m_state(new State()),
+        m_initialized(false),
+        m_good(false)
+    {
+        memset(&m_state->stream, 0, sizeof(m_state->stream));
+        int result = deflateInit2(&m_state->stream, parameters.level, Z_DEFLATED, parameters.windowBits, 8 /*DEF_MEM_LEVEL*/, parameters.strategy);
+        if (result != Z_OK) {
+            LOG_WARN("Streaming compression unavailable, error=%d (%s)", result, (m_state->stream.msg ? m_state->stream.msg : "(null)"));
+            return;
+        }
+        m_initialized = true;
+        m_good = true;
+    }
+
+    DeflateStream::~DeflateStream()
+    {
+        if (m_initialized) {
+            deflateEnd(&m_state->stream);
+        }
+    }
+
+    bool DeflateStream::good() const
+    {
+        return m_good;
+    }
+
+    bool DeflateStream::write(uint8_t const* data, size_t size)
+    {
+        if (!m_good) {
+            return false;
+        }
+        z_stream& stream = m_state->stream;
+        stream.next_in = data;
+        stream.avail_in = static_cast<uInt>(size);
+        return pump(Z_NO_FLUSH);
+    }
+
+    bool DeflateStream::finish(std::vector<uint8_t>& output)
+    {
+        if (!m_good) {
+            return false;
+        }
+        z_stream& stream = m_state->stream;
+        stream.next_in = nullptr;
+        stream.avail_in = 0;
+        if (!pump(Z_FINISH)) {
+            return false;
+        }
+        m_output.resize(stream.total_out);
+        output.swap(m_output);
+        m_output.clear();
+        // Nothing may be written until reset() starts a new body.
+        m_good = false;
+        return true;
+    }
+
+    void DeflateStream::reset()
+    {
+        if (!m_initialized) {
+            return;
+        }
+        deflateReset(&m_state->stream);
+        m_output.clear();
+        m_good = true;
+    }
+
+    size_t DeflateStream::totalIn() const
+    {
+        return m_initialized ? static_cast<size_t>(m_state->stream.total_in) : 0;
+    }
+
+    size_t DeflateStream::totalOut() const
+    {
+        return m_initialized ? static_cast<size_t>(m_state->stream.total_out) : 0;
+    }
+
+    bool DeflateStream::pump(int flush)
+    {
+        z_stream& stream = m_state->stream;
+        for (;;) {
+            const size_t used = static_cast<size_t>(stream.total_out);
+            if (m_output.size() - used < MIN_OUTPUT_CHUNK) {
+                // Grow geometrically so that a body costs O(log n) reallocations.
+                m_output.resize(m_output.size() + std::max<size_t>(MIN_OUTPUT_CHUNK, m_output.size() / 2));
+            }
+            stream.next_out = m_output.data() + used;
+            stream.avail_out = static_cast<uInt>(m_output.size() - used);
+
+            int result = deflate(&stream, flush);
+            if (result == Z_STREAM_END) {
+                return true;
+            }
+            if (result != Z_OK && result != Z_BUF_ERROR) {
+                LOG_WARN("Streaming compression failed, error=%d (%s)", result, (stream.msg ? stream.msg : "(null)"));
+                m_good = false;
+                return false;
+            }
+            if (flush == Z_NO_FLUSH && stream.avail_in == 0 && stream.avail_out != 0) {
+                // All input consumed; zlib keeps the rest in its window until the next call.
+                return true;
+            }
+        }
+    }
+
+} MAT_NS_END
+
+#endif
+
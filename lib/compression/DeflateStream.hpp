@@ -0,0 +1,89 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#pragma once
+#include "ctmacros.hpp"
+#include "api/IRuntimeConfig.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace MAT_NS_BEGIN {
+
+    /// <summary>
+    /// zlib settings for HTTP request compression, taken from the "http"
+    /// configuration map.
+    /// </summary>
+    struct DeflateParameters
+    {
+        int level;
+        int windowBits;
+        int strategy;
+
+        static DeflateParameters FromConfig(IRuntimeConfig& runtimeConfig);
+
+        /// <summary>
+        /// "gzip" or "deflate", the Content-Encoding of bodies written with these settings.
+        /// </summary>
+        const char* GetContentEncoding() const;
+
+        /// <summary>
+        /// Distinct for every combination of settings, and never 0.
+        /// </summary>
+        uint64_t GetKey() const
+        {
+            return (uint64_t { 1 } << 48) |
+                (static_cast<uint64_t>(static_cast<uint16_t>(level)) << 32) |
+                (static_cast<uint64_t>(static_cast<uint16_t>(windowBits)) << 16) |
+                static_cast<uint64_t>(static_cast<uint16_t>(strategy));
+        }
+    };
+
+    /// <summary>
+    /// Incremental deflate: input is compressed as it is written, so the
+    /// uncompressed request body never has to exist in one piece. The zlib
+    /// state survives reset(), so one stream serves any number of bodies.
+    /// </summary>
+    class DeflateStream
+    {
+    public:
+        explicit DeflateStream(DeflateParameters const& parameters);
+        ~DeflateStream();
+
+        DeflateStream(DeflateStream const&) = delete;
+        DeflateStream& operator=(DeflateStream const&) = delete;
+
+        /// <summary>
+        /// False if zlib could not be initialized or failed since the last reset().
+        /// </summary>
+        bool good() const;
+
+        bool write(uint8_t const* data, size_t size);
+
+        /// <summary>
+        /// Flushes pending input and hands over the compressed body. The stream
+        /// accepts no more input until reset().
+        /// </summary>
+        bool finish(std::vector<uint8_t>& output);
+
+        void reset();
+
+        size_t totalIn() const;
+        size_t totalOut() const;
+
+    protected:
+        bool pump(int flush);
+
+        struct State;
+        std::unique_ptr<State> m_state;
+        std::vector<uint8_t>   m_output;
+        bool                   m_initialized;
+        bool                   m_good;
+    };
+
+} MAT_NS_END
+
@@ -5,6 +5,8 @@
 #include "mat/config.h"
 
 #include "HttpDeflateCompression.hpp"
+#include "CompressionCodecs.hpp"
+#include "DeflateStream.hpp"
 #include "utils/Utils.hpp"
 #ifdef HAVE_MAT_ZLIB
 #define ZLIB_CONST
@@ -14,14 +16,20 @@
 namespace MAT_NS_BEGIN {
 
     HttpDeflateCompression::HttpDeflateCompression(IRuntimeConfig& runtimeConfig)
-        : m_config(runtimeConfig)
+        : m_config(runtimeConfig),
+        m_codecRejected(false)
     {
-        // Plain "deflate": negative -MAX_WBITS argument which makes zlib use "raw deflate"
-        // without zlib header, as required by IIS.
-        // "gzip": Add 16 to windowBits to write a simple gzip header
-#ifdef HAVE_MAT_ZLIB
-        m_windowBits = m_config.GetHttpRequestContentEncoding() == "gzip" ? (MAX_WBITS | 16) : -MAX_WBITS;
-#endif
+        std::string const& contentEncoding = m_config.GetHttpRequestContentEncoding();
+        if (contentEncoding != "deflate" && contentEncoding != "gzip") {
+            Variant& level = m_config[CFG_MAP_HTTP][CFG_INT_HTTP_ZSTD_LEVEL];
+            const char* dictionaryPath = m_config[CFG_MAP_HTTP][CFG_STR_HTTP_ZSTD_DICTIONARY];
+            m_codec = CompressionCodecFactory::Create(contentEncoding,
+                (level.type == Variant::TYPE_INT) ? static_cast<int>(static_cast<int64_t>(level)) : 0,
+                CompressionCodecFactory::LoadDictionary(dictionaryPath));
+            if (!m_codec) {
+                LOG_WARN("HTTP Content-Encoding \"%s\" is not available, using deflate", contentEncoding.c_str());
+            }
+        }
     }
 
     HttpDeflateCompression::~HttpDeflateCompression()
@@ -35,6 +43,23 @@ namespace MAT_NS_BEGIN {
         if (!m_config.IsHttpRequestCompressionEnabled()) {
             return true;
         }
+        if (ctx->compressed) {
+            // Deflated record by record while it was being packaged
+            return true;
+        }
+
+        if (m_codec && !m_codecRejected) {
+            std::vector<uint8_t> body;
+            if (!m_codec->Compress(ctx->body, body)) {
+                LOG_WARN("HTTP request compressing failed (%s)", m_codec->GetContentEncoding());
+                compressionFailed(ctx);
+                return false;
+            }
+            ctx->body.swap(body);
+            ctx->compressed = true;
+            ctx->contentEncoding = m_codec->GetContentEncoding();
+            return true;
+        }
 
         // Using a slightly adapted in-place compression technique as suggested
         // by Mark Adler himself: http://stackoverflow.com/a/12412863/3543211
@@ -42,7 +67,8 @@ namespace MAT_NS_BEGIN {
         z_stream stream;
         memset(&stream, 0, sizeof(stream));
 
-        int result = deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, m_windowBits, 8 /*DEF_MEM_LEVEL*/, Z_DEFAULT_STRATEGY);
+        DeflateParameters parameters = DeflateParameters::FromConfig(m_config);
+        int result = deflateInit2(&stream, parameters.level, Z_DEFLATED, parameters.windowBits, 8 /*DEF_MEM_LEVEL*/, parameters.strategy);
         if (result != Z_OK) {
             LOG_WARN("HTTP request compressing failed, error=%d/%d (%s)", 1, result, (stream.msg ? stream.msg : "(null)"));
             compressionFailed(ctx);
@@ -87,10 +113,18 @@ namespace MAT_NS_BEGIN {
 
         ctx->body.resize(stream.total_out);
         ctx->compressed = true;
+        ctx->contentEncoding = parameters.GetContentEncoding();
 #endif
         return true;
     }
 
+    void HttpDeflateCompression::handleContentEncodingRejected(EventsUploadContextPtr const& ctx)
+    {
+        if (m_codec && !m_codecRejected.exchange(true)) {
+            LOG_WARN("Collector rejected Content-Encoding \"%s\", using deflate from now on", ctx->contentEncoding.c_str());
+        }
+    }
+
 
 } MAT_NS_END
 
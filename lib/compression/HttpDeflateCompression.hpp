@@ -8,10 +8,19 @@
 #include "api/IRuntimeConfig.hpp"
 #include "system/Route.hpp"
 #include "system/Contexts.hpp"
+#include "ICompressionCodec.hpp"
+
+#include <atomic>
+#include <memory>
 
 namespace MAT_NS_BEGIN {
 
 
+    /// <summary>
+    /// Compresses request bodies with zlib, or with the codec named by the
+    /// "contentEncoding" setting when it is not a zlib encoding. If the
+    /// collector rejects that encoding, later requests fall back to deflate.
+    /// </summary>
     class HttpDeflateCompression {
     public:
         HttpDeflateCompression(IRuntimeConfig& runtimeConfig);
@@ -19,14 +28,17 @@ namespace MAT_NS_BEGIN {
 
     protected:
         bool handleCompress(EventsUploadContextPtr const& ctx);
+        void handleContentEncodingRejected(EventsUploadContextPtr const& ctx);
 
     protected:
         IRuntimeConfig& m_config;
-        int m_windowBits;
+        std::unique_ptr<ICompressionCodec> m_codec;
+        std::atomic<bool> m_codecRejected;
 
     public:
         RouteSource<EventsUploadContextPtr const&>                              compressionFailed;
         RoutePassThrough<HttpDeflateCompression, EventsUploadContextPtr const&> compress{ this, &HttpDeflateCompression::handleCompress };
+        RouteSink<HttpDeflateCompression, EventsUploadContextPtr const&>        contentEncodingRejected{ this, &HttpDeflateCompression::handleContentEncodingRejected };
     };
 
 } MAT_NS_END
@@ -0,0 +1,35 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#pragma once
+#include "ctmacros.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace MAT_NS_BEGIN {
+
+    /// <summary>
+    /// Whole-buffer compression codec for HTTP request bodies. Each codec
+    /// produces exactly one HTTP Content-Encoding and can decode its own
+    /// output, so the same object serves the uploader and PayloadDecoder.
+    /// </summary>
+    class ICompressionCodec
+    {
+    public:
+        virtual ~ICompressionCodec() noexcept = default;
+
+        /// <summary>
+        /// Value of the Content-Encoding header for bodies produced by Compress().
+        /// </summary>
+        virtual const char* GetContentEncoding() const = 0;
+
+        virtual bool Compress(std::vector<uint8_t> const& in, std::vector<uint8_t>& out) = 0;
+
+        virtual bool Decompress(std::vector<uint8_t> const& in, std::vector<uint8_t>& out) = 0;
+    };
+
+} MAT_NS_END
+
@@ -15,6 +15,7 @@ namespace MAT_NS_BEGIN
         {CFG_INT_SDK_MODE, SdkModeTypes::SdkModeTypes_CS},
         {CFG_BOOL_ENABLE_ANALYTICS, false},
         {CFG_INT_CACHE_FILE_SIZE, 3145728},
+        {CFG_STR_CACHE_FILE_FORMAT, "sqlite"},
         {CFG_INT_RAM_QUEUE_SIZE, 524288},
         {CFG_BOOL_ENABLE_MULTITENANT, true},
         {CFG_BOOL_ENABLE_DB_DROP_IF_FULL, false},
@@ -23,11 +24,15 @@ namespace MAT_NS_BEGIN
         {CFG_INT_RAM_QUEUE_BUFFERS, 3},
         {CFG_INT_TRACE_LEVEL_MASK, 0},
         {CFG_BOOL_ENABLE_TRACE, true},
+        {CFG_STR_TRACE_FORMAT, "text"},
         {CFG_STR_COLLECTOR_URL, COLLECTOR_URL_PROD},
         {CFG_INT_STORAGE_FULL_PCT, 75},
         {CFG_INT_STORAGE_FULL_CHECK_TIME, 5000},
+        {CFG_INT_STORAGE_VACUUM_PAGES, 256},
+        {CFG_INT_STORAGE_VACUUM_IDLE_TIME, 10000},
         {CFG_INT_RAMCACHE_FULL_PCT, 75},
         {CFG_BOOL_ENABLE_NET_DETECT, true},
+        {CFG_BOOL_ENABLE_PIPELINE_STATS, false},
         {CFG_BOOL_SESSION_RESET_ENABLED, false},
         {CFG_MAP_METASTATS_CONFIG,
          {/* Parameter that allows to split stats events by tenant */
@@ -59,18 +64,41 @@ namespace MAT_NS_BEGIN
 #endif
              ,
              {"contentEncoding", "deflate"},
+             /* zlib tuning for request compression */
+             {CFG_INT_HTTP_COMPRESSION_LEVEL, -1},
+             {CFG_STR_HTTP_COMPRESSION_STRATEGY, "default"},
+             {CFG_BOOL_HTTP_COMPRESSION_STREAMING, false},
+             /* Used when contentEncoding is "zstd" and the SDK is built with zstd */
+             {CFG_INT_HTTP_ZSTD_LEVEL, 3},
+             {CFG_STR_HTTP_ZSTD_DICTIONARY, ""},
              /* Optional parameter to require Microsoft Root CA */
              {CFG_BOOL_HTTP_MS_ROOT_CHECK, false},
              /* Optional parameter for SSL certificate verification (curl) */
              {CFG_BOOL_HTTP_SSL_VERIFY, true},
              /* Optional CA bundle path for OpenSSL-backed curl */
-             {CFG_STR_HTTP_SSL_CAINFO, ""}}},
+             {CFG_STR_HTTP_SSL_CAINFO, ""},
+             /* Connection warm-up and keep-alive (curl) */
+             {CFG_BOOL_HTTP_PRECONNECT, false},
+             {CFG_INT_HTTP_IDLE_CONNECTION_TIMEOUT, 118}}},
         {CFG_MAP_TPM,
          {
              {CFG_INT_TPM_MAX_BLOB_BYTES, 2097152},
              {CFG_INT_TPM_MAX_RETRY, 5},
              {CFG_BOOL_TPM_CLOCK_SKEW_ENABLED, true},
              {CFG_STR_TPM_BACKOFF, "E,3000,300000,2,1"},
+             {CFG_INT_TPM_MAX_PIPELINED_UPLOADS, 1},
+             {CFG_STR_TPM_UPLOAD_CONTROLLER, ""},
+         }},
+        {CFG_MAP_INGESTION,
+         {
+             {CFG_BOOL_INGESTION_ENABLED, false},
+             {CFG_INT_INGESTION_QUEUE_SIZE, 8192},
+             {CFG_INT_INGESTION_THREADS, 1},
+             {CFG_STR_INGESTION_BACKPRESSURE, "block"},
+         }},
+        {CFG_MAP_TASK_POOL,
+         {
+             {CFG_INT_TASK_POOL_THREADS, 1},
          }},
         {CFG_MAP_COMPAT,
          {
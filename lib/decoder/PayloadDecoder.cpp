@@ -26,6 +26,11 @@ namespace MAT_NS_BEGIN
         {
             return false;
         }
+
+        bool DecodeRequest(const std::vector<uint8_t>&, std::string&, const char*, const std::vector<uint8_t>&)
+        {
+            return false;
+        }
     };
 }
 MAT_NS_END
@@ -51,6 +56,7 @@ MAT_NS_END
 #include "CsProtocol_types.hpp"
 #include "bond/generated/CsProtocol_readers.hpp"
 #include "utils/ZlibUtils.hpp"
+#include "compression/CompressionCodecs.hpp"
 
 #include "zlib.h"
 #undef compress
@@ -574,6 +580,37 @@ namespace MAT_NS_BEGIN {
             return result;
         }
 
+        /// <summary>
+        /// Decodes a request body sent with the given HTTP Content-Encoding.
+        /// </summary>
+        /// <param name="in">Input request buffer containing HTTP request body</param>
+        /// <param name="out">Event payload in a human-readable format, e.g. JSON</param>
+        /// <param name="contentEncoding">Value of the Content-Encoding header, empty if the body is not compressed</param>
+        /// <param name="dictionary">Dictionary the body was compressed with, if the codec uses one (optional)</param>
+        bool DecodeRequest(const std::vector<uint8_t>& in, std::string& out, const char* contentEncoding, const std::vector<uint8_t>& dictionary)
+        {
+            if (contentEncoding == nullptr || contentEncoding[0] == '\0')
+            {
+                return DecodeRequest(in, out, false);
+            }
+
+            out.clear();
+            std::unique_ptr<ICompressionCodec> codec = CompressionCodecFactory::Create(contentEncoding, 0, dictionary);
+            if (!codec)
+            {
+                TEST_LOG_ERROR("Unsupported Content-Encoding: %s", contentEncoding);
+                return false;
+            }
+
+            std::vector<uint8_t> buffer;
+            if (!codec->Decompress(in, buffer))
+            {
+                TEST_LOG_ERROR("Failed to decompress %s data", contentEncoding);
+                return false;
+            }
+            return DecodeRequest(buffer, out, false);
+        }
+
         /// <summary>
         /// Decodes the record contents from binary into human-readable format.
         /// </summary>
@@ -10,11 +10,14 @@
 #include "RecordFlagConstants.hpp"
 #include "EventProperties.hpp"
 #include "CorrelationVector.hpp"
+#include "system/EventPropertiesStorage.hpp"
 #include "utils/Utils.hpp"
 
 #include <algorithm>
+#include <iterator>
 #include <map>
 #include <string>
+#include <tuple>
 #include <utility>
 
 namespace MAT_NS_BEGIN {
@@ -158,26 +161,52 @@ namespace MAT_NS_BEGIN {
             }
             record.flags = flags;
 
+            // Names were checked against PropertyNameTable as they were added
+            // to the event; SetProperty drops invalid ones, the bulk setters
+            // remember the first failure here.
+            EventRejectedReason isValidPropertyName = GetEventPropertiesStorage(eventProperties).invalidNameReason;
+            if (isValidPropertyName != REJECTED_REASON_OK)
+            {
+                DebugEvent evt;
+                evt.type = DebugEventType::EVT_REJECTED;
+                evt.param1 = isValidPropertyName;
+                m_owner.DispatchEvent(evt);
+                return false;
+            }
+
             std::map<std::string, ::CsProtocol::Value>& ext = record.data[0].properties;
             std::map<std::string, ::CsProtocol::Value> extPartB;
 
-            for (auto &kv : eventProperties.GetProperties()) {
-
-                EventRejectedReason isValidPropertyName = validatePropertyName(kv.first);
-                if (isValidPropertyName != REJECTED_REASON_OK)
+            // Properties come sorted by name, so each one is inserted right
+            // after the previous one instead of searching the whole tree.
+            // They are read straight from the flat storage, without going
+            // through the std::map that GetProperties() builds.
+            auto extHint = ext.begin();
+            auto extPartBHint = extPartB.begin();
+            auto put = [&](FlatPropertyMap::Entry const& entry, ::CsProtocol::Value&& value)
+            {
+                bool isPartB = (entry.dataCategory == DataCategory_PartB);
+                auto& hint = isPartB ? extPartBHint : extHint;
+                auto it = (isPartB ? extPartB : ext).emplace_hint(hint, std::piecewise_construct,
+                    std::forward_as_tuple(entry.name, entry.nameSize), std::forward_as_tuple());
+                it->second = std::move(value);
+                hint = std::next(it);
+            };
+            auto toString = [](FlatPropertyMap::Entry const& entry)
+            {
+                if (entry.type == EventProperty::TYPE_STRING)
                 {
-                    DebugEvent evt;
-                    evt.type = DebugEventType::EVT_REJECTED;
-                    evt.param1 = isValidPropertyName;
-                    m_owner.DispatchEvent(evt);
-                    return false;
+                    FlatPropertyMap::Slice value = entry.GetString();
+                    return std::string(value.data, value.size);
                 }
-                const auto &k = kv.first;
-                const auto &v = kv.second;
+                return entry.ToEventProperty().to_string();
+            };
+
+            for (auto const& v : GetEventPropertiesStorage(eventProperties).properties) {
                 if (v.piiKind != PiiKind_None)
                 {
                     if (v.piiKind == PiiKind::CustomerContentKind_GenericData)
-                    {  //LOG_TRACE("PIIExtensions: %s=%s (PiiKind=%u)", k.c_str(), v.to_string().c_str(), v.piiKind);
+                    {
                         CsProtocol::CustomerContent cc;
                         cc.Kind = CsProtocol::CustomerContentKind::GenericContent;
                         CsProtocol::Value temp;
@@ -186,19 +215,12 @@ namespace MAT_NS_BEGIN {
                         attrib.customerContent.push_back(cc);
 
                         temp.attributes.push_back(attrib);
-                        temp.stringValue = v.to_string();
-                        if (v.dataCategory == DataCategory_PartB)
-                        {
-                            extPartB[k] = std::move(temp);
-                        }
-                        else
-                        {
-                            ext[k] = std::move(temp);
-                        }
+                        temp.stringValue = toString(v);
+                        put(v, std::move(temp));
 
                     }
                     else
-                    { //LOG_TRACE("PIIExtensions: %s=%s (PiiKind=%u)", k.c_str(), v.to_string().c_str(), v.piiKind);
+                    {
                         CsProtocol::PII pii;
                         pii.Kind = static_cast<CsProtocol::PIIKind>(v.piiKind);
                         CsProtocol::Value temp;
@@ -208,57 +230,18 @@ namespace MAT_NS_BEGIN {
 
 
                         temp.attributes.push_back(attrib);
-                        temp.stringValue = v.to_string();
-                        if (v.dataCategory == DataCategory_PartB)
-                        {
-                            extPartB[k] = std::move(temp);
-                        }
-                        else
-                        {
-                            ext[k] = std::move(temp);
-                        }
-#if 0 /* v2 code */
-                        if (v.piiKind != PiiKind_None)
-                        {
-                            //LOG_TRACE("PIIExtensions: %s=%s (PiiKind=%u)", k.c_str(), v.to_string().c_str(), v.piiKind);
-                            CsProtocol::PII pii;
-                            pii.Kind = static_cast<CsProtocol::PIIKind>(v.piiKind);
-                            pii.RawContent = v.to_string();
-                            // ScrubType = 1 is the O365 scrubber which is the default behavior.
-                            // pii.ScrubType = static_cast<PIIScrubber>(O365);
-                            pii.ScrubType = CsProtocol::O365;
-                            PIIExtensions[k] = pii;
-                            // 4. Send event's Pii context fields as record.PIIExtensions
-                        }
-                        else
-                        {
-                            //LOG_TRACE("PIIExtensions: %s=%s (PiiKind=%u)", k.c_str(), v.to_string().c_str(), v.piiKind);
-                            CsProtocol::CustomerContent cc;
-                            cc.Kind = static_cast<CsProtocol::CustomerContentKind>(v.ccKind);
-                            cc.RawContent = v.to_string();
-                            ccExtensions[k] = cc;
-                            // 4. Send event's Pii context fields as record.PIIExtensions
-#endif
+                        temp.stringValue = toString(v);
+                        put(v, std::move(temp));
                     }
                 }
                 else {
-                    std::vector<uint8_t> guid;
-                    uint8_t guid_bytes[16] = { 0 };
-
                     switch (v.type)
                     {
                     case EventProperty::TYPE_STRING:
                     {
                         CsProtocol::Value temp;
-                        temp.stringValue = v.to_string();
-                        if (v.dataCategory == DataCategory_PartB)
-                        {
-                            extPartB[k] = std::move(temp);
-                        }
-                        else
-                        {
-                            ext[k] = std::move(temp);
-                        }
+                        temp.stringValue = toString(v);
+                        put(v, std::move(temp));
                         break;
                     }
                     case EventProperty::TYPE_INT64:
@@ -266,14 +249,7 @@ namespace MAT_NS_BEGIN {
                         CsProtocol::Value temp;
                         temp.type = ::CsProtocol::ValueKind::ValueInt64;
                         temp.longValue = v.as_int64;
-                        if (v.dataCategory == DataCategory_PartB)
-                        {
-                            extPartB[k] = std::move(temp);
-                        }
-                        else
-                        {
-                            ext[k] = std::move(temp);
-                        }
+                        put(v, std::move(temp));
                         break;
                     }
                     case EventProperty::TYPE_DOUBLE:
@@ -281,29 +257,15 @@ namespace MAT_NS_BEGIN {
                         CsProtocol::Value temp;
                         temp.type = ::CsProtocol::ValueKind::ValueDouble;
                         temp.doubleValue = v.as_double;
-                        if (v.dataCategory == DataCategory_PartB)
-                        {
-                            extPartB[k] = std::move(temp);
-                        }
-                        else
-                        {
-                            ext[k] = std::move(temp);
-                        }
+                        put(v, std::move(temp));
                         break;
                     }
                     case EventProperty::TYPE_TIME:
                     {
                         CsProtocol::Value temp;
                         temp.type = ::CsProtocol::ValueKind::ValueDateTime;
-                        temp.longValue = v.as_time_ticks.ticks;
-                        if (v.dataCategory == DataCategory_PartB)
-                        {
-                            extPartB[k] = std::move(temp);
-                        }
-                        else
-                        {
-                            ext[k] = std::move(temp);
-                        }
+                        temp.longValue = v.as_time_ticks;
+                        put(v, std::move(temp));
                         break;
                     }
                     case EventProperty::TYPE_BOOLEAN:
@@ -311,78 +273,47 @@ namespace MAT_NS_BEGIN {
                         CsProtocol::Value temp;
                         temp.type = ::CsProtocol::ValueKind::ValueBool;
                         temp.longValue = v.as_bool;
-                        if (v.dataCategory == DataCategory_PartB)
-                        {
-                            extPartB[k] = std::move(temp);
-                        }
-                        else
-                        {
-                            ext[k] = std::move(temp);
-                        }
+                        put(v, std::move(temp));
                         break;
                     }
                     case EventProperty::TYPE_GUID:
                     {
-                        GUID_t temp = v.as_guid;
-                        temp.to_bytes(guid_bytes);
-                        guid = std::vector<uint8_t>(guid_bytes, guid_bytes + sizeof(guid_bytes) / sizeof(guid_bytes[0]));
-
+                        // Already stored in the GUID_t::to_bytes layout
                         CsProtocol::Value tempValue;
                         tempValue.type = ::CsProtocol::ValueKind::ValueGuid;
-                        tempValue.guidValue.push_back(guid);
-                        if (v.dataCategory == DataCategory_PartB)
-                        {
-                            extPartB[k] = tempValue;
-                        }
-                        else
-                        {
-                            ext[k] = tempValue;
-                        }
+                        tempValue.guidValue.emplace_back(v.GetGuidBytes(), v.GetGuidBytes() + 16);
+                        put(v, std::move(tempValue));
                         break;
                     }
                     case EventProperty::TYPE_INT64_ARRAY:
                     {
                         CsProtocol::Value temp;
                         temp.type = ::CsProtocol::ValueKind::ValueArrayInt64;
-                        temp.longArray.push_back(*v.as_longArray);
-                        if (v.dataCategory == DataCategory_PartB)
-                        {
-                            extPartB[k] = std::move(temp);
-                        }
-                        else
-                        {
-                            ext[k] = std::move(temp);
-                        }
+                        temp.longArray.emplace_back(v.GetArray<int64_t>(), v.GetArray<int64_t>() + v.as_ref.count);
+                        put(v, std::move(temp));
                         break;
                     }
                     case EventProperty::TYPE_DOUBLE_ARRAY:
                     {
                         CsProtocol::Value temp;
                         temp.type = ::CsProtocol::ValueKind::ValueArrayDouble;
-                        temp.doubleArray.push_back(*v.as_doubleArray);
-                        if (v.dataCategory == DataCategory_PartB)
-                        {
-                            extPartB[k] = std::move(temp);
-                        }
-                        else
-                        {
-                            ext[k] = std::move(temp);
-                        }
+                        temp.doubleArray.emplace_back(v.GetArray<double>(), v.GetArray<double>() + v.as_ref.count);
+                        put(v, std::move(temp));
                         break;
                     }
                     case EventProperty::TYPE_STRING_ARRAY:
                     {
                         CsProtocol::Value temp;
                         temp.type = ::CsProtocol::ValueKind::ValueArrayString;
-                        temp.stringArray.push_back(*v.as_stringArray);
-                        if (v.dataCategory == DataCategory_PartB)
-                        {
-                            extPartB[k] = std::move(temp);
-                        }
-                        else
+                        std::vector<std::string> values;
+                        values.reserve(v.as_ref.count);
+                        for (size_t i = 0; i < v.as_ref.count; i++)
                         {
-                            ext[k] = std::move(temp);
+                            FlatPropertyMap::Slice const& value = v.GetArray<FlatPropertyMap::Slice>()[i];
+                            values.emplace_back(value.data, value.size);
                         }
+                        temp.stringArray.push_back(std::move(values));
+                        put(v, std::move(temp));
                         break;
                     }
                     case EventProperty::TYPE_GUID_ARRAY:
@@ -391,36 +322,21 @@ namespace MAT_NS_BEGIN {
                         temp.type = ::CsProtocol::ValueKind::ValueArrayGuid;
 
                         std::vector<std::vector<uint8_t>> values;
-                        for (const auto& tempValue : *v.as_guidArray)
+                        values.reserve(v.as_ref.count);
+                        for (size_t i = 0; i < v.as_ref.count; i++)
                         {
-                            tempValue.to_bytes(guid_bytes);
-                            guid = std::vector<uint8_t>(guid_bytes, guid_bytes + sizeof(guid_bytes) / sizeof(guid_bytes[0]));
-                            values.push_back(guid);
-                        }
-                        temp.guidArray.push_back(values);
-                        if (v.dataCategory == DataCategory_PartB)
-                        {
-                            extPartB[k] = std::move(temp);
-                        }
-                        else
-                        {
-                            ext[k] = std::move(temp);
+                            values.emplace_back(v.GetGuidBytes(i), v.GetGuidBytes(i) + 16);
                         }
+                        temp.guidArray.push_back(std::move(values));
+                        put(v, std::move(temp));
                         break;
                     }
                     default:
                     {
                         // Convert all unknown types to string
                         CsProtocol::Value temp;
-                        temp.stringValue = v.to_string();
-                        if (v.dataCategory == DataCategory_PartB)
-                        {
-                            extPartB[k] = std::move(temp);
-                        }
-                        else
-                        {
-                            ext[k] = std::move(temp);
-                        }
+                        temp.stringValue = toString(v);
+                        put(v, std::move(temp));
                     }
                     }
                 }
@@ -434,19 +350,20 @@ namespace MAT_NS_BEGIN {
             }
 
             // special case of CorrelationVector value
-            if (ext.count(CorrelationVector::PropertyName) > 0)
+            auto cv = ext.find(CorrelationVector::PropertyName);
+            if (cv != ext.end())
             {
-                CsProtocol::Value cvValue = ext[CorrelationVector::PropertyName];
+                CsProtocol::Value& cvValue = cv->second;
 
                 if (cvValue.type == ::CsProtocol::ValueKind::ValueString)
                 {
-                    record.cV = cvValue.stringValue;
+                    record.cV = std::move(cvValue.stringValue);
                 }
                 else
                 {
                     LOG_TRACE("CorrelationVector value type is invalid %u", cvValue.type);
                 }
-                ext.erase(CorrelationVector::PropertyName);
+                ext.erase(cv);
             }
 
             // scrub if MICROSOFT_EVENTTAG_DROP_PII is set
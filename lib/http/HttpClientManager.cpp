@@ -43,6 +43,13 @@ namespace MAT_NS_BEGIN {
         {
         }
 
+        // Reuse an idle callback for another request
+        void reset(EventsUploadContextPtr const& ctx)
+        {
+            m_ctx = ctx;
+            m_startTime = PAL::getMonotonicTimeMs();
+        }
+
         virtual void OnHttpResponse(IHttpResponse* response) override
         {
             m_ctx->durationMs = static_cast<int>(PAL::getMonotonicTimeMs() - m_startTime);
@@ -63,6 +70,10 @@ namespace MAT_NS_BEGIN {
             // implementation-dependent struct via data ptr, then the callback can
             // indicate either success or failure.. But alternatively the callback might
             // as well pass the data back by updating the data structure.
+            if (!m_hcm.m_logManager.HasListeners(EVT_HTTP_STATE))
+            {
+                return;
+            }
             DebugEvent evt(EVT_HTTP_STATE, size_t(state), 0, data, size);
             m_hcm.m_logManager.DispatchEvent(evt);
         }
@@ -91,23 +102,42 @@ namespace MAT_NS_BEGIN {
     HttpClientManager::~HttpClientManager() noexcept
     {
         cancelAllRequestsAsync();
+        for (HttpCallback* callback : m_idleCallbacks)
+        {
+            delete callback;
+        }
     }
 
     void HttpClientManager::handleSendRequest(EventsUploadContextPtr const& ctx)
     {
-        HttpCallback *callback = new HttpCallback(*this, ctx);
+        HttpCallback *callback = nullptr;
         {
             LOCKGUARD(m_httpCallbacksMtx);
+            if (!m_idleCallbacks.empty())
+            {
+                callback = m_idleCallbacks.back();
+                m_idleCallbacks.pop_back();
+                callback->reset(ctx);
+            }
+            else
+            {
+                callback = new HttpCallback(*this, ctx);
+            }
             m_httpCallbacks.push_back(callback);
         }
 
         LOG_INFO("Uploading %u event(s) of priority %d (%s) for %u tenant(s) in HTTP request %s (approx. %u bytes)...",
-            static_cast<unsigned>(ctx->recordIdsAndTenantIds.size()), ctx->latency, latencyToStr(ctx->latency), static_cast<unsigned>(ctx->packageIds.size()),
+            static_cast<unsigned>(ctx->recordIds.size()), ctx->latency, latencyToStr(ctx->latency), static_cast<unsigned>(ctx->packageIds.size()),
             ctx->httpRequest->GetId().c_str(), static_cast<unsigned>(ctx->httpRequest->GetSizeEstimate()));
 
         m_httpClient.SendRequestAsync(ctx->httpRequest, callback);
     }
 
+    void HttpClientManager::handlePrepareConnection(std::string const& url)
+    {
+        m_httpClient.PrepareConnection(url);
+    }
+
     void HttpClientManager::scheduleOnHttpResponse(HttpCallback* callback)
     {
         PAL::scheduleTask(&m_taskDispatcher, 0, this, &HttpClientManager::onHttpResponse, callback);
@@ -143,6 +173,17 @@ namespace MAT_NS_BEGIN {
             m_httpCallbacksCV.notify_all();
         }
 
+        // Dropping the context may release the request, whose HTTP client can
+        // still report state to the callback: keep it alive until then.
+        callback->m_ctx.reset();
+        {
+            LOCKGUARD(m_httpCallbacksMtx);
+            if (m_idleCallbacks.size() < MaxIdleCallbacks)
+            {
+                m_idleCallbacks.push_back(callback);
+                return;
+            }
+        }
         delete callback;
     }
 
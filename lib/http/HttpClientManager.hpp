@@ -12,6 +12,7 @@
 
 #include <list>
 #include <mutex>
+#include <vector>
 #include <chrono>
 #include <condition_variable>
 
@@ -52,11 +53,17 @@ class HttpClientManager
             this, &HttpClientManager::handleSendRequest
         };
 
+        RouteSink<HttpClientManager, std::string const&> prepareConnection
+        {
+            this, &HttpClientManager::handlePrepareConnection
+        };
+
     protected:
         class HttpCallback;
         friend class HttpCallback;
 
         void handleSendRequest(EventsUploadContextPtr const& ctx);
+        void handlePrepareConnection(std::string const& url);
         virtual void scheduleOnHttpResponse(HttpCallback* callback);
         void onHttpResponse(HttpCallback* callback);
         void cancelAllRequestsAsync(std::chrono::milliseconds bestEffortTimeout = std::chrono::milliseconds::zero());
@@ -67,6 +74,9 @@ class HttpClientManager
         ITaskDispatcher&          m_taskDispatcher;
         mutable std::recursive_mutex m_httpCallbacksMtx;
         std::list<HttpCallback*>  m_httpCallbacks;
+        // Callbacks of finished requests, reused by the next ones
+        static constexpr size_t   MaxIdleCallbacks = 8;
+        std::vector<HttpCallback*> m_idleCallbacks;
         // Signaled from onHttpResponse when a callback is removed, so cancelAllRequests
         // can drain via a condition variable instead of a poll loop.
         std::condition_variable_any m_httpCallbacksCV;
@@ -119,7 +119,7 @@ namespace MAT_NS_BEGIN {
                 }
             }
 
-            // 'response' is no longer owned by IHttpClient and gets deleted in EventsUploadContext.clear()
+            // 'response' is no longer owned by IHttpClient and gets deleted in EventsUploadContext.clear(), as this client has no IHttpObjectPool
             operation->OnResponse(response.release());
         }
     }
@@ -148,7 +148,7 @@ namespace MAT_NS_BEGIN {
 
     void HttpClient_CAPI::SendRequestAsync(IHttpRequest* request, IHttpResponseCallback* callback)
     {
-        // Note: 'request' is never owned by IHttpClient and gets deleted in EventsUploadContext.clear()
+        // Note: 'request' is never owned by IHttpClient and gets deleted in EventsUploadContext.clear(), as this client has no IHttpObjectPool
         auto simpleRequest = static_cast<SimpleHttpRequest*>(request);
         auto requestId = simpleRequest->m_id;
 
@@ -40,40 +40,550 @@ namespace MAT_NS_BEGIN {
             }
         }
 
+        /**
+         * Drop the operation and the contents of the request, keeping the
+         * capacity of its body
+         */
+        void Reset()
+        {
+            m_curlOperation.reset();
+            m_method = "GET";
+            m_url.clear();
+            m_headers.clear();
+            m_body.clear();
+            m_latency = EventLatency_Unspecified;
+        }
+
     private:
         std::shared_ptr<CurlHttpOperation> m_curlOperation;
     };
 
-    HttpClient_Curl::HttpClient_Curl()
+    /**
+     * Idle requests and responses of HttpClient_Curl. Shared with the upload
+     * contexts, so that it can take objects back after the client is gone.
+     */
+    class CurlHttpObjectPool : public IHttpObjectPool
+    {
+    public:
+        static constexpr size_t MaxIdle = 8;
+
+        CurlHttpObjectPool()
+        {
+            // Releasing an object never allocates
+            m_requests.reserve(MaxIdle);
+            m_responses.reserve(MaxIdle);
+        }
+
+        ~CurlHttpObjectPool()
+        {
+            for (CurlHttpRequest* request : m_requests) {
+                delete request;
+            }
+            for (SimpleHttpResponse* response : m_responses) {
+                delete response;
+            }
+        }
+
+        CurlHttpRequest* AcquireRequest()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (!m_requests.empty()) {
+                    CurlHttpRequest* request = m_requests.back();
+                    m_requests.pop_back();
+                    request->m_id = NextReqId();
+                    return request;
+                }
+            }
+            return new CurlHttpRequest();
+        }
+
+        std::unique_ptr<SimpleHttpResponse> AcquireResponse(std::string const& id)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (!m_responses.empty()) {
+                    std::unique_ptr<SimpleHttpResponse> response(m_responses.back());
+                    m_responses.pop_back();
+                    response->m_id = id;
+                    return response;
+                }
+            }
+            return std::unique_ptr<SimpleHttpResponse>(new SimpleHttpResponse(id));
+        }
+
+        virtual void ReleaseRequest(IHttpRequest* request, std::vector<uint8_t>& body) noexcept override
+        {
+            // Only requests of CreateRequest() come back here
+            auto curlRequest = static_cast<CurlHttpRequest*>(request);
+            // Outside of the lock: ~CurlHttpOperation may wait for the transfer
+            curlRequest->Reset();
+            // SetBody() moves the next body in, so the buffer goes back to the caller
+            if (body.empty() && body.capacity() < curlRequest->m_body.capacity()) {
+                body.swap(curlRequest->m_body);
+                curlRequest->m_body.clear();
+            }
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (m_requests.size() < MaxIdle) {
+                    m_requests.push_back(curlRequest);
+                    return;
+                }
+            }
+            delete curlRequest;
+        }
+
+        virtual void ReleaseResponse(IHttpResponse* response) noexcept override
+        {
+            auto simpleResponse = static_cast<SimpleHttpResponse*>(response);
+            simpleResponse->m_result = HttpResult_LocalFailure;
+            simpleResponse->m_statusCode = 0;
+            simpleResponse->m_headers.clear();
+            simpleResponse->m_body.clear();
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (m_responses.size() < MaxIdle) {
+                    m_responses.push_back(simpleResponse);
+                    return;
+                }
+            }
+            delete simpleResponse;
+        }
+
+    private:
+        std::mutex m_lock;
+        std::vector<CurlHttpRequest*> m_requests;
+        std::vector<SimpleHttpResponse*> m_responses;
+    };
+
+    constexpr size_t CurlHttpObjectPool::MaxIdle;
+
+    /* Upper bound on one idle wait of the multi loop. Bounds the latency of
+       noticing an abort on libcurl builds without curl_multi_wakeup. */
+    static constexpr int CURL_MULTI_IDLE_WAIT_MS = 100;
+
+    /* libcurl retires connections idle for longer than this by default. */
+    static constexpr long CURL_DEFAULT_IDLE_CONNECTION_TIMEOUT_SEC = 118;
+
+    /* Idle time before TCP keep-alive probes, short enough to keep NAT and
+       firewall mappings of an idle connection open. */
+    static constexpr long CURL_TCP_KEEPIDLE_SEC = 30;
+
+    static std::string GetOrigin(std::string const& url)
+    {
+        size_t start = url.find("://");
+        start = (start == std::string::npos) ? 0 : start + 3;
+        return url.substr(0, url.find('/', start));
+    }
+
+    CurlMultiEngine::CurlMultiEngine() :
+        m_handlePool(std::make_shared<CurlHandlePool>())
+    {
+        m_multi = curl_multi_init();
+        m_share = curl_share_init();
+        if (!IsValid())
+        {
+            return;
+        }
+
+        // Requests to the same collector ride one HTTP/2 connection when the
+        // server supports it; otherwise connections are kept alive and reused.
+        curl_multi_setopt(m_multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+
+        // The share is only touched from the loop thread, so it needs no lock callbacks.
+        curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+
+        m_thread = std::thread(&CurlMultiEngine::ThreadFunc, this);
+    }
+
+    CurlMultiEngine::~CurlMultiEngine()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_running = false;
+        }
+        Wakeup();
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+        if (m_multi != nullptr)
+        {
+            curl_multi_cleanup(m_multi);
+        }
+        if (m_share != nullptr)
+        {
+            curl_share_cleanup(m_share);
+        }
+    }
+
+    void CurlMultiEngine::Submit(std::shared_ptr<CurlHttpOperation> operation, DoneCallback callback)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (m_running)
+            {
+                m_pending.push_back(Transfer { std::move(operation), std::move(callback) });
+                operation = nullptr;
+            }
+        }
+        if (operation != nullptr)
+        {
+            // The loop is gone: complete as aborted so the caller still gets its callback.
+            operation->Abort();
+            operation->CompleteMultiTransfer(CURLE_ABORTED_BY_CALLBACK);
+            if (callback)
+            {
+                callback(std::move(operation));
+            }
+            return;
+        }
+        Wakeup();
+    }
+
+    void CurlMultiEngine::SubmitConnect(std::shared_ptr<CurlHttpOperation> operation, DoneCallback callback)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (m_running)
+            {
+                m_pendingConnects.push_back(Transfer { std::move(operation), std::move(callback) });
+                operation = nullptr;
+            }
+        }
+        if (operation != nullptr)
+        {
+            operation->Abort();
+            operation->CompleteMultiConnect(CURLE_ABORTED_BY_CALLBACK);
+            if (callback)
+            {
+                callback(std::move(operation));
+            }
+            return;
+        }
+        Wakeup();
+    }
+
+    void CurlMultiEngine::AbortAll()
+    {
+        m_abortAll = true;
+        Wakeup();
+    }
+
+    void CurlMultiEngine::Wakeup()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_wake.notify_all();
+        }
+#if LIBCURL_VERSION_NUM >= 0x074400 // Version 7.68.0
+        if (m_multi != nullptr)
+        {
+            curl_multi_wakeup(m_multi);
+        }
+#endif
+    }
+
+    void CurlMultiEngine::SetMaxActiveTransfers(size_t maxActive)
+    {
+        m_maxActive = maxActive;
+        Wakeup();
+    }
+
+    void CurlMultiEngine::SetIdleConnectionTimeout(long seconds)
+    {
+        m_idleConnectionTimeout = seconds;
+    }
+
+    void CurlMultiEngine::ApplyConnectionOptions(CURL* handle)
+    {
+        curl_easy_setopt(handle, CURLOPT_SHARE, m_share);
+        curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+        curl_easy_setopt(handle, CURLOPT_TCP_KEEPIDLE, CURL_TCP_KEEPIDLE_SEC);
+        curl_easy_setopt(handle, CURLOPT_TCP_KEEPINTVL, CURL_TCP_KEEPIDLE_SEC);
+#if LIBCURL_VERSION_NUM >= 0x074100 // Version 7.65.0
+        const long idleTimeout = m_idleConnectionTimeout.load();
+        if (idleTimeout > 0)
+        {
+            curl_easy_setopt(handle, CURLOPT_MAXAGE_CONN, idleTimeout);
+        }
+#endif
+    }
+
+    size_t CurlMultiEngine::GetActiveCount()
+    {
+        return m_activeCount.load();
+    }
+
+    size_t CurlMultiEngine::GetQueuedCount()
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return m_pending.size();
+    }
+
+    void CurlMultiEngine::AdmitPending(std::vector<Transfer>& finished)
+    {
+        const size_t maxActive = m_maxActive.load();
+        std::vector<Transfer> admitted;
+        std::deque<Transfer> connects;
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            connects.swap(m_pendingConnects);
+            while (!m_pending.empty() && (maxActive == 0 || m_active.size() + admitted.size() < maxActive))
+            {
+                admitted.push_back(std::move(m_pending.front()));
+                m_pending.pop_front();
+            }
+        }
+
+        // Connect-only operations end as soon as the handshake is done, so
+        // they are not held to the transfer budget.
+        for (auto& transfer : connects)
+        {
+            CurlHttpOperation& operation = *transfer.operation;
+            if (operation.WasAborted())
+            {
+                operation.CompleteMultiConnect(CURLE_ABORTED_BY_CALLBACK);
+                finished.push_back(std::move(transfer));
+                continue;
+            }
+            if (!operation.PrepareMultiConnect())
+            {
+                finished.push_back(std::move(transfer));
+                continue;
+            }
+            CURL* handle = operation.GetHandle();
+            ApplyConnectionOptions(handle);
+            if (curl_multi_add_handle(m_multi, handle) != CURLM_OK)
+            {
+                curl_easy_setopt(handle, CURLOPT_SHARE, static_cast<CURLSH*>(nullptr));
+                operation.CompleteMultiConnect(CURLE_FAILED_INIT);
+                finished.push_back(std::move(transfer));
+                continue;
+            }
+            m_connecting[handle] = std::move(transfer);
+        }
+
+        for (auto& transfer : admitted)
+        {
+            CurlHttpOperation& operation = *transfer.operation;
+            if (operation.WasAborted())
+            {
+                operation.CompleteMultiTransfer(CURLE_ABORTED_BY_CALLBACK);
+                finished.push_back(std::move(transfer));
+                continue;
+            }
+            if (!operation.PrepareMultiTransfer())
+            {
+                finished.push_back(std::move(transfer));
+                continue;
+            }
+            CURL* handle = operation.GetHandle();
+            ApplyConnectionOptions(handle);
+            if (curl_multi_add_handle(m_multi, handle) != CURLM_OK)
+            {
+                curl_easy_setopt(handle, CURLOPT_SHARE, static_cast<CURLSH*>(nullptr));
+                operation.CompleteMultiTransfer(CURLE_FAILED_INIT);
+                finished.push_back(std::move(transfer));
+                continue;
+            }
+            m_active[handle] = std::move(transfer);
+        }
+        m_activeCount = m_active.size();
+    }
+
+    void CurlMultiEngine::CollectFinished(std::vector<Transfer>& finished)
+    {
+        int remaining = 0;
+        CURLMsg* message;
+        while ((message = curl_multi_info_read(m_multi, &remaining)) != nullptr)
+        {
+            if (message->msg != CURLMSG_DONE)
+            {
+                continue;
+            }
+            // The message is invalidated by curl_multi_remove_handle.
+            CURL* handle = message->easy_handle;
+            const CURLcode result = message->data.result;
+            auto connecting = m_connecting.find(handle);
+            if (connecting != m_connecting.end())
+            {
+                // Removing the handle closes a connect-only connection, so check it first.
+                connecting->second.operation->CompleteMultiConnect(result);
+                finished.push_back(std::move(connecting->second));
+                m_connecting.erase(connecting);
+            }
+            curl_multi_remove_handle(m_multi, handle);
+            // Detach from the share so that the pooled handle does not keep it in use.
+            curl_easy_setopt(handle, CURLOPT_SHARE, static_cast<CURLSH*>(nullptr));
+
+            auto it = m_active.find(handle);
+            if (it == m_active.end())
+            {
+                continue;
+            }
+            it->second.operation->CompleteMultiTransfer(result);
+            finished.push_back(std::move(it->second));
+            m_active.erase(it);
+        }
+        m_activeCount = m_active.size();
+    }
+
+    void CurlMultiEngine::AbortRunning(std::vector<Transfer>& finished)
+    {
+        for (auto& entry : m_active)
+        {
+            curl_multi_remove_handle(m_multi, entry.first);
+            curl_easy_setopt(entry.first, CURLOPT_SHARE, static_cast<CURLSH*>(nullptr));
+            entry.second.operation->Abort();
+            entry.second.operation->CompleteMultiTransfer(CURLE_ABORTED_BY_CALLBACK);
+            finished.push_back(std::move(entry.second));
+        }
+        m_active.clear();
+        m_activeCount = 0;
+        for (auto& entry : m_connecting)
+        {
+            curl_multi_remove_handle(m_multi, entry.first);
+            curl_easy_setopt(entry.first, CURLOPT_SHARE, static_cast<CURLSH*>(nullptr));
+            entry.second.operation->Abort();
+            entry.second.operation->CompleteMultiConnect(CURLE_ABORTED_BY_CALLBACK);
+            finished.push_back(std::move(entry.second));
+        }
+        m_connecting.clear();
+
+        std::deque<Transfer> pending;
+        std::deque<Transfer> connects;
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            pending.swap(m_pending);
+            connects.swap(m_pendingConnects);
+        }
+        for (auto& transfer : pending)
+        {
+            transfer.operation->Abort();
+            transfer.operation->CompleteMultiTransfer(CURLE_ABORTED_BY_CALLBACK);
+            finished.push_back(std::move(transfer));
+        }
+        for (auto& transfer : connects)
+        {
+            transfer.operation->Abort();
+            transfer.operation->CompleteMultiConnect(CURLE_ABORTED_BY_CALLBACK);
+            finished.push_back(std::move(transfer));
+        }
+    }
+
+    void CurlMultiEngine::ThreadFunc()
+    {
+        size_t appliedMaxActive = 0;
+        std::vector<Transfer> finished;
+        for (;;)
+        {
+            const bool running = m_running.load();
+            const size_t maxActive = m_maxActive.load();
+            if (maxActive != appliedMaxActive)
+            {
+                // Bound the connection count to the request budget as well, so
+                // that queued HTTP/1.1 requests wait for a reusable connection.
+                // One more is left for a connect-only warm-up, which holds its
+                // connection only until the handshake is done.
+                const long maxConnections = (maxActive == 0) ? 0L : static_cast<long>(maxActive) + 1;
+                curl_multi_setopt(m_multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, maxConnections);
+                appliedMaxActive = maxActive;
+            }
+
+            if (!running || m_abortAll.exchange(false))
+            {
+                AbortRunning(finished);
+            }
+            else
+            {
+                AdmitPending(finished);
+            }
+
+            if (!m_active.empty() || !m_connecting.empty())
+            {
+                int stillRunning = 0;
+                curl_multi_perform(m_multi, &stillRunning);
+                CollectFinished(finished);
+            }
+
+            // Callbacks run without any engine lock held; they may submit more work.
+            for (auto& transfer : finished)
+            {
+                if (transfer.callback)
+                {
+                    transfer.callback(std::move(transfer.operation));
+                }
+            }
+            finished.clear();
+
+            if (!running)
+            {
+                break;
+            }
+
+            if (m_active.empty() && m_connecting.empty())
+            {
+                std::unique_lock<std::mutex> lock(m_lock);
+                m_wake.wait_for(lock, std::chrono::milliseconds(CURL_MULTI_IDLE_WAIT_MS), [this]() {
+                    return !m_running || m_abortAll || !m_pending.empty() || !m_pendingConnects.empty();
+                });
+            }
+            else
+            {
+#if LIBCURL_VERSION_NUM >= 0x074400 // Version 7.68.0
+                curl_multi_poll(m_multi, nullptr, 0, CURL_MULTI_IDLE_WAIT_MS, nullptr);
+#else
+                curl_multi_wait(m_multi, nullptr, 0, CURL_MULTI_IDLE_WAIT_MS, nullptr);
+#endif
+            }
+        }
+    }
+
+    //---
+
+    HttpClient_Curl::HttpClient_Curl() :
+        m_objectPool(std::make_shared<CurlHttpObjectPool>())
     {
         /* In windows, this will init the winsock stuff */
         TRACE("Initializing HttpClient_Curl...\n");
         curl_global_init(CURL_GLOBAL_ALL);
         TRACE("libcurl version = %s\n", curl_version_info(CURLVERSION_NOW)->version);
+
+        m_engine.reset(new CurlMultiEngine());
+        if (!m_engine->IsValid())
+        {
+            LOG_WARN("curl_multi is unavailable, using a thread per request");
+            m_engine.reset();
+        }
     }
 
     HttpClient_Curl::~HttpClient_Curl()
     {
+        // Completes (as aborted) whatever is still in flight before libcurl goes away.
+        m_engine.reset();
         curl_global_cleanup();
         TRACE("Destroyed HttpClient_Curl.\n");
     };
 
     IHttpRequest* HttpClient_Curl::CreateRequest()
     {
-        return new CurlHttpRequest();
+        return m_objectPool->AcquireRequest();
+    }
+
+    std::shared_ptr<IHttpObjectPool> HttpClient_Curl::GetObjectPool()
+    {
+        return m_objectPool;
     }
 
     void HttpClient_Curl::SendRequestAsync(IHttpRequest* request, IHttpResponseCallback* callback)
     {
-        // Note: 'request' is never owned by IHttpClient and gets deleted in EventsUploadContext.clear()
+        // Note: 'request' is never owned by IHttpClient. EventsUploadContext.clear() returns it to m_objectPool for reuse
         AddRequest(request);
         auto curlRequest = static_cast<CurlHttpRequest*>(request);
 
         std::string requestId = curlRequest->GetId();
-        std::map<std::string, std::string> requestHeaders;
-        for (const auto& header : curlRequest->m_headers) {
-            requestHeaders[header.first] = header.second;
-        }
 
         std::string sslCaInfo;
         {
@@ -81,37 +591,69 @@ namespace MAT_NS_BEGIN {
             sslCaInfo = m_sslCaInfo;
         }
 
-        auto curlOperation = std::make_shared<CurlHttpOperation>(curlRequest->m_method, curlRequest->m_url, callback, requestHeaders, curlRequest->m_body, false, HTTP_CONN_TIMEOUT, m_sslVerify, sslCaInfo);
+        auto curlOperation = std::make_shared<CurlHttpOperation>(curlRequest->m_method, curlRequest->m_url, callback, curlRequest->m_headers, curlRequest->m_body, false, HTTP_CONN_TIMEOUT, m_sslVerify, sslCaInfo,
+            (m_engine != nullptr) ? m_engine->GetHandlePool() : nullptr);
         curlRequest->SetOperation(curlOperation);
-        
+
+        if (m_engine != nullptr) {
+            std::string url = curlRequest->m_url;
+            TrackConnection(url, true);
+            // The engine holds a reference to curlOperation until the callback returns.
+            m_engine->Submit(curlOperation, [this, callback, requestId, url](std::shared_ptr<CurlHttpOperation> operation) {
+                this->EraseRequest(requestId);
+                const long code = operation->GetResponseCode();
+                const bool responded = (code > CURL_LAST);
+                if (responded) {
+                    m_requestCount++;
+                    if (operation->ReusedConnection()) {
+                        m_reusedConnectionCount++;
+                    } else {
+                        m_newConnectionCount++;
+                    }
+                }
+                this->TrackConnection(url, responded);
+                auto response = this->CreateResponse(requestId, *operation);
+                // Drop the engine's reference before handing the response over:
+                // once the receiver owns it, it may delete the request together
+                // with the callback that ~CurlHttpOperation still notifies.
+                operation.reset();
+                // 'response' is no longer owned by IHttpClient. EventsUploadContext.clear() returns it to m_objectPool for reuse
+                callback->OnHttpResponse(response.release());
+            });
+            return;
+        }
+
         // The lifetime of curlOperation is guarnteed by the call to result.wait() in the d'tor.  
         curlOperation->SendAsync([this, callback, requestId](CurlHttpOperation& operation) {
             this->EraseRequest(requestId);
+            // 'response' is no longer owned by IHttpClient. EventsUploadContext.clear() returns it to m_objectPool for reuse
+            callback->OnHttpResponse(this->CreateResponse(requestId, operation).release());
+        });
+    }
 
-            auto response = std::unique_ptr<SimpleHttpResponse>(new SimpleHttpResponse(requestId));
-            response->m_result = HttpResult_OK;
-
-            response->m_statusCode = operation.GetResponseCode();
-            if (response->m_statusCode == CURLE_FAILED_INIT) {
-                // There was an error in CURL stack while trying to create request
-                response->m_result = HttpResult_LocalFailure;
-            } else if ((CURLE_OK < response->m_statusCode) && (response->m_statusCode <= CURL_LAST)) {
-                if (operation.WasAborted()) {
-                    // Operation was manually aborted
-                    response->m_result = HttpResult_Aborted;
-                } else {
-                    // There was an error in CURL stack while trying to connect
-                    response->m_result = HttpResult_NetworkFailure;
-                }
+    std::unique_ptr<SimpleHttpResponse> HttpClient_Curl::CreateResponse(std::string const& requestId, CurlHttpOperation& operation)
+    {
+        auto response = m_objectPool->AcquireResponse(requestId);
+        response->m_result = HttpResult_OK;
+
+        response->m_statusCode = operation.GetResponseCode();
+        if (response->m_statusCode == CURLE_FAILED_INIT) {
+            // There was an error in CURL stack while trying to create request
+            response->m_result = HttpResult_LocalFailure;
+        } else if ((CURLE_OK < response->m_statusCode) && (response->m_statusCode <= CURL_LAST)) {
+            if (operation.WasAborted()) {
+                // Operation was manually aborted
+                response->m_result = HttpResult_Aborted;
+            } else {
+                // There was an error in CURL stack while trying to connect
+                response->m_result = HttpResult_NetworkFailure;
             }
+        }
 
-            auto responseHeaders = operation.GetResponseHeaders();
-            response->m_headers.insert(responseHeaders.begin(), responseHeaders.end());
-            response->m_body = operation.GetResponseBody();
-            
-            // 'response' is no longer owned by IHttpClient and gets deleted in EventsUploadContext.clear()
-            callback->OnHttpResponse(response.release());
-        });
+        operation.GetResponseHeaders(response->m_headers);
+        const std::vector<uint8_t>& body = operation.GetResponseBody();
+        response->m_body.assign(body.begin(), body.end());
+        return response;
     }
 
     void HttpClient_Curl::CancelRequestAsync(std::string const& id)
@@ -129,6 +671,24 @@ namespace MAT_NS_BEGIN {
 
         if (request != nullptr) {
             request->Cancel();
+            if (m_engine != nullptr) {
+                m_engine->Wakeup();
+            }
+        }
+    }
+
+    void HttpClient_Curl::CancelAllRequests()
+    {
+        std::map<std::string, IHttpRequest*> requests;
+        {
+            std::lock_guard<std::mutex> lock(m_requestsMtx);
+            requests.swap(m_requests);
+        }
+        for (auto& entry : requests) {
+            static_cast<CurlHttpRequest*>(entry.second)->Cancel();
+        }
+        if (m_engine != nullptr) {
+            m_engine->AbortAll();
         }
     }
 
@@ -137,6 +697,73 @@ namespace MAT_NS_BEGIN {
         SetSslVerification(
             config[CFG_MAP_HTTP][CFG_BOOL_HTTP_SSL_VERIFY],
             (const char *)config[CFG_MAP_HTTP][CFG_STR_HTTP_SSL_CAINFO]);
+        m_preconnect = static_cast<bool>(config[CFG_MAP_HTTP][CFG_BOOL_HTTP_PRECONNECT]);
+        uint32_t idleConnectionTimeout = config[CFG_MAP_HTTP][CFG_INT_HTTP_IDLE_CONNECTION_TIMEOUT];
+        m_idleConnectionTimeout = static_cast<long>(idleConnectionTimeout);
+        if (m_engine != nullptr) {
+            m_engine->SetMaxActiveTransfers(static_cast<uint32_t>(config[CFG_INT_MAX_PENDING_REQ]));
+            m_engine->SetIdleConnectionTimeout(m_idleConnectionTimeout);
+        }
+    }
+
+    void HttpClient_Curl::PrepareConnection(std::string const& url)
+    {
+        if (!m_preconnect || m_engine == nullptr || url.empty()) {
+            return;
+        }
+
+        const std::string origin = GetOrigin(url);
+        const long idleTimeout = (m_idleConnectionTimeout > 0) ? m_idleConnectionTimeout.load() : CURL_DEFAULT_IDLE_CONNECTION_TIMEOUT_SEC;
+        const uint64_t now = PAL::getMonotonicTimeMs();
+        {
+            std::lock_guard<std::mutex> lock(m_connectionsMtx);
+            auto it = m_connectionLastUsed.find(origin);
+            if (it != m_connectionLastUsed.end() && now < it->second + static_cast<uint64_t>(idleTimeout) * 1000) {
+                // Busy, or idle and still kept by the connection cache
+                return;
+            }
+            m_connectionLastUsed[origin] = now;
+        }
+
+        std::string sslCaInfo;
+        {
+            std::lock_guard<std::mutex> lock(m_requestsMtx);
+            sslCaInfo = m_sslCaInfo;
+        }
+
+        LOG_TRACE("Connecting to %s ahead of the upload", origin.c_str());
+        // Connect-only: nothing is sent to the collector, so the method is unused
+        auto curlOperation = std::make_shared<CurlHttpOperation>("GET", url, nullptr, std::map<std::string, std::string>(), m_noBody,
+            false, HTTP_CONN_TIMEOUT, m_sslVerify, sslCaInfo, m_engine->GetHandlePool());
+        m_engine->SubmitConnect(curlOperation, [this, url](std::shared_ptr<CurlHttpOperation> operation) {
+            const bool connected = (operation->GetResponseCode() == CURLE_OK);
+            if (connected) {
+                m_warmUpCount++;
+            }
+            this->TrackConnection(url, connected);
+        });
+    }
+
+    HttpClient_Curl::ConnectionStats HttpClient_Curl::GetConnectionStats() const
+    {
+        ConnectionStats stats;
+        stats.requests = m_requestCount.load();
+        stats.newConnections = m_newConnectionCount.load();
+        stats.reusedConnections = m_reusedConnectionCount.load();
+        stats.warmUps = m_warmUpCount.load();
+        return stats;
+    }
+
+    void HttpClient_Curl::TrackConnection(std::string const& url, bool connected)
+    {
+        const std::string origin = GetOrigin(url);
+        std::lock_guard<std::mutex> lock(m_connectionsMtx);
+        if (connected) {
+            m_connectionLastUsed[origin] = PAL::getMonotonicTimeMs();
+        } else {
+            // The next upload has to connect again, so it is worth warming up for
+            m_connectionLastUsed.erase(origin);
+        }
     }
 
     void HttpClient_Curl::SetSslVerification(bool sslVerify, const std::string& caInfo)
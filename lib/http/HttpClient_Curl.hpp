@@ -11,10 +11,8 @@
 #include <cstdlib>
 #include <cstdint>
 #include <string.h>
-#include <regex>
 
 #include <string>
-#include <sstream>
 #include <vector>
 #include <iterator>
 
@@ -22,6 +20,13 @@
 #include <numeric>
 #include <future>
 #include <atomic>
+#include <functional>
+#include <map>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 #include <poll.h>
 #include <curl/curl.h>
@@ -29,6 +34,7 @@
 #include <unistd.h>
 
 #include "IHttpClient.hpp"
+#include "HttpHeaderParser.hpp"
 #include "pal/PAL.hpp"
 
 #ifdef HAVE_ONEDS_BOUNDCHECK_METHODS
@@ -36,14 +42,16 @@
 #endif
 
 #define HTTP_CONN_TIMEOUT       5L
-#define HTTP_STATUS_REGEXP		"HTTP\\/\\d\\.\\d (\\d+)\\ .*"
-#define HTTP_HEADER_REGEXP      "(.*)\\: (.*)\\n*"
 
 #undef TRACE
 #define TRACE(...)	// printf
 
 namespace MAT_NS_BEGIN {
 
+class CurlHttpOperation;
+class CurlMultiEngine;
+class CurlHttpObjectPool;
+
 /**
  * Curl-based HTTP client
  */
@@ -55,18 +63,139 @@ public:
     virtual IHttpRequest* CreateRequest() override;
     virtual void SendRequestAsync(IHttpRequest* request, IHttpResponseCallback* callback) override;
     virtual void CancelRequestAsync(std::string const& id) override;
+    virtual void CancelAllRequests() override;
 
     virtual void ApplySettings(ILogConfiguration& config) override;
     void SetSslVerification(bool sslVerify, const std::string& caInfo = "");
 
+    /**
+     * True when requests run on the shared curl_multi loop rather than on a
+     * thread per request (the fallback if the multi handle cannot be created).
+     */
+    bool IsMultiEngineEnabled() const
+    {
+        return m_engine != nullptr;
+    }
+
+    /**
+     * Resolve, connect and complete the TLS handshake with the origin of url
+     * without sending a request, unless preconnect is disabled or a connection
+     * to it is already open or still within its idle timeout. The lookup and
+     * the TLS session land in the engine's shared caches, so the requests that
+     * follow skip the DNS round trip and resume the session.
+     */
+    virtual void PrepareConnection(std::string const& url) override;
+
+    /**
+     * Counters of connection reuse by requests on the multi engine.
+     */
+    struct ConnectionStats
+    {
+        size_t requests = 0;            // Requests that got a response
+        size_t newConnections = 0;      // ... over a connection they had to open
+        size_t reusedConnections = 0;   // ... over an open connection
+        size_t warmUps = 0;             // Connections established ahead of requests
+    };
+
+    ConnectionStats GetConnectionStats() const;
+
+    /**
+     * Requests and responses handed back through the pool are reset and reused
+     * by the next CreateRequest() and response, keeping the capacity of their
+     * bodies.
+     */
+    virtual std::shared_ptr<IHttpObjectPool> GetObjectPool() override;
+
 private:
     void EraseRequest(std::string const& id);
     void AddRequest(IHttpRequest* request);
+    std::unique_ptr<SimpleHttpResponse> CreateResponse(std::string const& requestId, CurlHttpOperation& operation);
+    void TrackConnection(std::string const& url, bool connected);
 
     std::mutex m_requestsMtx;
     std::map<std::string, IHttpRequest*> m_requests;
     std::atomic<bool> m_sslVerify { true };
     std::string m_sslCaInfo;
+    std::unique_ptr<CurlMultiEngine> m_engine;
+    std::shared_ptr<CurlHttpObjectPool> m_objectPool;
+
+    std::atomic<bool> m_preconnect { false };
+    std::atomic<long> m_idleConnectionTimeout { 0 };
+    // Origin (scheme://host:port) to the last time a connection to it was busy
+    std::mutex m_connectionsMtx;
+    std::map<std::string, uint64_t> m_connectionLastUsed;
+    const std::vector<uint8_t> m_noBody;
+    std::atomic<size_t> m_requestCount { 0 };
+    std::atomic<size_t> m_newConnectionCount { 0 };
+    std::atomic<size_t> m_reusedConnectionCount { 0 };
+    std::atomic<size_t> m_warmUpCount { 0 };
+};
+
+/**
+ * Pool of idle curl easy handles. A handle returned to the pool is reset but
+ * keeps its connection, DNS and TLS session caches, so the next request that
+ * picks it up can skip the handshake.
+ */
+class CurlHandlePool {
+public:
+    explicit CurlHandlePool(size_t maxIdle = 16) :
+        m_maxIdle(maxIdle)
+    {
+    }
+
+    ~CurlHandlePool()
+    {
+        for (CURL* handle : m_idle)
+        {
+            curl_easy_cleanup(handle);
+        }
+    }
+
+    CurlHandlePool(const CurlHandlePool&) = delete;
+    CurlHandlePool& operator=(const CurlHandlePool&) = delete;
+
+    CURL* Acquire()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (!m_idle.empty())
+            {
+                CURL* handle = m_idle.back();
+                m_idle.pop_back();
+                return handle;
+            }
+        }
+        return curl_easy_init();
+    }
+
+    void Release(CURL* handle)
+    {
+        if (handle == nullptr)
+        {
+            return;
+        }
+        curl_easy_reset(handle);
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (m_idle.size() < m_maxIdle)
+            {
+                m_idle.push_back(handle);
+                return;
+            }
+        }
+        curl_easy_cleanup(handle);
+    }
+
+    size_t GetIdleCount()
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return m_idle.size();
+    }
+
+private:
+    const size_t m_maxIdle;
+    std::mutex m_lock;
+    std::vector<CURL*> m_idle;
 };
 
 class CurlHttpOperation {
@@ -97,6 +226,7 @@ public:
      * @param httpConnTimeout   HTTP connection timeout in seconds
      * @param httpReadTimeout   HTTP read timeout in seconds
      */
+    template <typename THeaders>
     CurlHttpOperation(
             std::string method,
             std::string url,
@@ -104,14 +234,17 @@ public:
             // requestHeaders is copied into the curl_slist during construction
             // and need not outlive this operation. requestBody is stored by
             // reference and read by Send(), so it must outlive this operation.
-            const std::map<std::string, std::string>& requestHeaders,
+            // Any container of name/value pairs, e.g. HttpHeaders or std::map.
+            const THeaders& requestHeaders,
             const std::vector<uint8_t>& requestBody,
             // Default connectivity and response size options
             bool rawResponse                                         = false,
             size_t httpConnTimeout                                   = HTTP_CONN_TIMEOUT,
             // SSL certificate verification options
             bool sslVerify                                           = true,
-            const std::string& sslCaInfo                             = "") :
+            const std::string& sslCaInfo                             = "",
+            // Optional pool to borrow the easy handle from and return it to
+            std::shared_ptr<CurlHandlePool> handlePool               = nullptr) :
 
             // Optional connection params
             rawResponse(rawResponse),
@@ -121,6 +254,7 @@ public:
             m_method(method),
             m_url(url),
             m_sslCaInfo(sslCaInfo),
+            m_handlePool(std::move(handlePool)),
 
             // Local vars
             requestBody(requestBody)
@@ -130,7 +264,7 @@ public:
         response.size = 0;
 
         /* get a curl handle */
-        curl = curl_easy_init();
+        curl = (m_handlePool != nullptr) ? m_handlePool->Acquire() : curl_easy_init();
         if(!curl)
         {
             TRACE("libcurl failed to init!\n");
@@ -213,7 +347,14 @@ public:
         res = CURLE_OK;
         if (curl != nullptr)
         {
-            curl_easy_cleanup(curl);
+            if (m_handlePool != nullptr)
+            {
+                m_handlePool->Release(curl);
+            }
+            else
+            {
+                curl_easy_cleanup(curl);
+            }
         }
         curl_slist_free_all(m_headersChunk);
         ReleaseResponse();
@@ -227,9 +368,6 @@ public:
         TRACE("method=%s\n", this->m_method.c_str());
 
         ReleaseResponse();
-        // Request buffer
-        const void *request  = requestBody.empty() ? nullptr : requestBody.data();
-        const size_t reqSize = requestBody.size();
         int socketWaitResult = 0;
 
         if(!curl || !m_isConfigured)
@@ -303,53 +441,7 @@ public:
             goto cleanup;
         }
 
-        // send all data to our callback function
-        if (rawResponse)
-        {
-            if (!SetOption(CURLOPT_HEADER, 1L)
-                || !SetOption(CURLOPT_WRITEFUNCTION,
-                    static_cast<curl_write_callback>(&WriteMemoryCallback))
-                || !SetOption(CURLOPT_WRITEDATA, static_cast<void*>(&response)))
-            {
-                DispatchEvent(OnSendFailed);
-                goto cleanup;
-            }
-        }
-        else if (!SetOption(CURLOPT_WRITEFUNCTION,
-                static_cast<curl_write_callback>(&WriteVectorCallback))
-            || !SetOption(CURLOPT_HEADERFUNCTION,
-                static_cast<curl_write_callback>(&WriteVectorCallback))
-            || !SetOption(CURLOPT_HEADERDATA, static_cast<void*>(&respHeaders))
-            || !SetOption(CURLOPT_WRITEDATA, static_cast<void*>(&respBody)))
-        {
-            DispatchEvent(OnSendFailed);
-            goto cleanup;
-        }
-
-        // TODO: only two methods supported for now - POST and GET
-        if (m_method.compare("POST") == 0)
-        {
-            // POST
-            if (!SetOption(CURLOPT_POST, 1L)
-                || !SetOption(CURLOPT_POSTFIELDS, static_cast<const char*>(request))
-                || !SetOption(CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(reqSize)))
-            {
-                DispatchEvent(OnSendFailed);
-                goto cleanup;
-            }
-        } else
-        if (m_method.compare("GET") == 0)
-        {
-            // GET
-        } else
-        {
-            TRACE("Error #4: unsupported method %s\n", m_method.c_str());
-            res = CURLE_UNSUPPORTED_PROTOCOL;
-            goto cleanup;
-        }
-
-        if (!SetOption(CURLOPT_LOW_SPEED_TIME, 30L)
-            || !SetOption(CURLOPT_LOW_SPEED_LIMIT, 4096L))
+        if (!ConfigureTransfer())
         {
             DispatchEvent(OnSendFailed);
             goto cleanup;
@@ -369,25 +461,15 @@ public:
         /* Code snippet to parse raw HTTP response. This might come in handy
          * if we ever consider to handle the raw upload instead of curl_easy_perform
        ...
-       std::string resp((const char *)response);
-       std::regex http_status_regex(HTTP_STATUS_REGEXP);
-       std::smatch match;
-       if(std::regex_search(resp, match, http_status_regex))
-         http_code = std::stol(match[1]);
+       http_code = HttpHeaderParser::ParseStatusLine(response, statusLineLength);
        ...
          */
 
         /* libcurl is nice enough to parse the response code itself: */
+        if (!ReadResponseCode())
         {
-            long responseCode = 0;
-            const CURLcode infoResult = curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &responseCode);
-            if (infoResult != CURLE_OK)
-            {
-                res = static_cast<long>(infoResult);
-                DispatchEvent(OnSendFailed);
-                goto cleanup;
-            }
-            res = responseCode;
+            DispatchEvent(OnSendFailed);
+            goto cleanup;
         }
         // We got some response from server. Dump the contents.
         TRACE("HTTP response code %d\n", res);
@@ -412,6 +494,127 @@ cleanup:
         return result;
     }
 
+    /**
+     * Prepare the handle for a complete transfer driven by a curl_multi loop.
+     * Unlike Send(), there is no separate connect-only stage: the connect
+     * timeout is enforced by curl and the socket is owned by the multi handle.
+     */
+    bool PrepareMultiTransfer()
+    {
+        ReleaseResponse();
+        if (!curl || !m_isConfigured)
+        {
+            if (res == CURLE_OK)
+            {
+                res = CURLE_FAILED_INIT;
+            }
+            DispatchEvent(OnSendFailed);
+            return false;
+        }
+        if (!SetOption(CURLOPT_CONNECTTIMEOUT, static_cast<long>(httpConnTimeout))
+            // Wait for an existing HTTP/2 connection to multiplex onto rather
+            // than opening a parallel one.
+            || !SetOption(CURLOPT_PIPEWAIT, 1L)
+            || !SetOption(CURLOPT_NOPROGRESS, 0L)
+            || !SetOption(CURLOPT_XFERINFOFUNCTION, static_cast<curl_xferinfo_callback>(&AbortCheckCallback))
+            || !SetOption(CURLOPT_XFERINFODATA, static_cast<void*>(this))
+            || !ConfigureTransfer())
+        {
+            DispatchEvent(OnSendFailed);
+            return false;
+        }
+        DispatchEvent(OnSending);
+        return true;
+    }
+
+    /**
+     * Prepare the handle to only resolve, connect and handshake with the
+     * server on a curl_multi loop. No request is sent.
+     */
+    bool PrepareMultiConnect()
+    {
+        if (!curl || !m_isConfigured)
+        {
+            if (res == CURLE_OK)
+            {
+                res = CURLE_FAILED_INIT;
+            }
+            DispatchEvent(OnConnectFailed);
+            return false;
+        }
+        if (!SetOption(CURLOPT_CONNECTTIMEOUT, static_cast<long>(httpConnTimeout))
+            || !SetOption(CURLOPT_CONNECT_ONLY, 1L))
+        {
+            DispatchEvent(OnConnectFailed);
+            return false;
+        }
+        DispatchEvent(OnConnecting);
+        return true;
+    }
+
+    /**
+     * Record the outcome of a connect-only transfer completed by a curl_multi
+     * loop. Must run before the handle is removed from the multi handle, which
+     * closes the connection. The result is CURLE_OK only if a connection was
+     * established.
+     */
+    void CompleteMultiConnect(CURLcode curlResult)
+    {
+        if (isAborted && curlResult == CURLE_OK)
+        {
+            curlResult = CURLE_ABORTED_BY_CALLBACK;
+        }
+        res = static_cast<long>(curlResult);
+        if (curlResult == CURLE_OK)
+        {
+            curl_socket_t socket = CURL_SOCKET_BAD;
+#if LIBCURL_VERSION_NUM >= 0x072D00 // Version 7.45.00
+            const CURLcode infoResult = curl_easy_getinfo(curl, CURLINFO_ACTIVESOCKET, &socket);
+#else
+            long lastSocket = -1;
+            const CURLcode infoResult = curl_easy_getinfo(curl, CURLINFO_LASTSOCKET, &lastSocket);
+            socket = static_cast<curl_socket_t>(lastSocket);
+#endif
+            if (infoResult != CURLE_OK || socket == CURL_SOCKET_BAD)
+            {
+                res = static_cast<long>(infoResult != CURLE_OK ? infoResult : CURLE_COULDNT_CONNECT);
+            }
+        }
+        if (res != CURLE_OK)
+        {
+            TRACE("Error: %s\n", curl_easy_strerror(static_cast<CURLcode>(res)));
+            DispatchEvent(OnConnectFailed);
+            return;
+        }
+        DispatchEvent(OnConnected);
+    }
+
+    /**
+     * Record the outcome of a transfer completed by a curl_multi loop.
+     */
+    void CompleteMultiTransfer(CURLcode curlResult)
+    {
+        if (isAborted && curlResult == CURLE_OK)
+        {
+            curlResult = CURLE_ABORTED_BY_CALLBACK;
+        }
+        res = static_cast<long>(curlResult);
+        if (curlResult != CURLE_OK)
+        {
+            TRACE("Error: %s\n", curl_easy_strerror(curlResult));
+            DispatchEvent((curlResult == CURLE_COULDNT_CONNECT || curlResult == CURLE_COULDNT_RESOLVE_HOST
+                || curlResult == CURLE_OPERATION_TIMEDOUT) ? OnConnectFailed : OnSendFailed);
+            return;
+        }
+        if (!ReadResponseCode())
+        {
+            DispatchEvent(OnSendFailed);
+            return;
+        }
+        TRACE("HTTP response code %d\n", res);
+        DispatchEvent(OnResponse);
+    }
+
     /**
      * Get HTTP response code. This function returns CURL error code if HTTP response code is invalid.
      */
@@ -433,34 +636,17 @@ cleanup:
      *
      * @return
      */
-    std::map<std::string, std::string> GetResponseHeaders()
+    void GetResponseHeaders(HttpHeaders& headers)
     {
-        std::map<std::string, std::string> result;
-        if (respHeaders.empty())
-        {
-            return result;
-        }
-
-        std::stringstream ss;
-        std::string headers(reinterpret_cast<const char*>(respHeaders.data()), respHeaders.size());
-        ss.str(headers);
-
-        std::string header;
-        while (std::getline(ss, header, '\n')) {
-            std::smatch match;
-            std::regex http_headers_regex(HTTP_HEADER_REGEXP);
-            if (std::regex_search(header, match, http_headers_regex))
-                result[match[1]] = match[2];    // Key: value
-        }
-        return result;
+        HttpHeaderParser::Parse(reinterpret_cast<const char*>(respHeaders.data()), respHeaders.size(), headers);
     }
 
     /**
-     * Return a copy of response body
+     * Return the response body
      *
      * @return
      */
-    std::vector<uint8_t> GetResponseBody()
+    const std::vector<uint8_t>& GetResponseBody() const
     {
         return respBody;
     }
@@ -516,6 +702,18 @@ cleanup:
         return curl;
     }
 
+    /**
+     * True if the last transfer got a response over a connection that an
+     * earlier transfer had opened.
+     */
+    bool ReusedConnection()
+    {
+        long connects = 0;
+        return curl != nullptr
+            && curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &connects) == CURLE_OK
+            && connects == 0;
+    }
+
 protected:
     const bool   rawResponse;       // Do not split response headers from response body
     const size_t httpConnTimeout;   // Timeout for connect.  Default: 5s
@@ -529,6 +727,7 @@ protected:
     std::string m_method;
     std::string m_url;
     std::string m_sslCaInfo;
+    std::shared_ptr<CurlHandlePool> m_handlePool;
     bool m_isConfigured = false;
     // The SDK upload path keeps the owning IHttpRequest alive through the
     // callback context until Send() completes; copying this body would duplicate
@@ -552,6 +751,84 @@ protected:
 
     std::future<long>       result;
 
+    /**
+     * Set the response sinks, method, body and stall limits for the transfer.
+     */
+    bool ConfigureTransfer()
+    {
+        // Request buffer
+        const void *request  = requestBody.empty() ? nullptr : requestBody.data();
+        const size_t reqSize = requestBody.size();
+
+        // send all data to our callback function
+        if (rawResponse)
+        {
+            if (!SetOption(CURLOPT_HEADER, 1L)
+                || !SetOption(CURLOPT_WRITEFUNCTION,
+                    static_cast<curl_write_callback>(&WriteMemoryCallback))
+                || !SetOption(CURLOPT_WRITEDATA, static_cast<void*>(&response)))
+            {
+                return false;
+            }
+        }
+        else if (!SetOption(CURLOPT_WRITEFUNCTION,
+                static_cast<curl_write_callback>(&WriteVectorCallback))
+            || !SetOption(CURLOPT_HEADERFUNCTION,
+                static_cast<curl_write_callback>(&WriteVectorCallback))
+            || !SetOption(CURLOPT_HEADERDATA, static_cast<void*>(&respHeaders))
+            || !SetOption(CURLOPT_WRITEDATA, static_cast<void*>(&respBody)))
+        {
+            return false;
+        }
+
+        // TODO: only two methods supported for now - POST and GET
+        if (m_method.compare("POST") == 0)
+        {
+            // POST
+            if (!SetOption(CURLOPT_POST, 1L)
+                || !SetOption(CURLOPT_POSTFIELDS, static_cast<const char*>(request))
+                || !SetOption(CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(reqSize)))
+            {
+                return false;
+            }
+        } else
+        if (m_method.compare("GET") == 0)
+        {
+            // GET
+        } else
+        {
+            TRACE("Error #4: unsupported method %s\n", m_method.c_str());
+            res = CURLE_UNSUPPORTED_PROTOCOL;
+            return false;
+        }
+
+        if (!SetOption(CURLOPT_LOW_SPEED_TIME, 30L)
+            || !SetOption(CURLOPT_LOW_SPEED_LIMIT, 4096L))
+        {
+            return false;
+        }
+        return true;
+    }
+
+    bool ReadResponseCode()
+    {
+        long responseCode = 0;
+        const CURLcode infoResult = curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &responseCode);
+        if (infoResult != CURLE_OK)
+        {
+            res = static_cast<long>(infoResult);
+            return false;
+        }
+        res = responseCode;
+        return true;
+    }
+
+    static int AbortCheckCallback(void* clientp, curl_off_t, curl_off_t, curl_off_t, curl_off_t)
+    {
+        // Non-zero aborts the transfer with CURLE_ABORTED_BY_CALLBACK.
+        return static_cast<CurlHttpOperation*>(clientp)->isAborted.load() ? 1 : 0;
+    }
+
     template<typename TValue>
     bool SetOption(CURLoption option, TValue value)
     {
@@ -676,6 +953,106 @@ protected:
 
 };
 
+/**
+ * Event loop that drives every request of an HttpClient_Curl through a single
+ * curl_multi handle on one thread. Easy handles come from a CurlHandlePool,
+ * DNS results and TLS sessions are shared through a curl_share handle, and
+ * the multi handle's connection cache lets consecutive uploads reuse (and,
+ * over HTTP/2, multiplex onto) the same connection.
+ */
+class CurlMultiEngine {
+public:
+    using DoneCallback = std::function<void(std::shared_ptr<CurlHttpOperation>)>;
+
+    CurlMultiEngine();
+    ~CurlMultiEngine();
+
+    CurlMultiEngine(const CurlMultiEngine&) = delete;
+    CurlMultiEngine& operator=(const CurlMultiEngine&) = delete;
+
+    /**
+     * False if the multi or share handle could not be created.
+     */
+    bool IsValid() const
+    {
+        return m_multi != nullptr && m_share != nullptr;
+    }
+
+    /**
+     * Queue an operation. The callback runs on the loop thread once the
+     * transfer completes, fails or is aborted, and is always invoked. It
+     * receives the engine's reference to the operation, so the engine never
+     * destroys an operation after its callback has returned.
+     */
+    void Submit(std::shared_ptr<CurlHttpOperation> operation, DoneCallback callback);
+
+    /**
+     * Queue a connect-only operation. It runs alongside the transfers without
+     * taking one of their slots; the callback is invoked as for Submit().
+     */
+    void SubmitConnect(std::shared_ptr<CurlHttpOperation> operation, DoneCallback callback);
+
+    /**
+     * Abort every queued and running transfer.
+     */
+    void AbortAll();
+
+    /**
+     * Wake the loop so that it notices aborted operations without waiting
+     * for the next progress callback.
+     */
+    void Wakeup();
+
+    /**
+     * Cap the number of transfers running at once (0 means unlimited).
+     * Further submissions wait in FIFO order for a free slot.
+     */
+    void SetMaxActiveTransfers(size_t maxActive);
+
+    /**
+     * Retire connections that have been idle for longer than this many
+     * seconds instead of reusing them (0 keeps the libcurl default).
+     */
+    void SetIdleConnectionTimeout(long seconds);
+
+    const std::shared_ptr<CurlHandlePool>& GetHandlePool() const
+    {
+        return m_handlePool;
+    }
+
+    size_t GetActiveCount();
+    size_t GetQueuedCount();
+
+private:
+    struct Transfer {
+        std::shared_ptr<CurlHttpOperation> operation;
+        DoneCallback callback;
+    };
+
+    void ThreadFunc();
+    void AdmitPending(std::vector<Transfer>& finished);
+    void CollectFinished(std::vector<Transfer>& finished);
+    void AbortRunning(std::vector<Transfer>& finished);
+    void ApplyConnectionOptions(CURL* handle);
+
+    CURLM* m_multi = nullptr;
+    CURLSH* m_share = nullptr;
+    std::shared_ptr<CurlHandlePool> m_handlePool;
+
+    std::mutex m_lock;
+    std::condition_variable m_wake;
+    std::deque<Transfer> m_pending;
+    std::deque<Transfer> m_pendingConnects;
+    std::map<CURL*, Transfer> m_active;       // Touched by the loop thread only
+    std::map<CURL*, Transfer> m_connecting;   // Touched by the loop thread only
+    std::atomic<size_t> m_activeCount { 0 };
+    std::atomic<size_t> m_maxActive { 0 };
+    std::atomic<long> m_idleConnectionTimeout { 0 };
+    std::atomic<bool> m_running { true };
+    std::atomic<bool> m_abortAll { false };
+    std::thread m_thread;
+};
+
 } MAT_NS_END
 
 #endif // HAVE_MAT_DEFAULT_HTTP_CLIENT
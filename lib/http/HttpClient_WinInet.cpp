@@ -518,7 +518,7 @@ IHttpRequest* HttpClient_WinInet::CreateRequest()
 
 void HttpClient_WinInet::SendRequestAsync(IHttpRequest* request, IHttpResponseCallback* callback)
 {
-    // Note: 'request' is never owned by IHttpClient and gets deleted in EventsUploadContext.clear()
+    // Note: 'request' is never owned by IHttpClient and gets deleted in EventsUploadContext.clear(), as this client has no IHttpObjectPool
     WinInetRequestWrapper *wrapper = new WinInetRequestWrapper(*this, static_cast<SimpleHttpRequest*>(request));
     wrapper->send(callback);
 }
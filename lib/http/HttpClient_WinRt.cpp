@@ -307,7 +307,7 @@ namespace MAT_NS_BEGIN {
                 }
             }
 
-            // 'response' gets released in EventsUploadContext.clear()
+            // 'response' gets deleted in EventsUploadContext.clear(), as this client has no IHttpObjectPool
             m_appCallback->OnHttpResponse(response.release());
             m_parent.erase(m_id);
 
@@ -371,7 +371,7 @@ namespace MAT_NS_BEGIN {
 
     void HttpClient_WinRt::SendRequestAsync(IHttpRequest* request, IHttpResponseCallback* callback)
     {
-        // Note: 'request' is never owned by IHttpClient and gets deleted in EventsUploadContext.clear()
+        // Note: 'request' is never owned by IHttpClient and gets deleted in EventsUploadContext.clear(), as this client has no IHttpObjectPool
         if (request==nullptr)
         {
             LOG_ERROR("request is null!");
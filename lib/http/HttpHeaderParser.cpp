@@ -0,0 +1,136 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "HttpHeaderParser.hpp"
+
+#include <cstring>
+
+namespace MAT_NS_BEGIN {
+
+    static bool isWhitespace(char c)
+    {
+        return c == ' ' || c == '\t';
+    }
+
+    int HttpHeaderParser::ParseStatusLine(char const* line, size_t size)
+    {
+        // "HTTP/" version SP 3DIGIT [SP reason]; HTTP/2 status lines carry no minor version
+        if (size < 5 || memcmp(line, "HTTP/", 5) != 0)
+        {
+            return 0;
+        }
+        size_t pos = 5;
+        while (pos < size && line[pos] != ' ')
+        {
+            pos++;
+        }
+        if (size - pos < 4)
+        {
+            return 0;
+        }
+        int status = 0;
+        for (size_t i = pos + 1; i < pos + 4; i++)
+        {
+            if (line[i] < '0' || line[i] > '9')
+            {
+                return 0;
+            }
+            status = status * 10 + (line[i] - '0');
+        }
+        if (size - pos > 4 && line[pos + 4] != ' ')
+        {
+            return 0;
+        }
+        return status;
+    }
+
+    int HttpHeaderParser::Parse(char const* data, size_t size, HttpHeaders& headers)
+    {
+        headers.clear();
+        int status = 0;
+        HttpHeaders::iterator last = headers.end();
+
+        char const* end = data + size;
+        char const* line = data;
+        while (line < end)
+        {
+            char const* eol = static_cast<char const*>(memchr(line, '\n', static_cast<size_t>(end - line)));
+            char const* next = (eol != nullptr) ? eol + 1 : end;
+            if (eol == nullptr)
+            {
+                eol = end;
+            }
+            if (eol > line && eol[-1] == '\r')
+            {
+                eol--;
+            }
+            size_t length = static_cast<size_t>(eol - line);
+
+            if (length == 0)
+            {
+                // End of one response's headers
+                last = headers.end();
+            }
+            else if (isWhitespace(line[0]))
+            {
+                // Folded continuation of the previous value
+                char const* begin = line;
+                while (begin < eol && isWhitespace(*begin))
+                {
+                    begin++;
+                }
+                char const* finish = eol;
+                while (finish > begin && isWhitespace(finish[-1]))
+                {
+                    finish--;
+                }
+                if (last != headers.end() && finish > begin)
+                {
+                    last->second.append(1, ' ').append(begin, finish);
+                }
+            }
+            else if (int lineStatus = ParseStatusLine(line, length))
+            {
+                // A later response replaces the headers of an earlier one
+                status = lineStatus;
+                headers.clear();
+                last = headers.end();
+            }
+            else
+            {
+                char const* colon = static_cast<char const*>(memchr(line, ':', length));
+                char const* nameEnd = colon;
+                while (nameEnd != nullptr && nameEnd > line && isWhitespace(nameEnd[-1]))
+                {
+                    nameEnd--;
+                }
+                if (nameEnd != nullptr && nameEnd > line)
+                {
+                    char const* value = colon + 1;
+                    while (value < eol && isWhitespace(*value))
+                    {
+                        value++;
+                    }
+                    char const* valueEnd = eol;
+                    while (valueEnd > value && isWhitespace(valueEnd[-1]))
+                    {
+                        valueEnd--;
+                    }
+                    last = headers.emplace_hint(headers.end(),
+                        std::piecewise_construct,
+                        std::forward_as_tuple(line, nameEnd),
+                        std::forward_as_tuple(value, valueEnd));
+                }
+                else
+                {
+                    last = headers.end();
+                }
+            }
+            line = next;
+        }
+        return status;
+    }
+
+} MAT_NS_END
@@ -0,0 +1,44 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef HTTPHEADERPARSER_HPP
+#define HTTPHEADERPARSER_HPP
+
+#include "IHttpClient.hpp"
+
+#include <cstddef>
+
+namespace MAT_NS_BEGIN {
+
+    /// <summary>
+    /// Single-pass parser for a raw HTTP/1.x response header block, as
+    /// collected by CURLOPT_HEADERFUNCTION. Only the header names and values
+    /// that are kept are allocated.
+    ///
+    /// The block may hold several responses (an interim "100 Continue", or
+    /// one per redirect); only the headers of the last one are returned.
+    /// Lines without a colon are skipped, values are stripped of leading
+    /// and trailing whitespace, and obsolete folded continuation lines are
+    /// joined to the previous value.
+    /// </summary>
+    class HttpHeaderParser
+    {
+    public:
+        /// <summary>
+        /// Parses the header block into <paramref name="headers"/>, replacing
+        /// its contents.
+        /// </summary>
+        /// <returns>Status code of the last status line, or 0 if there is none.</returns>
+        static int Parse(char const* data, size_t size, HttpHeaders& headers);
+
+        /// <summary>
+        /// Parses "HTTP/x.y NNN reason".
+        /// </summary>
+        /// <returns>The status code, or 0 if the line is not a status line.</returns>
+        static int ParseStatusLine(char const* line, size_t size);
+    };
+
+} MAT_NS_END
+
+#endif
@@ -37,6 +37,7 @@ namespace MAT_NS_BEGIN {
 
     bool HttpRequestEncoder::handleEncode(EventsUploadContextPtr const& ctx)
     {
+        ctx->httpObjectPool = m_httpClient.GetObjectPool();
         ctx->httpRequest = m_httpClient.CreateRequest();
         ctx->httpRequestId = ctx->httpRequest->GetId();
 
@@ -151,7 +152,7 @@ namespace MAT_NS_BEGIN {
         ctx->httpRequest->GetHeaders().set("APIKey", tenantTokens);
 
         if (ctx->compressed) {
-            ctx->httpRequest->GetHeaders().add("Content-Encoding", "deflate");
+            ctx->httpRequest->GetHeaders().add("Content-Encoding", ctx->contentEncoding.empty() ? "deflate" : ctx->contentEncoding);
         }
 
 
@@ -83,6 +83,17 @@ namespace MAT_NS_BEGIN {
             processBody(response, outcome);
         }
 
+        if (outcome == Rejected && response.GetStatusCode() == 415 && ctx->compressed &&
+            !ctx->contentEncoding.empty() && ctx->contentEncoding != "deflate" && ctx->contentEncoding != "gzip")
+        {
+            // The collector does not support the negotiated Content-Encoding:
+            // keep the events and send them again with deflate.
+            LOG_WARN("HTTP request %s failed, Content-Encoding \"%s\" is not supported by the server",
+                response.GetId().c_str(), ctx->contentEncoding.c_str());
+            contentEncodingRejected(ctx);
+            outcome = RetryNetwork;
+        }
+
         switch (outcome) {
         case Accepted: {
             LOG_INFO("HTTP request %s finished after %d ms, events were successfully uploaded to the server",
@@ -91,7 +102,7 @@ namespace MAT_NS_BEGIN {
                 DebugEvent evt;
                 evt.type = DebugEventType::EVT_HTTP_OK;
                 evt.param1 = response.GetStatusCode();
-                evt.param2 = ctx->recordIdsAndTenantIds.size();
+                evt.param2 = ctx->recordIds.size();
                 evt.data = static_cast<void *>(request.GetBody().data());
                 evt.size = request.GetBody().size();
                 DispatchEvent(evt);
@@ -113,7 +124,7 @@ namespace MAT_NS_BEGIN {
                 // This is to be addressed with ETW trace API that can send
                 // a detailed error context to ETW provider.
                 evt.param1 = response.GetStatusCode();
-                evt.param2 = ctx->recordIdsAndTenantIds.size();
+                evt.param2 = ctx->recordIds.size();
                 evt.data = static_cast<void *>(request.GetBody().data());
                 evt.size = request.GetBody().size();
                 DispatchEvent(evt);
@@ -129,7 +140,7 @@ namespace MAT_NS_BEGIN {
                 DebugEvent evt;
                 evt.type = DebugEventType::EVT_HTTP_FAILURE;
                 evt.param1 = 0; // response.GetStatusCode();
-                evt.param2 = ctx->recordIdsAndTenantIds.size();
+                evt.param2 = ctx->recordIds.size();
                 DispatchEvent(evt);
             }
             ctx->httpResponse = nullptr;
@@ -147,7 +158,7 @@ namespace MAT_NS_BEGIN {
                 DebugEvent evt;
                 evt.type = DebugEventType::EVT_HTTP_FAILURE;
                 evt.param1 = response.GetStatusCode();
-                evt.param2 = ctx->recordIdsAndTenantIds.size();
+                evt.param2 = ctx->recordIds.size();
                 DispatchEvent(evt);
             }
             temporaryServerFailure(ctx);
@@ -161,7 +172,7 @@ namespace MAT_NS_BEGIN {
                 DebugEvent evt;
                 evt.type = DebugEventType::EVT_HTTP_FAILURE;
                 evt.param1 = response.GetStatusCode();
-                evt.param2 = ctx->recordIdsAndTenantIds.size();
+                evt.param2 = ctx->recordIds.size();
                 DispatchEvent(evt);
             }
             temporaryNetworkFailure(ctx);
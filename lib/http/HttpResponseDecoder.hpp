@@ -40,8 +40,10 @@ namespace MAT_NS_BEGIN {
         RouteSource<EventsUploadContextPtr const&>                    temporaryNetworkFailure;
         RouteSource<EventsUploadContextPtr const&>                    temporaryServerFailure;
         RouteSource<EventsUploadContextPtr const&>                    requestAborted;
+        RouteSource<EventsUploadContextPtr const&>                    contentEncodingRejected;
 
         virtual bool DispatchEvent(DebugEvent evt) override;
+
     };
 
 } MAT_NS_END
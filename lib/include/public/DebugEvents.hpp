@@ -126,6 +126,17 @@ namespace MAT_NS_BEGIN
 
         /// <summary>Ticket Expired</summary>
         EVT_TICKET_EXPIRED      = 0x0F000000,
+
+        /// <summary>Upload controller changed package size, upload interval or
+        /// uploads in flight. param1: package size limit in bytes,
+        /// param2: uploads in flight, data: UploadControllerState.
+        /// </summary>
+        EVT_UPLOAD_TUNED        = 0x10000000,
+
+        /// <summary>Per-stage pipeline latencies, raised at teardown.
+        /// param1: number of stages, data: PipelineStats.
+        /// </summary>
+        EVT_PIPELINE_STATS      = 0x11000000,
         /// <summary>Unknown error.</summary>
         EVT_UNKNOWN             = 0xDEADBEEF,
 
@@ -133,6 +144,23 @@ namespace MAT_NS_BEGIN
         //EVT_MASK_ALL        = 0xFFFFFFFF // We don't allow the 'all' handler at this time.
     } DebugEventType;
 
+    /// <summary>
+    /// The UploadControllerState structure describes a decision of the upload controller.
+    /// </summary>
+    struct UploadControllerState
+    {
+        /// <summary>Package size limit in bytes.</summary>
+        size_t maxUploadSizeBytes;
+        /// <summary>Number of uploads allowed in flight.</summary>
+        size_t maxUploadsInFlight;
+        /// <summary>Minimum delay before the next upload, in milliseconds.</summary>
+        size_t uploadDelayMs;
+        /// <summary>Smoothed round trip time of accepted uploads, in milliseconds.</summary>
+        size_t rttMs;
+        /// <summary>Smoothed throughput of accepted uploads, in bytes per second.</summary>
+        size_t throughputBps;
+    };
+
     /// <summary>The DebugEvent class represents a debug event object.</summary>
     class DebugEvent
     {
@@ -196,12 +224,28 @@ namespace MAT_NS_BEGIN
 #pragma warning( push )
 #pragma warning( disable: 4251 )
 #endif
-    /// <summary>The DebugEventSource class represents a debug event source.</summary>
+    /// <summary>
+    /// The DebugEventSource class represents a debug event source.
+    ///
+    /// Dispatching does not take a lock: it reads an immutable snapshot of the
+    /// listeners that is replaced whenever a listener or a cascaded source is
+    /// added or removed. Once a Remove or Detach call returns, the listener or
+    /// source is no longer called, unless the call was made from a listener.
+    /// </summary>
     class MATSDK_LIBABI DebugEventSource: public DebugEventDispatcher
     {
     public:
         /// <summary>The DebugEventSource constructor.</summary>
-        DebugEventSource() : seq(0) {}
+        DebugEventSource();
+
+        /// <summary>Copies the listeners and cascaded sources of another source.</summary>
+        DebugEventSource(DebugEventSource const& other);
+
+        /// <summary>Replaces the listeners and cascaded sources with those of another source.</summary>
+        DebugEventSource& operator=(DebugEventSource const& other);
+
+        /// <summary>The DebugEventSource destructor. Stops the threads of queued listeners.</summary>
+        virtual ~DebugEventSource() noexcept;
 
         /// <summary>Adds an event listener for the specified debug event type.</summary>
         virtual void AddEventListener(DebugEventType type, DebugEventListener &listener);
@@ -218,6 +262,21 @@ namespace MAT_NS_BEGIN
         /// <summary>Detach cascaded DebugEventSource to forward all events to</summary>
         virtual bool DetachEventSource(DebugEventSource & other);
 
+        /// <summary>Tells whether this source or a cascaded one has a listener for the type.</summary>
+        virtual bool HasListeners(DebugEventType type) const;
+
+        /// <summary>
+        /// Adds an event listener that is called on a thread of its own, so that a slow
+        /// listener does not hold up the SDK thread that raised the event. Up to
+        /// maxQueuedEvents events wait for the listener; further ones are dropped and
+        /// counted by GetDroppedEventCount. The data pointer of a queued event refers to
+        /// memory that only lives while the event is raised, so it is passed as nullptr.
+        /// </summary>
+        virtual void AddQueuedEventListener(DebugEventType type, DebugEventListener &listener, size_t maxQueuedEvents);
+
+        /// <summary>Number of events queued listeners of this source could not keep up with.</summary>
+        uint64_t GetDroppedEventCount() const;
+
     protected:
 #ifndef _MANAGED
         /// <summary>
@@ -232,6 +291,15 @@ namespace MAT_NS_BEGIN
         }
 #endif
 
+        /// <summary>Sequence number of the last dispatched event.</summary>
+        uint64_t sequence() const;
+
+        /// <summary>Publishes a new dispatch snapshot built from listeners and cascaded. Call under stateLock.</summary>
+        void publish();
+
+        /// <summary>Waits until no dispatch uses a replaced snapshot and frees them. Call without stateLock.</summary>
+        void synchronize();
+
         /// <summary>A collection of debug event listeners.</summary>
         std::map<unsigned, std::vector<DebugEventListener*> > listeners;
 
@@ -567,6 +567,7 @@ namespace MAT_NS_BEGIN
         DROPPED_REASON_RETRY_EXCEEDED,
         DROPPED_REASON_TEARDOWN_TIMEOUT,
         DROPPED_REASON_LATENCY_DISABLED_BY_PROFILE,
+        DROPPED_REASON_INGESTION_QUEUE_FULL,
         DROPPED_REASON_COUNT
     };
 
@@ -12,6 +12,7 @@
 
 #include <tuple>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 #include <cstddef>
@@ -97,6 +98,38 @@ namespace MAT_NS_BEGIN
             return (it != end()) ? it->second : m_empty;
         }
 
+        /// <summary>
+        /// Gets a string value given a name, compared without regard to case
+        /// as HTTP does for header names.
+        /// </summary>
+        /// <param name="name">A string that contains the name.</param>
+        /// <returns>A string that contains the value associated with the name.</returns>
+        std::string const& getIgnoreCase(std::string const& name) const
+        {
+            auto it = findIgnoreCase(name);
+            return (it != end()) ? it->second : m_empty;
+        }
+
+        /// <summary>
+        /// Appends every value of a name, compared without regard to case.
+        /// </summary>
+        /// <param name="name">A string that contains the name.</param>
+        /// <param name="values">The vector the values are appended to.</param>
+        /// <returns>The number of values found.</returns>
+        size_t getAll(std::string const& name, std::vector<std::string>& values) const
+        {
+            size_t found = 0;
+            for (auto const& header : *this)
+            {
+                if (equalsIgnoreCase(header.first, name))
+                {
+                    values.push_back(header.second);
+                    found++;
+                }
+            }
+            return found;
+        }
+
         /// <summary>
         /// Tests whether the multimap contains the specified name.
         /// </summary>
@@ -112,6 +145,45 @@ namespace MAT_NS_BEGIN
         using std::multimap<std::string, std::string>::end;
 
     protected:
+        static bool equalsIgnoreCase(std::string const& a, std::string const& b)
+        {
+            if (a.size() != b.size())
+            {
+                return false;
+            }
+            for (size_t i = 0; i < a.size(); i++)
+            {
+                char x = a[i];
+                char y = b[i];
+                if (x != y && ((x | 0x20) != (y | 0x20) || (x | 0x20) < 'a' || (x | 0x20) > 'z'))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /// <summary>
+        /// Exact lookup first, which is how the SDK spells the headers it
+        /// reads; the scan only runs when a server used different case.
+        /// </summary>
+        const_iterator findIgnoreCase(std::string const& name) const
+        {
+            auto it = find(name);
+            if (it != end())
+            {
+                return it;
+            }
+            for (it = begin(); it != end(); ++it)
+            {
+                if (equalsIgnoreCase(it->first, name))
+                {
+                    break;
+                }
+            }
+            return it;
+        }
+
         std::string m_empty;
     };
 
@@ -511,6 +583,32 @@ namespace MAT_NS_BEGIN
         }
     };
 
+    /// <summary>
+    /// The IHttpObjectPool class takes back the request and response objects of
+    /// an HTTP client once the SDK is done with them, so that the client can reset
+    /// and reuse them instead of freeing them.
+    /// </summary>
+    class IHttpObjectPool
+    {
+    public:
+        virtual ~IHttpObjectPool() noexcept = default;
+
+        /// <summary>
+        /// Takes back a request created by IHttpClient::CreateRequest(), after its
+        /// response has been handled or when it was never sent.
+        /// </summary>
+        /// <param name="request">The request, not to be used by the caller anymore.</param>
+        /// <param name="body">When empty, may receive the emptied buffer of the request
+        /// body, so that the caller fills it for the next request instead of allocating.</param>
+        virtual void ReleaseRequest(IHttpRequest* request, std::vector<uint8_t>& body) noexcept = 0;
+
+        /// <summary>
+        /// Takes back a response passed to IHttpResponseCallback::OnHttpResponse().
+        /// </summary>
+        /// <param name="response">The response, not to be used by the caller anymore.</param>
+        virtual void ReleaseResponse(IHttpResponse* response) noexcept = 0;
+    };
+
     /// <summary>
     /// The IHttpClient class is the interface for HTTP client implementations.
     /// </summary>
@@ -569,6 +667,23 @@ namespace MAT_NS_BEGIN
         /// </summary>
         /// <param name="config">The log configuration to read settings from.</param>
         virtual void ApplySettings(ILogConfiguration& /*config*/) {}
+
+        /// <summary>
+        /// Hints that a request to the URL is about to be sent, so that the
+        /// client may resolve the host and open a connection ahead of it.
+        /// Default implementation is a no-op.
+        /// </summary>
+        /// <param name="url">The URL of the upcoming request.</param>
+        virtual void PrepareConnection(std::string const& /*url*/) {}
+
+        /// <summary>
+        /// Gets the pool that takes back the requests and responses of this client.
+        /// Without a pool, the caller deletes them using their virtual destructor.
+        /// The pool may outlive the client.
+        /// Default implementation returns nullptr.
+        /// </summary>
+        /// <returns>The pool, or nullptr when the client does not reuse its objects.</returns>
+        virtual std::shared_ptr<IHttpObjectPool> GetObjectPool() { return nullptr; }
     };
 
     /// @endcond
@@ -114,6 +114,12 @@ namespace MAT_NS_BEGIN
     /// </summary>
     static constexpr const char* const CFG_BOOL_ENABLE_IP_SCRUBBING = "enableIpScrubbing";
 
+    /// <summary>
+    /// Measure per-stage pipeline latencies, reported by ILogManager::GetPipelineStats.
+    /// Off by default.
+    /// </summary>
+    static constexpr const char* const CFG_BOOL_ENABLE_PIPELINE_STATS = "enablePipelineStats";
+
     /// <summary>
     /// Parameter that allows to check if the SDK is running on UTC mode
     /// </summary>
@@ -139,6 +145,12 @@ namespace MAT_NS_BEGIN
     /// </summary>
     static constexpr const char* const CFG_STR_CACHE_FILE_PATH = "cacheFilePath";
 
+    /// <summary>
+    /// The offline storage format: "sqlite" (default) or "segment" for
+    /// append-only segment files next to the cache file-path.
+    /// </summary>
+    static constexpr const char* const CFG_STR_CACHE_FILE_FORMAT = "cacheFileFormat";
+
     /// <summary>
     /// the cache file size limit in bytes.
     /// </summary>
@@ -179,6 +191,12 @@ namespace MAT_NS_BEGIN
     /// </summary>
     static constexpr const char* const CFG_STR_TRACE_FOLDER_PATH = "traceFolderPath";
 
+    /// <summary>
+    /// Trace file format: "text" (default) or "binary". Binary traces are
+    /// written by a background thread and rendered with the decode-trace tool.
+    /// </summary>
+    static constexpr const char* const CFG_STR_TRACE_FORMAT = "traceFormat";
+
     /// <summary>
     /// The SDK mode.
     /// </summary>
@@ -234,6 +252,17 @@ namespace MAT_NS_BEGIN
     /// </summary>
     static constexpr const char* const CFG_INT_STORAGE_FULL_CHECK_TIME = "cacheFullNotificationIntervalTime";
 
+    /// <summary>
+    /// The maximum number of unused cache file pages given back per idle
+    /// vacuum step. 0 reclaims space on every delete instead.
+    /// </summary>
+    static constexpr const char* const CFG_INT_STORAGE_VACUUM_PAGES = "cacheVacuumPages";
+
+    /// <summary>
+    /// The time (ms) without deletes after which unused cache file pages are reclaimed.
+    /// </summary>
+    static constexpr const char* const CFG_INT_STORAGE_VACUUM_IDLE_TIME = "cacheVacuumIdleTime";
+
     /// <summary>
     /// The cache memory percentage full notification.
     /// </summary>
@@ -371,6 +400,31 @@ namespace MAT_NS_BEGIN
     /// </summary>
     static constexpr const char* const CFG_BOOL_HTTP_COMPRESSION = "compress";
 
+    /// <summary>
+    /// HTTP configuration: zlib compression level, 0 (store) to 9 (best), or -1 for the zlib default
+    /// </summary>
+    static constexpr const char* const CFG_INT_HTTP_COMPRESSION_LEVEL = "compressLevel";
+
+    /// <summary>
+    /// HTTP configuration: zlib compression strategy: "default", "filtered", "huffman", "rle" or "fixed"
+    /// </summary>
+    static constexpr const char* const CFG_STR_HTTP_COMPRESSION_STRATEGY = "compressStrategy";
+
+    /// <summary>
+    /// HTTP configuration: compress records as they are packaged instead of compressing the finished request body
+    /// </summary>
+    static constexpr const char* const CFG_BOOL_HTTP_COMPRESSION_STREAMING = "compressStreaming";
+
+    /// <summary>
+    /// HTTP configuration: zstd compression level, used when contentEncoding is "zstd"
+    /// </summary>
+    static constexpr const char* const CFG_INT_HTTP_ZSTD_LEVEL = "zstdLevel";
+
+    /// <summary>
+    /// HTTP configuration: path of a trained zstd dictionary shared with the collector
+    /// </summary>
+    static constexpr const char* const CFG_STR_HTTP_ZSTD_DICTIONARY = "zstdDictionary";
+
     /// <summary>
     /// HTTP configuration: SSL certificate verification (peer + host)
     /// </summary>
@@ -381,6 +435,16 @@ namespace MAT_NS_BEGIN
     /// </summary>
     static constexpr const char* const CFG_STR_HTTP_SSL_CAINFO = "sslCaInfo";
 
+    /// <summary>
+    /// HTTP configuration: resolve and handshake with the collector while an upload is scheduled
+    /// </summary>
+    static constexpr const char* const CFG_BOOL_HTTP_PRECONNECT = "preconnect";
+
+    /// <summary>
+    /// HTTP configuration: seconds an idle collector connection is kept for reuse
+    /// </summary>
+    static constexpr const char* const CFG_INT_HTTP_IDLE_CONNECTION_TIMEOUT = "idleConnectionTimeout";
+
     /// <summary>
     /// TPM configuration map
     /// </summary>
@@ -406,6 +470,58 @@ namespace MAT_NS_BEGIN
     /// </summary>
     static constexpr const char* const CFG_BOOL_TPM_CLOCK_SKEW_ENABLED = "clockSkewEnabled";
 
+    /// <summary>
+    /// TPM configuration: number of uploads prepared and sent concurrently,
+    /// one latency class per package. Capped by CFG_INT_MAX_PENDING_REQ;
+    /// 1 disables pipelining.
+    /// </summary>
+    static constexpr const char* const CFG_INT_TPM_MAX_PIPELINED_UPLOADS = "maxPipelinedUploads";
+
+    /// <summary>
+    /// TPM configuration: upload controller tuning package size, upload
+    /// interval and uploads in flight from past uploads, empty for none.
+    /// "A,minUploadSizeBytes,targetRttMs" selects additive increase and
+    /// multiplicative decrease within maxBlobSize and maxPendingHTTPRequests.
+    /// </summary>
+    static constexpr const char* const CFG_STR_TPM_UPLOAD_CONTROLLER = "uploadController";
+
+    /// <summary>
+    /// Ingestion queue configuration map
+    /// </summary>
+    static constexpr const char* const CFG_MAP_INGESTION = "ingestion";
+
+    /// <summary>
+    /// Ingestion queue: hand events to pipeline threads through a lock-free ring
+    /// instead of processing them on the logging thread
+    /// </summary>
+    static constexpr const char* const CFG_BOOL_INGESTION_ENABLED = "enabled";
+
+    /// <summary>
+    /// Ingestion queue: ring capacity in events (rounded up to a power of two)
+    /// </summary>
+    static constexpr const char* const CFG_INT_INGESTION_QUEUE_SIZE = "queueSize";
+
+    /// <summary>
+    /// Ingestion queue: number of pipeline threads draining the ring
+    /// </summary>
+    static constexpr const char* const CFG_INT_INGESTION_THREADS = "threads";
+
+    /// <summary>
+    /// Ingestion queue: policy when the ring is full - "block", "drop" or "spill"
+    /// </summary>
+    static constexpr const char* const CFG_STR_INGESTION_BACKPRESSURE = "backpressure";
+
+    /// <summary>
+    /// Task pool configuration map
+    /// </summary>
+    static constexpr const char* const CFG_MAP_TASK_POOL = "taskPool";
+
+    /// <summary>
+    /// Task pool: number of worker threads. Values above 1 replace the shared single worker
+    /// thread with a work-stealing pool owned by the LogManager
+    /// </summary>
+    static constexpr const char* const CFG_INT_TASK_POOL_THREADS = "threads";
+
     /// <summary>
     /// When enabled, the session timer is reset after session is completed, allowing for several session events in the duration of the SDK lifecycle
     /// </summary>
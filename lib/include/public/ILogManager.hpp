@@ -21,6 +21,7 @@
 #include "ISemanticContext.hpp"
 #include "LogConfiguration.hpp"
 #include "LogSessionData.hpp"
+#include "PipelineStats.hpp"
 
 #include "DebugEvents.hpp"
 #include "TransmitProfiles.hpp"
@@ -429,6 +430,25 @@ namespace MAT_NS_BEGIN
         /// method if StartActivity returned true.
         /// </summary>
         virtual void EndActivity() = 0;
+
+        /// <summary>
+        /// Tells whether an event of the specified type would reach any debug event
+        /// listener, so that callers can skip building it. Log managers that cannot
+        /// tell cheaply answer true.
+        /// </summary>
+        virtual bool HasListeners(DebugEventType /*type*/) const
+        {
+            return true;
+        }
+
+        /// <summary>
+        /// Gets the latency histograms of the pipeline stages and the depth of
+        /// the queues between them, measured when CFG_BOOL_ENABLE_PIPELINE_STATS is set.
+        /// </summary>
+        /// <param name="stats">Receives the snapshot.</param>
+        /// <param name="reset">Start a new measurement interval after the snapshot.</param>
+        /// <returns>STATUS_SUCCESS, or STATUS_ENOSYS when latencies are not measured.</returns>
+        virtual status_t GetPipelineStats(PipelineStats& stats, bool reset = false) = 0;
     };
 
 }
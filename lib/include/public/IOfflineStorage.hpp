@@ -358,6 +358,17 @@ namespace MAT_NS_BEGIN {
 
         virtual void ReleaseAllRecords() {}
 
+        /// <summary>
+        /// Give up to maxPages unused pages back to the file system
+        /// </summary>
+        /// <remarks>
+        /// Called from the internal worker thread once uploads have been idle
+        /// for a while. Storages that free space on delete need not override it.
+        /// </remarks>
+        /// <param name="maxPages">Upper bound of pages to reclaim, 0 for all</param>
+        /// <returns>Number of unused pages left</returns>
+        virtual size_t ReclaimFreePages(size_t /*maxPages*/) { return 0; }
+
     };
 
     // IOfflineStorage as Module. External offline storage implementations need to inherit from it.
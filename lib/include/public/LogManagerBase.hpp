@@ -622,6 +622,14 @@ namespace MAT_NS_BEGIN
             GetDebugEventSource().AddEventListener(type, listener);
         }
 
+        /// <summary>
+        /// Add Debug callback that runs on a thread of its own, see DebugEventSource::AddQueuedEventListener
+        /// </summary>
+        static void AddQueuedEventListener(DebugEventType type, DebugEventListener& listener, size_t maxQueuedEvents)
+        {
+            GetDebugEventSource().AddQueuedEventListener(type, listener, maxQueuedEvents);
+        }
+
         /// <summary>
         /// Remove Debug callback
         /// </summary>
@@ -672,6 +680,19 @@ namespace MAT_NS_BEGIN
         static void SetLevelFilter(uint8_t defaultLevel, const std::set<uint8_t>& allowedLevels)
             LM_SAFE_CALL_VOID(SetLevelFilter, defaultLevel, allowedLevels)
 
+        /// <summary>
+        /// Gets the latency histograms of the pipeline stages, see ILogManager::GetPipelineStats
+        /// </summary>
+        static status_t GetPipelineStats(PipelineStats& stats, bool reset = false)
+        {
+            LM_LOCKGUARD(stateLock());
+            if (nullptr != instance)
+            {
+                return instance->GetPipelineStats(stats, reset);
+            }
+            return STATUS_EFAIL;
+        }
+
         static ILogController* GetController()
         {
             // No-op LogManager is implemented as C++11 magic local static
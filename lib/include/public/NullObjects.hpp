@@ -165,6 +165,11 @@ namespace MAT_NS_BEGIN
             return false;
         }
 
+        virtual bool HasListeners(DebugEventType /*type*/) const override
+        {
+            return false;
+        }
+
         virtual void Configure() override {}
 
         virtual void FlushAndTeardown() override {}
@@ -338,6 +343,11 @@ namespace MAT_NS_BEGIN
             return this;
         }
 
+        virtual status_t GetPipelineStats(PipelineStats& /*stats*/, bool /*reset*/) override
+        {
+            return STATUS_ENOSYS;
+        }
+
         virtual IAuthTokensController * GetAuthTokensController() override
         {
             return nullptr;
@@ -47,6 +47,19 @@ namespace MAT_NS_BEGIN {
         /// </returns>
         bool DecodeRequest(const std::vector<uint8_t>& in, std::string& out, bool compressed = true);
 
+        /// <summary>
+        /// Decode a request body sent with the given HTTP Content-Encoding, e.g. "deflate", "gzip" or "zstd".
+        /// <param name="in">Payload data, e.g. HTTPS POST request body</param>
+        /// <param name="out">Record(s) in JSON format</param>
+        /// <param name="contentEncoding">Content-Encoding of the payload, empty if it is not compressed</param>
+        /// <param name="dictionary">Dictionary the payload was compressed with (optional, zstd only)</param>
+        /// </summary>
+        /// <returns>
+        /// Returns true on success, false if the encoding is not supported by this build.
+        /// </returns>
+        bool DecodeRequest(const std::vector<uint8_t>& in, std::string& out, const char* contentEncoding,
+            const std::vector<uint8_t>& dictionary = std::vector<uint8_t>());
+
     }
 
 } MAT_NS_END
@@ -0,0 +1,98 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef MAT_PIPELINESTATS_HPP
+#define MAT_PIPELINESTATS_HPP
+
+#include "ctmacros.hpp"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace MAT_NS_BEGIN
+{
+    /// <summary>
+    /// Stages an event passes through between the logger and the collector.
+    /// </summary>
+    enum PipelineStage
+    {
+        /// <summary>Logger::submit until the event is handed to the log manager.</summary>
+        PipelineStage_Submit,
+        /// <summary>Wait in the ingestion queue, when it is enabled.</summary>
+        PipelineStage_Queue,
+        /// <summary>Log manager lock, custom decorator and data inspectors.</summary>
+        PipelineStage_Dispatch,
+        /// <summary>Bond serialization of the record.</summary>
+        PipelineStage_Serialize,
+        /// <summary>Writing the record to offline storage.</summary>
+        PipelineStage_Store,
+        /// <summary>Reading and reserving the records of one upload.</summary>
+        PipelineStage_Retrieve,
+        /// <summary>Finalizing the package of one upload.</summary>
+        PipelineStage_Package,
+        /// <summary>Compressing the body of one upload.</summary>
+        PipelineStage_Compress,
+        /// <summary>Building the HTTP request of one upload.</summary>
+        PipelineStage_Encode,
+        /// <summary>HTTP round trip, until the response is handled.</summary>
+        PipelineStage_Send,
+        /// <summary>Decoding the HTTP response of one upload.</summary>
+        PipelineStage_Decode,
+        /// <summary>From storing a record until the collector accepted it.</summary>
+        PipelineStage_Delivery,
+        PipelineStage_Max
+    };
+
+    /// <summary>
+    /// Latency distribution of one pipeline stage. Percentiles are upper bounds
+    /// of histogram buckets, which are at most 1/16 wider than their lower bound.
+    /// </summary>
+    struct PipelineStageStats
+    {
+        PipelineStage stage = PipelineStage_Max;
+        /// <summary>Short lower-case name of the stage, e.g. "serialize".</summary>
+        const char* name = "";
+        /// <summary>Number of measurements.</summary>
+        uint64_t count = 0;
+        uint64_t minNs = 0;
+        uint64_t maxNs = 0;
+        uint64_t meanNs = 0;
+        uint64_t p50Ns = 0;
+        uint64_t p90Ns = 0;
+        uint64_t p99Ns = 0;
+        uint64_t p999Ns = 0;
+        /// <summary>Events or uploads in the stage right now, and the most seen at once.</summary>
+        uint64_t active = 0;
+        uint64_t maxActive = 0;
+        /// <summary>Non-empty buckets as (upper bound in ns, count), in increasing order.</summary>
+        std::vector<std::pair<uint64_t, uint64_t>> buckets;
+    };
+
+    /// <summary>
+    /// Depth of a queue between pipeline stages.
+    /// </summary>
+    struct PipelineQueueStats
+    {
+        /// <summary>"ingestion", "storage" or "http".</summary>
+        const char* name = "";
+        uint64_t depth = 0;
+        /// <summary>Highest depth seen, or 0 when the queue does not track it.</summary>
+        uint64_t maxDepth = 0;
+    };
+
+    /// <summary>
+    /// Snapshot returned by ILogManager::GetPipelineStats and carried by EVT_PIPELINE_STATS.
+    /// </summary>
+    struct PipelineStats
+    {
+        /// <summary>One entry per PipelineStage, in pipeline order.</summary>
+        std::vector<PipelineStageStats> stages;
+        std::vector<PipelineQueueStats> queues;
+    };
+
+}
+MAT_NS_END
+
+#endif
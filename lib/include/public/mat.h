@@ -60,7 +60,9 @@ extern "C" {
         EVT_OP_VERSION = 0x0000000B,
         EVT_OP_OPEN_WITH_PARAMS = 0x0000000C,
         EVT_OP_FLUSHANDTEARDOWN = 0x0000000D,
-        EVT_OP_MAX = EVT_OP_FLUSHANDTEARDOWN + 1,
+        EVT_OP_GET_LOGGER = 0x0000000E,
+        EVT_OP_LOG_BATCH = 0x0000000F,
+        EVT_OP_MAX = EVT_OP_LOG_BATCH + 1,
     } evt_call_t;
 
     typedef enum evt_prop_t
@@ -191,6 +193,38 @@ extern "C" {
         evt_prop_v              value;
         uint32_t                piiKind;
     } evt_prop;
+
+    /**
+     * <summary>
+     * Logger handle obtained with 'evt_get_logger'. Valid until the SDK instance is closed.
+     * </summary>
+     */
+    typedef int64_t  evt_logger_t;
+
+    /**
+     * <summary>
+     * Input and output of 'evt_get_logger'
+     * </summary>
+     */
+    typedef struct evt_logger_data_t
+    {
+        const char*             token;      /* In: iKey, NULL for the primary token */
+        const char*             source;     /* In: event source, may be NULL */
+        evt_logger_t            logger;     /* Out */
+    } evt_logger_data_t;
+
+    /**
+     * <summary>
+     * Input of 'evt_log_batch'. Each event is an evt_prop array terminated by
+     * a TYPE_NULL entry. When 'logger' is 0 the logger of every event is
+     * resolved from its iKey and event source, as done by 'evt_log'.
+     * </summary>
+     */
+    typedef struct evt_log_batch_data_t
+    {
+        evt_logger_t            logger;
+        evt_prop**              events;
+    } evt_log_batch_data_t;
     
     /**
      * <summary>
@@ -628,6 +662,59 @@ extern "C" {
         return (const char *)(ctx.data);
     }
 
+    /** <summary>
+     * Obtain a logger handle for the given iKey and event source. The lookup
+     * is done once, so events logged through the handle with 'evt_log_batch'
+     * skip the per-event logger resolution of 'evt_log'.
+     * </summary>
+     * <param name="handle">SDK handle.</param>
+     * <param name="token">iKey, NULL for the primary token.</param>
+     * <param name="source">Event source, may be NULL.</param>
+     * <returns>Logger handle, 0 on failure.</returns>
+     */
+    static inline evt_logger_t evt_get_logger(evt_handle_t handle, const char* token, const char* source)
+    {
+        evt_logger_data_t data;
+        evt_context_t ctx;
+
+        data.token = token;
+        data.source = source;
+        data.logger = 0;
+
+        ctx.call = EVT_OP_GET_LOGGER;
+        ctx.handle = handle;
+        ctx.data = (void *)(&data);
+        if (evt_api_call(&ctx) != 0)
+        {
+            return 0;
+        }
+        return data.logger;
+    }
+
+    /** <summary>
+     * Logs several telemetry events in one call.
+     * </summary>
+     * <param name="handle">SDK handle.</param>
+     * <param name="logger">Logger handle from evt_get_logger, or 0 to use the iKey of each event.</param>
+     * <param name="count">Number of events.</param>
+     * <param name="events">Events, each one terminated by { .name = NULL, .type = TYPE_NULL }.</param>
+     * <returns>Status code.</returns>
+     */
+    static inline evt_status_t evt_log_batch(evt_handle_t handle, evt_logger_t logger, uint32_t count, evt_prop** events)
+    {
+        evt_log_batch_data_t data;
+        evt_context_t ctx;
+
+        data.logger = logger;
+        data.events = events;
+
+        ctx.call = EVT_OP_LOG_BATCH;
+        ctx.handle = handle;
+        ctx.data = (void *)(&data);
+        ctx.size = count;
+        return evt_api_call(&ctx);
+    }
+
     /* New API calls to be added using evt_api_call(&ctx) for backwards-forward / ABI compat */
 
 #ifdef __cplusplus
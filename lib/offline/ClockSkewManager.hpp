@@ -19,7 +19,7 @@ namespace MAT_NS_BEGIN {
 
         void handleResponse(const HttpHeaders& headers)
         {
-            const auto& timeString = headers.get("time-delta-millis");
+            const auto& timeString = headers.getIgnoreCase("time-delta-millis");
             if (!timeString.empty())
             {
                 SetDelta(timeString);
@@ -53,7 +53,7 @@ namespace MAT_NS_BEGIN {
         {
             bool isNewTokenKilled = false;
 
-            std::string timeStr = headers.get("Retry-After");
+            std::string timeStr = headers.getIgnoreCase("Retry-After");
             if (!timeStr.empty())
             {
                 int64_t timeinSecs = 0;
@@ -66,18 +66,13 @@ namespace MAT_NS_BEGIN {
                 }
             }
 
-            std::pair<std::multimap<std::string, std::string>::const_iterator, std::multimap<std::string, std::string>::const_iterator> ret;
-            ret = headers.equal_range("kill-tokens");
-
-            if (ret.first != ret.second)
+            std::vector<std::string> tokens;
+            if (headers.getAll("kill-tokens", tokens) != 0)
             {
                 std::vector<std::string> killtokensVector;
 
-                for (std::multimap<std::string, std::string>::const_iterator it = ret.first; it != ret.second; ++it)
+                for (std::string& token : tokens)
                 {
-                    // it->second is a const reference (const_iterator), so this is a
-                    // copy; no std::move (moving from const silently copies anyway).
-                    std::string token = it->second;
                     size_t pos = token.find(':');
                     if (pos != std::string::npos)
                     {
@@ -92,11 +87,11 @@ namespace MAT_NS_BEGIN {
                     {
                         continue;
                     }
-                    killtokensVector.push_back(token);
+                    killtokensVector.push_back(std::move(token));
                 }
 
                 int64_t timeinSecs = 0;
-                std::string timeString = headers.get("kill-duration");
+                std::string timeString = headers.getIgnoreCase("kill-duration");
                 if (!timeString.empty())
                 {
                     tryParseSeconds(timeString, timeinSecs);
@@ -209,6 +204,7 @@ namespace MAT_NS_BEGIN {
             return now > maxTime - durationMs ? maxTime : now + durationMs;
         }
 
+    public:
         // Parse a count of seconds from a response-header value (Retry-After /
         // kill-duration). Returns false when the value is malformed or out of
         // range instead of letting std::stoll throw: the worker thread that drives
@@ -279,6 +275,8 @@ namespace MAT_NS_BEGIN {
             }
         }
 
+    private:
+
         // Tenant tokens are opaque (they may legitimately contain spaces, quotes,
         // etc.). Every sink that consumes the token handles raw bytes safely -- the
         // offline-storage DELETE is parameterized (SQLite bind / Room DAO) and the
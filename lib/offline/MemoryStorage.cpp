@@ -15,6 +15,7 @@ namespace MAT_NS_BEGIN {
         m_observer(nullptr),
         m_config(runtimeConfig),
         m_logManager(logManager),
+        m_queuedCount(),
         m_size(0),
         m_lastReadCount(0)
     {
@@ -40,12 +41,11 @@ namespace MAT_NS_BEGIN {
     /// </remarks>
     void MemoryStorage::Shutdown()
     {
-        LOCKGUARD(m_reserved_lock);
-        LOCKGUARD(m_records_lock);
+        LOCKGUARD(m_lock);
 
         for (unsigned latency = EventLatency_Off; (latency <= EventLatency_Max); latency++)
         {
-            size_t numRecords = m_records[latency].size();
+            size_t numRecords = m_queuedCount[latency];
             if (numRecords)
             {
                 // OfflineStorageHandler high-level wrapper must flush these on graceful shutdown
@@ -53,9 +53,9 @@ namespace MAT_NS_BEGIN {
             }
         }
 
-        if (m_reserved_records.size())
+        if (m_reserved.size())
         {
-            LOG_WARN("Discarding %u reserved records", m_reserved_records.size());
+            LOG_WARN("Discarding %u reserved records", m_reserved.size());
         }
     }
     
@@ -68,14 +68,82 @@ namespace MAT_NS_BEGIN {
     void MemoryStorage::Flush()
     {
     }
-    
-    template<typename T, typename V>
-    bool contains(T vec, V value)
+
+    /// <summary>
+    /// Takes a slot from the free list, or grows the pool.
+    /// </summary>
+    MemoryStorage::RecordHandle MemoryStorage::allocateSlot()
     {
-        auto it = std::find(vec.begin(), vec.end(), value);
-        if (it != vec.end())
-            return true;
-        return false;
+        if (!m_freeSlots.empty())
+        {
+            RecordHandle handle = m_freeSlots.back();
+            m_freeSlots.pop_back();
+            return handle;
+        }
+        m_slots.emplace_back();
+        return static_cast<RecordHandle>(m_slots.size() - 1);
+    }
+
+    /// <summary>
+    /// Returns a slot to the free list. Small buffers are kept so the next
+    /// record copied into the slot does not allocate; large blobs are freed.
+    /// </summary>
+    void MemoryStorage::releaseSlot(RecordHandle handle)
+    {
+        static constexpr size_t PooledBlobCapacity = 4096;
+
+        StorageRecord& record = m_slots[handle].record;
+        record.id.clear();
+        record.tenantToken.clear();
+        if (record.blob.capacity() > PooledBlobCapacity)
+        {
+            StorageBlob().swap(record.blob);
+        }
+        else
+        {
+            record.blob.clear();
+        }
+        m_slots[handle].state = SlotState::Free;
+        m_freeSlots.push_back(handle);
+    }
+
+    /// <summary>
+    /// Drops a queued record. Its handle is skipped and recycled when the
+    /// ring reaches it, so nothing has to be erased from the middle of a ring.
+    /// </summary>
+    void MemoryStorage::deleteQueued(RecordHandle handle)
+    {
+        Slot& slot = m_slots[handle];
+        m_size -= std::min(m_size, recordSize(slot.record));
+        m_queuedCount[slot.record.latency]--;
+        StorageBlob().swap(slot.record.blob);
+        slot.state = SlotState::Deleted;
+    }
+
+    /// <summary>
+    /// Moves a reserved record back to the front of its ram queue.
+    /// </summary>
+    void MemoryStorage::requeue(RecordHandle handle, bool incrementRetryCount)
+    {
+        Slot& slot = m_slots[handle];
+        if (incrementRetryCount)
+            slot.record.retryCount++;
+        slot.record.reservedUntil = 0;
+        slot.state = SlotState::Queued;
+        m_queues[slot.record.latency].push_front(handle);
+        m_queuedCount[slot.record.latency]++;
+        m_size += recordSize(slot.record);
+    }
+
+    std::unordered_multimap<size_t, MemoryStorage::RecordHandle>::iterator MemoryStorage::findReserved(StorageRecordId const& id)
+    {
+        auto range = m_reserved.equal_range(std::hash<StorageRecordId>()(id));
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            if (m_slots[it->second].record.id == id)
+                return it;
+        }
+        return m_reserved.end();
     }
 
     /// <summary>
@@ -96,43 +164,49 @@ namespace MAT_NS_BEGIN {
         if (record.latency == EventLatency_Off)
             return false;
 
-        LOCKGUARD(m_records_lock);
-        m_size += record.blob.size() + sizeof(record); // approximate contents size
-
-#ifdef DEBUG_DUPLICATE_ROUTES
-        if (contains(m_records[record.latency], record))
-            LOG_WARN("Vector already contains this element!");
-#endif
-
-        m_records[record.latency].push_back(std::move(record));
+        LOCKGUARD(m_lock);
+        storeRecord(record);
         return true;
     }
 
     size_t MemoryStorage::StoreRecords(std::vector<StorageRecord> & records)
     {
         size_t stored = 0;
+        LOCKGUARD(m_lock);
         for (auto  & i : records) {
-            if (StoreRecord(i)) {
+            if (i.latency != EventLatency_Off) {
+                storeRecord(i);
                 ++stored;
             }
         }
         return stored;
     }
 
+    void MemoryStorage::storeRecord(StorageRecord const& record)
+    {
+        m_size += recordSize(record);
+
+        RecordHandle handle = allocateSlot();
+        Slot& slot = m_slots[handle];
+        slot.record = record; // reuses the buffers of the pooled slot
+        slot.state = SlotState::Queued;
+        m_queues[record.latency].push_back(handle);
+        m_queuedCount[record.latency]++;
+    }
+
     /// <summary>
-    /// Get records from MemoryStorage.
-    /// Getting records automatically deletes them.
-    /// Reservation is not currently supported.
+    /// Get records from MemoryStorage, oldest first within each latency.
+    /// Without a lease the records are moved to the consumer and deleted.
+    /// With a lease the consumer gets a copy and the record stays in its
+    /// slot as reserved until it is deleted or released by id.
     /// </summary>
-    /// <param name="consumer">The consumer.</param>
+    /// <param name="consumer">The consumer. It must leave the record untouched when it returns false.</param>
     /// <param name="leaseTimeMs">The lease time ms.</param>
     /// <param name="minLatency">The minimum latency.</param>
     /// <param name="maxCount">The maximum count.</param>
     /// <returns></returns>
     bool MemoryStorage::GetAndReserveRecords(std::function<bool(StorageRecord&&)> const & consumer, unsigned leaseTimeMs, EventLatency minLatency, unsigned maxCount)
     {
-        UNREFERENCED_PARAMETER(leaseTimeMs);
-
         LOG_TRACE("Retrieving max. %u%s events of latency at least %d (%s)",
             maxCount, (maxCount > 0) ? "" : " (unlimited)",
             minLatency, latencyToStr(static_cast<EventLatency>(minLatency)));
@@ -143,33 +217,51 @@ namespace MAT_NS_BEGIN {
         if (minLatency == EventLatency_Unspecified)
             minLatency = EventLatency_Off;
 
-        LOCKGUARD(m_reserved_lock);
-        LOCKGUARD(m_records_lock);
+        int64_t reservedUntil = leaseTimeMs ? PAL::getUtcSystemTimeMs() + leaseTimeMs : 0;
+
+        LOCKGUARD(m_lock);
         m_lastReadCount = 0;
         // Start processing events of critical latency first
         for (int latency = static_cast<int>(EventLatency_Max); (latency >= static_cast<int>(minLatency)) && (maxCount); latency--)
         {
-            while (maxCount && (m_records[latency]).size())
+            HandleRing& queue = m_queues[latency];
+            while (maxCount && !queue.empty())
             {
-                StorageRecord & record = m_records[latency].back();
-
-                size_t recordSize = record.blob.size() + sizeof(record);
-                StorageRecord forConsumer(record);
-                if (leaseTimeMs)
+                RecordHandle handle = queue.front();
+                Slot& slot = m_slots[handle];
+                if (slot.state == SlotState::Deleted)
                 {
-                    forConsumer.reservedUntil = PAL::getUtcSystemTimeMs() + leaseTimeMs;
+                    queue.pop_front();
+                    releaseSlot(handle);
+                    continue;
                 }
 
-                bool wantMore = consumer(std::move(forConsumer)); // move to consumer
-                if (!wantMore) {
-                    return true;
+                size_t size = recordSize(slot.record);
+                if (leaseTimeMs)
+                {
+                    // Release must be able to restore the record after the
+                    // consumer took its blob, so reserved records are copied.
+                    StorageRecord forConsumer(slot.record);
+                    forConsumer.reservedUntil = reservedUntil;
+                    if (!consumer(std::move(forConsumer))) {
+                        return true;
+                    }
+                    queue.pop_front();
+                    slot.record.reservedUntil = reservedUntil;
+                    slot.idHash = std::hash<StorageRecordId>()(slot.record.id);
+                    slot.state = SlotState::Reserved;
+                    m_reserved.emplace(slot.idHash, handle);
                 }
-
-                if (leaseTimeMs) {
-                    m_reserved_records[record.id] = std::move(record); // move to reserved
+                else
+                {
+                    if (!consumer(std::move(slot.record))) {
+                        return true;
+                    }
+                    queue.pop_front();
+                    releaseSlot(handle);
                 }
-                m_records[latency].pop_back();
-                m_size -= std::min(m_size, recordSize);
+                m_queuedCount[latency]--;
+                m_size -= std::min(m_size, size);
                 maxCount--;
                 m_lastReadCount++;
             }
@@ -194,32 +286,23 @@ namespace MAT_NS_BEGIN {
     /// <returns></returns>
     unsigned MemoryStorage::LastReadRecordCount()
     {
-        LOCKGUARD(m_records_lock);
+        LOCKGUARD(m_lock);
         return static_cast<unsigned>(m_lastReadCount);
     }
 
     void MemoryStorage::DeleteAllRecords()
     {
+        LOCKGUARD(m_lock);
+        m_reserved.clear();
+        for (unsigned latency = EventLatency_Off; (latency <= EventLatency_Max); latency++)
         {
-            LOCKGUARD(m_reserved_lock);
-            if (m_reserved_records.size())
-            {
-                m_reserved_records.clear();
-            }
-        }
-        {
-            LOCKGUARD(m_records_lock);
-            for (unsigned latency = EventLatency_Off; (latency <= EventLatency_Max); latency++)
-            {
-                auto& records = m_records[latency];
-                if (records.size()) {
-                    records.clear();
-                }
-            }
-            m_size = 0;
-            m_lastReadCount = 0;
+            m_queues[latency].clear();
+            m_queuedCount[latency] = 0;
         }
-
+        m_slots.clear();
+        m_freeSlots.clear();
+        m_size = 0;
+        m_lastReadCount = 0;
     }
 
     void MemoryStorage::DeleteRecords(const std::map<std::string, std::string> & whereFilter)
@@ -241,42 +324,31 @@ namespace MAT_NS_BEGIN {
             return matched;
         };
 
+        LOCKGUARD(m_lock);
+
         // Delete from reserved, which is typically a shorter list
-        std::vector<StorageRecordId> m_reserved_ids;
+        auto it = m_reserved.begin();
+        while (it != m_reserved.end())
         {
-            LOCKGUARD(m_reserved_lock);
-            for (const auto & kv : m_reserved_records)
+            if (matcher(m_slots[it->second].record, whereFilter))
             {
-                if (matcher(kv.second, whereFilter))
-                {
-                    m_reserved_ids.push_back(kv.first);
-                }
+                releaseSlot(it->second);
+                it = m_reserved.erase(it);
+                continue;
             }
-        }
-        if (!m_reserved_ids.empty())
-        {
-            bool fromMemory = true;
-            DeleteRecords(m_reserved_ids, HttpHeaders(), fromMemory);
+            ++it;
         }
 
         // Delete from ram queue, which is a bigger list
+        for (unsigned latency = EventLatency_Off; latency <= EventLatency_Max;  latency++)
         {
-            LOCKGUARD(m_records_lock);
-            for (unsigned latency = EventLatency_Off; latency <= EventLatency_Max;  latency++)
+            HandleRing const& queue = m_queues[latency];
+            for (size_t i = 0; i < queue.size(); i++)
             {
-                auto& records = m_records[latency];
-                auto it = records.begin();
-                // remove from records all ids that were found in the set
-                while (it != records.end()) {
-                    auto &v = *it;
-                    if (matcher(v, whereFilter))
-                    {
-                        size_t recordSize = v.blob.size() + sizeof(v);
-                        m_size -= std::min(m_size, recordSize);
-                        it = records.erase(it);
-                        continue;
-                    }
-                    ++it;
+                RecordHandle handle = queue[i];
+                if (m_slots[handle].state == SlotState::Queued && matcher(m_slots[handle].record, whereFilter))
+                {
+                    deleteQueued(handle);
                 }
             }
         }
@@ -293,60 +365,41 @@ namespace MAT_NS_BEGIN {
         UNREFERENCED_PARAMETER(headers);
         UNREFERENCED_PARAMETER(fromMemory);
 
+        LOCKGUARD(m_lock);
+
+        // Delete from reserved records, one hash lookup each
+        std::unordered_set<StorageRecordId> idSet;
+        for (auto const& id : ids)
         {
-            // Delete from reserved records (m_reserved_records)
-            LOCKGUARD(m_reserved_lock);
-            if (m_reserved_records.size())
+            auto it = findReserved(id);
+            if (it != m_reserved.end())
             {
-                std::unordered_set<StorageRecordId> idSet(ids.begin(), ids.end());
-                auto it = m_reserved_records.begin();
-                while (it != m_reserved_records.end()) {
-                    auto &kv = *it;
-                    if (idSet.count(kv.first))
-                    {
-                        idSet.erase(kv.first);
-                        it = m_reserved_records.erase(it);
-                        continue;
-                    }
-                    ++it;
-                }
-                if (idSet.size() == 0) // done
-                    return;
+                releaseSlot(it->second);
+                m_reserved.erase(it);
+            }
+            else
+            {
+                idSet.insert(id);
             }
         }
 
+        // Delete the rest from ram queue
+        for (unsigned latency = EventLatency_Off; (latency <= EventLatency_Max) && idSet.size(); latency++)
         {
-            // Delete from ram queue (m_records[])
-            LOCKGUARD(m_records_lock);
+            if (m_queuedCount[latency] == 0)
+                continue;
 
-            // convert vector of ids to unordered set
-            std::unordered_set<StorageRecordId> idSet(ids.begin(), ids.end());
-
-            // For each latency - delete from current unreserved records
-            for (unsigned latency = EventLatency_Off; (latency <= EventLatency_Max); latency++)
+            HandleRing const& queue = m_queues[latency];
+            for (size_t i = 0; (i < queue.size()) && idSet.size(); i++)
             {
-                auto& records = m_records[latency];
-                if (records.size() && idSet.size())
+                RecordHandle handle = queue[i];
+                if (m_slots[handle].state == SlotState::Queued && idSet.erase(m_slots[handle].record.id))
                 {
-                    auto it = records.begin();
-                    // remove from records all ids that were found in the set
-                    while (it != records.end()) {
-                        auto &v = *it;
-                        if (idSet.count(v.id))
-                        {
-                            // record id appears once only, so remove from set
-                            idSet.erase(v.id);
-                            size_t recordSize = v.blob.size() + sizeof(v);
-                            m_size -= std::min(m_size, recordSize);
-                            it = records.erase(it);
-                            continue;
-                        }
-                        ++it;
-                    }
+                    // record id appears once only, so it was removed from the set
+                    deleteQueued(handle);
                 }
             }
         }
-
     }
 
     /// <summary>
@@ -358,28 +411,19 @@ namespace MAT_NS_BEGIN {
     /// <param name="fromMemory"></param>
     void MemoryStorage::ReleaseRecords(std::vector<StorageRecordId> const & ids, bool incrementRetryCount, HttpHeaders headers, bool & fromMemory)
     {
-        UNREFERENCED_PARAMETER(incrementRetryCount);
         UNREFERENCED_PARAMETER(headers);
         UNREFERENCED_PARAMETER(fromMemory);
 
-        // Move back from reserved records to ram queue
-        LOCKGUARD(m_reserved_lock);
-        if (m_reserved_records.size())
+        // Move back from reserved records to the front of ram queue. Going
+        // backwards keeps the records in the order they are listed.
+        LOCKGUARD(m_lock);
+        for (auto id = ids.rbegin(); id != ids.rend(); ++id)
         {
-            std::unordered_set<StorageRecordId> idSet(ids.begin(), ids.end());
-            auto it = m_reserved_records.begin();
-            while (it != m_reserved_records.end()) {
-                auto &kv = *it;
-                if (idSet.count(kv.first))
-                {
-                    if (incrementRetryCount)
-                        kv.second.retryCount++;
-                    StoreRecord(kv.second);
-                    idSet.erase(kv.first);
-                    it = m_reserved_records.erase(it);
-                    continue;
-                }
-                ++it;
+            auto it = findReserved(*id);
+            if (it != m_reserved.end())
+            {
+                requeue(it->second, incrementRetryCount);
+                m_reserved.erase(it);
             }
         }
     }
@@ -388,17 +432,12 @@ namespace MAT_NS_BEGIN {
     {
         // In case if HTTP upload has been canceled or didn't succeed,
         // we'd move all reserved records to regular ram queue
-        LOCKGUARD(m_reserved_lock);
-        if (m_reserved_records.size())
+        LOCKGUARD(m_lock);
+        for (auto const& kv : m_reserved)
         {
-            auto it = m_reserved_records.begin();
-            while (it != m_reserved_records.end())
-            {
-                auto &kv = *it;
-                StoreRecord(kv.second);
-                it = m_reserved_records.erase(it);
-            }
+            requeue(kv.second, false);
         }
+        m_reserved.clear();
     }
 
     /// <summary>
@@ -453,7 +492,7 @@ namespace MAT_NS_BEGIN {
     /// </remarks>
     size_t MemoryStorage::GetSize()
     {
-        LOCKGUARD(m_records_lock);
+        LOCKGUARD(m_lock);
         return m_size;
     }
 
@@ -464,16 +503,16 @@ namespace MAT_NS_BEGIN {
     /// <returns></returns>
     size_t MemoryStorage::GetRecordCount(EventLatency latency) const
     {
-        LOCKGUARD(m_records_lock);
+        LOCKGUARD(m_lock);
         size_t numRecords = 0;
         if (latency == EventLatency_Unspecified)
         {
             for (unsigned lat = EventLatency_Off; lat <= EventLatency_Max; lat++)
-                numRecords += m_records[lat].size();
+                numRecords += m_queuedCount[lat];
         }
         else
         {
-            numRecords = m_records[latency].size();
+            numRecords = m_queuedCount[latency];
         }
         return numRecords;
     }
@@ -516,8 +555,8 @@ namespace MAT_NS_BEGIN {
     /// <returns></returns>
     size_t MemoryStorage::GetReservedCount()
     {
-        LOCKGUARD(m_reserved_lock);
-        return m_reserved_records.size();
+        LOCKGUARD(m_lock);
+        return m_reserved.size();
     }
 
     /// <summary>
@@ -525,21 +564,16 @@ namespace MAT_NS_BEGIN {
     /// GetRecordCount(), so add them here for accurate shutdown reporting.
     /// </summary>
     /// <remarks>
-    /// Take both locks (reserved first, then records — matching the order used
-    /// by Shutdown() and GetAndReserveRecords()) so the returned count is an
-    /// atomic snapshot. Without this, a record moving between the active queue
-    /// and the reserved map (e.g. via GetAndReserveRecords / ReleaseRecords)
-    /// could be double-counted or missed.
+    /// Queued and reserved records share one lock, so a record moving between
+    /// the ram queue and the reserved set is never double-counted or missed.
     /// </remarks>
     size_t MemoryStorage::GetRemainingRecordCountForShutdown() const
     {
-        LOCKGUARD(m_reserved_lock);
-        LOCKGUARD(m_records_lock);
+        LOCKGUARD(m_lock);
         size_t records = 0;
         for (unsigned lat = EventLatency_Off; lat <= EventLatency_Max; lat++)
-            records += m_records[lat].size();
-        return records + m_reserved_records.size();
+            records += m_queuedCount[lat];
+        return records + m_reserved.size();
     }
 
 } MAT_NS_END
-
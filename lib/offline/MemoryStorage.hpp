@@ -16,11 +16,14 @@
 #include "ILogManager.hpp"
 
 #include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 namespace MAT_NS_BEGIN {
 
@@ -78,20 +81,122 @@ namespace MAT_NS_BEGIN {
         virtual ~MemoryStorage() override;
 
     protected:
-        
+
+        /// <summary>
+        /// Compact reference to a record slot in the pool.
+        /// </summary>
+        typedef uint32_t RecordHandle;
+
+        enum class SlotState : uint8_t
+        {
+            Free,
+            Queued,
+            Reserved,
+            // Deleted while queued; the handle is still in its ring and the
+            // slot is recycled once the ring pops it.
+            Deleted
+        };
+
+        struct Slot
+        {
+            StorageRecord   record;
+            size_t          idHash = 0;
+            SlotState       state = SlotState::Free;
+        };
+
+        /// <summary>
+        /// Growable FIFO ring of record handles. Handles are pushed at the back
+        /// on store, popped from the front on read, and released records go
+        /// back to the front since they are older than anything queued.
+        /// </summary>
+        class HandleRing
+        {
+        public:
+            bool empty() const { return m_count == 0; }
+            size_t size() const { return m_count; }
+            RecordHandle front() const { return m_items[m_head]; }
+            RecordHandle operator[](size_t index) const { return m_items[(m_head + index) & (m_items.size() - 1)]; }
+
+            void push_back(RecordHandle handle)
+            {
+                reserveOne();
+                m_items[(m_head + m_count) & (m_items.size() - 1)] = handle;
+                m_count++;
+            }
+
+            void push_front(RecordHandle handle)
+            {
+                reserveOne();
+                m_head = (m_head + m_items.size() - 1) & (m_items.size() - 1);
+                m_items[m_head] = handle;
+                m_count++;
+            }
+
+            void pop_front()
+            {
+                m_head = (m_head + 1) & (m_items.size() - 1);
+                m_count--;
+            }
+
+            void clear()
+            {
+                std::vector<RecordHandle>().swap(m_items);
+                m_head = 0;
+                m_count = 0;
+            }
+
+        protected:
+            void reserveOne()
+            {
+                if (m_count < m_items.size())
+                    return;
+                // Capacity stays a power of two so positions wrap with a mask
+                std::vector<RecordHandle> items(m_items.empty() ? 64 : m_items.size() * 2);
+                for (size_t i = 0; i < m_count; i++)
+                    items[i] = (*this)[i];
+                m_items.swap(items);
+                m_head = 0;
+            }
+
+            std::vector<RecordHandle>   m_items;
+            size_t                      m_head = 0;
+            size_t                      m_count = 0;
+        };
+
+        void storeRecord(StorageRecord const& record);
+        RecordHandle allocateSlot();
+        void releaseSlot(RecordHandle handle);
+        void deleteQueued(RecordHandle handle);
+        void requeue(RecordHandle handle, bool incrementRetryCount);
+        std::unordered_multimap<size_t, RecordHandle>::iterator findReserved(StorageRecordId const& id);
+
+        static size_t recordSize(StorageRecord const& record)
+        {
+            return record.blob.size() + sizeof(record); // approximate contents size
+        }
+
         IOfflineStorageObserver*    m_observer;
         IRuntimeConfig&             m_config;
         ILogManager&                m_logManager;
 
-        mutable std::mutex          m_records_lock;
-        std::vector<StorageRecord>  m_records[EventLatency_Max+1];
-        
+        mutable std::mutex          m_lock;
+
+        /// <summary>
+        /// Pool of record slots. Queued and reserved records stay in their slot
+        /// until they are handed out for good or deleted, and freed slots keep
+        /// their buffers for the next record.
+        /// </summary>
+        std::vector<Slot>           m_slots;
+        std::vector<RecordHandle>   m_freeSlots;
+
+        HandleRing                  m_queues[EventLatency_Max+1];
+        size_t                      m_queuedCount[EventLatency_Max+1];
+
         /// <summary>
-        /// Contains reserved (aka in-flight) records.
+        /// Contains reserved (aka in-flight) records, keyed by the hash of their id.
         /// Current storage interface API requires deletion and release by StorageRecordId.
         /// </summary>
-        mutable std::mutex          m_reserved_lock;
-        std::map<StorageRecordId, StorageRecord> m_reserved_records;
+        std::unordered_multimap<size_t, RecordHandle> m_reserved;
 
         size_t                      m_size;
 
@@ -12,6 +12,7 @@
 #include "offline/OfflineStorage_Room.hpp"
 #else
 #include "offline/OfflineStorage_SQLite.hpp"
+#include "offline/OfflineStorage_Segment.hpp"
 #endif
 
 #include <memory>
@@ -30,6 +31,11 @@ namespace MAT_NS_BEGIN
         LOG_TRACE("Creating OfflineStorage_Room");
         return std::make_shared<OfflineStorage_Room>(logManager, runtimeConfig);
 #else
+        const char* format = runtimeConfig[CFG_STR_CACHE_FILE_FORMAT];
+        if ((format != nullptr) && (std::string(format) == "segment")) {
+            LOG_TRACE("Creating OfflineStorage_Segment");
+            return std::make_shared<OfflineStorage_Segment>(logManager, runtimeConfig);
+        }
         LOG_TRACE("Creating OfflineStorage_SQLite");
         return std::make_shared<OfflineStorage_SQLite>(logManager, runtimeConfig);
 #endif //USE_ROOM
@@ -26,6 +26,8 @@ namespace MAT_NS_BEGIN {
         m_killSwitchManager(),
         m_clockSkewManager(),
         m_flushPending(false),
+        m_isVacuumScheduled(false),
+        m_lastDeleteTime(0),
         m_offlineStorageMemory(nullptr),
         m_offlineStorageDisk(nullptr),
         m_readFromMemory(false),
@@ -110,6 +112,13 @@ namespace MAT_NS_BEGIN {
         LOG_TRACE("Shutting down offline storage handler");
         m_shutdownStarted = true;
         WaitForFlush();
+        {
+            LOCKGUARD(m_vacuumLock);
+            if (m_isVacuumScheduled.exchange(false))
+            {
+                m_vacuumHandle.Cancel();
+            }
+        }
         if (nullptr != m_offlineStorageMemory)
         {
             m_offlineStorageMemory->ReleaseAllRecords();
@@ -183,15 +192,12 @@ namespace MAT_NS_BEGIN {
             auto records = m_offlineStorageMemory->GetRecords(false, EventLatency_Unspecified);
             std::vector<StorageRecordId> ids;
 
-            // TODO: [MG] - consider running the batch in transaction
-            //            if (sqlite)
-            //                sqlite->Execute("BEGIN");
-
+            // The disk storage stores the whole batch in a single transaction.
             size_t totalSaved = m_offlineStorageDisk->StoreRecords(records);
-
-            // TODO: [MG] - consider running the batch in transaction
-            //            if (sqlite)
-            //                sqlite->Execute("END");
+            if (totalSaved < records.size())
+            {
+                LOG_WARN("Flush persisted %zu of %zu records", totalSaved, records.size());
+            }
 
             // Delete records from reserved on flush
             HttpHeaders dummy;
@@ -224,6 +230,50 @@ namespace MAT_NS_BEGIN {
         m_logManager.EndActivity();
     }
 
+    void OfflineStorageHandler::scheduleVacuum()
+    {
+        uint32_t pages = m_config[CFG_INT_STORAGE_VACUUM_PAGES];
+        if ((pages == 0) || m_shutdownStarted || (m_offlineStorageDisk == nullptr))
+        {
+            return;
+        }
+
+        m_lastDeleteTime = PAL::getMonotonicTimeMs();
+        if (!m_isVacuumScheduled.exchange(true))
+        {
+            uint32_t idleTime = m_config[CFG_INT_STORAGE_VACUUM_IDLE_TIME];
+            LOCKGUARD(m_vacuumLock);
+            m_vacuumHandle = PAL::scheduleTask(&m_taskDispatcher, idleTime, this, &OfflineStorageHandler::vacuum);
+        }
+    }
+
+    void OfflineStorageHandler::vacuum()
+    {
+        LOCKGUARD(m_vacuumLock);
+        if (m_shutdownStarted || !m_isVacuumScheduled)
+        {
+            return;
+        }
+
+        // Deletes arrived since this was scheduled: wait until they stop
+        uint32_t idleTime = m_config[CFG_INT_STORAGE_VACUUM_IDLE_TIME];
+        int64_t idleFor = PAL::getMonotonicTimeMs() - m_lastDeleteTime;
+        if (idleFor < static_cast<int64_t>(idleTime))
+        {
+            m_vacuumHandle = PAL::scheduleTask(&m_taskDispatcher, static_cast<unsigned>(idleTime - idleFor), this, &OfflineStorageHandler::vacuum);
+            return;
+        }
+
+        uint32_t pages = m_config[CFG_INT_STORAGE_VACUUM_PAGES];
+        size_t remaining = m_offlineStorageDisk->ReclaimFreePages(pages);
+        if (remaining > 0)
+        {
+            m_vacuumHandle = PAL::scheduleTask(&m_taskDispatcher, idleTime, this, &OfflineStorageHandler::vacuum);
+            return;
+        }
+        m_isVacuumScheduled = false;
+    }
+
     bool OfflineStorageHandler::StoreRecord(StorageRecord const& record)
     {
         // Don't discard on shutdown because the kill-switch may be temporary.
@@ -308,6 +358,11 @@ namespace MAT_NS_BEGIN {
         return true;
     }
 
+    size_t OfflineStorageHandler::ReclaimFreePages(size_t maxPages)
+    {
+        return (nullptr != m_offlineStorageDisk) ? m_offlineStorageDisk->ReclaimFreePages(maxPages) : 0;
+    }
+
     bool OfflineStorageHandler::IsLastReadFromMemory()
     {
         return m_readFromMemory;
@@ -422,6 +477,7 @@ namespace MAT_NS_BEGIN {
                 storagePtr->DeleteRecords(whereFilter);
             }
         }
+        scheduleVacuum();
     }
 
     /// <summary>
@@ -461,6 +517,7 @@ namespace MAT_NS_BEGIN {
             if (nullptr != m_offlineStorageDisk)
             {
                 m_offlineStorageDisk->DeleteRecords(ids, headers, fromMemory);
+                scheduleVacuum();
             }
         }
     }
@@ -489,6 +546,11 @@ namespace MAT_NS_BEGIN {
             if (nullptr != m_offlineStorageDisk)
             {
                 m_offlineStorageDisk->ReleaseRecords(ids, incrementRetryCount, headers, fromMemory);
+                if (incrementRetryCount)
+                {
+                    // Records over the retry limit are deleted
+                    scheduleVacuum();
+                }
             }
         }
     }
@@ -54,6 +54,7 @@ namespace MAT_NS_BEGIN {
 
         virtual std::vector<StorageRecord> GetRecords(bool shutdown, EventLatency minLatency = EventLatency_Unspecified, unsigned maxCount = 0) override;
         virtual bool ResizeDb() override;
+        virtual size_t ReclaimFreePages(size_t maxPages) override;
 
         virtual void OnStorageOpened(std::string const& type) override;
         virtual void OnStorageFailed(std::string const& reason) override;
@@ -82,6 +83,13 @@ namespace MAT_NS_BEGIN {
         PAL::DeferredCallbackHandle            m_flushHandle;
         PAL::Event                             m_flushComplete;
 
+        // Unused disk pages are reclaimed a bounded step at a time once
+        // deletes have stopped for a while
+        std::mutex                             m_vacuumLock;
+        std::atomic<bool>                      m_isVacuumScheduled;
+        std::atomic<int64_t>                   m_lastDeleteTime;
+        PAL::DeferredCallbackHandle            m_vacuumHandle;
+
         std::unique_ptr<IOfflineStorage>       m_offlineStorageMemory;
         std::shared_ptr<IOfflineStorage>       m_offlineStorageDisk;
 
@@ -100,6 +108,8 @@ namespace MAT_NS_BEGIN {
 
     private:
         void WaitForFlush();
+        void scheduleVacuum();
+        void vacuum();
 
     };
 
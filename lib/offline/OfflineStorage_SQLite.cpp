@@ -18,6 +18,17 @@ namespace MAT_NS_BEGIN {
 
     constexpr static size_t kBlockSize = 8192;
 
+    // Rows per execution of the multi-row insert used by StoreRecords. Kept well
+    // below SQLITE_MAX_VARIABLE_NUMBER (999 on older builds) at six columns a row.
+    constexpr static size_t kInsertBatchRows = 32;
+    constexpr static size_t kInsertColumns = 6;
+
+    // Rows deleted per statement when trimming, and the share of the used
+    // space a trim gives back (at least one record, more if the storage is
+    // further over its limit)
+    constexpr static unsigned kTrimChunkRows = 256;
+    constexpr static size_t kTrimPercent = 25;
+
     std::mutex OfflineStorage_SQLite::m_initAndShutdownLock;
     int OfflineStorage_SQLite::m_instanceCount = 0;
 
@@ -80,6 +91,9 @@ namespace MAT_NS_BEGIN {
         uint32_t ramSizeLimit = m_config[CFG_INT_RAM_QUEUE_SIZE];
         m_DbSizeHeapLimit = ramSizeLimit;
 
+        uint32_t vacuumPages = m_config[CFG_INT_STORAGE_VACUUM_PAGES];
+        m_vacuumPages = vacuumPages;
+
         const char* skipSqliteInit = m_config["skipSqliteInitAndShutdown"];
         if (skipSqliteInit != nullptr)
         {
@@ -147,14 +161,22 @@ namespace MAT_NS_BEGIN {
             m_db->execute(command.c_str());
     }
 
+    bool OfflineStorage_SQLite::isValidRecord(StorageRecord const& record)
+    {
+        if (record.id.empty() || record.tenantToken.empty() || static_cast<int>(record.latency) < 0 || record.timestamp <= 0) {
+            LOG_ERROR("Failed to store event %s:%s: Invalid parameters",
+                tenantTokenToId(record.tenantToken).c_str(), record.id.c_str());
+            return false;
+        }
+        return true;
+    }
+
     bool OfflineStorage_SQLite::StoreRecord(StorageRecord const& record)
     {
         // TODO: [MG] - this works, but may not play nicely with several LogManager instances
         // static SqliteStatement sql_insert(*m_db, m_stmtInsertEvent_id_tenant_prio_ts_data);
 
-        if (record.id.empty() || record.tenantToken.empty() || static_cast<int>(record.latency) < 0 || record.timestamp <= 0) {
-            LOG_ERROR("Failed to store event %s:%s: Invalid parameters",
-                tenantTokenToId(record.tenantToken).c_str(), record.id.c_str());
+        if (!isValidRecord(record)) {
             m_observer->OnStorageFailed("Invalid parameters");
             return false;
         }
@@ -181,6 +203,13 @@ namespace MAT_NS_BEGIN {
             m_DbSizeEstimate += record.id.size() + record.tenantToken.size() + record.blob.size();
         }
 
+        checkSizeLimits();
+        return true;
+
+    }
+
+    void OfflineStorage_SQLite::checkSizeLimits()
+    {
         if ((m_DbSizeNotificationLimit != 0) && (m_DbSizeEstimate>m_DbSizeNotificationLimit))
         {
             auto now = PAL::getMonotonicTimeMs();
@@ -210,18 +239,120 @@ namespace MAT_NS_BEGIN {
                 m_resizing = false;
             }
         }
+    }
 
-        return true;
+    /// <summary>
+    /// Inserts the records with the multi-row statement, kInsertBatchRows at a
+    /// time, and with the single-row statement for the tail. A chunk that fails
+    /// is retried row by row so that one bad row does not reject its neighbours.
+    /// Must be called inside a transaction. Returns the number of rows inserted.
+    /// </summary>
+    size_t OfflineStorage_SQLite::insertRecordsUnsafe(std::vector<StorageRecord const*> const& records, size_t& bytesStored)
+    {
+        size_t inserted = 0;
+        auto insertOne = [&](StorageRecord const& r) {
+            if (SqliteStatement(*m_db, m_stmtInsertEvent_id_tenant_prio_ts_data).execute(r.id, r.tenantToken,
+                static_cast<int>(r.latency), static_cast<int>(r.persistence), r.timestamp, r.blob))
+            {
+                bytesStored += r.id.size() + r.tenantToken.size() + r.blob.size();
+                inserted++;
+            }
+        };
+
+        size_t pos = 0;
+        if (m_stmtInsertEvents_batch != 0)
+        {
+            SqliteStatement batchStmt(*m_db, m_stmtInsertEvents_batch);
+            for (; records.size() - pos >= kInsertBatchRows; pos += kInsertBatchRows)
+            {
+                int failedIdx = 0;
+                size_t chunkBytes = 0;
+                for (size_t i = 0; i < kInsertBatchRows; i++)
+                {
+                    auto const& r = *records[pos + i];
+                    chunkBytes += r.id.size() + r.tenantToken.size() + r.blob.size();
+                    if (failedIdx == 0)
+                    {
+                        failedIdx = batchStmt.bindAt(static_cast<int>(i * kInsertColumns), r.id, r.tenantToken,
+                            static_cast<int>(r.latency), static_cast<int>(r.persistence), r.timestamp, r.blob);
+                    }
+                }
+                if (batchStmt.executeBound(failedIdx))
+                {
+                    bytesStored += chunkBytes;
+                    inserted += kInsertBatchRows;
+                    continue;
+                }
+                batchStmt.reset();
+                for (size_t i = 0; i < kInsertBatchRows; i++)
+                {
+                    insertOne(*records[pos + i]);
+                }
+            }
+        }
 
+        for (; pos < records.size(); pos++)
+        {
+            insertOne(*records[pos]);
+        }
+        return inserted;
     }
 
     size_t OfflineStorage_SQLite::StoreRecords(std::vector<StorageRecord> & records)
     {
+        if (records.empty()) {
+            return 0;
+        }
+
+        if (!m_db) {
+            LOG_ERROR("Failed to store %zu events: Database is not open", records.size());
+            m_observer->OnStorageOpenFailed("Database is not open");
+            return 0;
+        }
+
+        // Invalid records are reported and skipped up front, so the valid ones
+        // can be fed to the multi-row statement as one contiguous run.
+        std::vector<StorageRecord const*> valid;
+        valid.reserve(records.size());
+        for (auto const& record : records) {
+            if (isValidRecord(record)) {
+                valid.push_back(&record);
+            }
+        }
+        const size_t invalidCount = records.size() - valid.size();
+
         size_t stored = 0;
-        for (auto & i : records) {
-            if (StoreRecord(i)) {
-                ++stored;
+        if (!valid.empty())
+        {
+            LOCKGUARD(m_lock);
+#ifdef ENABLE_LOCKING
+            // One write transaction for the whole batch: a single journal sync
+            // instead of one per record.
+            DbTransaction transaction(m_db.get());
+            if (!transaction.locked)
+            {
+                LOG_ERROR("Failed to store %zu events: Database error", records.size());
+                m_observer->OnStorageFailed("Database error");
+                return 0;
             }
+#endif
+            size_t bytesStored = 0;
+            stored = insertRecordsUnsafe(valid, bytesStored);
+            m_DbSizeEstimate += bytesStored;
+        }
+
+        // Partial-failure report: one notification per batch rather than per record.
+        const size_t failed = records.size() - stored;
+        if (failed > 0)
+        {
+            LOG_ERROR("Stored %zu of %zu events: %zu invalid, %zu failed to insert",
+                stored, records.size(), invalidCount, failed - invalidCount);
+            m_observer->OnStorageFailed((failed == invalidCount) ? "Invalid parameters" : "Database error");
+        }
+
+        if (stored > 0)
+        {
+            checkSizeLimits();
         }
         return stored;
     }
@@ -753,7 +884,10 @@ namespace MAT_NS_BEGIN {
 
     bool OfflineStorage_SQLite::initializeDatabase()
     {
-        SqliteStatement(*m_db, "PRAGMA auto_vacuum=FULL").select();
+        // Incremental mode only moves freed pages to the free list on delete;
+        // ReclaimFreePages() gives them back to the file system later. An
+        // existing database switches between FULL and INCREMENTAL in place.
+        SqliteStatement(*m_db, (m_vacuumPages > 0) ? "PRAGMA auto_vacuum=INCREMENTAL" : "PRAGMA auto_vacuum=FULL").select();
         SqliteStatement(*m_db, "PRAGMA journal_mode=WAL").select();
         SqliteStatement(*m_db, "PRAGMA synchronous=NORMAL").select();
         {
@@ -811,6 +945,22 @@ namespace MAT_NS_BEGIN {
             return false;
         }
 
+        // Reserve, release and delete look records up by ID. The index is
+        // created on open for existing databases too; older SDK versions
+        // ignore it, so the schema version stays the same.
+        if (!SqliteStatement(*m_db,
+            "CREATE INDEX IF NOT EXISTS k_record_id ON " TABLE_NAME_EVENTS " (record_id)"
+        ).execute()) {
+            return false;
+        }
+
+        // Trimming walks the oldest records of the lowest persistence first
+        if (!SqliteStatement(*m_db,
+            "CREATE INDEX IF NOT EXISTS k_persistence_timestamp ON " TABLE_NAME_EVENTS " (persistence ASC, timestamp ASC)"
+        ).execute()) {
+            return false;
+        }
+
         if (!SqliteStatement(*m_db,
             "CREATE TABLE IF NOT EXISTS " TABLE_NAME_SETTINGS " ("
             "name"  " TEXT,"
@@ -850,22 +1000,20 @@ namespace MAT_NS_BEGIN {
 
         PREPARE_SQL(m_stmtGetPageCount,
             "PRAGMA page_count");
+        PREPARE_SQL(m_stmtGetFreePageCount,
+            "PRAGMA freelist_count");
 
         PREPARE_SQL(m_stmtGetRecordCount,
             "SELECT count(*) FROM " TABLE_NAME_EVENTS);
         PREPARE_SQL(m_stmtGetRecordCountBylatency,
             "SELECT count(*) FROM " TABLE_NAME_EVENTS " WHERE latency=?");
 
-        PREPARE_SQL(m_stmtPerTenantTrimCount,
-            "SELECT tenant_token FROM " TABLE_NAME_EVENTS " ORDER BY persistence ASC, timestamp ASC LIMIT MAX(1,"
-            "(SELECT COUNT(record_id) FROM " TABLE_NAME_EVENTS ")"
-            "* ? / 100)");
-        PREPARE_SQL(m_stmtTrimEvents_percent,
-                    "DELETE FROM " TABLE_NAME_EVENTS " WHERE record_id IN ("
-                                                     "SELECT record_id FROM " TABLE_NAME_EVENTS " ORDER BY persistence ASC, timestamp ASC LIMIT MAX(1,"
-                                                                                                "(SELECT COUNT(record_id) FROM " TABLE_NAME_EVENTS ")"
-                                                                                                                                                   "* ? / 100)"
-                                                                                                                                                   ")");
+        PREPARE_SQL(m_stmtSelectTrimSizes,
+            "SELECT length(record_id)+length(tenant_token)+ifnull(length(payload),0) FROM " TABLE_NAME_EVENTS
+            " ORDER BY persistence ASC, timestamp ASC");
+        PREPARE_SQL(m_stmtTrimEvents_count,
+            "DELETE FROM " TABLE_NAME_EVENTS " WHERE rowid IN ("
+            "SELECT rowid FROM " TABLE_NAME_EVENTS " ORDER BY persistence ASC, timestamp ASC LIMIT ?)");
 
         PREPARE_SQL(m_stmtDeleteEvents_tenants,
                 SQL_SUPPLY_PACKAGED_IDS
@@ -911,6 +1059,14 @@ namespace MAT_NS_BEGIN {
             " WHERE retry_count>?");
         PREPARE_SQL(m_stmtInsertEvent_id_tenant_prio_ts_data,
             "REPLACE INTO " TABLE_NAME_EVENTS " (record_id,tenant_token,latency,persistence,timestamp,payload) VALUES (?,?,?,?,?,?)");
+        {
+            std::string batchInsert("REPLACE INTO " TABLE_NAME_EVENTS " (record_id,tenant_token,latency,persistence,timestamp,payload) VALUES (?,?,?,?,?,?)");
+            for (size_t i = 1; i < kInsertBatchRows; i++) {
+                batchInsert += ",(?,?,?,?,?,?)";
+            }
+            // Optional: StoreRecords falls back to single-row inserts without it.
+            m_stmtInsertEvents_batch = m_db->prepare(batchInsert.c_str());
+        }
         PREPARE_SQL(m_stmtInsertSetting_name_value,
             "REPLACE INTO " TABLE_NAME_SETTINGS " (name,value) VALUES (?,?)");
         PREPARE_SQL(m_stmtDeleteSetting_name,
@@ -986,6 +1142,101 @@ namespace MAT_NS_BEGIN {
         return OfflineStorage_SQLite::GetRecordCountUnsafe(latency);
     }
 
+    size_t OfflineStorage_SQLite::GetFreePageCountUnsafe() const
+    {
+        unsigned freePages = 0;
+        SqliteStatement freePageStmt(*m_db, m_stmtGetFreePageCount);
+        if (freePageStmt.select())
+        {
+            freePageStmt.getRow(freePages);
+        }
+        freePageStmt.reset();
+        return freePages;
+    }
+
+    /// <summary>
+    /// Gives up to maxPages pages of the free list back to the file system,
+    /// all of them if maxPages is 0. Returns the number of free pages left.
+    /// </summary>
+    size_t OfflineStorage_SQLite::ReclaimFreePages(size_t maxPages)
+    {
+        if (!m_db) {
+            return 0;
+        }
+
+        LOCKGUARD(m_lock);
+        size_t freePages = GetFreePageCountUnsafe();
+        if (freePages == 0 || m_vacuumPages == 0)
+        {
+            return freePages;
+        }
+        {
+#ifdef ENABLE_LOCKING
+            DbTransaction transaction(m_db.get());
+            if (!transaction.locked)
+            {
+                return freePages;
+            }
+#endif
+            // Every freed page comes back as a result row
+            std::string vacuum = "PRAGMA incremental_vacuum(" + toString(maxPages) + ")";
+            SqliteStatement vacuumStmt(*m_db, vacuum.c_str());
+            if (vacuumStmt.select())
+            {
+                int freed;
+                while (vacuumStmt.getRow(freed)) {}
+            }
+        }
+        size_t remaining = GetFreePageCountUnsafe();
+        LOG_TRACE("Reclaimed %zu free pages, %zu left", freePages - remaining, remaining);
+        m_DbSizeEstimate = GetSize();
+        return remaining;
+    }
+
+    /// <summary>
+    /// Deletes the oldest records of the lowest persistence, walking the
+    /// trim index until about a quarter of the used space (and at least the
+    /// part over the limit) is covered. Returns the number of records deleted.
+    /// </summary>
+    size_t OfflineStorage_SQLite::trimUnsafe(size_t usedBytes)
+    {
+        size_t needed = (usedBytes > m_DbSizeLimit) ? (usedBytes - m_DbSizeLimit) : 0;
+        size_t wanted = std::max(needed, usedBytes * kTrimPercent / 100);
+
+        size_t rows = 0;
+        {
+            SqliteStatement sizeStmt(*m_db, m_stmtSelectTrimSizes);
+            size_t bytes = 0;
+            int64_t rowBytes = 0;
+            if (sizeStmt.select())
+            {
+                while (sizeStmt.getRow(rowBytes))
+                {
+                    if ((rows > 0) && (bytes >= needed) && (bytes + static_cast<size_t>(rowBytes) > wanted))
+                    {
+                        break;
+                    }
+                    bytes += static_cast<size_t>(rowBytes);
+                    rows++;
+                }
+            }
+            sizeStmt.reset();
+        }
+
+        size_t dropped = 0;
+        SqliteStatement trimStmt(*m_db, m_stmtTrimEvents_count);
+        while (dropped < rows)
+        {
+            unsigned chunk = static_cast<unsigned>(std::min<size_t>(kTrimChunkRows, rows - dropped));
+            if (!trimStmt.execute(chunk) || trimStmt.changes() == 0)
+            {
+                break;
+            }
+            dropped += trimStmt.changes();
+        }
+        return dropped;
+    }
+
     bool OfflineStorage_SQLite::ResizeDb()
     {
         if (!m_db) {
@@ -1000,6 +1251,14 @@ namespace MAT_NS_BEGIN {
 
         LOCKGUARD(m_lock);
         {
+            // Pages freed since the last idle vacuum may be all that is over
+            if (m_vacuumPages != 0)
+            {
+                ReclaimFreePages(0);
+                if (m_DbSizeEstimate <= m_DbSizeLimit)
+                    return false;
+            }
+
 #ifdef ENABLE_LOCKING
             DbTransaction transaction(m_db.get());
             if (!transaction.locked)
@@ -1008,29 +1267,23 @@ namespace MAT_NS_BEGIN {
                 return false;
             }
 #endif
-            auto count = GetRecordCountUnsafe(EventLatency::EventLatency_Unspecified);
-            if (m_DbSizeEstimate > 2 * m_DbSizeLimit)
+            // However far over the limit, only the oldest records needed to
+            // get back under it are dropped
+            size_t usedBytes = m_DbSizeEstimate - std::min<size_t>(m_DbSizeEstimate, GetFreePageCountUnsafe() * m_pageSize);
+            eventsDropped = trimUnsafe(usedBytes);
+            if (eventsDropped == 0)
             {
-                LOG_TRACE("DB is too big, deleting...");
-                Execute("DELETE FROM " TABLE_NAME_EVENTS);
-                Execute("VACUUM");
-                eventsDropped = count;
-            }
-            else
-            {
-                SqliteStatement trimStmt(*m_db, m_stmtTrimEvents_percent);
-                if (!trimStmt.execute(25))
-                {
-                    // If something went wrong with trimming 25%, try more radical measure
-                    LOG_TRACE("Evict all non-critical");
-                    Execute("DELETE FROM " TABLE_NAME_EVENTS " WHERE persistence=1");
-                }
-                eventsDropped = count - GetRecordCountUnsafe(EventLatency::EventLatency_Unspecified);
-                LOG_TRACE("Db resized, events dropped: %zu", eventsDropped);
-                trimStmt.reset();
+                // If something went wrong with trimming, try more radical measure
+                LOG_TRACE("Evict all non-critical");
+                SqliteStatement deleteStmt(*m_db, "DELETE FROM " TABLE_NAME_EVENTS " WHERE persistence=1");
+                deleteStmt.execute();
+                eventsDropped = deleteStmt.changes();
             }
+            LOG_TRACE("Db resized, events dropped: %zu", eventsDropped);
         }
 
+        // Trimming is rare and already over the limit: give the pages back now
+        ReclaimFreePages(0);
         m_DbSizeEstimate = GetSize();
         DebugEvent evt(DebugEventType::EVT_DROPPED);
         evt.param1 = eventsDropped;
@@ -51,6 +51,7 @@ namespace MAT_NS_BEGIN {
         virtual size_t GetRecordCount(EventLatency latency) const override;
         virtual std::vector<StorageRecord> GetRecords(bool shutdown, EventLatency minLatency = EventLatency_Normal, unsigned maxCount = 0) override;
         virtual bool ResizeDb() override;
+        virtual size_t ReclaimFreePages(size_t maxPages) override;
 
     protected:
         bool initializeDatabase();
@@ -60,6 +61,10 @@ namespace MAT_NS_BEGIN {
             std::vector<std::string>::const_iterator const & begin,
             std::vector<std::string>::const_iterator const & end) const;
 
+        bool isValidRecord(StorageRecord const& record);
+        size_t insertRecordsUnsafe(std::vector<StorageRecord const*> const& records, size_t& bytesStored);
+        void checkSizeLimits();
+
         // Debug routine to print record count in the DB
         void printRecordCount();
 
@@ -90,10 +95,11 @@ namespace MAT_NS_BEGIN {
         size_t                      m_stmtCommitTransaction {};
         size_t                      m_stmtRollbackTransaction {};
         size_t                      m_stmtGetPageCount {};
+        size_t                      m_stmtGetFreePageCount {};
         size_t                      m_stmtGetRecordCount {};
         size_t                      m_stmtGetRecordCountBylatency {};
-        size_t                      m_stmtPerTenantTrimCount {};
-        size_t                      m_stmtTrimEvents_percent {};
+        size_t                      m_stmtSelectTrimSizes {};
+        size_t                      m_stmtTrimEvents_count {};
         size_t                      m_stmtDeleteEvents_ids {};
         size_t                      m_stmtReleaseExpiredEvents {};
         size_t                      m_stmtDeleteEvents_tenants {};
@@ -105,6 +111,7 @@ namespace MAT_NS_BEGIN {
         size_t                      m_stmtDeleteEventsRetried_maxRetryCount {};
         size_t                      m_stmtSelectEventsRetried_maxRetryCount {};
         size_t                      m_stmtInsertEvent_id_tenant_prio_ts_data {};
+        size_t                      m_stmtInsertEvents_batch {};
         size_t                      m_stmtInsertSetting_name_value {};
         size_t                      m_stmtDeleteSetting_name {};
         size_t                      m_stmtSelectSetting_name {};
@@ -114,6 +121,7 @@ namespace MAT_NS_BEGIN {
         uint64_t                    m_DbSizeNotificationInterval {};
         size_t                      m_DbSizeHeapLimit {};
         size_t                      m_DbSizeLimit {};
+        size_t                      m_vacuumPages {};
         std::atomic<size_t>         m_DbSizeEstimate {};
         uint64_t                    m_isStorageFullNotificationSendTime {};
 
@@ -122,6 +130,8 @@ namespace MAT_NS_BEGIN {
 
     private:
         size_t GetRecordCountUnsafe(EventLatency latency) const;
+        size_t GetFreePageCountUnsafe() const;
+        size_t trimUnsafe(size_t usedBytes);
     };
 
 
@@ -0,0 +1,1741 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "mat/config.h"
+#ifdef HAVE_MAT_STORAGE
+
+#include "OfflineStorage_Segment.hpp"
+#include "ILogManager.hpp"
+#include "utils/FileUtils.hpp"
+#include "utils/StringUtils.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace MAT_NS_BEGIN {
+
+    // File layouts, all integers little-endian:
+    //
+    //   segment   "MATSEG1\0", then records:
+    //             u32 body size, u32 CRC-32 of the body, body:
+    //             i64 timestamp, u8 latency, u8 persistence, u16 id size,
+    //             u16 tenant token size, u16 trace ID size, id, tenant token,
+    //             trace ID, blob
+    //   sidecar   24-byte entries: u8 op, 3 bytes zero, u32 record offset,
+    //             u64 segment, u32 value, u32 CRC-32 of the first 20 bytes
+    //   manifest  "MATSEGM1", u64 next segment, u32 count, count times
+    //             (u64 segment, u8 latency), u32 CRC-32 of everything before
+    //   settings  "MATSEGS1", u32 count, count times (u32 size, name,
+    //             u32 size, value), u32 CRC-32 of everything before
+
+    static const uint8_t kSegmentMagic[8]  = { 'M', 'A', 'T', 'S', 'E', 'G', '1', 0 };
+    static const uint8_t kManifestMagic[8] = { 'M', 'A', 'T', 'S', 'E', 'G', 'M', '1' };
+    static const uint8_t kSettingsMagic[8] = { 'M', 'A', 'T', 'S', 'E', 'G', 'S', '1' };
+
+    constexpr static size_t kRecordHeaderSize = 8;
+    constexpr static size_t kRecordFixedSize = 16;
+    constexpr static size_t kSidecarEntrySize = 24;
+
+    constexpr static uint8_t kSidecarDelete = 1;
+    constexpr static uint8_t kSidecarRetryCount = 2;
+
+    // Segments are sealed at an eighth of the size limit within these bounds,
+    // so that trimming can give back space a segment at a time
+    constexpr static size_t kMinSegmentBytes = 64 * 1024;
+    constexpr static size_t kMaxSegmentBytes = 4 * 1024 * 1024;
+
+    // The sidecar is rewritten once it holds this many entries and at least
+    // twice the entries still needed
+    constexpr static size_t kSidecarCompactEntries = 4096;
+
+    // Number of consecutive missing segments that ends the sweep for
+    // leftovers of a storage with a corrupt manifest
+    constexpr static uint64_t kSegmentSweepGap = 64;
+
+    static uint32_t Crc32(uint8_t const* data, size_t size)
+    {
+        static const std::array<uint32_t, 256> table = []() {
+            std::array<uint32_t, 256> result {};
+            for (uint32_t i = 0; i < 256; i++)
+            {
+                uint32_t crc = i;
+                for (int bit = 0; bit < 8; bit++)
+                {
+                    crc = (crc & 1) ? (0xEDB88320u ^ (crc >> 1)) : (crc >> 1);
+                }
+                result[i] = crc;
+            }
+            return result;
+        }();
+
+        uint32_t crc = 0xFFFFFFFFu;
+        for (size_t i = 0; i < size; i++)
+        {
+            crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        }
+        return crc ^ 0xFFFFFFFFu;
+    }
+
+    static void PutU16(std::vector<uint8_t>& out, uint16_t value)
+    {
+        out.push_back(static_cast<uint8_t>(value));
+        out.push_back(static_cast<uint8_t>(value >> 8));
+    }
+
+    static void PutU32(std::vector<uint8_t>& out, uint32_t value)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+
+    static void PutU64(std::vector<uint8_t>& out, uint64_t value)
+    {
+        for (int i = 0; i < 8; i++)
+        {
+            out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+
+    static void PutString(std::vector<uint8_t>& out, std::string const& value)
+    {
+        out.insert(out.end(), value.begin(), value.end());
+    }
+
+    static uint16_t GetU16(uint8_t const* data)
+    {
+        return static_cast<uint16_t>(data[0] | (data[1] << 8));
+    }
+
+    static uint32_t GetU32(uint8_t const* data)
+    {
+        uint32_t value = 0;
+        for (int i = 3; i >= 0; i--)
+        {
+            value = (value << 8) | data[i];
+        }
+        return value;
+    }
+
+    static uint64_t GetU64(uint8_t const* data)
+    {
+        uint64_t value = 0;
+        for (int i = 7; i >= 0; i--)
+        {
+            value = (value << 8) | data[i];
+        }
+        return value;
+    }
+
+    static bool ReadFile(std::string const& path, std::vector<uint8_t>& contents)
+    {
+        contents.clear();
+        std::FILE* file = FileOpen(path.c_str(), "rb");
+        if (file == nullptr)
+        {
+            return false;
+        }
+        uint8_t buffer[4096];
+        size_t read;
+        while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+        {
+            contents.insert(contents.end(), buffer, buffer + read);
+        }
+        bool ok = (std::ferror(file) == 0);
+        FileClose(file);
+        return ok;
+    }
+
+    /// <summary>
+    /// Writes the file next to its destination and moves it over, so that
+    /// readers find either the old or the new contents.
+    /// </summary>
+    static bool ReplaceFile(std::string const& path, std::vector<uint8_t> const& contents)
+    {
+        std::string tempPath = path + ".tmp";
+        std::FILE* file = FileOpen(tempPath.c_str(), "wb");
+        if (file == nullptr)
+        {
+            return false;
+        }
+        bool ok = (std::fwrite(contents.data(), 1, contents.size(), file) == contents.size());
+        ok = (FileClose(file) == 0) && ok;
+        if (!ok)
+        {
+            FileDelete(tempPath.c_str());
+            return false;
+        }
+#ifdef _WIN32
+        // rename() does not replace existing files on Windows
+        FileDelete(path.c_str());
+#endif
+        return std::rename(tempPath.c_str(), path.c_str()) == 0;
+    }
+
+    /// <summary>
+    /// One segment file: appended through a stdio stream while it is the
+    /// current segment of its latency, read through a memory mapping of the
+    /// whole file that grows as needed.
+    /// </summary>
+    class SegmentFile
+    {
+    public:
+        explicit SegmentFile(std::string path) :
+            m_path(std::move(path))
+        {
+        }
+
+        ~SegmentFile()
+        {
+            closeWriter();
+            unmap();
+#ifndef _WIN32
+            if (m_fd >= 0)
+            {
+                ::close(m_fd);
+            }
+#else
+            if (m_reader != nullptr)
+            {
+                FileClose(m_reader);
+            }
+#endif
+        }
+
+        SegmentFile(SegmentFile const&) = delete;
+        SegmentFile& operator=(SegmentFile const&) = delete;
+
+        std::string const& path() const
+        {
+            return m_path;
+        }
+
+        size_t size() const
+        {
+            return m_size;
+        }
+
+        /// <summary>
+        /// Creates an empty segment and keeps it open for appending.
+        /// </summary>
+        bool create()
+        {
+            m_writer = FileOpen(m_path.c_str(), "wb");
+            if (m_writer == nullptr)
+            {
+                return false;
+            }
+            m_size = 0;
+            return append(kSegmentMagic, sizeof(kSegmentMagic)) && flush();
+        }
+
+        /// <summary>
+        /// Opens an existing segment for reading.
+        /// </summary>
+        bool open()
+        {
+            if (!FileExists(m_path.c_str()))
+            {
+                return false;
+            }
+            m_size = FileGetSize(m_path.c_str());
+            uint8_t const* header = view(0, sizeof(kSegmentMagic));
+            return (header != nullptr) && (memcmp(header, kSegmentMagic, sizeof(kSegmentMagic)) == 0);
+        }
+
+        bool openWriter()
+        {
+            m_writer = FileOpen(m_path.c_str(), "ab");
+            return m_writer != nullptr;
+        }
+
+        void closeWriter()
+        {
+            if (m_writer != nullptr)
+            {
+                FileClose(m_writer);
+                m_writer = nullptr;
+            }
+        }
+
+        bool append(void const* data, size_t size)
+        {
+            if (m_writer == nullptr || std::fwrite(data, 1, size, m_writer) != size)
+            {
+                return false;
+            }
+            m_size += size;
+            return true;
+        }
+
+        bool flush()
+        {
+            return (m_writer == nullptr) || (std::fflush(m_writer) == 0);
+        }
+
+        bool sync()
+        {
+            if (m_writer == nullptr)
+            {
+                return true;
+            }
+            if (std::fflush(m_writer) != 0)
+            {
+                return false;
+            }
+#ifdef _WIN32
+            return _commit(_fileno(m_writer)) == 0;
+#else
+            return ::fsync(fileno(m_writer)) == 0;
+#endif
+        }
+
+        /// <summary>
+        /// Bytes [offset, offset + size) of the file, valid until the next call.
+        /// </summary>
+        uint8_t const* view(size_t offset, size_t size)
+        {
+            if (size == 0 || offset > m_size || size > m_size - offset)
+            {
+                return nullptr;
+            }
+#ifndef _WIN32
+            if (offset + size > m_mapSize)
+            {
+                unmap();
+                if (m_fd < 0)
+                {
+                    m_fd = ::open(m_path.c_str(), O_RDONLY);
+                    if (m_fd < 0)
+                    {
+                        return nullptr;
+                    }
+                }
+                void* map = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, m_fd, 0);
+                if (map == MAP_FAILED)
+                {
+                    return nullptr;
+                }
+                m_map = map;
+                m_mapSize = m_size;
+            }
+            return static_cast<uint8_t const*>(m_map) + offset;
+#else
+            if (m_reader == nullptr)
+            {
+                m_reader = FileOpen(m_path.c_str(), "rb");
+                if (m_reader == nullptr)
+                {
+                    return nullptr;
+                }
+            }
+            m_buffer.resize(size);
+            if (_fseeki64(m_reader, static_cast<int64_t>(offset), SEEK_SET) != 0
+                || std::fread(m_buffer.data(), 1, size, m_reader) != size)
+            {
+                return nullptr;
+            }
+            return m_buffer.data();
+#endif
+        }
+
+    private:
+        void unmap()
+        {
+#ifndef _WIN32
+            if (m_map != nullptr)
+            {
+                ::munmap(m_map, m_mapSize);
+                m_map = nullptr;
+                m_mapSize = 0;
+            }
+#endif
+        }
+
+        std::string m_path;
+        std::FILE*  m_writer {};
+        size_t      m_size {};
+#ifndef _WIN32
+        int         m_fd { -1 };
+        void*       m_map {};
+        size_t      m_mapSize {};
+#else
+        std::FILE*  m_reader {};
+        std::vector<uint8_t> m_buffer;
+#endif
+    };
+
+    MATSDK_LOG_INST_COMPONENT_CLASS(OfflineStorage_Segment, "EventsSDK.Storage", "Events telemetry client - OfflineStorage_Segment class")
+
+    OfflineStorage_Segment::OfflineStorage_Segment(ILogManager& logManager, IRuntimeConfig& runtimeConfig)
+        : m_config(runtimeConfig)
+        , m_logManager(logManager)
+    {
+        uint32_t percentage = m_config[CFG_INT_STORAGE_FULL_PCT];
+        m_DbSizeLimit = m_config.GetOfflineStorageMaximumSizeBytes();
+        const char* cacheFilePath = m_config[CFG_STR_CACHE_FILE_PATH];
+        m_basePath = (cacheFilePath != nullptr) ? cacheFilePath : "";
+
+        if ((percentage == 0) || (percentage > 100))
+        {
+            percentage = DB_FULL_NOTIFICATION_DEFAULT_PERCENTAGE; // 75%
+        }
+        m_DbSizeNotificationLimit = (percentage * m_DbSizeLimit) / 100;
+        m_DbSizeNotificationInterval = m_config[CFG_INT_STORAGE_FULL_CHECK_TIME];
+
+        m_segmentLimit = (m_DbSizeLimit == 0) ? kMaxSegmentBytes
+            : std::min(std::max(m_DbSizeLimit / 8, kMinSegmentBytes), kMaxSegmentBytes);
+    }
+
+    OfflineStorage_Segment::~OfflineStorage_Segment()
+    {
+        closeUnsafe();
+    }
+
+    std::string OfflineStorage_Segment::segmentPath(uint64_t seq) const
+    {
+        char name[24];
+        snprintf(name, sizeof(name), ".seg.%016llx", static_cast<unsigned long long>(seq));
+        return m_basePath + name;
+    }
+
+    void OfflineStorage_Segment::Initialize(IOfflineStorageObserver& observer)
+    {
+        m_observer = &observer;
+
+        LOCKGUARD(m_lock);
+        LOG_TRACE("Initializing offline storage: %s", m_basePath.c_str());
+        auto startTime = GetUptimeMs();
+        if (!m_basePath.empty() && openUnsafe())
+        {
+            m_isOpened = true;
+            m_observer->OnStorageOpened("Segment/Default");
+            LOG_INFO("Storage opened in %lld ms with %zu records in %zu segments",
+                GetUptimeMs() - startTime, m_entries.size(), m_segments.size());
+            return;
+        }
+
+        m_observer->OnStorageFailed("Storage is corrupt");
+        removeAllFilesUnsafe();
+        if (!m_basePath.empty() && writeManifest())
+        {
+            m_sidecar = FileOpen((m_basePath + ".seg.acks").c_str(), "wb");
+            if (m_sidecar != nullptr)
+            {
+                m_isOpened = true;
+                m_observer->OnStorageOpened("Segment/Clean");
+                LOG_INFO("Using new segment storage after dropping the existing one");
+                return;
+            }
+        }
+
+        LOG_ERROR("No segment storage could be opened");
+        m_observer->OnStorageOpened("Segment/None");
+    }
+
+    void OfflineStorage_Segment::Shutdown()
+    {
+        LOG_TRACE("Shutting down offline storage %s", m_basePath.c_str());
+        LOCKGUARD(m_lock);
+        Flush();
+        closeUnsafe();
+        m_isOpened = false;
+    }
+
+    void OfflineStorage_Segment::Flush()
+    {
+        LOCKGUARD(m_lock);
+        for (uint64_t seq : m_active)
+        {
+            if (seq != 0)
+            {
+                m_segments[seq].file->sync();
+            }
+        }
+        if (m_sidecar != nullptr)
+        {
+            std::fflush(m_sidecar);
+#ifdef _WIN32
+            _commit(_fileno(m_sidecar));
+#else
+            ::fsync(fileno(m_sidecar));
+#endif
+        }
+    }
+
+    bool OfflineStorage_Segment::openUnsafe()
+    {
+        if (!loadManifest())
+        {
+            LOG_WARN("Segment manifest is corrupt");
+            return false;
+        }
+
+        // Segments listed in the manifest but gone from the disk are dropped
+        bool missing = false;
+        for (auto it = m_segments.begin(); it != m_segments.end();)
+        {
+            if (!it->second.file->open())
+            {
+                LOG_WARN("Segment %s is missing or corrupt", it->second.file->path().c_str());
+                FileDelete(it->second.file->path().c_str());
+                it = m_segments.erase(it);
+                missing = true;
+                continue;
+            }
+            replaySegment(it->first, it->second);
+            ++it;
+        }
+        if (missing && !writeManifest())
+        {
+            return false;
+        }
+
+        // Appends continue in the newest segment of each latency
+        for (auto& segment : m_segments)
+        {
+            int latency = segment.second.latency;
+            if (m_active[latency] != 0)
+            {
+                m_segments[m_active[latency]].sealed = true;
+            }
+            m_active[latency] = segment.first;
+        }
+        for (uint64_t& seq : m_active)
+        {
+            if (seq == 0)
+            {
+                continue;
+            }
+            Segment& segment = m_segments[seq];
+            if (segment.sealed || segment.file->size() >= m_segmentLimit || !segment.file->openWriter())
+            {
+                segment.sealed = true;
+                seq = 0;
+            }
+        }
+
+        replaySidecar();
+        loadSettings();
+        if (m_sidecar == nullptr)
+        {
+            m_sidecar = FileOpen((m_basePath + ".seg.acks").c_str(), "ab");
+            if (m_sidecar == nullptr)
+            {
+                return false;
+            }
+        }
+        reclaimUnsafe(false);
+        flushWritersUnsafe();
+        return true;
+    }
+
+    void OfflineStorage_Segment::closeUnsafe()
+    {
+        if (m_sidecar != nullptr)
+        {
+            FileClose(m_sidecar);
+            m_sidecar = nullptr;
+        }
+        m_sidecarEntries = 0;
+        m_segments.clear();
+        std::fill(std::begin(m_active), std::end(m_active), 0);
+        std::fill(std::begin(m_counts), std::end(m_counts), 0);
+        m_entries.clear();
+        m_order.clear();
+        m_ids.clear();
+        m_reserved.clear();
+        m_settings.clear();
+    }
+
+    void OfflineStorage_Segment::removeAllFilesUnsafe()
+    {
+        closeUnsafe();
+        // Without a trustworthy manifest, sweep the numbers segments would
+        // have had until a long enough run of them is missing
+        for (uint64_t seq = 1, missing = 0; missing < kSegmentSweepGap; seq++)
+        {
+            missing = (FileDelete(segmentPath(seq).c_str()) == 0) ? 0 : missing + 1;
+        }
+        m_nextSeq = 1;
+        for (char const* suffix : { ".seg", ".seg.acks", ".seg.settings" })
+        {
+            FileDelete((m_basePath + suffix).c_str());
+        }
+    }
+
+    bool OfflineStorage_Segment::loadManifest()
+    {
+        std::vector<uint8_t> contents;
+        std::string path = m_basePath + ".seg";
+        if (!FileExists(path.c_str()))
+        {
+            // Fresh storage
+            return writeManifest();
+        }
+        if (!ReadFile(path, contents) || contents.size() < sizeof(kManifestMagic) + 16
+            || memcmp(contents.data(), kManifestMagic, sizeof(kManifestMagic)) != 0
+            || Crc32(contents.data(), contents.size() - 4) != GetU32(contents.data() + contents.size() - 4))
+        {
+            return false;
+        }
+
+        uint8_t const* data = contents.data() + sizeof(kManifestMagic);
+        m_nextSeq = GetU64(data);
+        uint32_t count = GetU32(data + 8);
+        data += 12;
+        if (contents.size() != sizeof(kManifestMagic) + 16 + count * size_t(9))
+        {
+            return false;
+        }
+        for (uint32_t i = 0; i < count; i++, data += 9)
+        {
+            uint64_t seq = GetU64(data);
+            if (seq >= m_nextSeq || data[8] > EventLatency_Max)
+            {
+                return false;
+            }
+            Segment& segment = m_segments[seq];
+            segment.file.reset(new SegmentFile(segmentPath(seq)));
+            segment.latency = static_cast<EventLatency>(data[8]);
+        }
+        return true;
+    }
+
+    bool OfflineStorage_Segment::writeManifest()
+    {
+        std::vector<uint8_t> contents(kManifestMagic, kManifestMagic + sizeof(kManifestMagic));
+        PutU64(contents, m_nextSeq);
+        PutU32(contents, static_cast<uint32_t>(m_segments.size()));
+        for (auto const& segment : m_segments)
+        {
+            PutU64(contents, segment.first);
+            contents.push_back(static_cast<uint8_t>(segment.second.latency));
+        }
+        PutU32(contents, Crc32(contents.data(), contents.size()));
+        if (!ReplaceFile(m_basePath + ".seg", contents))
+        {
+            LOG_ERROR("Failed to write segment manifest");
+            return false;
+        }
+        return true;
+    }
+
+    void OfflineStorage_Segment::replaySegment(uint64_t seq, Segment& segment)
+    {
+        SegmentFile& file = *segment.file;
+        size_t offset = sizeof(kSegmentMagic);
+        while (file.size() - offset >= kRecordHeaderSize)
+        {
+            uint8_t const* header = file.view(offset, kRecordHeaderSize);
+            if (header == nullptr)
+            {
+                break;
+            }
+            uint32_t bodySize = GetU32(header);
+            uint32_t crc = GetU32(header + 4);
+            if (bodySize < kRecordFixedSize || bodySize > file.size() - offset - kRecordHeaderSize || offset > UINT32_MAX)
+            {
+                break;
+            }
+            uint8_t const* body = file.view(offset + kRecordHeaderSize, bodySize);
+            if (body == nullptr || Crc32(body, bodySize) != crc)
+            {
+                break;
+            }
+
+            uint16_t idSize = GetU16(body + 10);
+            uint16_t tenantSize = GetU16(body + 12);
+            uint16_t traceIdSize = GetU16(body + 14);
+            if (kRecordFixedSize + idSize + tenantSize + traceIdSize > bodySize || body[8] > EventLatency_Max)
+            {
+                break;
+            }
+            Entry entry;
+            entry.timestamp = static_cast<int64_t>(GetU64(body));
+            entry.latency = static_cast<EventLatency>(body[8]);
+            entry.persistence = static_cast<EventPersistence>(body[9]);
+            char const* strings = reinterpret_cast<char const*>(body + kRecordFixedSize);
+            entry.id.assign(strings, idSize);
+            entry.tenantToken.assign(strings + idSize, tenantSize);
+#ifdef HAVE_MAT_EVT_TRACEID
+            entry.traceId.assign(strings + idSize + tenantSize, traceIdSize);
+#endif
+            entry.size = static_cast<uint32_t>(kRecordHeaderSize + bodySize);
+            addEntryUnsafe(RecordLocation(seq, static_cast<uint32_t>(offset)), std::move(entry));
+            offset += kRecordHeaderSize + bodySize;
+        }
+
+        if (offset != file.size())
+        {
+            // Torn or corrupt tail: keep what came before it and append elsewhere
+            LOG_WARN("Segment %s is damaged after %zu of %zu bytes", file.path().c_str(), offset, file.size());
+            segment.sealed = true;
+        }
+    }
+
+    void OfflineStorage_Segment::replaySidecar()
+    {
+        std::vector<uint8_t> contents;
+        std::string path = m_basePath + ".seg.acks";
+        if (!FileExists(path.c_str()) || !ReadFile(path, contents))
+        {
+            m_sidecarEntries = 0;
+            m_sidecar = FileOpen(path.c_str(), "wb");
+            return;
+        }
+
+        size_t valid = 0;
+        for (; (valid + 1) * kSidecarEntrySize <= contents.size(); valid++)
+        {
+            uint8_t const* data = contents.data() + valid * kSidecarEntrySize;
+            if (Crc32(data, 20) != GetU32(data + 20))
+            {
+                break;
+            }
+            RecordLocation location(GetU64(data + 8), GetU32(data + 4));
+            auto it = m_entries.find(location);
+            if (it == m_entries.end())
+            {
+                continue;
+            }
+            if (data[0] == kSidecarDelete)
+            {
+                removeEntryUnsafe(location, false);
+            }
+            else if (data[0] == kSidecarRetryCount)
+            {
+                it->second.retryCount = static_cast<int>(GetU32(data + 16));
+            }
+        }
+        m_sidecarEntries = valid;
+
+        if (valid * kSidecarEntrySize != contents.size())
+        {
+            // Later entries would land behind the damaged one: start over
+            LOG_WARN("Sidecar %s is damaged after %zu entries", path.c_str(), valid);
+            compactSidecarUnsafe(true);
+        }
+    }
+
+    void OfflineStorage_Segment::loadSettings()
+    {
+        std::vector<uint8_t> contents;
+        std::string path = m_basePath + ".seg.settings";
+        if (!FileExists(path.c_str()) || !ReadFile(path, contents))
+        {
+            return;
+        }
+        if (contents.size() < sizeof(kSettingsMagic) + 8
+            || memcmp(contents.data(), kSettingsMagic, sizeof(kSettingsMagic)) != 0
+            || Crc32(contents.data(), contents.size() - 4) != GetU32(contents.data() + contents.size() - 4))
+        {
+            LOG_WARN("Settings %s are corrupt", path.c_str());
+            return;
+        }
+
+        size_t offset = sizeof(kSettingsMagic);
+        size_t end = contents.size() - 4;
+        uint32_t count = GetU32(contents.data() + offset);
+        offset += 4;
+        std::map<std::string, std::string> settings;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            std::string parts[2];
+            for (auto& part : parts)
+            {
+                if (end - offset < 4)
+                {
+                    return;
+                }
+                uint32_t size = GetU32(contents.data() + offset);
+                offset += 4;
+                if (end - offset < size)
+                {
+                    return;
+                }
+                part.assign(reinterpret_cast<char const*>(contents.data() + offset), size);
+                offset += size;
+            }
+            settings[parts[0]] = parts[1];
+        }
+        m_settings.swap(settings);
+    }
+
+    bool OfflineStorage_Segment::saveSettings()
+    {
+        std::vector<uint8_t> contents(kSettingsMagic, kSettingsMagic + sizeof(kSettingsMagic));
+        PutU32(contents, static_cast<uint32_t>(m_settings.size()));
+        for (auto const& setting : m_settings)
+        {
+            PutU32(contents, static_cast<uint32_t>(setting.first.size()));
+            PutString(contents, setting.first);
+            PutU32(contents, static_cast<uint32_t>(setting.second.size()));
+            PutString(contents, setting.second);
+        }
+        PutU32(contents, Crc32(contents.data(), contents.size()));
+        return ReplaceFile(m_basePath + ".seg.settings", contents);
+    }
+
+    bool OfflineStorage_Segment::isValidRecord(StorageRecord const& record)
+    {
+        if (record.id.empty() || record.tenantToken.empty() || static_cast<int>(record.latency) < 0 || record.timestamp <= 0
+            || record.id.size() > UINT16_MAX || record.tenantToken.size() > UINT16_MAX) {
+            LOG_ERROR("Failed to store event %s:%s: Invalid parameters",
+                tenantTokenToId(record.tenantToken).c_str(), record.id.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    OfflineStorage_Segment::Segment* OfflineStorage_Segment::activeSegment(EventLatency latency, size_t recordSize)
+    {
+        uint64_t seq = m_active[latency];
+        if (seq != 0)
+        {
+            Segment& segment = m_segments[seq];
+            if (segment.file->size() + recordSize <= m_segmentLimit || segment.file->size() <= sizeof(kSegmentMagic))
+            {
+                return &segment;
+            }
+            sealUnsafe(seq);
+        }
+
+        seq = m_nextSeq++;
+        Segment& segment = m_segments[seq];
+        segment.file.reset(new SegmentFile(segmentPath(seq)));
+        segment.latency = latency;
+        // The manifest lists the segment before the first record goes in
+        if (!segment.file->create() || !writeManifest())
+        {
+            LOG_ERROR("Failed to create segment %s", segment.file->path().c_str());
+            std::string path = segment.file->path();
+            m_segments.erase(seq);
+            FileDelete(path.c_str());
+            return nullptr;
+        }
+        m_active[latency] = seq;
+        return &segment;
+    }
+
+    void OfflineStorage_Segment::sealUnsafe(uint64_t seq)
+    {
+        Segment& segment = m_segments[seq];
+        segment.file->flush();
+        segment.file->closeWriter();
+        segment.sealed = true;
+        if (m_active[segment.latency] == seq)
+        {
+            m_active[segment.latency] = 0;
+        }
+    }
+
+    bool OfflineStorage_Segment::appendUnsafe(StorageRecord const& record, size_t& bytesStored)
+    {
+        EventLatency latency = (record.latency > EventLatency_Max) ? EventLatency_Normal : record.latency;
+        std::string traceId;
+#ifdef HAVE_MAT_EVT_TRACEID
+        traceId = record.traceId.substr(0, UINT16_MAX);
+#endif
+
+        std::vector<uint8_t> data;
+        data.reserve(kRecordHeaderSize + kRecordFixedSize + record.id.size() + record.tenantToken.size() + traceId.size() + record.blob.size());
+        data.resize(kRecordHeaderSize);
+        PutU64(data, static_cast<uint64_t>(record.timestamp));
+        data.push_back(static_cast<uint8_t>(latency));
+        data.push_back(static_cast<uint8_t>(record.persistence));
+        PutU16(data, static_cast<uint16_t>(record.id.size()));
+        PutU16(data, static_cast<uint16_t>(record.tenantToken.size()));
+        PutU16(data, static_cast<uint16_t>(traceId.size()));
+        PutString(data, record.id);
+        PutString(data, record.tenantToken);
+        PutString(data, traceId);
+        data.insert(data.end(), record.blob.begin(), record.blob.end());
+        uint32_t bodySize = static_cast<uint32_t>(data.size() - kRecordHeaderSize);
+        uint32_t crc = Crc32(data.data() + kRecordHeaderSize, bodySize);
+        for (int i = 0; i < 4; i++)
+        {
+            data[i] = static_cast<uint8_t>(bodySize >> (8 * i));
+            data[4 + i] = static_cast<uint8_t>(crc >> (8 * i));
+        }
+
+        // Same ID again replaces the record
+        auto existing = m_ids.find(record.id);
+        if (existing != m_ids.end())
+        {
+            removeEntryUnsafe(existing->second, true);
+        }
+
+        Segment* segment = activeSegment(latency, data.size());
+        if (segment == nullptr)
+        {
+            return false;
+        }
+        uint64_t seq = m_active[latency];
+        size_t offset = segment->file->size();
+        if (!segment->file->append(data.data(), data.size()))
+        {
+            LOG_ERROR("Failed to append to segment %s", segment->file->path().c_str());
+            // Whatever made it to the file ends the segment on replay
+            sealUnsafe(seq);
+            return false;
+        }
+
+        Entry entry;
+        entry.id = record.id;
+        entry.tenantToken = record.tenantToken;
+        entry.latency = latency;
+        entry.persistence = record.persistence;
+        entry.timestamp = record.timestamp;
+#ifdef HAVE_MAT_EVT_TRACEID
+        entry.traceId = traceId;
+#endif
+        entry.size = static_cast<uint32_t>(data.size());
+        addEntryUnsafe(RecordLocation(seq, static_cast<uint32_t>(offset)), std::move(entry));
+        bytesStored += data.size();
+        return true;
+    }
+
+    void OfflineStorage_Segment::addEntryUnsafe(RecordLocation const& location, Entry&& entry)
+    {
+        auto existing = m_ids.find(entry.id);
+        if (existing != m_ids.end())
+        {
+            // Replayed segments: the later copy wins
+            removeEntryUnsafe(existing->second, false);
+        }
+
+        Segment& segment = m_segments[location.first];
+        segment.liveCount++;
+        segment.liveBytes += entry.size;
+        m_counts[entry.latency]++;
+        m_order.insert(OrderKey { entry.latency, entry.persistence, entry.timestamp, location });
+        m_ids[entry.id] = location;
+        if (entry.reservedUntil != 0)
+        {
+            m_reserved.insert(location);
+        }
+        m_entries[location] = std::move(entry);
+    }
+
+    void OfflineStorage_Segment::removeEntryUnsafe(RecordLocation const& location, bool logDelete)
+    {
+        auto it = m_entries.find(location);
+        if (it == m_entries.end())
+        {
+            return;
+        }
+        Entry const& entry = it->second;
+        if (logDelete)
+        {
+            writeSidecar(kSidecarDelete, location, 0);
+        }
+        m_order.erase(OrderKey { entry.latency, entry.persistence, entry.timestamp, location });
+        auto id = m_ids.find(entry.id);
+        if (id != m_ids.end() && id->second == location)
+        {
+            m_ids.erase(id);
+        }
+        m_reserved.erase(location);
+        m_counts[entry.latency]--;
+        auto segment = m_segments.find(location.first);
+        if (segment != m_segments.end())
+        {
+            segment->second.liveCount--;
+            segment->second.liveBytes -= entry.size;
+            segment->second.deleted.push_back(location.second);
+        }
+        m_entries.erase(it);
+    }
+
+    void OfflineStorage_Segment::setRetryCountUnsafe(RecordLocation const& location, Entry& entry, int retryCount)
+    {
+        entry.retryCount = retryCount;
+        writeSidecar(kSidecarRetryCount, location, static_cast<uint32_t>(retryCount));
+    }
+
+    bool OfflineStorage_Segment::writeSidecar(uint8_t op, RecordLocation const& location, uint32_t value)
+    {
+        if (m_sidecar == nullptr)
+        {
+            return false;
+        }
+        std::vector<uint8_t> data;
+        data.reserve(kSidecarEntrySize);
+        data.push_back(op);
+        data.insert(data.end(), 3, 0);
+        PutU32(data, location.second);
+        PutU64(data, location.first);
+        PutU32(data, value);
+        PutU32(data, Crc32(data.data(), data.size()));
+        if (std::fwrite(data.data(), 1, data.size(), m_sidecar) != data.size())
+        {
+            LOG_ERROR("Failed to append to the segment sidecar");
+            return false;
+        }
+        m_sidecarEntries++;
+        return true;
+    }
+
+    bool OfflineStorage_Segment::readRecord(RecordLocation const& location, Entry const& entry, StorageRecord& record)
+    {
+        auto segment = m_segments.find(location.first);
+        if (segment == m_segments.end())
+        {
+            return false;
+        }
+        uint8_t const* data = segment->second.file->view(location.second, entry.size);
+        if (data == nullptr)
+        {
+            return false;
+        }
+        uint8_t const* body = data + kRecordHeaderSize;
+        size_t blobOffset = kRecordHeaderSize + kRecordFixedSize + GetU16(body + 10) + GetU16(body + 12) + GetU16(body + 14);
+
+        record.id = entry.id;
+        record.tenantToken = entry.tenantToken;
+        record.latency = entry.latency;
+        record.persistence = entry.persistence;
+        record.timestamp = entry.timestamp;
+        record.retryCount = entry.retryCount;
+        record.reservedUntil = entry.reservedUntil;
+#ifdef HAVE_MAT_EVT_TRACEID
+        record.traceId = entry.traceId;
+#endif
+        record.blob.assign(data + blobOffset, data + entry.size);
+        return true;
+    }
+
+    void OfflineStorage_Segment::flushWritersUnsafe()
+    {
+        for (uint64_t seq : m_active)
+        {
+            if (seq != 0)
+            {
+                m_segments[seq].file->flush();
+            }
+        }
+        if (m_sidecar != nullptr)
+        {
+            std::fflush(m_sidecar);
+        }
+    }
+
+    void OfflineStorage_Segment::reclaimUnsafe(bool all)
+    {
+        // Copy the live records out of mostly dead segments, one per call
+        // unless space is needed right away
+        std::vector<uint64_t> sparse;
+        for (auto const& segment : m_segments)
+        {
+            if (segment.second.sealed && segment.second.liveCount != 0 && segment.second.liveBytes * 4 < segment.second.file->size())
+            {
+                sparse.push_back(segment.first);
+            }
+        }
+        for (uint64_t seq : sparse)
+        {
+            if (!compactSegmentUnsafe(seq) || !all)
+            {
+                break;
+            }
+        }
+
+        std::vector<std::string> dead;
+        for (auto it = m_segments.begin(); it != m_segments.end();)
+        {
+            if (it->second.sealed && it->second.liveCount == 0)
+            {
+                dead.push_back(it->second.file->path());
+                it = m_segments.erase(it);
+                continue;
+            }
+            ++it;
+        }
+        if (!dead.empty())
+        {
+            // Delete the files only once the manifest no longer lists them
+            flushWritersUnsafe();
+            if (writeManifest())
+            {
+                for (auto const& path : dead)
+                {
+                    FileDelete(path.c_str());
+                }
+            }
+        }
+
+        if (m_sidecarEntries > kSidecarCompactEntries)
+        {
+            compactSidecarUnsafe(false);
+        }
+    }
+
+    bool OfflineStorage_Segment::compactSegmentUnsafe(uint64_t seq)
+    {
+        std::vector<RecordLocation> live;
+        for (auto it = m_entries.lower_bound(RecordLocation(seq, 0)); it != m_entries.end() && it->first.first == seq; ++it)
+        {
+            live.push_back(it->first);
+        }
+
+        std::vector<uint8_t> data;
+        for (auto const& location : live)
+        {
+            Entry entry = m_entries[location];
+            uint8_t const* source = m_segments[seq].file->view(location.second, entry.size);
+            if (source == nullptr)
+            {
+                return false;
+            }
+            data.assign(source, source + entry.size);
+
+            Segment* target = activeSegment(entry.latency, data.size());
+            if (target == nullptr)
+            {
+                return false;
+            }
+            RecordLocation copy(m_active[entry.latency], static_cast<uint32_t>(target->file->size()));
+            if (!target->file->append(data.data(), data.size()))
+            {
+                sealUnsafe(copy.first);
+                return false;
+            }
+            // The copy sits in a newer segment, so it wins on replay until
+            // the old segment is gone
+            removeEntryUnsafe(location, false);
+            int retryCount = entry.retryCount;
+            addEntryUnsafe(copy, std::move(entry));
+            if (retryCount != 0)
+            {
+                writeSidecar(kSidecarRetryCount, copy, static_cast<uint32_t>(retryCount));
+            }
+        }
+        LOG_TRACE("Compacted %zu records out of segment %llu", live.size(), static_cast<unsigned long long>(seq));
+        return true;
+    }
+
+    void OfflineStorage_Segment::compactSidecarUnsafe(bool force)
+    {
+        std::vector<uint8_t> contents;
+        size_t entries = 0;
+        auto add = [&](uint8_t op, RecordLocation const& location, uint32_t value) {
+            size_t start = contents.size();
+            contents.push_back(op);
+            contents.insert(contents.end(), 3, 0);
+            PutU32(contents, location.second);
+            PutU64(contents, location.first);
+            PutU32(contents, value);
+            PutU32(contents, Crc32(contents.data() + start, 20));
+            entries++;
+        };
+        for (auto const& segment : m_segments)
+        {
+            for (uint32_t offset : segment.second.deleted)
+            {
+                add(kSidecarDelete, RecordLocation(segment.first, offset), 0);
+            }
+        }
+        for (auto const& entry : m_entries)
+        {
+            if (entry.second.retryCount != 0)
+            {
+                add(kSidecarRetryCount, entry.first, static_cast<uint32_t>(entry.second.retryCount));
+            }
+        }
+        if (!force && m_sidecarEntries <= 2 * entries)
+        {
+            return;
+        }
+
+        std::string path = m_basePath + ".seg.acks";
+        if (m_sidecar != nullptr)
+        {
+            FileClose(m_sidecar);
+            m_sidecar = nullptr;
+        }
+        if (ReplaceFile(path, contents))
+        {
+            m_sidecarEntries = entries;
+        }
+        m_sidecar = FileOpen(path.c_str(), "ab");
+    }
+
+    size_t OfflineStorage_Segment::getSizeUnsafe() const
+    {
+        size_t size = m_sidecarEntries * kSidecarEntrySize;
+        for (auto const& segment : m_segments)
+        {
+            size += segment.second.file->size();
+        }
+        return size;
+    }
+
+    bool OfflineStorage_Segment::StoreRecord(StorageRecord const& record)
+    {
+        if (!isValidRecord(record)) {
+            m_observer->OnStorageFailed("Invalid parameters");
+            return false;
+        }
+
+        {
+            LOCKGUARD(m_lock);
+            if (!m_isOpened) {
+                LOG_ERROR("Failed to store event %s:%s: Storage is not open",
+                    tenantTokenToId(record.tenantToken).c_str(), record.id.c_str());
+                m_observer->OnStorageOpenFailed("Storage is not open");
+                return false;
+            }
+            size_t bytesStored = 0;
+            bool stored = appendUnsafe(record, bytesStored);
+            flushWritersUnsafe();
+            if (!stored) {
+                m_observer->OnStorageFailed("Write error");
+                return false;
+            }
+        }
+
+        checkSizeLimits();
+        return true;
+    }
+
+    size_t OfflineStorage_Segment::StoreRecords(std::vector<StorageRecord> & records)
+    {
+        if (records.empty()) {
+            return 0;
+        }
+
+        size_t stored = 0;
+        size_t invalidCount = 0;
+        {
+            LOCKGUARD(m_lock);
+            if (!m_isOpened) {
+                LOG_ERROR("Failed to store %zu events: Storage is not open", records.size());
+                m_observer->OnStorageOpenFailed("Storage is not open");
+                return 0;
+            }
+            size_t bytesStored = 0;
+            for (auto const& record : records) {
+                if (!isValidRecord(record)) {
+                    invalidCount++;
+                }
+                else if (appendUnsafe(record, bytesStored)) {
+                    stored++;
+                }
+            }
+            // One write to the OS for the whole batch
+            flushWritersUnsafe();
+        }
+
+        const size_t failed = records.size() - stored;
+        if (failed > 0)
+        {
+            LOG_ERROR("Stored %zu of %zu events: %zu invalid, %zu failed to write",
+                stored, records.size(), invalidCount, failed - invalidCount);
+            m_observer->OnStorageFailed((failed == invalidCount) ? "Invalid parameters" : "Write error");
+        }
+
+        if (stored > 0)
+        {
+            checkSizeLimits();
+        }
+        return stored;
+    }
+
+    void OfflineStorage_Segment::checkSizeLimits()
+    {
+        size_t size = GetSize();
+        if ((m_DbSizeNotificationLimit != 0) && (size > m_DbSizeNotificationLimit))
+        {
+            auto now = PAL::getMonotonicTimeMs();
+            if (static_cast<uint64_t>(now - m_isStorageFullNotificationSendTime) > m_DbSizeNotificationInterval)
+            {
+                // Notify the client that the storage is getting full, but only once in DB_FULL_CHECK_TIME_MS
+                m_isStorageFullNotificationSendTime = now;
+                DebugEvent evt;
+                evt.type = DebugEventType::EVT_STORAGE_FULL;
+                evt.param1 = (100 * size) / m_DbSizeLimit;
+                m_logManager.DispatchEvent(evt);
+            }
+        }
+
+        if ((m_DbSizeLimit != 0) && (size > m_DbSizeLimit) && m_config[CFG_BOOL_ENABLE_DB_DROP_IF_FULL])
+        {
+            ResizeDb();
+        }
+    }
+
+    bool OfflineStorage_Segment::GetAndReserveRecords(std::function<bool(StorageRecord&&)> const& consumer, unsigned leaseTimeMs, EventLatency minLatency, unsigned maxCount)
+    {
+        m_lastReadCount = 0;
+
+        LOCKGUARD(m_lock);
+        if (!m_isOpened) {
+            LOG_ERROR("Failed to retrieve events to send: Storage is not open");
+            return false;
+        }
+
+        LOG_TRACE("Retrieving max. %u%s events of latency at least %d (%s)",
+            maxCount, (maxCount > 0) ? "" : " (unlimited)", minLatency, latencyToStr(static_cast<EventLatency>(minLatency)));
+
+        int64_t now = PAL::getUtcSystemTimeMs();
+        std::vector<RecordLocation> expired;
+        for (auto const& location : m_reserved)
+        {
+            if (m_entries[location].reservedUntil <= now)
+            {
+                expired.push_back(location);
+            }
+        }
+        for (auto const& location : expired)
+        {
+            Entry& entry = m_entries[location];
+            entry.reservedUntil = 0;
+            m_reserved.erase(location);
+            setRetryCountUnsafe(location, entry, entry.retryCount + 1);
+        }
+        if (!expired.empty()) {
+            LOG_TRACE("Released %zu expired reserved events", expired.size());
+        }
+
+        unsigned consumed = 0;
+        for (auto const& key : m_order)
+        {
+            if (key.latency < minLatency || (maxCount > 0 && consumed >= maxCount))
+            {
+                break;
+            }
+            Entry& entry = m_entries[key.location];
+            if (entry.reservedUntil != 0)
+            {
+                continue;
+            }
+            StorageRecord record;
+            if (!readRecord(key.location, entry, record))
+            {
+                LOG_ERROR("Failed to read event %s from its segment", entry.id.c_str());
+                continue;
+            }
+            if (!consumer(std::move(record)))
+            {
+                break;
+            }
+            entry.reservedUntil = now + leaseTimeMs;
+            m_reserved.insert(key.location);
+            consumed++;
+        }
+        flushWritersUnsafe();
+
+        if (consumed == 0) {
+            return false;
+        }
+        LOG_TRACE("Reserved %u event(s) for %u milliseconds", consumed, leaseTimeMs);
+        m_lastReadCount = consumed;
+        return true;
+    }
+
+    bool OfflineStorage_Segment::IsLastReadFromMemory()
+    {
+        return false;
+    }
+
+    unsigned OfflineStorage_Segment::LastReadRecordCount()
+    {
+        return m_lastReadCount;
+    }
+
+    std::vector<StorageRecord> OfflineStorage_Segment::GetRecords(bool shutdown, EventLatency minLatency, unsigned maxCount)
+    {
+        std::vector<StorageRecord> records;
+        LOCKGUARD(m_lock);
+        if (!m_isOpened) {
+            return records;
+        }
+
+        // Outside of shutdown: only unreserved records of the lowest latency found
+        int latency = EventLatency_Unspecified;
+        if (!shutdown)
+        {
+            for (auto it = m_order.rbegin(); it != m_order.rend() && latency == EventLatency_Unspecified; ++it)
+            {
+                if (it->latency >= minLatency && m_entries[it->location].reservedUntil == 0)
+                {
+                    latency = it->latency;
+                }
+            }
+        }
+
+        for (auto const& key : m_order)
+        {
+            if (key.latency < minLatency)
+            {
+                break;
+            }
+            Entry const& entry = m_entries[key.location];
+            if (!shutdown && (key.latency != latency || entry.reservedUntil != 0))
+            {
+                continue;
+            }
+            StorageRecord record;
+            if (readRecord(key.location, entry, record))
+            {
+                records.push_back(std::move(record));
+            }
+        }
+        if (!shutdown)
+        {
+            std::stable_sort(records.begin(), records.end(), [](StorageRecord const& a, StorageRecord const& b) {
+                return a.timestamp < b.timestamp;
+            });
+        }
+        if (maxCount > 0 && records.size() > maxCount)
+        {
+            records.resize(maxCount);
+        }
+        return records;
+    }
+
+    void OfflineStorage_Segment::DeleteAllRecords()
+    {
+        LOCKGUARD(m_lock);
+        if (!m_isOpened) {
+            return;
+        }
+        std::vector<std::string> paths;
+        for (auto const& segment : m_segments)
+        {
+            paths.push_back(segment.second.file->path());
+        }
+        m_segments.clear();
+        std::fill(std::begin(m_active), std::end(m_active), 0);
+        std::fill(std::begin(m_counts), std::end(m_counts), 0);
+        m_entries.clear();
+        m_order.clear();
+        m_ids.clear();
+        m_reserved.clear();
+        if (writeManifest())
+        {
+            for (auto const& path : paths)
+            {
+                FileDelete(path.c_str());
+            }
+        }
+        compactSidecarUnsafe(true);
+    }
+
+    void OfflineStorage_Segment::DeleteRecords(const std::map<std::string, std::string> & whereFilter)
+    {
+        LOCKGUARD(m_lock);
+        if (!m_isOpened) {
+            return;
+        }
+
+        // Same columns and fail-closed rules as the SQLite storage
+        std::map<std::string, int64_t> numbers;
+        for (auto const& filter : whereFilter)
+        {
+            if (filter.first == "record_id" || filter.first == "tenant_token")
+            {
+                continue;
+            }
+            if (filter.first != "latency" && filter.first != "persistence" && filter.first != "retry_count")
+            {
+                LOG_WARN("DeleteRecords: unrecognized filter column '%s'; nothing deleted", filter.first.c_str());
+                return;
+            }
+            size_t consumed = 0;
+            int64_t number = 0;
+            try
+            {
+                number = static_cast<int64_t>(std::stoll(filter.second, &consumed));
+            }
+            catch (const std::exception&)
+            {
+                consumed = 0;
+            }
+            if (filter.second.empty() || consumed != filter.second.size())
+            {
+                LOG_WARN("DeleteRecords: invalid numeric filter value for column '%s'; nothing deleted", filter.first.c_str());
+                return;
+            }
+            numbers[filter.first] = number;
+        }
+        if (whereFilter.empty())
+        {
+            LOG_WARN("DeleteRecords: no recognized filter columns; nothing deleted");
+            return;
+        }
+
+        std::vector<RecordLocation> matches;
+        for (auto const& item : m_entries)
+        {
+            Entry const& entry = item.second;
+            bool match = true;
+            for (auto const& filter : whereFilter)
+            {
+                if (filter.first == "record_id")
+                    match = (entry.id == filter.second);
+                else if (filter.first == "tenant_token")
+                    match = (entry.tenantToken == filter.second);
+                else if (filter.first == "latency")
+                    match = (entry.latency == numbers[filter.first]);
+                else if (filter.first == "persistence")
+                    match = (entry.persistence == numbers[filter.first]);
+                else
+                    match = (entry.retryCount == numbers[filter.first]);
+                if (!match)
+                    break;
+            }
+            if (match)
+            {
+                matches.push_back(item.first);
+            }
+        }
+        for (auto const& location : matches)
+        {
+            removeEntryUnsafe(location, true);
+        }
+        reclaimUnsafe(false);
+        flushWritersUnsafe();
+    }
+
+    void OfflineStorage_Segment::DeleteRecords(std::vector<StorageRecordId> const& ids, HttpHeaders headers, bool& fromMemory)
+    {
+        UNREFERENCED_PARAMETER(fromMemory);
+        UNREFERENCED_PARAMETER(headers);
+
+        if (ids.empty()) {
+            return;
+        }
+
+        LOCKGUARD(m_lock);
+        if (!m_isOpened) {
+            LOG_ERROR("Failed to delete %u sent event(s) {%s%s}: Storage is not open",
+                static_cast<unsigned>(ids.size()), ids.front().c_str(), (ids.size() > 1) ? ", ..." : "");
+            return;
+        }
+        LOG_TRACE("Deleting %u sent event(s) {%s%s}...", static_cast<unsigned>(ids.size()), ids.front().c_str(), (ids.size() > 1) ? ", ..." : "");
+
+        for (auto const& id : ids)
+        {
+            auto it = m_ids.find(id);
+            if (it != m_ids.end())
+            {
+                removeEntryUnsafe(it->second, true);
+            }
+        }
+        reclaimUnsafe(false);
+        flushWritersUnsafe();
+    }
+
+    void OfflineStorage_Segment::ReleaseRecords(std::vector<StorageRecordId> const& ids, bool incrementRetryCount, HttpHeaders headers, bool& fromMemory)
+    {
+        UNREFERENCED_PARAMETER(fromMemory);
+        UNREFERENCED_PARAMETER(headers);
+
+        if (ids.empty()) {
+            return;
+        }
+
+        LOCKGUARD(m_lock);
+        if (!m_isOpened) {
+            LOG_ERROR("Failed to release %u event(s) {%s%s}, retry count %s: Storage is not open",
+                static_cast<unsigned>(ids.size()), ids.front().c_str(), (ids.size() > 1) ? ", ..." : "", incrementRetryCount ? "+1" : "not changed");
+            return;
+        }
+
+        unsigned released = 0;
+        for (auto const& id : ids)
+        {
+            auto it = m_ids.find(id);
+            if (it == m_ids.end())
+            {
+                continue;
+            }
+            Entry& entry = m_entries[it->second];
+            if (entry.reservedUntil == 0)
+            {
+                continue;
+            }
+            entry.reservedUntil = 0;
+            m_reserved.erase(it->second);
+            if (incrementRetryCount)
+            {
+                setRetryCountUnsafe(it->second, entry, entry.retryCount + 1);
+            }
+            released++;
+        }
+        LOG_TRACE("Successfully released %u requested event(s), %u were not found anymore",
+            released, static_cast<unsigned>(ids.size()) - released);
+
+        if (incrementRetryCount)
+        {
+            int maxRetryCount = static_cast<int>(m_config.GetMaximumRetryCount());
+            std::map<std::string, size_t> deletedData;
+            std::vector<RecordLocation> dropped;
+            for (auto const& item : m_entries)
+            {
+                if (item.second.retryCount > maxRetryCount)
+                {
+                    deletedData[item.second.tenantToken]++;
+                    dropped.push_back(item.first);
+                }
+            }
+            for (auto const& location : dropped)
+            {
+                removeEntryUnsafe(location, true);
+            }
+            if (!dropped.empty())
+            {
+                LOG_ERROR("Deleted %zu events over maximum retry count %d", dropped.size(), maxRetryCount);
+                m_observer->OnStorageRecordsDropped(deletedData);
+                reclaimUnsafe(false);
+            }
+        }
+        flushWritersUnsafe();
+    }
+
+    bool OfflineStorage_Segment::StoreSetting(std::string const& name, std::string const& value)
+    {
+        if (name.empty()) {
+            LOG_ERROR("Failed to set setting \"%s\": Name cannot be empty", name.c_str());
+            return false;
+        }
+
+        LOCKGUARD(m_lock);
+        if (!m_isOpened) {
+            LOG_ERROR("Failed to set setting \"%s\": Storage is not open", name.c_str());
+            return false;
+        }
+        if (value.empty()) {
+            m_settings.erase(name);
+        }
+        else {
+            m_settings[name] = value;
+        }
+        if (!saveSettings()) {
+            LOG_ERROR("Failed to set setting \"%s\": Write error", name.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    std::string OfflineStorage_Segment::GetSetting(std::string const& name)
+    {
+        LOCKGUARD(m_lock);
+        auto it = m_settings.find(name);
+        return (it != m_settings.end()) ? it->second : std::string();
+    }
+
+    bool OfflineStorage_Segment::DeleteSetting(std::string const& name)
+    {
+        if (name.empty()) {
+            LOG_ERROR("Failed to delete setting \"%s\": Name cannot be empty", name.c_str());
+            return false;
+        }
+        LOCKGUARD(m_lock);
+        if (!m_isOpened) {
+            return false;
+        }
+        if (m_settings.erase(name) == 0) {
+            return true;
+        }
+        return saveSettings();
+    }
+
+    size_t OfflineStorage_Segment::GetSize()
+    {
+        LOCKGUARD(m_lock);
+        return getSizeUnsafe();
+    }
+
+    size_t OfflineStorage_Segment::GetSegmentCount() const
+    {
+        LOCKGUARD(m_lock);
+        return m_segments.size();
+    }
+
+    size_t OfflineStorage_Segment::GetRecordCount(EventLatency latency) const
+    {
+        LOCKGUARD(m_lock);
+        if (latency == EventLatency_Unspecified)
+        {
+            return m_entries.size();
+        }
+        if (latency < EventLatency_Off || latency > EventLatency_Max)
+        {
+            return 0;
+        }
+        return m_counts[latency];
+    }
+
+    bool OfflineStorage_Segment::ResizeDb()
+    {
+        size_t eventsDropped = 0;
+        {
+            LOCKGUARD(m_lock);
+            if (!m_isOpened) {
+                LOG_ERROR("Failed to resize storage: storage is not open");
+                return false;
+            }
+
+            size_t size = getSizeUnsafe();
+            if (m_DbSizeLimit == 0 || size <= m_DbSizeLimit)
+                return false;
+
+            size_t count = m_entries.size();
+            if (size > 2 * m_DbSizeLimit)
+            {
+                LOG_TRACE("Storage is too big, deleting...");
+                DeleteAllRecords();
+                eventsDropped = count;
+            }
+            else if (count != 0)
+            {
+                // Drop the oldest quarter, normal persistence first, and give
+                // the space back right away
+                std::vector<OrderKey> keys(m_order.begin(), m_order.end());
+                std::sort(keys.begin(), keys.end(), [](OrderKey const& a, OrderKey const& b) {
+                    return (a.persistence != b.persistence) ? (a.persistence < b.persistence) : (a.timestamp < b.timestamp);
+                });
+                eventsDropped = std::max<size_t>(1, count * 25 / 100);
+                for (size_t i = 0; i < eventsDropped; i++)
+                {
+                    removeEntryUnsafe(keys[i].location, true);
+                }
+                for (uint64_t seq : m_active)
+                {
+                    if (seq != 0)
+                    {
+                        sealUnsafe(seq);
+                    }
+                }
+                reclaimUnsafe(true);
+                flushWritersUnsafe();
+                LOG_TRACE("Storage resized, events dropped: %zu", eventsDropped);
+            }
+        }
+
+        DebugEvent evt(DebugEventType::EVT_DROPPED);
+        evt.param1 = eventsDropped;
+        evt.param2 = static_cast<size_t>(DROPPED_REASON_OFFLINE_STORAGE_OVERFLOW);
+        evt.size = eventsDropped;
+        m_logManager.DispatchEvent(evt);
+
+        return true;
+    }
+
+} MAT_NS_END
+#endif
@@ -0,0 +1,178 @@
+#include "mat/config.h"
+#ifdef HAVE_MAT_STORAGE
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#pragma once
+#include "pal/PAL.hpp"
+#include "IOfflineStorage.hpp"
+
+#include "api/IRuntimeConfig.hpp"
+
+#include "ILogManager.hpp"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+
+namespace MAT_NS_BEGIN {
+
+    class SegmentFile;
+
+    /// <summary>
+    /// Offline storage made of append-only segment files next to the
+    /// configured cache file, one series of segments per latency. Records are
+    /// written once, each with a CRC. Deletes and retry counts are appended to
+    /// a small sidecar log, and leases only live in memory. Opening replays
+    /// the segments and the sidecar up to the first torn or corrupt entry.
+    /// Segments without live records are removed, and mostly dead ones are
+    /// copied into the current segment of their latency.
+    /// </summary>
+    class OfflineStorage_Segment : public IOfflineStorage
+    {
+    public:
+        OfflineStorage_Segment(ILogManager& logManager, IRuntimeConfig& runtimeConfig);
+
+        virtual ~OfflineStorage_Segment() override;
+        virtual void Initialize(IOfflineStorageObserver& observer) override;
+        virtual void Shutdown() override;
+        virtual void Flush() override;
+        virtual bool StoreRecord(StorageRecord const& record) override;
+        virtual size_t StoreRecords(std::vector<StorageRecord> & records) override;
+        virtual bool GetAndReserveRecords(std::function<bool(StorageRecord&&)> const& consumer, unsigned leaseTimeMs, EventLatency minLatency = EventLatency_Normal, unsigned maxCount = 0) override;
+        virtual bool IsLastReadFromMemory() override;
+        virtual unsigned LastReadRecordCount() override;
+
+        virtual void DeleteRecords(const std::map<std::string, std::string> & whereFilter) override;
+        virtual void DeleteAllRecords() override;
+        virtual void DeleteRecords(std::vector<StorageRecordId> const& ids, HttpHeaders headers, bool& fromMemory) override;
+        virtual void ReleaseRecords(std::vector<StorageRecordId> const& ids, bool incrementRetryCount, HttpHeaders headers, bool& fromMemory) override;
+
+        virtual bool StoreSetting(std::string const& name, std::string const& value) override;
+        virtual std::string GetSetting(std::string const& name) override;
+        virtual bool DeleteSetting(std::string const& name) override;
+        virtual size_t GetSize() override;
+        virtual size_t GetRecordCount(EventLatency latency) const override;
+        virtual std::vector<StorageRecord> GetRecords(bool shutdown, EventLatency minLatency = EventLatency_Normal, unsigned maxCount = 0) override;
+        virtual bool ResizeDb() override;
+
+        /// <summary>
+        /// Number of segment files currently in use.
+        /// </summary>
+        size_t GetSegmentCount() const;
+
+    protected:
+        // Segment sequence number and offset of the record in it
+        using RecordLocation = std::pair<uint64_t, uint32_t>;
+
+        struct Entry
+        {
+            StorageRecordId  id;
+            std::string      tenantToken;
+            EventLatency     latency       = EventLatency_Normal;
+            EventPersistence persistence   = EventPersistence_Normal;
+            int64_t          timestamp     = 0;
+#ifdef HAVE_MAT_EVT_TRACEID
+            std::string      traceId;
+#endif
+            uint32_t         size          = 0;
+            int              retryCount    = 0;
+            int64_t          reservedUntil = 0;
+        };
+
+        // Retrieval order: latency and persistence descending, oldest first
+        struct OrderKey
+        {
+            int            latency;
+            int            persistence;
+            int64_t        timestamp;
+            RecordLocation location;
+
+            bool operator<(OrderKey const& other) const
+            {
+                if (latency != other.latency)
+                    return latency > other.latency;
+                if (persistence != other.persistence)
+                    return persistence > other.persistence;
+                if (timestamp != other.timestamp)
+                    return timestamp < other.timestamp;
+                return location < other.location;
+            }
+        };
+
+        struct Segment
+        {
+            std::unique_ptr<SegmentFile> file;
+            EventLatency          latency   = EventLatency_Normal;
+            bool                  sealed    = false;
+            size_t                liveCount = 0;
+            size_t                liveBytes = 0;
+            // Offsets of deleted records, rewritten when the sidecar is compacted
+            std::vector<uint32_t> deleted;
+        };
+
+        bool openUnsafe();
+        void closeUnsafe();
+        void removeAllFilesUnsafe();
+        bool loadManifest();
+        bool writeManifest();
+        void replaySegment(uint64_t seq, Segment& segment);
+        void replaySidecar();
+        void loadSettings();
+        bool saveSettings();
+
+        bool isValidRecord(StorageRecord const& record);
+        bool appendUnsafe(StorageRecord const& record, size_t& bytesStored);
+        Segment* activeSegment(EventLatency latency, size_t recordSize);
+        void sealUnsafe(uint64_t seq);
+        void addEntryUnsafe(RecordLocation const& location, Entry&& entry);
+        void removeEntryUnsafe(RecordLocation const& location, bool logDelete);
+        void setRetryCountUnsafe(RecordLocation const& location, Entry& entry, int retryCount);
+        bool writeSidecar(uint8_t op, RecordLocation const& location, uint32_t value);
+        bool readRecord(RecordLocation const& location, Entry const& entry, StorageRecord& record);
+        void reclaimUnsafe(bool all);
+        bool compactSegmentUnsafe(uint64_t seq);
+        void compactSidecarUnsafe(bool force);
+        void flushWritersUnsafe();
+        size_t getSizeUnsafe() const;
+        void checkSizeLimits();
+        std::string segmentPath(uint64_t seq) const;
+
+        mutable std::recursive_mutex m_lock {};
+        IOfflineStorageObserver*    m_observer {};
+        IRuntimeConfig&             m_config;
+        ILogManager&                m_logManager;
+        bool                        m_isOpened {};
+
+        std::string                 m_basePath;
+        uint64_t                    m_nextSeq { 1 };
+        std::map<uint64_t, Segment> m_segments;
+        uint64_t                    m_active[EventLatency_Max + 1] {};
+        std::map<RecordLocation, Entry> m_entries;
+        std::set<OrderKey>          m_order;
+        std::unordered_map<std::string, RecordLocation> m_ids;
+        std::set<RecordLocation>    m_reserved;
+        size_t                      m_counts[EventLatency_Max + 1] {};
+
+        std::FILE*                  m_sidecar {};
+        size_t                      m_sidecarEntries {};
+        std::map<std::string, std::string> m_settings;
+
+        size_t                      m_segmentLimit {};
+        unsigned                    m_lastReadCount {};
+        size_t                      m_DbSizeNotificationLimit {};
+        uint64_t                    m_DbSizeNotificationInterval {};
+        size_t                      m_DbSizeLimit {};
+        uint64_t                    m_isStorageFullNotificationSendTime {};
+
+    protected:
+        MATSDK_LOG_DECL_COMPONENT_CLASS();
+    };
+
+
+} MAT_NS_END
+#endif
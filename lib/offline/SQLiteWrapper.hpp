@@ -622,6 +622,33 @@ namespace MAT_NS_BEGIN {
             }
         }
 
+        /// <summary>
+        /// Binds arguments to consecutive parameters following <paramref name="offset"/>,
+        /// for statements whose parameter count is not known at compile time.
+        /// Returns 0 on success or the 1-based index of the parameter that failed.
+        /// </summary>
+        template<typename... TArgs>
+        int bindAt(int offset, TArgs&& ... args)
+        {
+            if (m_stmt == nullptr) {
+                return offset + 1;
+            }
+            return bindAll(offset, std::forward<TArgs>(args) ...);
+        }
+
+        /// <summary>
+        /// Executes a statement whose parameters were bound with bindAt().
+        /// </summary>
+        bool executeBound(int bindFailedIdx = 0)
+        {
+            if (m_stmt != nullptr) {
+                return execute2(bindFailedIdx);
+            }
+            else {
+                return false;
+            }
+        }
+
         template<typename... TArgs>
         bool select(TArgs&& ... args)
         {
@@ -45,7 +45,7 @@ namespace MAT_NS_BEGIN {
     {
         auto consumer = [&ctx, this](StorageRecord&& record) -> bool {
             bool wantMore = true;
-            retrievedEvent(ctx, std::move(record), wantMore);
+            retrievedEvent(ctx, record, wantMore);
             return wantMore;
         };
 
@@ -69,12 +69,7 @@ namespace MAT_NS_BEGIN {
         {
             headers = ctx->httpResponse->GetHeaders();
         }
-        std::vector<StorageRecordId> recordIds;
-        for (const auto& item : ctx->recordIdsAndTenantIds)
-        {
-            recordIds.push_back(item.first);
-        }
-        m_offlineStorage.DeleteRecords(recordIds, headers, ctx->fromMemory);
+        m_offlineStorage.DeleteRecords(ctx->recordIds, headers, ctx->fromMemory);
         return true;
     }
 
@@ -88,12 +83,7 @@ namespace MAT_NS_BEGIN {
         {
             headers = ctx->httpResponse->GetHeaders();
         }
-        std::vector<StorageRecordId> recordIds;
-        for (const auto& item : ctx->recordIdsAndTenantIds)
-        {
-            recordIds.push_back(item.first);
-        }
-        m_offlineStorage.ReleaseRecords(recordIds, false, headers, ctx->fromMemory);
+        m_offlineStorage.ReleaseRecords(ctx->recordIds, false, headers, ctx->fromMemory);
         return true;
     }
 
@@ -105,13 +95,7 @@ namespace MAT_NS_BEGIN {
         {
             headers = ctx->httpResponse->GetHeaders();
         }
-        std::vector<StorageRecordId> recordIds;
-        for (const auto& item : ctx->recordIdsAndTenantIds)
-        {
-            recordIds.push_back(item.first);
-        }
-
-        m_offlineStorage.ReleaseRecords(recordIds, true, headers, ctx->fromMemory);
+        m_offlineStorage.ReleaseRecords(ctx->recordIds, true, headers, ctx->fromMemory);
         return true;
     }
 
@@ -12,7 +12,7 @@ namespace MAT_NS_BEGIN {
 
 size_t BondSplicer::addTenantToken(std::string const& tenantToken)
 {
-    size_t begin = m_buffer.size();
+    size_t begin = m_recordsSize;
 
     m_overheadEstimate += 8 + tenantToken.size();
 
@@ -21,42 +21,69 @@ size_t BondSplicer::addTenantToken(std::string const& tenantToken)
 }
 
 void BondSplicer::addRecord(size_t dataPackageIndex, std::vector<uint8_t> const& recordBlob)
+{
+    addRecord(dataPackageIndex, std::vector<uint8_t>(recordBlob));
+}
+
+void BondSplicer::addRecord(size_t dataPackageIndex, std::vector<uint8_t>&& recordBlob)
 {
     assert(dataPackageIndex < m_packages.size());
     assert(!recordBlob.empty() && recordBlob.back() == bond_lite::BT_STOP);
 
-    m_packages[dataPackageIndex].records.push_back(Span{m_buffer.size(), recordBlob.size()});
-    m_buffer.insert(m_buffer.end(), recordBlob.begin(), recordBlob.end());
+    m_packages[dataPackageIndex].records.push_back(Span{m_segments.size(), recordBlob.size()});
+    m_recordsSize += recordBlob.size();
+    m_segments.push_back(std::move(recordBlob));
 }
 
 size_t BondSplicer::getSizeEstimate() const
 {
-    return m_buffer.size() + m_overheadEstimate + 8 /*DataPackages*/;
+    return m_recordsSize + m_overheadEstimate + 8 /*DataPackages*/;
 }
 
 std::vector<uint8_t> BondSplicer::splice() const
 {
     std::vector<uint8_t> output;
+    spliceInto(output);
+    return output;
+}
+
+void BondSplicer::spliceInto(std::vector<uint8_t>& output) const
+{
+    // The body size is known up front, so it is allocated at most once and
+    // every record segment is copied into it exactly once.
+    output.clear();
+    output.reserve(m_recordsSize);
     bond_lite::CompactBinaryProtocolWriter writer(output);
 
     if (!m_packages.empty()) {
         for (PackageInfo const& package : m_packages) {
             if (!package.records.empty()) {
                 for (Span const& record : package.records) {
-                    writer.WriteBlob(m_buffer.data() + record.offset, record.length);
+                    writer.WriteBlob(m_segments[record.offset].data(), record.length);
                 }
             } 
         }
     } 
+}
 
-    return output;
+bool BondSplicer::isCompressed() const
+{
+    return false;
 }
 
 void BondSplicer::clear()
 {
-    // Swap with empty instead of clear() to release memory
-    std::vector<uint8_t>().swap(m_buffer);
-    std::vector<PackageInfo>().swap(m_packages);
+    // Keep the capacity for the next package, unless an unusually large
+    // package grew it past the high-water mark
+    m_segments.clear();
+    m_packages.clear();
+    if (m_segments.capacity() > MaxRetainedSegments) {
+        std::vector<std::vector<uint8_t>>().swap(m_segments);
+    }
+    if (m_packages.capacity() > MaxRetainedPackages) {
+        std::vector<PackageInfo>().swap(m_packages);
+    }
+    m_recordsSize = 0;
     m_overheadEstimate = 0;
 }
 
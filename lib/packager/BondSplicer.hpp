@@ -18,20 +18,30 @@ namespace MAT_NS_BEGIN {
 class BondSplicer : public ISplicer
 {
   protected:
-    std::vector<uint8_t>     m_buffer;
-    std::vector<PackageInfo> m_packages;
-    size_t                   m_overheadEstimate {};
+    // Each record blob is kept as its own segment and only concatenated
+    // into the output once, in splice().
+    std::vector<std::vector<uint8_t>> m_segments;
+    std::vector<PackageInfo>          m_packages;
+    size_t                            m_recordsSize {};
+    size_t                            m_overheadEstimate {};
 
   public:
+    // clear() releases vectors grown past these
+    static constexpr size_t MaxRetainedSegments = 4096;
+    static constexpr size_t MaxRetainedPackages = 64;
+
     BondSplicer() noexcept = default;
     BondSplicer(BondSplicer const&) = delete;
     BondSplicer& operator=(BondSplicer const&) = delete;
 
     size_t addTenantToken(std::string const& tenantToken) override;
     void addRecord(size_t dataPackageIndex, std::vector<uint8_t> const& recordBlob) override;
+    void addRecord(size_t dataPackageIndex, std::vector<uint8_t>&& recordBlob) override;
 
     size_t getSizeEstimate() const override;
     std::vector<uint8_t> splice() const override;
+    void spliceInto(std::vector<uint8_t>& output) const override;
+    bool isCompressed() const override;
 
     void clear() override;
 };
@@ -0,0 +1,81 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "DeflateSplicer.hpp"
+#include "bond/All.hpp"
+#include "bond/generated/CsProtocol_writers.hpp"
+#include <assert.h>
+
+#ifdef HAVE_MAT_ZLIB
+
+namespace MAT_NS_BEGIN {
+
+DeflateSplicer::DeflateSplicer(DeflateParameters const& parameters)
+    : m_stream(parameters)
+{
+}
+
+bool DeflateSplicer::good() const
+{
+    return m_stream.good();
+}
+
+size_t DeflateSplicer::addTenantToken(std::string const& tenantToken)
+{
+    m_overheadEstimate += 8 + tenantToken.size();
+    return m_packageCount++;
+}
+
+void DeflateSplicer::addRecord(size_t dataPackageIndex, std::vector<uint8_t> const& recordBlob)
+{
+    UNREFERENCED_PARAMETER(dataPackageIndex);
+    assert(dataPackageIndex < m_packageCount);
+    assert(!recordBlob.empty() && recordBlob.back() == bond_lite::BT_STOP);
+
+    m_recordsSize += recordBlob.size();
+    // A failure is sticky: splice() reports it for the whole package.
+    m_stream.write(recordBlob.data(), recordBlob.size());
+}
+
+void DeflateSplicer::addRecord(size_t dataPackageIndex, std::vector<uint8_t>&& recordBlob)
+{
+    addRecord(dataPackageIndex, static_cast<std::vector<uint8_t> const&>(recordBlob));
+    // The record is already in the compressed body; drop it right away.
+    std::vector<uint8_t>().swap(recordBlob);
+}
+
+size_t DeflateSplicer::getSizeEstimate() const
+{
+    return m_recordsSize + m_overheadEstimate + 8 /*DataPackages*/;
+}
+
+std::vector<uint8_t> DeflateSplicer::splice() const
+{
+    std::vector<uint8_t> output;
+    if (!m_stream.finish(output)) {
+        LOG_WARN("HTTP request compressing failed after %u bytes", static_cast<unsigned>(m_recordsSize));
+        output.clear();
+    }
+    return output;
+}
+
+bool DeflateSplicer::isCompressed() const
+{
+    return true;
+}
+
+void DeflateSplicer::clear()
+{
+    m_stream.reset();
+    m_packageCount = 0;
+    m_recordsSize = 0;
+    m_overheadEstimate = 0;
+}
+
+
+} MAT_NS_END
+
+#endif
+
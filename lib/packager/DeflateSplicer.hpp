@@ -0,0 +1,62 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef DEFLATESPLICER_HPP
+#define DEFLATESPLICER_HPP
+
+#include "pal/PAL.hpp"
+#include "ISplicer.hpp"
+#include "compression/DeflateStream.hpp"
+
+#include <vector>
+
+namespace MAT_NS_BEGIN {
+
+
+/// <summary>
+/// Splicer that deflates each record as it is added, so the package body is
+/// compressed by the time it is finalized and no uncompressed copy of it is
+/// ever built. Records appear in the body in the order they were added
+/// rather than grouped by tenant, which Common Schema bodies allow because
+/// every record carries its own iKey.
+/// </summary>
+class DeflateSplicer : public ISplicer
+{
+  protected:
+    // Finished by splice() and made reusable again by clear().
+    mutable DeflateStream m_stream;
+    size_t                m_packageCount {};
+    size_t                m_recordsSize {};
+    size_t                m_overheadEstimate {};
+
+  public:
+    explicit DeflateSplicer(DeflateParameters const& parameters);
+    DeflateSplicer(DeflateSplicer const&) = delete;
+    DeflateSplicer& operator=(DeflateSplicer const&) = delete;
+
+    bool good() const;
+
+    size_t addTenantToken(std::string const& tenantToken) override;
+    void addRecord(size_t dataPackageIndex, std::vector<uint8_t> const& recordBlob) override;
+    void addRecord(size_t dataPackageIndex, std::vector<uint8_t>&& recordBlob) override;
+
+    /// <summary>
+    /// Uncompressed size, so that the maximum upload size means the same
+    /// thing with and without streaming compression.
+    /// </summary>
+    size_t getSizeEstimate() const override;
+
+    /// <summary>
+    /// Compressed body, or an empty vector if compression failed.
+    /// </summary>
+    std::vector<uint8_t> splice() const override;
+    bool isCompressed() const override;
+
+    void clear() override;
+};
+
+
+} MAT_NS_END
+#endif
+
@@ -16,6 +16,10 @@ namespace MAT_NS_BEGIN {
 class ISplicer
 {
   protected:
+    /// <summary>
+    /// Location of a record within the splicer. Segmented splicers store
+    /// the segment index in offset.
+    /// </summary>
     struct Span {
         size_t offset, length;
     };
@@ -32,9 +36,29 @@ class ISplicer
     virtual size_t addTenantToken(std::string const& tenantToken) = 0;
     virtual void addRecord(size_t dataPackageIndex, std::vector<uint8_t> const& recordBlob) = 0;
 
+    /// <summary>
+    /// Adds a record by taking ownership of its serialized blob, so that it
+    /// is copied only once, when the package body is spliced together.
+    /// </summary>
+    virtual void addRecord(size_t dataPackageIndex, std::vector<uint8_t>&& recordBlob) = 0;
+
     virtual size_t getSizeEstimate() const = 0;
     virtual std::vector<uint8_t> splice() const = 0;
 
+    /// <summary>
+    /// Splices the package body into output, replacing its contents. Splicers
+    /// that can write in place reuse the capacity output already has.
+    /// </summary>
+    virtual void spliceInto(std::vector<uint8_t>& output) const
+    {
+        output = splice();
+    }
+
+    /// <summary>
+    /// True if splice() returns a body that is already compressed.
+    /// </summary>
+    virtual bool isCompressed() const = 0;
+
     virtual void clear() = 0;
 };
 
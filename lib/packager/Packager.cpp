@@ -20,15 +20,21 @@ namespace MAT_NS_BEGIN {
         }
     }
 
-    void Packager::handleAddEventToPackage(EventsUploadContextPtr const& ctx, StorageRecord const& record, bool& wantMore)
+    void Packager::handleAddEventToPackage(EventsUploadContextPtr const& ctx, StorageRecord& record, bool& wantMore)
     {
         try {
             if (ctx->maxUploadSize == 0) {
                 ctx->maxUploadSize = m_config.GetMaximumUploadSizeBytes();
             }
+            if (ctx->singleLatency && ctx->latency != EventLatency_Unspecified && record.latency != ctx->latency) {
+                wantMore = false;
+                LOG_TRACE("Latency %d package complete, not adding the next event (ID %s, latency %d)",
+                    ctx->latency, record.id.c_str(), record.latency);
+                return;
+            }
             if (ctx->splicer->getSizeEstimate() + record.blob.size() > ctx->maxUploadSize) {
                 wantMore = false;
-                if (!ctx->recordIdsAndTenantIds.empty()) {
+                if (!ctx->recordIds.empty()) {
                     LOG_TRACE("Maximum upload size %u bytes exceeded, not adding the next event (ID %s, size %u bytes)",
                         ctx->maxUploadSize, record.id.c_str(), static_cast<unsigned>(record.blob.size()));
                     return;
@@ -59,9 +65,11 @@ namespace MAT_NS_BEGIN {
                 it = ctx->packageIds.insert(it, { tenantToken, ctx->splicer->addTenantToken(tenantToken) });
             }
 
-            ctx->splicer->addRecord(it->second, record.blob);
+            // The record is owned by the retrieval loop and discarded after this
+            // call, so the blob is handed over to the splicer instead of copied.
+            ctx->splicer->addRecord(it->second, std::move(record.blob));
 
-            ctx->recordIdsAndTenantIds[record.id] = record.tenantToken;
+            ctx->addRecord(record.id, record.tenantToken);
             ctx->recordTimestamps.push_back(record.timestamp);
             ctx->maxRetryCountSeen = std::max<int>(ctx->maxRetryCountSeen, record.retryCount);
         }
@@ -78,9 +86,16 @@ namespace MAT_NS_BEGIN {
             return;
         }
 
-        ctx->body = ctx->splicer->splice();
+        ctx->splicer->spliceInto(ctx->body);
+        ctx->compressed = ctx->splicer->isCompressed();
         ctx->splicer->clear();
 
+        if (ctx->body.empty()) {
+            LOG_WARN("Failed to package %u events", static_cast<unsigned>(ctx->recordIds.size()));
+            packagingFailed(ctx);
+            return;
+        }
+
         packagedEvents(ctx);
     }
 
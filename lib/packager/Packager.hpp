@@ -16,7 +16,7 @@ namespace MAT_NS_BEGIN {
         Packager(IRuntimeConfig& runtimeConfig);
 
     protected:
-        void handleAddEventToPackage(EventsUploadContextPtr const& ctx, StorageRecord const& record, bool& wantMore);
+        void handleAddEventToPackage(EventsUploadContextPtr const& ctx, StorageRecord& record, bool& wantMore);
         void handleFinalizePackage(EventsUploadContextPtr const& ctx);
 
     protected:
@@ -24,11 +24,12 @@ namespace MAT_NS_BEGIN {
         std::string      m_forcedTenantToken;
 
     public:
-        RouteSink<Packager, EventsUploadContextPtr const&, StorageRecord const&, bool&> addEventToPackage{ this, &Packager::handleAddEventToPackage };
+        RouteSink<Packager, EventsUploadContextPtr const&, StorageRecord&, bool&>       addEventToPackage{ this, &Packager::handleAddEventToPackage };
         RouteSink<Packager, EventsUploadContextPtr const&>                              finalizePackage{ this, &Packager::handleFinalizePackage };
 
         RouteSource<EventsUploadContextPtr const&>                                      emptyPackage;
         RouteSource<EventsUploadContextPtr const&>                                      packagedEvents;
+        RouteSource<EventsUploadContextPtr const&>                                      packagingFailed;
     };
 
 
@@ -0,0 +1,686 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "mat/config.h"
+
+#include "BinaryTrace.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#if defined(__linux__) && !defined(_WIN32)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace PAL_NS_BEGIN
+{
+    namespace detail
+    {
+        std::atomic<bool> g_binaryTrace(false);
+
+        constexpr size_t BinaryTraceArgs::Capacity;
+        constexpr size_t BinaryTraceArgs::MaxStringLength;
+
+        namespace
+        {
+            // File layout: magic, byte order marker, then records tagged by type
+            constexpr char     kMagic[8]        = { 'M', 'A', 'T', 'T', 'R', 'C', '0', '1' };
+            constexpr uint32_t kByteOrderMarker = 0x01020304;
+            constexpr char     kRecordString    = 'S'; // id, uint16 length, characters
+            constexpr char     kRecordEvent     = 'E'; // time, thread, level, component id, format id, uint16 length, args
+            constexpr char     kRecordDropped   = 'D'; // time, thread, count
+
+            // Ring record: uint16 length, then time, component, format, level and args
+            constexpr size_t   kRingSize        = 64 * 1024;
+            constexpr size_t   kHeaderSize      = 8 + 8 + 8 + 1;
+            constexpr auto     kDrainInterval   = std::chrono::milliseconds(50);
+
+            uint64_t nowNs() noexcept
+            {
+                return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count());
+            }
+
+            uint64_t currentThreadId() noexcept
+            {
+#if defined(__linux__) && !defined(_WIN32)
+                return static_cast<uint64_t>(syscall(SYS_gettid));
+#else
+                return static_cast<uint64_t>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+#endif
+            }
+
+            /// <summary>
+            /// Single producer, single consumer byte ring of one thread.
+            /// </summary>
+            struct TraceRing
+            {
+                TraceRing(uint64_t generation_, uint64_t tid_) :
+                    data(new uint8_t[kRingSize]),
+                    tid(tid_),
+                    generation(generation_)
+                {
+                }
+
+                bool push(const uint8_t* header, size_t headerSize, const uint8_t* args, size_t argsSize) noexcept
+                {
+                    const size_t length = headerSize + argsSize;
+                    const uint64_t h = head.load(std::memory_order_relaxed);
+                    const uint64_t t = tail.load(std::memory_order_acquire);
+                    if (kRingSize - static_cast<size_t>(h - t) < length + sizeof(uint16_t))
+                    {
+                        dropped.fetch_add(1, std::memory_order_relaxed);
+                        return false;
+                    }
+                    const uint16_t length16 = static_cast<uint16_t>(length);
+                    copyIn(h, &length16, sizeof(length16));
+                    copyIn(h + sizeof(length16), header, headerSize);
+                    copyIn(h + sizeof(length16) + headerSize, args, argsSize);
+                    head.store(h + sizeof(length16) + length, std::memory_order_release);
+                    return true;
+                }
+
+                void copyIn(uint64_t position, const void* source, size_t size) noexcept
+                {
+                    const size_t offset = static_cast<size_t>(position % kRingSize);
+                    const size_t first = std::min(size, kRingSize - offset);
+                    memcpy(data.get() + offset, source, first);
+                    memcpy(data.get(), static_cast<const uint8_t*>(source) + first, size - first);
+                }
+
+                void copyOut(uint64_t position, void* target, size_t size) const noexcept
+                {
+                    const size_t offset = static_cast<size_t>(position % kRingSize);
+                    const size_t first = std::min(size, kRingSize - offset);
+                    memcpy(target, data.get() + offset, first);
+                    memcpy(static_cast<uint8_t*>(target) + first, data.get(), size - first);
+                }
+
+                std::unique_ptr<uint8_t[]> data;
+                std::atomic<uint64_t>      head { 0 };
+                std::atomic<uint64_t>      tail { 0 };
+                std::atomic<uint64_t>      dropped { 0 };
+                std::atomic<bool>          orphaned { false };
+                const uint64_t             tid;
+                const uint64_t             generation;
+                // Writer only
+                uint64_t                   reportedDrops = 0;
+            };
+
+            template <typename T>
+            void appendValue(std::string& out, T value)
+            {
+                out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+            }
+
+            /// <summary>
+            /// Background writer draining the rings of all threads.
+            /// </summary>
+            class TraceWriter
+            {
+            public:
+                static TraceWriter& instance()
+                {
+                    // Never destroyed: threads may still exit and release rings at process exit
+                    static TraceWriter* writer = new TraceWriter();
+                    return *writer;
+                }
+
+                uint64_t generation() const noexcept
+                {
+                    return m_generation.load(std::memory_order_acquire);
+                }
+
+                std::shared_ptr<TraceRing> registerRing(uint64_t generation)
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    if (!m_running || (generation != m_generation.load(std::memory_order_relaxed)))
+                    {
+                        return nullptr;
+                    }
+                    auto ring = std::make_shared<TraceRing>(generation, currentThreadId());
+                    m_rings.push_back(ring);
+                    return ring;
+                }
+
+                void start(std::ostream& stream)
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    if (m_running)
+                    {
+                        return;
+                    }
+                    m_stream = &stream;
+                    m_stream->write(kMagic, sizeof(kMagic));
+                    m_stream->write(reinterpret_cast<const char*>(&kByteOrderMarker), sizeof(kByteOrderMarker));
+                    m_stream->flush();
+                    m_strings.clear();
+                    m_rings.clear();
+                    m_stop = false;
+                    m_running = true;
+                    m_generation.fetch_add(1, std::memory_order_release);
+                    m_thread = std::thread(&TraceWriter::run, this);
+                }
+
+                void stop()
+                {
+                    {
+                        std::lock_guard<std::mutex> lock(m_lock);
+                        if (!m_running)
+                        {
+                            return;
+                        }
+                        m_stop = true;
+                        m_running = false;
+                    }
+                    m_cv.notify_all();
+                    m_thread.join();
+
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    m_rings.clear();
+                    m_stream = nullptr;
+                }
+
+            private:
+                TraceWriter() = default;
+
+                void run()
+                {
+                    bool stop = false;
+                    while (!stop)
+                    {
+                        {
+                            std::unique_lock<std::mutex> lock(m_lock);
+                            m_cv.wait_for(lock, kDrainInterval, [this]() { return m_stop; });
+                            stop = m_stop;
+                        }
+                        drain();
+                    }
+                }
+
+                void appendString(std::string& out, uint64_t id)
+                {
+                    if (!m_strings.insert(id).second)
+                    {
+                        return;
+                    }
+                    const char* str = reinterpret_cast<const char*>(static_cast<uintptr_t>(id));
+                    const size_t length = (str == nullptr) ? 0 : std::min<size_t>(strlen(str), UINT16_MAX);
+                    out.push_back(kRecordString);
+                    appendValue(out, id);
+                    appendValue(out, static_cast<uint16_t>(length));
+                    out.append(str, length);
+                }
+
+                void drain()
+                {
+                    std::vector<std::shared_ptr<TraceRing>> rings;
+                    {
+                        std::lock_guard<std::mutex> lock(m_lock);
+                        rings = m_rings;
+                    }
+
+                    std::string out;
+                    std::vector<uint8_t> record;
+                    std::vector<TraceRing*> finished;
+                    for (const auto& ring : rings)
+                    {
+                        // A ring orphaned before this pass is empty once drained
+                        const bool orphaned = ring->orphaned.load(std::memory_order_acquire);
+                        uint64_t t = ring->tail.load(std::memory_order_relaxed);
+                        const uint64_t h = ring->head.load(std::memory_order_acquire);
+                        while (t < h)
+                        {
+                            uint16_t length = 0;
+                            ring->copyOut(t, &length, sizeof(length));
+                            record.resize(length);
+                            ring->copyOut(t + sizeof(length), record.data(), length);
+                            t += sizeof(length) + length;
+
+                            uint64_t time, component, format;
+                            memcpy(&time, record.data(), sizeof(time));
+                            memcpy(&component, record.data() + 8, sizeof(component));
+                            memcpy(&format, record.data() + 16, sizeof(format));
+                            appendString(out, component);
+                            appendString(out, format);
+
+                            out.push_back(kRecordEvent);
+                            appendValue(out, time);
+                            appendValue(out, ring->tid);
+                            out.push_back(static_cast<char>(record[24]));
+                            appendValue(out, component);
+                            appendValue(out, format);
+                            appendValue(out, static_cast<uint16_t>(length - kHeaderSize));
+                            out.append(reinterpret_cast<const char*>(record.data()) + kHeaderSize, length - kHeaderSize);
+                        }
+                        ring->tail.store(t, std::memory_order_release);
+
+                        const uint64_t dropped = ring->dropped.load(std::memory_order_relaxed);
+                        if (dropped != ring->reportedDrops)
+                        {
+                            out.push_back(kRecordDropped);
+                            appendValue(out, nowNs());
+                            appendValue(out, ring->tid);
+                            appendValue(out, dropped - ring->reportedDrops);
+                            ring->reportedDrops = dropped;
+                        }
+                        if (orphaned)
+                        {
+                            finished.push_back(ring.get());
+                        }
+                    }
+
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    if (!finished.empty())
+                    {
+                        m_rings.erase(std::remove_if(m_rings.begin(), m_rings.end(), [&finished](const std::shared_ptr<TraceRing>& ring) {
+                            return std::find(finished.cbegin(), finished.cend(), ring.get()) != finished.cend();
+                        }), m_rings.end());
+                    }
+                    if (!out.empty() && (m_stream != nullptr))
+                    {
+                        m_stream->write(out.data(), static_cast<std::streamsize>(out.size()));
+                        m_stream->flush();
+                    }
+                }
+
+                std::mutex                               m_lock;
+                std::condition_variable                  m_cv;
+                std::thread                              m_thread;
+                bool                                     m_stop = false;
+                bool                                     m_running = false;
+                std::atomic<uint64_t>                    m_generation { 0 };
+                std::ostream*                            m_stream = nullptr;
+                std::vector<std::shared_ptr<TraceRing>>  m_rings;
+                // Strings already written to the current file
+                std::unordered_set<uint64_t>             m_strings;
+            };
+
+            struct RingHolder
+            {
+                ~RingHolder()
+                {
+                    if (ring)
+                    {
+                        ring->orphaned.store(true, std::memory_order_release);
+                    }
+                }
+
+                std::shared_ptr<TraceRing> ring;
+            };
+
+            thread_local RingHolder t_ring;
+        }
+
+        void binary_log(int level, char const* component, char const* fmt, BinaryTraceArgs const& args) noexcept
+        {
+            TraceWriter& writer = TraceWriter::instance();
+            const uint64_t generation = writer.generation();
+            std::shared_ptr<TraceRing>& ring = t_ring.ring;
+            if (!ring || (ring->generation != generation))
+            {
+                if (ring)
+                {
+                    ring->orphaned.store(true, std::memory_order_release);
+                }
+                try
+                {
+                    ring = writer.registerRing(generation);
+                }
+                catch (...)
+                {
+                    ring = nullptr;
+                }
+                if (!ring)
+                {
+                    return;
+                }
+            }
+
+            uint8_t header[kHeaderSize];
+            const uint64_t time = nowNs();
+            const uint64_t componentId = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(component));
+            const uint64_t formatId = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(fmt));
+            memcpy(header, &time, sizeof(time));
+            memcpy(header + 8, &componentId, sizeof(componentId));
+            memcpy(header + 16, &formatId, sizeof(formatId));
+            header[24] = static_cast<uint8_t>(level);
+            ring->push(header, sizeof(header), args.data(), args.size());
+        }
+
+        void binary_trace_start(std::ostream& stream)
+        {
+            TraceWriter::instance().start(stream);
+            g_binaryTrace.store(true, std::memory_order_release);
+        }
+
+        void binary_trace_stop()
+        {
+            g_binaryTrace.store(false, std::memory_order_release);
+            TraceWriter::instance().stop();
+        }
+
+        namespace
+        {
+            struct TraceArg
+            {
+                char        tag = '?';
+                uint64_t    bits = 0;
+                std::string str;
+            };
+
+            template <typename T>
+            bool readValue(std::istream& in, T& value)
+            {
+                return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+            }
+
+            bool readString(std::istream& in, std::string& str)
+            {
+                uint16_t length = 0;
+                if (!readValue(in, length))
+                {
+                    return false;
+                }
+                str.resize(length);
+                return (length == 0) || static_cast<bool>(in.read(&str[0], length));
+            }
+
+            std::vector<TraceArg> parseArgs(const std::string& packed)
+            {
+                std::vector<TraceArg> args;
+                size_t i = 0;
+                while (i < packed.size())
+                {
+                    TraceArg arg;
+                    arg.tag = packed[i++];
+                    if (arg.tag == 's')
+                    {
+                        uint16_t length = 0;
+                        if (i + sizeof(length) > packed.size())
+                        {
+                            break;
+                        }
+                        memcpy(&length, packed.data() + i, sizeof(length));
+                        i += sizeof(length);
+                        arg.str = packed.substr(i, length);
+                        i += length;
+                    }
+                    else if (arg.tag != '?')
+                    {
+                        if (i + sizeof(arg.bits) > packed.size())
+                        {
+                            break;
+                        }
+                        memcpy(&arg.bits, packed.data() + i, sizeof(arg.bits));
+                        i += sizeof(arg.bits);
+                    }
+                    args.push_back(std::move(arg));
+                }
+                return args;
+            }
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable:4996)
+#endif
+            template <typename T>
+            void appendFormatted(std::string& out, const std::string& spec, T value)
+            {
+                char buffer[1024];
+                const int length = snprintf(buffer, sizeof(buffer), spec.c_str(), value);
+                if (length > 0)
+                {
+                    out.append(buffer, std::min<size_t>(static_cast<size_t>(length), sizeof(buffer) - 1));
+                }
+            }
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+            double asDouble(const TraceArg& arg)
+            {
+                if (arg.tag == 'd')
+                {
+                    double value;
+                    memcpy(&value, &arg.bits, sizeof(value));
+                    return value;
+                }
+                return (arg.tag == 'i') ? static_cast<double>(static_cast<int64_t>(arg.bits)) : static_cast<double>(arg.bits);
+            }
+
+            int64_t asInt(const TraceArg& arg)
+            {
+                return (arg.tag == 'd') ? static_cast<int64_t>(asDouble(arg)) : static_cast<int64_t>(arg.bits);
+            }
+
+            /// <summary>
+            /// printf-style rendering of a format string with recorded arguments.
+            /// Length modifiers are replaced, since integers are recorded as 64 bits.
+            /// </summary>
+            std::string formatMessage(const std::string& fmt, const std::vector<TraceArg>& args)
+            {
+                std::string out;
+                size_t next = 0;
+                size_t i = 0;
+                while (i < fmt.size())
+                {
+                    if (fmt[i] != '%')
+                    {
+                        out.push_back(fmt[i++]);
+                        continue;
+                    }
+                    if ((i + 1 < fmt.size()) && (fmt[i + 1] == '%'))
+                    {
+                        out.push_back('%');
+                        i += 2;
+                        continue;
+                    }
+
+                    std::string spec = "%";
+                    i++;
+                    while ((i < fmt.size()) && strchr("-+ #0", fmt[i]) != nullptr)
+                    {
+                        spec.push_back(fmt[i++]);
+                    }
+                    // Width and precision, '*' takes an argument
+                    for (int part = 0; part < 2; part++)
+                    {
+                        if ((part == 1) && ((i >= fmt.size()) || (fmt[i] != '.')))
+                        {
+                            break;
+                        }
+                        if (part == 1)
+                        {
+                            spec.push_back(fmt[i++]);
+                        }
+                        if ((i < fmt.size()) && (fmt[i] == '*'))
+                        {
+                            spec += std::to_string((next < args.size()) ? asInt(args[next]) : 0);
+                            next++;
+                            i++;
+                        }
+                        while ((i < fmt.size()) && isdigit(static_cast<unsigned char>(fmt[i])))
+                        {
+                            spec.push_back(fmt[i++]);
+                        }
+                    }
+                    while ((i < fmt.size()) && strchr("hlLqjzt", fmt[i]) != nullptr)
+                    {
+                        i++;
+                    }
+                    if ((i + 2 < fmt.size()) && (fmt[i] == 'I') && isdigit(static_cast<unsigned char>(fmt[i + 1])))
+                    {
+                        i += 3; // I32, I64
+                    }
+                    else if ((i < fmt.size()) && (fmt[i] == 'I'))
+                    {
+                        i++;
+                    }
+                    if (i >= fmt.size())
+                    {
+                        out += spec;
+                        break;
+                    }
+
+                    const char conversion = fmt[i++];
+                    if (next >= args.size() || (args[next].tag == '?'))
+                    {
+                        out += "<?>";
+                        next++;
+                        continue;
+                    }
+                    const TraceArg& arg = args[next++];
+                    switch (conversion)
+                    {
+                    case 'd':
+                    case 'i':
+                        appendFormatted(out, spec + "lld", static_cast<long long>(asInt(arg)));
+                        break;
+                    case 'u':
+                    case 'o':
+                    case 'x':
+                    case 'X':
+                        appendFormatted(out, spec + "ll" + conversion, static_cast<unsigned long long>(asInt(arg)));
+                        break;
+                    case 'c':
+                        appendFormatted(out, spec + "c", static_cast<int>(asInt(arg)));
+                        break;
+                    case 'e':
+                    case 'E':
+                    case 'f':
+                    case 'F':
+                    case 'g':
+                    case 'G':
+                    case 'a':
+                    case 'A':
+                        appendFormatted(out, spec + conversion, asDouble(arg));
+                        break;
+                    case 's':
+                        if (arg.tag == 's')
+                        {
+                            appendFormatted(out, spec + "s", arg.str.c_str());
+                        }
+                        else
+                        {
+                            out += "<?>";
+                        }
+                        break;
+                    case 'p':
+                        appendFormatted(out, "0x%llx", static_cast<unsigned long long>(arg.bits));
+                        break;
+                    default:
+                        out += spec;
+                        out.push_back(conversion);
+                        break;
+                    }
+                }
+                return out;
+            }
+
+            void appendLinePrefix(std::string& line, uint64_t timeNs, uint64_t tid, char level, const std::string& component)
+            {
+                const time_t seconds = static_cast<time_t>(timeNs / 1000000000ULL);
+                struct tm utc = {};
+#ifdef _WIN32
+                gmtime_s(&utc, &seconds);
+#else
+                gmtime_r(&seconds, &utc);
+#endif
+                char buffer[64];
+                snprintf(buffer, sizeof(buffer), "%04d-%02d-%02dT%02d:%02d:%02d.%03uZ|%08llu|%c|",
+                    utc.tm_year + 1900, utc.tm_mon + 1, utc.tm_mday, utc.tm_hour, utc.tm_min, utc.tm_sec,
+                    static_cast<unsigned>((timeNs / 1000000ULL) % 1000), static_cast<unsigned long long>(tid), level);
+                line += buffer;
+                line += component;
+                line += "|";
+            }
+        }
+
+        bool decode_binary_trace(std::istream& in, std::ostream& out)
+        {
+            static char const levels[] = "?EWID";
+
+            char magic[sizeof(kMagic)];
+            uint32_t marker = 0;
+            if (!in.read(magic, sizeof(magic)) || (memcmp(magic, kMagic, sizeof(kMagic)) != 0) ||
+                !readValue(in, marker) || (marker != kByteOrderMarker))
+            {
+                return false;
+            }
+
+            std::unordered_map<uint64_t, std::string> strings;
+            std::string line;
+            for (;;)
+            {
+                const int type = in.get();
+                if (type == std::char_traits<char>::eof())
+                {
+                    return true;
+                }
+
+                uint64_t time = 0, tid = 0;
+                if (type == kRecordString)
+                {
+                    uint64_t id = 0;
+                    std::string str;
+                    if (!readValue(in, id) || !readString(in, str))
+                    {
+                        return false;
+                    }
+                    strings[id] = std::move(str);
+                }
+                else if (type == kRecordEvent)
+                {
+                    uint8_t level = 0;
+                    uint64_t component = 0, format = 0;
+                    std::string packed;
+                    if (!readValue(in, time) || !readValue(in, tid) || !readValue(in, level) ||
+                        !readValue(in, component) || !readValue(in, format) || !readString(in, packed))
+                    {
+                        return false;
+                    }
+                    line.clear();
+                    appendLinePrefix(line, time, tid, levels[(level < 5) ? level : 0], strings[component]);
+                    line += formatMessage(strings[format], parseArgs(packed));
+                    line += "\n";
+                    out << line;
+                }
+                else if (type == kRecordDropped)
+                {
+                    uint64_t count = 0;
+                    if (!readValue(in, time) || !readValue(in, tid) || !readValue(in, count))
+                    {
+                        return false;
+                    }
+                    line.clear();
+                    appendLinePrefix(line, time, tid, 'W', "MATSDK.Trace");
+                    line += std::to_string(count) + " trace points dropped, ring buffer full\n";
+                    out << line;
+                }
+                else
+                {
+                    return false;
+                }
+            }
+        }
+
+    } // namespace detail
+
+} PAL_NS_END
@@ -0,0 +1,174 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef BINARYTRACE_HPP
+#define BINARYTRACE_HPP
+
+#include "ctmacros.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iosfwd>
+#include <string>
+#include <type_traits>
+
+namespace PAL_NS_BEGIN
+{
+    namespace detail
+    {
+        /// <summary>
+        /// Trace point arguments packed by type, without formatting. Each
+        /// argument is a tag byte followed by its value: 'i' int64, 'u' uint64,
+        /// 'd' double, 'p' pointer as uint64, 's' uint16 length and the
+        /// characters, '?' for a type that cannot be recorded.
+        /// </summary>
+        class BinaryTraceArgs
+        {
+        public:
+            static constexpr size_t Capacity = 448;
+            static constexpr size_t MaxStringLength = 256;
+
+            void put(uint8_t tag, const void* value, size_t size) noexcept
+            {
+                if (m_size + 1 + size > Capacity)
+                {
+                    return;
+                }
+                m_data[m_size++] = tag;
+                if (size != 0)
+                {
+                    memcpy(m_data + m_size, value, size);
+                    m_size += size;
+                }
+            }
+
+            void putString(const char* str) noexcept
+            {
+                if (str == nullptr)
+                {
+                    str = "(null)";
+                }
+                if (m_size + 3 > Capacity)
+                {
+                    return;
+                }
+                size_t length = strnlen(str, MaxStringLength);
+                if (length > Capacity - m_size - 3)
+                {
+                    length = Capacity - m_size - 3;
+                }
+                const uint16_t length16 = static_cast<uint16_t>(length);
+                m_data[m_size++] = 's';
+                memcpy(m_data + m_size, &length16, sizeof(length16));
+                m_size += sizeof(length16);
+                memcpy(m_data + m_size, str, length);
+                m_size += length;
+            }
+
+            const uint8_t* data() const noexcept { return m_data; }
+            size_t size() const noexcept { return m_size; }
+
+        private:
+            uint8_t m_data[Capacity];
+            size_t  m_size = 0;
+        };
+
+        template <typename T>
+        inline typename std::enable_if<(std::is_integral<T>::value && std::is_signed<T>::value) || std::is_enum<T>::value>::type
+        encodeTraceArg(BinaryTraceArgs& args, T value) noexcept
+        {
+            const int64_t v = static_cast<int64_t>(value);
+            args.put('i', &v, sizeof(v));
+        }
+
+        template <typename T>
+        inline typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type
+        encodeTraceArg(BinaryTraceArgs& args, T value) noexcept
+        {
+            const uint64_t v = static_cast<uint64_t>(value);
+            args.put('u', &v, sizeof(v));
+        }
+
+        template <typename T>
+        inline typename std::enable_if<std::is_floating_point<T>::value>::type
+        encodeTraceArg(BinaryTraceArgs& args, T value) noexcept
+        {
+            const double v = static_cast<double>(value);
+            args.put('d', &v, sizeof(v));
+        }
+
+        template <typename T>
+        inline typename std::enable_if<std::is_pointer<T>::value>::type
+        encodeTraceArg(BinaryTraceArgs& args, T value) noexcept
+        {
+            const uint64_t v = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value));
+            args.put('p', &v, sizeof(v));
+        }
+
+        // Strings are copied: the writer runs after the caller's buffer is gone
+        inline void encodeTraceArg(BinaryTraceArgs& args, const char* value) noexcept
+        {
+            args.putString(value);
+        }
+
+        inline void encodeTraceArg(BinaryTraceArgs& args, char* value) noexcept
+        {
+            args.putString(value);
+        }
+
+        inline void encodeTraceArg(BinaryTraceArgs& args, std::nullptr_t) noexcept
+        {
+            const uint64_t v = 0;
+            args.put('p', &v, sizeof(v));
+        }
+
+        template <typename T>
+        inline typename std::enable_if<!std::is_arithmetic<T>::value && !std::is_enum<T>::value && !std::is_pointer<T>::value>::type
+        encodeTraceArg(BinaryTraceArgs& args, const T&) noexcept
+        {
+            args.put('?', nullptr, 0);
+        }
+
+        inline void encodeTraceArgs(BinaryTraceArgs&) noexcept
+        {
+        }
+
+        template <typename T, typename... Rest>
+        inline void encodeTraceArgs(BinaryTraceArgs& args, const T& value, const Rest&... rest) noexcept
+        {
+            encodeTraceArg(args, value);
+            encodeTraceArgs(args, rest...);
+        }
+
+        /// <summary>
+        /// True while binary tracing is running. Set by log_init.
+        /// </summary>
+        extern std::atomic<bool> g_binaryTrace;
+
+        /// <summary>
+        /// Append a trace point to the ring buffer of the calling thread.
+        /// Records that do not fit are counted as dropped.
+        /// </summary>
+        void binary_log(int level, char const* component, char const* fmt, BinaryTraceArgs const& args) noexcept;
+
+        /// <summary>
+        /// Start or stop the writer thread that drains the ring buffers into
+        /// the stream. The stream must stay open until binary_trace_stop returns.
+        /// </summary>
+        void binary_trace_start(std::ostream& stream);
+        void binary_trace_stop();
+
+        /// <summary>
+        /// Render a binary trace as text lines in the format of the text trace.
+        /// Returns false when the input is not a binary trace or is truncated.
+        /// </summary>
+        bool decode_binary_trace(std::istream& in, std::ostream& out);
+
+    } // namespace detail
+
+} PAL_NS_END
+
+#endif
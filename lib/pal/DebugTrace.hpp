@@ -9,6 +9,7 @@
 
 #include "ctmacros.hpp"
 #include "typename.hpp"
+#include "BinaryTrace.hpp"
 
 namespace PAL_NS_BEGIN
 {
@@ -53,6 +54,23 @@ namespace PAL_NS_BEGIN
     namespace detail {
         extern LogLevel g_logLevel;
         extern void log(LogLevel level, char const* component, char const* fmt, ...);
+
+        /// <summary>
+        /// Record a trace point in the binary trace when it runs, otherwise
+        /// format it as text.
+        /// </summary>
+        template <typename... Args>
+        inline void trace(LogLevel level, char const* component, char const* fmt, Args... args)
+        {
+            if (g_binaryTrace.load(std::memory_order_relaxed))
+            {
+                BinaryTraceArgs packed;
+                encodeTraceArgs(packed, args...);
+                binary_log(level, component, fmt, packed);
+                return;
+            }
+            log(level, component, fmt, args...);
+        }
     } // namespace detail
 
 #define MATSDK_SET_LOG_LEVEL_(level_) (PAL::detail::g_logLevel = (level_))
@@ -68,7 +86,7 @@ namespace PAL_NS_BEGIN
 // Log a message on a specific level, which is checked efficiently before evaluating arguments
 #define MATSDK_LOG_(level_, comp_, fmt_, ...)                                    \
     if (MATSDK_LOG_ENABLED_(level_)) {                                           \
-        PAL::detail::log((level_), (comp_), (fmt_), ##__VA_ARGS__); \
+        PAL::detail::trace((level_), (comp_), (fmt_), ##__VA_ARGS__); \
     } else static_cast<void>(0)
 
 } PAL_NS_END // namespace PAL
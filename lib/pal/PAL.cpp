@@ -101,7 +101,7 @@ namespace PAL_NS_BEGIN {
         std::string                   debugLogPath;
         std::unique_ptr<std::fstream> debugLogStream;
 
-        bool log_init(bool isTraceEnabled, const std::string& traceFolderPath)
+        bool log_init(bool isTraceEnabled, const std::string& traceFolderPath, bool isBinaryTrace)
         {
             if (!isTraceEnabled)
             {
@@ -137,16 +137,21 @@ namespace PAL_NS_BEGIN {
             }
             debugLogPath += "mat-debug-";
             debugLogPath += std::to_string(MAT::GetCurrentProcessId());
-            debugLogPath += ".log";
+            debugLogPath += isBinaryTrace ? ".bin" : ".log";
 
             debugLogStream = std::unique_ptr<std::fstream>(new std::fstream());
-            debugLogStream->open(debugLogPath, std::fstream::out);
+            debugLogStream->open(debugLogPath, isBinaryTrace ? (std::fstream::out | std::fstream::binary) : std::fstream::out);
             if (!debugLogStream->is_open())
             {
                 // If file cannot be created, log to /dev/null
                 debugLogStream->open(DEBUG_LOG_NULL);
                 result = false;
             }
+            else if (isBinaryTrace)
+            {
+                // Trace points are recorded unformatted and written by a background thread
+                binary_trace_start(*debugLogStream);
+            }
             debugLogMutex.unlock();
             return result;
         }
@@ -163,6 +168,7 @@ namespace PAL_NS_BEGIN {
 
         void log_done()
         {
+            binary_trace_stop();
             debugLogMutex.lock();
             if (debugLogStream)
             {
@@ -172,7 +178,7 @@ namespace PAL_NS_BEGIN {
             debugLogMutex.unlock();
         }
 #else
-        bool log_init(bool /*isTraceEnabled*/, const std::string& /*traceFolderPath*/)
+        bool log_init(bool /*isTraceEnabled*/, const std::string& /*traceFolderPath*/, bool /*isBinaryTrace*/)
         {
             return false;
         }
@@ -623,7 +629,12 @@ namespace PAL_NS_BEGIN {
                 traceFolderPath = static_cast<std::string&>(configuration[CFG_STR_TRACE_FOLDER_PATH]);
             }
 
-            detail::isLoggingInited = detail::log_init(configuration[CFG_BOOL_ENABLE_TRACE], traceFolderPath);
+            std::string traceFormat;
+            if (configuration.HasConfig(CFG_STR_TRACE_FORMAT))
+            {
+                traceFormat = static_cast<std::string&>(configuration[CFG_STR_TRACE_FORMAT]);
+            }
+            detail::isLoggingInited = detail::log_init(configuration[CFG_BOOL_ENABLE_TRACE], traceFolderPath, traceFormat == "binary");
             LOG_TRACE("Initializing...");
             m_SystemInformation = SystemInformationImpl::Create(configuration);
             m_DeviceInformation = DeviceInformationImpl::Create(configuration);
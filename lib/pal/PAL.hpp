@@ -242,7 +242,7 @@ namespace PAL_NS_BEGIN
 #ifdef HAVE_MAT_LOGGING
     namespace detail
     {
-        bool log_init(bool isTraceEnabled, const std::string& traceFolderPath);
+        bool log_init(bool isTraceEnabled, const std::string& traceFolderPath, bool isBinaryTrace = false);
         const std::unique_ptr<std::fstream>& getDebugLogStream() noexcept;
         const std::string& getDebugLogPath() noexcept;
         void log_done();
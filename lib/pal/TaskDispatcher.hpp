@@ -102,13 +102,50 @@ namespace PAL_NS_BEGIN {
         }
     };
 
+    namespace detail {
+
+        /// <summary>
+        /// Strand of the task that the calling thread is passing to Queue(), or
+        /// zero. Dispatchers that use more than one thread run the tasks of one
+        /// strand one at a time, in queue order. It travels beside the task so
+        /// that the layout of the public MAT::Task does not change.
+        /// </summary>
+        inline uint64_t& queuedStrandKey()
+        {
+            static thread_local uint64_t strandKey = 0;
+            return strandKey;
+        }
+
+        inline void queueOnStrand(MAT::ITaskDispatcher* taskDispatcher, MAT::Task* task, uint64_t strandKey)
+        {
+            uint64_t& queued = queuedStrandKey();
+            const uint64_t outer = queued;
+            queued = strandKey;
+            taskDispatcher->Queue(task);
+            queued = outer;
+        }
+
+        /// <summary>
+        /// Every SDK component that queues work (TransmissionPolicyManager,
+        /// HttpClientManager, OfflineStorageHandler, Statistics) is its own
+        /// strand. They guard the state they share with their own locks, as
+        /// application threads call into them too, so different components
+        /// run in parallel while the work of one stays in order.
+        /// </summary>
+        template<typename TObject>
+        uint64_t componentStrand(TObject* obj)
+        {
+            return reinterpret_cast<uintptr_t>(obj);
+        }
+    }
+
     template<typename TObject, typename... TFuncArgs, typename... TPassedArgs>
     void dispatchTask(MAT::ITaskDispatcher* taskDispatcher, TObject* obj, void (TObject::*func)(TFuncArgs...), TPassedArgs&&... args)
     {
         assert(obj != nullptr);
         auto bound = std::bind(std::mem_fn(func), obj, std::forward<TPassedArgs>(args)...);
         MAT::Task* task = new detail::TaskCall<decltype(bound)>(bound);
-        taskDispatcher->Queue(task);
+        detail::queueOnStrand(taskDispatcher, task, detail::componentStrand(obj));
     }
 
     template<typename TObject, typename... TFuncArgs, typename... TPassedArgs>
@@ -122,7 +159,7 @@ namespace PAL_NS_BEGIN {
     {
         auto bound = std::bind(std::mem_fn(func), obj, std::forward<TPassedArgs>(args)...);
         auto task = new detail::TaskCall<decltype(bound)>(bound, getMonotonicTimeMs() + (int64_t)delayMs);
-        taskDispatcher->Queue(task);
+        detail::queueOnStrand(taskDispatcher, task, detail::componentStrand(obj));
         return DeferredCallbackHandle(task, taskDispatcher);
     }
 
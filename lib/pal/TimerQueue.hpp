@@ -0,0 +1,174 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef TIMER_QUEUE_HPP
+#define TIMER_QUEUE_HPP
+
+#include <cstddef>
+#include <stdint.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ITaskDispatcher.hpp"
+#include "ctmacros.hpp"
+
+namespace PAL_NS_BEGIN {
+
+    /// <summary>
+    /// Indexed binary min-heap of timed tasks ordered by TargetTime, with ties
+    /// broken by insertion order. The task pointer doubles as the handle: the
+    /// heap keeps each task's position, so push, pop and erase are all
+    /// O(log n) instead of a linear walk over a sorted list.
+    /// Not thread-safe; callers hold their dispatcher lock.
+    /// </summary>
+    class TimerQueue
+    {
+    public:
+        bool empty() const
+        {
+            return m_heap.empty();
+        }
+
+        size_t size() const
+        {
+            return m_heap.size();
+        }
+
+        bool contains(MAT::Task* task) const
+        {
+            return m_index.find(task) != m_index.end();
+        }
+
+        /// <summary>
+        /// Task with the earliest TargetTime. The queue must not be empty.
+        /// </summary>
+        MAT::Task* top() const
+        {
+            return m_heap.front().task;
+        }
+
+        /// <summary>
+        /// Deadline the task had when it was pushed. The queue must not be empty.
+        /// </summary>
+        uint64_t topTime() const
+        {
+            return m_heap.front().targetTime;
+        }
+
+        void push(MAT::Task* task)
+        {
+            m_index[task] = m_heap.size();
+            m_heap.push_back(Entry { task->TargetTime, m_sequence++, task });
+            siftUp(m_heap.size() - 1);
+        }
+
+        MAT::Task* pop()
+        {
+            MAT::Task* task = m_heap.front().task;
+            removeAt(0);
+            return task;
+        }
+
+        /// <summary>
+        /// Removes the task if it is queued. Returns false if it was not.
+        /// </summary>
+        bool erase(MAT::Task* task)
+        {
+            auto it = m_index.find(task);
+            if (it == m_index.end())
+            {
+                return false;
+            }
+            removeAt(it->second);
+            return true;
+        }
+
+    protected:
+        struct Entry
+        {
+            uint64_t   targetTime;
+            uint64_t   sequence;
+            MAT::Task* task;
+        };
+
+        bool earlier(size_t a, size_t b) const
+        {
+            return (m_heap[a].targetTime != m_heap[b].targetTime)
+                ? (m_heap[a].targetTime < m_heap[b].targetTime)
+                : (m_heap[a].sequence < m_heap[b].sequence);
+        }
+
+        void swapEntries(size_t a, size_t b)
+        {
+            std::swap(m_heap[a], m_heap[b]);
+            m_index[m_heap[a].task] = a;
+            m_index[m_heap[b].task] = b;
+        }
+
+        void siftUp(size_t i)
+        {
+            while (i > 0)
+            {
+                size_t parent = (i - 1) / 2;
+                if (!earlier(i, parent))
+                {
+                    break;
+                }
+                swapEntries(i, parent);
+                i = parent;
+            }
+        }
+
+        void siftDown(size_t i)
+        {
+            for (;;)
+            {
+                size_t smallest = i;
+                size_t left = 2 * i + 1;
+                size_t right = left + 1;
+                if (left < m_heap.size() && earlier(left, smallest))
+                {
+                    smallest = left;
+                }
+                if (right < m_heap.size() && earlier(right, smallest))
+                {
+                    smallest = right;
+                }
+                if (smallest == i)
+                {
+                    break;
+                }
+                swapEntries(i, smallest);
+                i = smallest;
+            }
+        }
+
+        void removeAt(size_t i)
+        {
+            m_index.erase(m_heap[i].task);
+            const size_t last = m_heap.size() - 1;
+            if (i != last)
+            {
+                m_heap[i] = m_heap[last];
+                m_index[m_heap[i].task] = i;
+                m_heap.pop_back();
+                // The moved entry may belong above or below its new slot.
+                siftUp(i);
+                siftDown(i);
+            }
+            else
+            {
+                m_heap.pop_back();
+            }
+        }
+
+        std::vector<Entry> m_heap;
+        std::unordered_map<MAT::Task*, size_t> m_index;
+        uint64_t m_sequence = 0;
+    };
+
+} PAL_NS_END
+
+#endif
@@ -0,0 +1,560 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+// clang-format off
+#include "pal/WorkStealingTaskDispatcher.hpp"
+#include "pal/PAL.hpp"
+#include "pal/TaskDispatcher.hpp"
+#include "pal/TimerQueue.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#if defined(MATSDK_PAL_CPP11) || defined(MATSDK_PAL_WIN32)
+
+/* Maximum scheduler interval for SDK is 1 hour required for clamping in case of monotonic clock drift */
+#define MAX_FUTURE_DELTA_MS (60 * 60 * 1000)
+
+/* Upper bound on a single idle wait. Guards against a lost wake-up turning into a stall. */
+#define MAX_IDLE_WAIT_MS    100
+
+namespace PAL_NS_BEGIN {
+
+    class WorkStealingTaskDispatcher;
+
+    namespace {
+        // Identifies the pool and worker a thread belongs to, so that tasks
+        // queued from a worker land on that worker's own deque.
+        thread_local WorkStealingTaskDispatcher* t_pool = nullptr;
+        thread_local size_t t_workerIndex = 0;
+    }
+
+    class WorkStealingTaskDispatcher : public ITaskDispatcher
+    {
+    protected:
+        // A ready item is either an unordered task or a strand with pending work.
+        struct WorkItem
+        {
+            MAT::Task* task;
+            uint64_t   strandKey;
+        };
+
+        struct Worker
+        {
+            std::mutex           lock;
+            std::deque<WorkItem> items;
+            std::thread          thread;
+        };
+
+        std::vector<std::unique_ptr<Worker>> m_workers;
+        std::atomic<size_t>   m_nextWorker;
+
+        // Pending tasks per strand key. A key is present while its strand
+        // is queued or running, so at most one worker drains it at a time.
+        std::mutex            m_strandLock;
+        std::unordered_map<uint64_t, std::deque<MAT::Task*>> m_strands;
+
+        // Guards the timer heap and the strand of each timer, the due timed
+        // tasks that can still be cancelled and the task each worker is
+        // currently running.
+        std::mutex            m_lock;
+        std::condition_variable m_taskDone;
+        TimerQueue            m_timers;
+        std::unordered_map<MAT::Task*, uint64_t> m_timerStrands;
+        std::unordered_set<MAT::Task*> m_pendingTimers;
+        std::vector<MAT::Task*> m_running;
+        std::atomic<uint64_t> m_nextTimerDue;
+
+        std::mutex            m_idleLock;
+        std::condition_variable m_idle;
+        std::atomic<size_t>   m_readyCount;
+        std::atomic<size_t>   m_busyCount;
+        std::atomic<size_t>   m_sleepingWorkers;
+        std::atomic<bool>     m_stopping;
+        std::atomic<bool>     m_joined;
+        // Index of the worker that joined the pool from inside a task, if
+        // any. The others must not wait for it to go idle.
+        std::atomic<size_t>   m_joiningWorker;
+
+    public:
+
+        explicit WorkStealingTaskDispatcher(size_t threadCount) :
+            m_nextWorker(0),
+            m_nextTimerDue(UINT64_MAX),
+            m_readyCount(0),
+            m_busyCount(0),
+            m_sleepingWorkers(0),
+            m_stopping(false),
+            m_joined(false),
+            m_joiningWorker(SIZE_MAX)
+        {
+            threadCount = std::max<size_t>(threadCount, 1);
+            m_running.resize(threadCount, nullptr);
+            for (size_t i = 0; i < threadCount; i++)
+            {
+                m_workers.emplace_back(new Worker());
+            }
+            // Start threads only once every deque exists: workers steal from each other.
+            for (size_t i = 0; i < threadCount; i++)
+            {
+                m_workers[i]->thread = std::thread(&WorkStealingTaskDispatcher::threadFunc, this, i);
+            }
+            LOG_INFO("Started task pool with %u threads", static_cast<unsigned>(threadCount));
+        }
+
+        ~WorkStealingTaskDispatcher()
+        {
+            Join();
+            // A worker that joined the pool from a task drains what is left
+            // once that task returns.
+            for (auto& worker : m_workers)
+            {
+                try {
+                    if (!worker->thread.joinable())
+                    {
+                        continue;
+                    }
+                    if (worker->thread.get_id() == std::this_thread::get_id())
+                    {
+                        worker->thread.detach();
+                    }
+                    else
+                    {
+                        worker->thread.join();
+                    }
+                }
+                catch (...) {};
+            }
+        }
+
+        void Join() final
+        {
+            if (m_joined.exchange(true))
+            {
+                return;
+            }
+            const bool fromWorker = isWorkerThread();
+            if (fromWorker)
+            {
+                m_joiningWorker = t_workerIndex;
+            }
+            m_stopping = true;
+            {
+                std::lock_guard<std::mutex> lock(m_idleLock);
+                m_idle.notify_all();
+            }
+
+            // Workers drain ready work before they exit.
+            for (size_t i = 0; i < m_workers.size(); i++)
+            {
+                // The calling worker is still inside a task. It drains what is
+                // left, including the rest of its strand, once the task returns,
+                // and is joined by the destructor.
+                std::thread& thread = m_workers[i]->thread;
+                try {
+                    if (thread.joinable() && !(fromWorker && (i == t_workerIndex)))
+                    {
+                        thread.join();
+                    }
+                }
+                catch (...) {};
+            }
+            if (!fromWorker)
+            {
+                dropPending();
+            }
+        }
+
+        void Queue(MAT::Task* item) final
+        {
+            if (item == nullptr)
+            {
+                return;
+            }
+            // Set by the PAL helpers for the duration of this call
+            const uint64_t strandKey = detail::queuedStrandKey();
+            if (m_joined && !isWorkerThread())
+            {
+                LOG_WARN("Task pool already joined, dropping item=%p", item);
+                delete item;
+                return;
+            }
+            if (item->Type == MAT::Task::Shutdown)
+            {
+                // Shutdown is expressed through Join() for the pool.
+                delete item;
+                return;
+            }
+
+            if (item->Type == MAT::Task::TimedCall)
+            {
+                const uint64_t now = getMonotonicTimeMs();
+                if (item->TargetTime > now)
+                {
+                    if (item->TargetTime - now > MAX_FUTURE_DELTA_MS)
+                    {
+                        item->TargetTime = now + MAX_FUTURE_DELTA_MS;
+                    }
+                    bool earliest;
+                    {
+                        std::lock_guard<std::mutex> lock(m_lock);
+                        m_timers.push(item);
+                        if (strandKey != 0)
+                        {
+                            m_timerStrands[item] = strandKey;
+                        }
+                        earliest = (item->TargetTime < m_nextTimerDue.load());
+                        if (earliest)
+                        {
+                            m_nextTimerDue = item->TargetTime;
+                        }
+                    }
+                    if (earliest)
+                    {
+                        // A sleeping worker may be waiting for a later deadline.
+                        std::lock_guard<std::mutex> lock(m_idleLock);
+                        m_idle.notify_one();
+                    }
+                    return;
+                }
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_pendingTimers.insert(item);
+            }
+            enqueue(item, strandKey);
+        }
+
+        // Cancel a task or wait for task completion for up to waitTime ms.
+        // Mirrors the single worker thread: timed tasks that have not started
+        // are removed, a running task is waited for (unless it is the caller's
+        // own task), and anything else is reported as cancelled.
+        bool Cancel(MAT::Task* item, uint64_t waitTime) override
+        {
+            if (item == nullptr)
+            {
+                return false;
+            }
+
+            std::unique_lock<std::mutex> lock(m_lock);
+            if (m_timers.erase(item))
+            {
+                m_timerStrands.erase(item);
+                delete item;
+                return true;
+            }
+            if (m_pendingTimers.erase(item) > 0)
+            {
+                // Already due: the task is freed when a worker dequeues it.
+                return true;
+            }
+
+            auto runningOn = [this, item]() -> size_t {
+                for (size_t i = 0; i < m_running.size(); i++)
+                {
+                    if (m_running[i] == item)
+                    {
+                        return i;
+                    }
+                }
+                return SIZE_MAX;
+            };
+
+            const size_t worker = runningOn();
+            if (worker == SIZE_MAX)
+            {
+                return true;
+            }
+            if (isWorkerThread() && t_workerIndex == worker)
+            {
+                // The SDK may attempt to cancel itself from within its own task.
+                return true;
+            }
+            if (waitTime > 0)
+            {
+                m_taskDone.wait_for(lock, std::chrono::milliseconds(waitTime), [&runningOn]() { return runningOn() == SIZE_MAX; });
+            }
+            return runningOn() == SIZE_MAX;
+        }
+
+    protected:
+        // Frees the timers that never came due and anything still queued
+        // once no worker is left to run it.
+        void dropPending()
+        {
+            size_t dropped = 0;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                while (!m_timers.empty())
+                {
+                    delete m_timers.pop();
+                    dropped++;
+                }
+                m_timerStrands.clear();
+                m_pendingTimers.clear();
+            }
+            for (auto& worker : m_workers)
+            {
+                std::lock_guard<std::mutex> lock(worker->lock);
+                for (auto const& item : worker->items)
+                {
+                    delete item.task;
+                    dropped += (item.task != nullptr) ? 1 : 0;
+                }
+                worker->items.clear();
+            }
+            {
+                std::lock_guard<std::mutex> lock(m_strandLock);
+                for (auto& strand : m_strands)
+                {
+                    for (auto task : strand.second)
+                    {
+                        delete task;
+                        dropped++;
+                    }
+                }
+                m_strands.clear();
+            }
+            if (dropped > 0)
+            {
+                LOG_WARN("Task pool joined with %u tasks that never ran", static_cast<unsigned>(dropped));
+            }
+        }
+
+        bool isWorkerThread() const
+        {
+            return t_pool == this;
+        }
+
+        // Tasks queued without PAL::dispatchTask / scheduleTask have no strand.
+        void enqueue(MAT::Task* task, uint64_t key)
+        {
+            if (key != 0)
+            {
+                std::lock_guard<std::mutex> lock(m_strandLock);
+                auto it = m_strands.find(key);
+                if (it != m_strands.end())
+                {
+                    // The strand is already queued or running and will pick this up.
+                    it->second.push_back(task);
+                    return;
+                }
+                m_strands[key].push_back(task);
+            }
+            push(WorkItem { (key != 0) ? nullptr : task, key });
+        }
+
+        void push(WorkItem const& item)
+        {
+            const size_t index = isWorkerThread() ? t_workerIndex : (m_nextWorker.fetch_add(1) % m_workers.size());
+            {
+                Worker& worker = *m_workers[index];
+                std::lock_guard<std::mutex> lock(worker.lock);
+                worker.items.push_back(item);
+            }
+            m_readyCount.fetch_add(1, std::memory_order_seq_cst);
+            // Producers only touch the idle lock when a worker is actually parked.
+            if (m_sleepingWorkers.load(std::memory_order_seq_cst) > 0)
+            {
+                std::lock_guard<std::mutex> lock(m_idleLock);
+                m_idle.notify_one();
+            }
+        }
+
+        bool popLocal(size_t index, WorkItem& item)
+        {
+            Worker& worker = *m_workers[index];
+            std::lock_guard<std::mutex> lock(worker.lock);
+            if (worker.items.empty())
+            {
+                return false;
+            }
+            item = worker.items.front();
+            worker.items.pop_front();
+            return true;
+        }
+
+        bool steal(size_t index, WorkItem& item)
+        {
+            for (size_t i = 1; i < m_workers.size(); i++)
+            {
+                Worker& victim = *m_workers[(index + i) % m_workers.size()];
+                std::lock_guard<std::mutex> lock(victim.lock);
+                if (!victim.items.empty())
+                {
+                    item = victim.items.back();
+                    victim.items.pop_back();
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Moves due timers to the ready queues and returns how long a worker
+        // with nothing to do may sleep.
+        unsigned promoteDueTimers()
+        {
+            const uint64_t now = getMonotonicTimeMs();
+            uint64_t nextDue = m_nextTimerDue.load();
+            if (nextDue > now)
+            {
+                return static_cast<unsigned>(std::min<uint64_t>(nextDue - now, MAX_IDLE_WAIT_MS));
+            }
+
+            std::vector<WorkItem> due;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                while (!m_timers.empty() && m_timers.topTime() <= now)
+                {
+                    MAT::Task* task = m_timers.pop();
+                    m_pendingTimers.insert(task);
+                    uint64_t strandKey = 0;
+                    auto strand = m_timerStrands.find(task);
+                    if (strand != m_timerStrands.end())
+                    {
+                        strandKey = strand->second;
+                        m_timerStrands.erase(strand);
+                    }
+                    due.push_back(WorkItem { task, strandKey });
+                }
+                nextDue = m_timers.empty() ? UINT64_MAX : m_timers.topTime();
+                m_nextTimerDue = nextDue;
+            }
+            // Heap order is deadline order, so timers on one strand keep it.
+            for (auto const& item : due)
+            {
+                enqueue(item.task, item.strandKey);
+            }
+            return static_cast<unsigned>(std::min<uint64_t>(nextDue - now, MAX_IDLE_WAIT_MS));
+        }
+
+        void run(size_t index, MAT::Task* task)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (task->Type == MAT::Task::TimedCall && m_pendingTimers.erase(task) == 0)
+                {
+                    // Cancelled after it became due
+                    delete task;
+                    return;
+                }
+                m_running[index] = task;
+            }
+
+            LOG_TRACE("Execute item=%p type=%s on worker %u", task, task->TypeName.c_str(), static_cast<unsigned>(index));
+            // Same containment as the single worker thread: an exception
+            // escaping a task must not terminate the host process.
+            try {
+                (*task)();
+            }
+            catch (const std::exception& ex) {
+                LOG_ERROR("Unhandled exception in worker task: %s", ex.what());
+            }
+            catch (...) {
+                LOG_ERROR("Unhandled non-standard exception in worker task");
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_running[index] = nullptr;
+            }
+            m_taskDone.notify_all();
+            task->Type = MAT::Task::Done;
+            delete task;
+        }
+
+        void process(size_t index, WorkItem const& item)
+        {
+            if (item.task != nullptr)
+            {
+                run(index, item.task);
+                return;
+            }
+
+            MAT::Task* task;
+            {
+                std::lock_guard<std::mutex> lock(m_strandLock);
+                auto& pending = m_strands[item.strandKey];
+                task = pending.front();
+                pending.pop_front();
+            }
+            run(index, task);
+
+            bool more;
+            {
+                std::lock_guard<std::mutex> lock(m_strandLock);
+                auto it = m_strands.find(item.strandKey);
+                more = !it->second.empty();
+                if (!more)
+                {
+                    m_strands.erase(it);
+                }
+            }
+            if (more)
+            {
+                // Requeue behind other ready work so that one busy key cannot starve the rest.
+                push(item);
+            }
+        }
+
+        void threadFunc(size_t index)
+        {
+            t_pool = this;
+            t_workerIndex = index;
+            LOG_INFO("Running task pool worker %u", static_cast<unsigned>(index));
+
+            for (;;)
+            {
+                const unsigned waitMs = promoteDueTimers();
+
+                // Counted as busy before looking for work, so that Join never
+                // sees an idle pool while an item is between a deque and a worker.
+                m_busyCount.fetch_add(1, std::memory_order_seq_cst);
+                WorkItem item {};
+                if (popLocal(index, item) || steal(index, item))
+                {
+                    m_readyCount.fetch_sub(1, std::memory_order_seq_cst);
+                    process(index, item);
+                    m_busyCount.fetch_sub(1, std::memory_order_seq_cst);
+                    continue;
+                }
+                m_busyCount.fetch_sub(1, std::memory_order_seq_cst);
+
+                std::unique_lock<std::mutex> lock(m_idleLock);
+                if (m_stopping && m_readyCount.load() == 0 && m_busyCount.load() <= ((m_joiningWorker.load() != SIZE_MAX) ? 1u : 0u))
+                {
+                    m_idle.notify_all();
+                    break;
+                }
+                m_sleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+                if (m_readyCount.load(std::memory_order_seq_cst) == 0)
+                {
+                    m_idle.wait_for(lock, std::chrono::milliseconds(m_stopping ? 1 : std::max(waitMs, 1u)));
+                }
+                m_sleepingWorkers.fetch_sub(1, std::memory_order_seq_cst);
+            }
+            if (m_joiningWorker.load() == index)
+            {
+                // The other workers are gone, this one was the last to run tasks
+                dropPending();
+            }
+            t_pool = nullptr;
+        }
+    };
+
+    namespace WorkStealingTaskDispatcherFactory {
+        std::shared_ptr<ITaskDispatcher> Create(size_t threadCount)
+        {
+            return std::make_shared<WorkStealingTaskDispatcher>(threadCount);
+        }
+    }
+
+} PAL_NS_END
+
+#endif
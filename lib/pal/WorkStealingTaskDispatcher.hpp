@@ -0,0 +1,29 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef WORK_STEALING_TASK_DISPATCHER_HPP
+#define WORK_STEALING_TASK_DISPATCHER_HPP
+
+#include <cstddef>
+#include <memory>
+
+#include "ITaskDispatcher.hpp"
+#include "ctmacros.hpp"
+
+namespace PAL_NS_BEGIN {
+
+    /// <summary>
+    /// Multi-threaded alternative to the single PAL worker thread. Each worker
+    /// owns a deque and steals from the others when it runs dry; timed tasks
+    /// wait in a min-heap. Tasks of one strand run one at a time in queue order,
+    /// while tasks of different strands run in parallel. PAL::dispatchTask and
+    /// PAL::scheduleTask put each component on a strand of its own.
+    /// </summary>
+    namespace WorkStealingTaskDispatcherFactory {
+        std::shared_ptr<MAT::ITaskDispatcher> Create(size_t threadCount);
+    }
+
+} PAL_NS_END
+
+#endif
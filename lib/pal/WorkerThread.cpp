@@ -5,6 +5,7 @@
 // clang-format off
 #include "pal/WorkerThread.hpp"
 #include "pal/PAL.hpp"
+#include "pal/TimerQueue.hpp"
 
 #include <exception>
 
@@ -34,7 +35,7 @@ namespace PAL_NS_BEGIN {
         std::timed_mutex      m_execution_mutex;
 
         std::list<MAT::Task*> m_queue;
-        std::list<MAT::Task*> m_timerQueue;
+        TimerQueue            m_timerQueue;
         Event                 m_event;
         MAT::Task*            m_itemInProgress;
         int count = 0;
@@ -82,11 +83,7 @@ namespace PAL_NS_BEGIN {
             LOG_INFO("queue item=%p", &item);
             LOCKGUARD(m_lock);
             if (item->Type == MAT::Task::TimedCall) {
-                auto it = m_timerQueue.begin();
-                while (it != m_timerQueue.end() && (*it)->TargetTime < item->TargetTime) {
-                    ++it;
-                }
-                m_timerQueue.insert(it, item);
+                m_timerQueue.push(item);
             }
             else {
                 m_queue.push_back(item);
@@ -153,13 +150,9 @@ namespace PAL_NS_BEGIN {
                 return (m_itemInProgress != item);
             }
 
-            {
-                auto it = std::find(m_timerQueue.begin(), m_timerQueue.end(), item);
-                if (it != m_timerQueue.end()) {
-                    // Still in the queue
-                    m_timerQueue.erase(it);
-                    delete item;
-                }
+            if (m_timerQueue.erase(item)) {
+                // Still in the queue
+                delete item;
             }
 #if 0
             for (;;) {
@@ -192,17 +185,15 @@ namespace PAL_NS_BEGIN {
 
                     auto now = getMonotonicTimeMs();
                     if (!self->m_timerQueue.empty()) {
-                        const auto currTargetTime = self->m_timerQueue.front()->TargetTime;
+                        const auto currTargetTime = self->m_timerQueue.topTime();
                         if (currTargetTime <= now) {
                             // process the item at the front immediately
-                            item = std::unique_ptr<MAT::Task>(self->m_timerQueue.front());
-                            self->m_timerQueue.pop_front();
+                            item = std::unique_ptr<MAT::Task>(self->m_timerQueue.pop());
                         } else {
                            // timed call in future, we need to resort the items in the queue
                            const auto delta = currTargetTime - now;
                            if (delta > MAX_FUTURE_DELTA_MS) {
-                               const auto itemPtr = self->m_timerQueue.front();
-                               self->m_timerQueue.pop_front();
+                               const auto itemPtr = self->m_timerQueue.pop();
                                itemPtr->TargetTime = now + MAX_FUTURE_DELTA_MS;
                                self->Queue(itemPtr);
                                continue;
@@ -0,0 +1,351 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "PipelineStatsCollector.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <new>
+
+namespace MAT_NS_BEGIN {
+
+    constexpr unsigned PipelineStatsCollector::SubBucketBits;
+    constexpr size_t   PipelineStatsCollector::SubBucketCount;
+    constexpr unsigned PipelineStatsCollector::MaxMagnitude;
+    constexpr size_t   PipelineStatsCollector::BucketCount;
+    constexpr size_t   PipelineStatsCollector::StripeCount;
+
+    namespace
+    {
+        const char* const kStageNames[PipelineStage_Max] = {
+            "submit",
+            "queue",
+            "dispatch",
+            "serialize",
+            "store",
+            "retrieve",
+            "package",
+            "compress",
+            "encode",
+            "send",
+            "decode",
+            "delivery"
+        };
+
+        inline unsigned highestBit(uint64_t value) noexcept
+        {
+            unsigned bit = 0;
+            for (unsigned step = 32; step != 0; step >>= 1)
+            {
+                if ((value >> step) != 0)
+                {
+                    value >>= step;
+                    bit += step;
+                }
+            }
+            return bit;
+        }
+
+        inline size_t threadStripe() noexcept
+        {
+            // Threads take stripes round-robin; past StripeCount they share
+            static std::atomic<size_t> nextStripe(0);
+            static thread_local size_t stripe = nextStripe.fetch_add(1, std::memory_order_relaxed) % PipelineStatsCollector::StripeCount;
+            return stripe;
+        }
+
+        inline void storeMax(std::atomic<uint64_t>& target, uint64_t value) noexcept
+        {
+            uint64_t current = target.load(std::memory_order_relaxed);
+            while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        inline void storeMin(std::atomic<uint64_t>& target, uint64_t value) noexcept
+        {
+            uint64_t current = target.load(std::memory_order_relaxed);
+            while (value < current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed))
+            {
+            }
+        }
+    }
+
+    PipelineStatsCollector::Stripe::Stripe() noexcept :
+        sum(0),
+        min(std::numeric_limits<uint64_t>::max()),
+        max(0)
+    {
+        for (auto& bucket : buckets)
+        {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    PipelineStatsCollector::PipelineStatsCollector(bool enabled) :
+        m_enabled(enabled)
+    {
+        for (size_t stage = 0; stage < PipelineStage_Max; stage++)
+        {
+            for (auto& stripe : m_stripes[stage])
+            {
+                stripe.store(nullptr, std::memory_order_relaxed);
+            }
+            m_active[stage].store(0, std::memory_order_relaxed);
+            m_maxActive[stage].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    PipelineStatsCollector::~PipelineStatsCollector()
+    {
+        for (auto& stage : m_stripes)
+        {
+            for (auto& stripe : stage)
+            {
+                delete stripe.load(std::memory_order_acquire);
+            }
+        }
+    }
+
+    size_t PipelineStatsCollector::BucketIndex(uint64_t valueNs) noexcept
+    {
+        const uint64_t limit = (uint64_t(1) << MaxMagnitude) - 1;
+        if (valueNs > limit)
+        {
+            valueNs = limit;
+        }
+        if (valueNs < 2 * SubBucketCount)
+        {
+            return static_cast<size_t>(valueNs);
+        }
+        // Top SubBucketBits + 1 bits select the bucket within the power of two
+        const unsigned shift = highestBit(valueNs) - SubBucketBits;
+        return (shift + 1) * SubBucketCount + static_cast<size_t>((valueNs >> shift) & (SubBucketCount - 1));
+    }
+
+    uint64_t PipelineStatsCollector::BucketUpperBound(size_t index) noexcept
+    {
+        if (index < 2 * SubBucketCount)
+        {
+            return index;
+        }
+        const unsigned shift = static_cast<unsigned>(index / SubBucketCount) - 1;
+        const uint64_t subBucket = index % SubBucketCount;
+        return ((SubBucketCount + subBucket + 1) << shift) - 1;
+    }
+
+    const char* PipelineStatsCollector::GetStageName(PipelineStage stage) noexcept
+    {
+        return (stage < PipelineStage_Max) ? kStageNames[stage] : "";
+    }
+
+    PipelineStatsCollector::Stripe* PipelineStatsCollector::getStripe(PipelineStage stage) noexcept
+    {
+        std::atomic<Stripe*>& slot = m_stripes[stage][threadStripe()];
+        Stripe* stripe = slot.load(std::memory_order_acquire);
+        if (stripe == nullptr)
+        {
+            // Stripes are created on first use: most threads only see a few stages
+            Stripe* created = new (std::nothrow) Stripe();
+            if (created == nullptr)
+            {
+                return nullptr;
+            }
+            if (slot.compare_exchange_strong(stripe, created, std::memory_order_acq_rel))
+            {
+                stripe = created;
+            }
+            else
+            {
+                delete created;
+            }
+        }
+        return stripe;
+    }
+
+    void PipelineStatsCollector::recordTo(Stripe& stripe, int64_t durationNs) noexcept
+    {
+        const uint64_t value = (durationNs > 0) ? static_cast<uint64_t>(durationNs) : 0;
+        stripe.buckets[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+        stripe.sum.fetch_add(value, std::memory_order_relaxed);
+        storeMin(stripe.min, value);
+        storeMax(stripe.max, value);
+    }
+
+    void PipelineStatsCollector::Record(PipelineStage stage, int64_t durationNs) noexcept
+    {
+        if (!m_enabled || stage >= PipelineStage_Max)
+        {
+            return;
+        }
+        Stripe* stripe = getStripe(stage);
+        if (stripe != nullptr)
+        {
+            recordTo(*stripe, durationNs);
+        }
+    }
+
+    void PipelineStatsCollector::enter(PipelineStage stage) noexcept
+    {
+        const uint64_t active = m_active[stage].fetch_add(1, std::memory_order_relaxed) + 1;
+        storeMax(m_maxActive[stage], active);
+    }
+
+    void PipelineStatsCollector::leave(PipelineStage stage) noexcept
+    {
+        m_active[stage].fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void PipelineStatsCollector::recordIngestion(PipelineTimes& times, int64_t now) noexcept
+    {
+        if (times.submitted != 0)
+        {
+            const int64_t handedOff = (times.queued != 0) ? times.queued : times.dispatched;
+            Record(PipelineStage_Submit, handedOff - times.submitted);
+        }
+        if (times.queued != 0)
+        {
+            Record(PipelineStage_Queue, times.dispatched - times.queued);
+        }
+        Record(PipelineStage_Dispatch, now - times.dispatched);
+        times.submitted = 0;
+        times.queued = 0;
+        times.dispatched = 0;
+    }
+
+    void PipelineStatsCollector::Advance(PipelineTimes& times, PipelineStage next) noexcept
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+        const int64_t now = PipelineTimes::Now();
+        if (times.dispatched != 0)
+        {
+            recordIngestion(times, now);
+        }
+        if (times.stageStart != 0)
+        {
+            Record(times.stage, now - times.stageStart);
+            leave(times.stage);
+        }
+        if (next < PipelineStage_Max)
+        {
+            times.stage = next;
+            times.stageStart = now;
+            enter(next);
+        }
+        else
+        {
+            times.stage = PipelineStage_Max;
+            times.stageStart = 0;
+        }
+    }
+
+    void PipelineStatsCollector::Abandon(PipelineTimes& times) noexcept
+    {
+        if (times.stageStart != 0)
+        {
+            leave(times.stage);
+            times.stage = PipelineStage_Max;
+            times.stageStart = 0;
+        }
+    }
+
+    bool PipelineStatsCollector::handleDelivered(EventsUploadContextPtr const& ctx)
+    {
+        if (!m_enabled)
+        {
+            return true;
+        }
+        Advance(ctx->pipelineTimes, PipelineStage_Max);
+
+        // Record timestamps are wall clock milliseconds taken when storing
+        const int64_t now = PAL::getUtcSystemTimeMs();
+        Stripe* stripe = ctx->recordTimestamps.empty() ? nullptr : getStripe(PipelineStage_Delivery);
+        if (stripe != nullptr)
+        {
+            for (int64_t timestamp : ctx->recordTimestamps)
+            {
+                recordTo(*stripe, (now - timestamp) * 1000000);
+            }
+        }
+        return true;
+    }
+
+    void PipelineStatsCollector::GetStats(PipelineStats& stats, bool reset)
+    {
+        stats.stages.clear();
+        stats.stages.resize(PipelineStage_Max);
+
+        std::vector<uint64_t> buckets(BucketCount);
+        for (size_t stage = 0; stage < PipelineStage_Max; stage++)
+        {
+            PipelineStageStats& result = stats.stages[stage];
+            result.stage = static_cast<PipelineStage>(stage);
+            result.name = kStageNames[stage];
+            result.active = m_active[stage].load(std::memory_order_relaxed);
+            result.maxActive = reset ? m_maxActive[stage].exchange(result.active, std::memory_order_relaxed)
+                                     : m_maxActive[stage].load(std::memory_order_relaxed);
+
+            std::fill(buckets.begin(), buckets.end(), 0);
+            uint64_t sum = 0;
+            uint64_t min = std::numeric_limits<uint64_t>::max();
+            uint64_t max = 0;
+            for (auto& slot : m_stripes[stage])
+            {
+                Stripe* stripe = slot.load(std::memory_order_acquire);
+                if (stripe == nullptr)
+                {
+                    continue;
+                }
+                // Exchanging each counter loses no measurement taken meanwhile
+                for (size_t i = 0; i < BucketCount; i++)
+                {
+                    buckets[i] += reset ? stripe->buckets[i].exchange(0, std::memory_order_relaxed)
+                                        : stripe->buckets[i].load(std::memory_order_relaxed);
+                }
+                sum += reset ? stripe->sum.exchange(0, std::memory_order_relaxed) : stripe->sum.load(std::memory_order_relaxed);
+                min = std::min(min, reset ? stripe->min.exchange(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed)
+                                          : stripe->min.load(std::memory_order_relaxed));
+                max = std::max(max, reset ? stripe->max.exchange(0, std::memory_order_relaxed) : stripe->max.load(std::memory_order_relaxed));
+            }
+
+            for (size_t i = 0; i < BucketCount; i++)
+            {
+                if (buckets[i] != 0)
+                {
+                    result.count += buckets[i];
+                    result.buckets.emplace_back(BucketUpperBound(i), buckets[i]);
+                }
+            }
+            if (result.count == 0)
+            {
+                continue;
+            }
+            result.minNs = std::min(min, max);
+            result.maxNs = max;
+            result.meanNs = sum / result.count;
+
+            const double quantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+            uint64_t* targets[] = { &result.p50Ns, &result.p90Ns, &result.p99Ns, &result.p999Ns };
+            size_t next = 0;
+            uint64_t seen = 0;
+            for (auto const& bucket : result.buckets)
+            {
+                seen += bucket.second;
+                while (next < 4 && static_cast<double>(seen) >= quantiles[next] * static_cast<double>(result.count))
+                {
+                    *targets[next++] = std::max(result.minNs, std::min(bucket.first, result.maxNs));
+                }
+            }
+            while (next < 4)
+            {
+                *targets[next++] = result.maxNs;
+            }
+        }
+    }
+
+} MAT_NS_END
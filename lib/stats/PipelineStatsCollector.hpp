@@ -0,0 +1,155 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef PIPELINESTATSCOLLECTOR_HPP
+#define PIPELINESTATSCOLLECTOR_HPP
+
+#include "pal/PAL.hpp"
+
+#include "PipelineStats.hpp"
+#include "system/Contexts.hpp"
+#include "system/Route.hpp"
+
+#include <atomic>
+
+namespace MAT_NS_BEGIN {
+
+    class PipelineStatsCollector;
+
+    /// <summary>
+    /// Route pass-through that moves a context to the next pipeline stage. The
+    /// stage the context leaves is measured, unless the probe marks a failure.
+    /// </summary>
+    template <typename TContextPtr>
+    class PipelineProbe : public IRoutePassThrough<TContextPtr const&>
+    {
+    public:
+        PipelineProbe(PipelineStatsCollector& collector, PipelineStage next, bool completed = true) :
+            m_collector(collector),
+            m_next(next),
+            m_completed(completed)
+        {
+        }
+
+        virtual bool operator()(TContextPtr const& ctx) override;
+
+    protected:
+        PipelineStatsCollector& m_collector;
+        PipelineStage           m_next;
+        bool                    m_completed;
+    };
+
+    /// <summary>
+    /// Per-stage latency histograms of the event pipeline. Buckets are
+    /// log-linear: 16 buckets per power of two, up to 2^40 ns. Each thread
+    /// records into a stripe of its own, so recording takes no lock and
+    /// rarely shares a cache line; snapshots merge the stripes.
+    /// </summary>
+    class PipelineStatsCollector
+    {
+    public:
+        static constexpr unsigned SubBucketBits  = 4;
+        static constexpr size_t   SubBucketCount = size_t(1) << SubBucketBits;
+        static constexpr unsigned MaxMagnitude   = 40;
+        static constexpr size_t   BucketCount    = (MaxMagnitude - SubBucketBits + 1) * SubBucketCount;
+        static constexpr size_t   StripeCount    = 16;
+
+        explicit PipelineStatsCollector(bool enabled = true);
+        ~PipelineStatsCollector();
+
+        PipelineStatsCollector(PipelineStatsCollector const&) = delete;
+        PipelineStatsCollector& operator=(PipelineStatsCollector const&) = delete;
+
+        bool IsEnabled() const noexcept
+        {
+            return m_enabled;
+        }
+
+        /// <summary>
+        /// Adds one measurement of a stage.
+        /// </summary>
+        void Record(PipelineStage stage, int64_t durationNs) noexcept;
+
+        /// <summary>
+        /// Ends the stage the context is in, measuring it, and enters the next
+        /// one. PipelineStage_Max leaves the pipeline. The first call on an event
+        /// also measures the log manager hops stamped in its PipelineTimes.
+        /// </summary>
+        void Advance(PipelineTimes& times, PipelineStage next) noexcept;
+
+        /// <summary>
+        /// Leaves the current stage without measuring it, on a failure path.
+        /// </summary>
+        void Abandon(PipelineTimes& times) noexcept;
+
+        /// <summary>
+        /// Fills one PipelineStageStats per stage. With reset, the returned
+        /// measurements are removed, so the next call covers a new interval.
+        /// </summary>
+        void GetStats(PipelineStats& stats, bool reset = false);
+
+        static size_t BucketIndex(uint64_t valueNs) noexcept;
+        static uint64_t BucketUpperBound(size_t index) noexcept;
+        static const char* GetStageName(PipelineStage stage) noexcept;
+
+    protected:
+        struct Stripe
+        {
+            Stripe() noexcept;
+
+            std::atomic<uint64_t> sum;
+            std::atomic<uint64_t> min;
+            std::atomic<uint64_t> max;
+            std::atomic<uint64_t> buckets[BucketCount];
+        };
+
+        Stripe* getStripe(PipelineStage stage) noexcept;
+        void recordTo(Stripe& stripe, int64_t durationNs) noexcept;
+        void recordIngestion(PipelineTimes& times, int64_t now) noexcept;
+        void enter(PipelineStage stage) noexcept;
+        void leave(PipelineStage stage) noexcept;
+
+        bool handleDelivered(EventsUploadContextPtr const& ctx);
+
+        bool                  m_enabled;
+        std::atomic<Stripe*>  m_stripes[PipelineStage_Max][StripeCount];
+        std::atomic<uint64_t> m_active[PipelineStage_Max];
+        std::atomic<uint64_t> m_maxActive[PipelineStage_Max];
+
+    public:
+        PipelineProbe<IncomingEventContextPtr>                                     serializing{ *this, PipelineStage_Serialize };
+        PipelineProbe<IncomingEventContextPtr>                                     serialized{ *this, PipelineStage_Max };
+        PipelineProbe<IncomingEventContextPtr>                                     storing{ *this, PipelineStage_Store };
+        PipelineProbe<IncomingEventContextPtr>                                     stored{ *this, PipelineStage_Max };
+        PipelineProbe<IncomingEventContextPtr>                                     storeFailed{ *this, PipelineStage_Max, false };
+
+        PipelineProbe<EventsUploadContextPtr>                                      retrieving{ *this, PipelineStage_Retrieve };
+        PipelineProbe<EventsUploadContextPtr>                                      packaging{ *this, PipelineStage_Package };
+        PipelineProbe<EventsUploadContextPtr>                                      compressing{ *this, PipelineStage_Compress };
+        PipelineProbe<EventsUploadContextPtr>                                      encoding{ *this, PipelineStage_Encode };
+        PipelineProbe<EventsUploadContextPtr>                                      uploading{ *this, PipelineStage_Send };
+        PipelineProbe<EventsUploadContextPtr>                                      decoding{ *this, PipelineStage_Decode };
+        PipelineProbe<EventsUploadContextPtr>                                      decoded{ *this, PipelineStage_Max };
+        PipelineProbe<EventsUploadContextPtr>                                      uploadAbandoned{ *this, PipelineStage_Max, false };
+        // Ends decoding and measures the delivery of each uploaded record
+        RoutePassThrough<PipelineStatsCollector, EventsUploadContextPtr const&>   delivered{ this, &PipelineStatsCollector::handleDelivered };
+    };
+
+    template <typename TContextPtr>
+    bool PipelineProbe<TContextPtr>::operator()(TContextPtr const& ctx)
+    {
+        if (m_completed)
+        {
+            m_collector.Advance(ctx->pipelineTimes, m_next);
+        }
+        else
+        {
+            m_collector.Abandon(ctx->pipelineTimes);
+        }
+        return true;
+    }
+
+} MAT_NS_END
+
+#endif
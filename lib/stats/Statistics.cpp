@@ -9,6 +9,7 @@
 #include "ILogManager.hpp"
 #include "mat/config.h"
 #include "utils/Utils.hpp"
+#include "utils/RecordIdAllocator.hpp"
 #include "decorators/RecordFlagConstants.hpp"
 #include <oacr.h>
 
@@ -93,7 +94,7 @@ namespace MAT_NS_BEGIN {
             }
             if (result)
             {
-                IncomingEventContext evt(PAL::generateUuidString(), tenantToken, EventLatency_Normal, EventPersistence_Normal, &record);
+                IncomingEventContext evt(RecordIdAllocator::GetInstance().Next(), tenantToken, EventLatency_Normal, EventPersistence_Normal, &record);
                 m_iTelemetrySystem.sendEvent(&evt);
             }
             else
@@ -185,7 +186,7 @@ namespace MAT_NS_BEGIN {
 
         DebugEvent evt;
         evt.type = DebugEventType::EVT_SENDING;
-        evt.param1 = ctx->recordIdsAndTenantIds.size();
+        evt.param1 = ctx->recordIds.size();
         OnDebugEvent(evt);
 
         return true;
@@ -211,7 +212,7 @@ namespace MAT_NS_BEGIN {
         bool metastatsOnly = (ctx->packageIds.count(m_config.GetMetaStatsTenantToken()) == ctx->packageIds.size());
         {
             LOCKGUARD(m_metaStats_mtx);
-            m_metaStats.updateOnPackageSentSucceeded(ctx->recordIdsAndTenantIds, ctx->latency, ctx->maxRetryCountSeen, ctx->durationMs, latencyToSendMs, metastatsOnly);
+            m_metaStats.updateOnPackageSentSucceeded(ctx->getRecordCountPerTenant(), ctx->latency, ctx->maxRetryCountSeen, ctx->durationMs, latencyToSendMs, metastatsOnly);
         }
         scheduleSend();
         return true;
@@ -223,12 +224,7 @@ namespace MAT_NS_BEGIN {
         {
             LOCKGUARD(m_metaStats_mtx);
             m_metaStats.updateOnPackageFailed(status);
-            std::map<std::string, size_t> countOnTenant;
-            for (const auto& recordAndTenant : ctx->recordIdsAndTenantIds)
-            {
-                countOnTenant[recordAndTenant.second]++;
-            }
-            m_metaStats.updateOnRecordsRejected(REJECTED_REASON_SERVER_DECLINED, countOnTenant);
+            m_metaStats.updateOnRecordsRejected(REJECTED_REASON_SERVER_DECLINED, ctx->getRecordCountPerTenant());
         }
         scheduleSend();
         return true;
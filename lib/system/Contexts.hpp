@@ -6,6 +6,7 @@
 #pragma once
 #include "IHttpClient.hpp"
 #include "IOfflineStorage.hpp"
+#include "PipelineStats.hpp"
 #include "packager/ISplicer.hpp"
 #include "packager/BondSplicer.hpp"
 #include "pal/PAL.hpp"
@@ -15,20 +16,47 @@
 #include <memory>
 #include <vector>
 #include <atomic>
+#include <chrono>
 
 namespace MAT_NS_BEGIN {
 
+    /// <summary>
+    /// Where a context is in the pipeline, for the per-stage latency histograms.
+    /// Times are steady clock nanoseconds, 0 when not set.
+    /// </summary>
+    struct PipelineTimes
+    {
+        static int64_t Now() noexcept
+        {
+            return static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+        // Hops before the telemetry system, recorded when it receives the event
+        int64_t       submitted = 0;
+        int64_t       queued = 0;
+        int64_t       dispatched = 0;
+
+        // Stage the context is in and when it entered it
+        PipelineStage stage = PipelineStage_Max;
+        int64_t       stageStart = 0;
+    };
+
 
     class IncomingEventContext {
     public:
         ::CsProtocol::Record*  source;
         StorageRecord          record;
         std::uint64_t          policyBitFlags;
+        PipelineTimes          pipelineTimes;
+        // Caller still reads *source after sendEvent, hand-offs must copy it
+        bool                   keepSource;
 
     public:
         IncomingEventContext() :
             source(nullptr),
-            policyBitFlags(0)
+            policyBitFlags(0),
+            keepSource(false)
         {
         }
 
@@ -36,14 +64,16 @@ namespace MAT_NS_BEGIN {
         IncomingEventContext(std::string const& id, std::string const& tenantToken, EventLatency latency, EventPersistence persistence, ::CsProtocol::Record* source)
             : source(source),
             record{ id, tenantToken, latency, persistence, (source != nullptr) ? source->cV : "" },
-	    policyBitFlags(0)
+	    policyBitFlags(0),
+            keepSource(false)
         {
         }
 #else
         IncomingEventContext(std::string const& id, std::string const& tenantToken, EventLatency latency, EventPersistence persistence, ::CsProtocol::Record* source)
             : source(source),
             record{ id, tenantToken, latency, persistence },
-	    policyBitFlags(0)
+	    policyBitFlags(0),
+            keepSource(false)
         {
         }
 #endif
@@ -79,38 +109,98 @@ namespace MAT_NS_BEGIN {
         void clear() noexcept
         {
             if (httpRequest != nullptr) {
-                delete httpRequest;
+                if (httpObjectPool != nullptr) {
+                    // Takes the body buffer back for the next upload
+                    httpObjectPool->ReleaseRequest(httpRequest, body);
+                } else {
+                    delete httpRequest;
+                }
                 httpRequest = nullptr;
             }
             if (httpResponse != nullptr) {
-                delete httpResponse;
+                if (httpObjectPool != nullptr) {
+                    httpObjectPool->ReleaseResponse(httpResponse);
+                } else {
+                    delete httpResponse;
+                }
                 httpResponse = nullptr;
             }
         }
 
+        /**
+        * Prepare the context for another upload: release the HTTP objects and
+        * clear every field, keeping the splicer and the capacity of the buffers
+        */
+        void reset() noexcept
+        {
+            clear();
+            httpObjectPool.reset();
+
+            requestedMinLatency = EventLatency_Unspecified;
+            requestedMaxCount = 0;
+            pipelined = false;
+
+            if (splicer != nullptr) {
+                splicer->clear();
+            }
+            maxUploadSize = 0;
+            latency = EventLatency_Unspecified;
+            singleLatency = false;
+            packageIds.clear();
+#ifdef HAVE_MAT_EVT_TRACEID
+            traceId.clear();
+#endif
+            recordIds.clear();
+            recordTenants.clear();
+            tenantTokens.clear();
+            recordTimestamps.clear();
+            maxRetryCountSeen = 0;
+
+            body.clear();
+            compressed = false;
+            contentEncoding.clear();
+
+            httpRequestId.clear();
+
+            durationMs = -1;
+            fromMemory = false;
+            pipelineTimes = PipelineTimes();
+        }
+
         // Retrieving
         EventLatency                         requestedMinLatency = EventLatency_Unspecified;
         unsigned                             requestedMaxCount = 0;
+        // Prepared while an earlier upload of the same round is on the wire
+        bool                                 pipelined = false;
 
         // Packaging
         std::unique_ptr<ISplicer>            splicer;
         unsigned                             maxUploadSize = 0;
         EventLatency                         latency = EventLatency_Unspecified;
+        // Stop at the first record of another latency than the first one
+        bool                                 singleLatency = false;
         std::map<std::string, size_t>        packageIds;
 #ifdef HAVE_MAT_EVT_TRACEID  
         std::string                          traceId;
 #endif
-        std::map<std::string, std::string>   recordIdsAndTenantIds;
+        // Packaged records in order; recordTenants[i] indexes tenantTokens,
+        // which holds each tenant token of the upload once.
+        std::vector<StorageRecordId>         recordIds;
+        std::vector<uint32_t>                recordTenants;
+        std::vector<std::string>             tenantTokens;
         std::vector<int64_t>                 recordTimestamps;
         unsigned                             maxRetryCountSeen = 0;
 
         // Encoding
         std::vector<uint8_t>                 body;
         bool                                 compressed = false;
+        std::string                          contentEncoding;
 
         // Sending
         IHttpRequest*                        httpRequest = nullptr;
         std::string                          httpRequestId;
+        // Takes back httpRequest and httpResponse, when the HTTP client has one
+        std::shared_ptr<IHttpObjectPool>     httpObjectPool;
 
         // Receiving
         IHttpResponse*                       httpResponse = nullptr;
@@ -118,6 +208,46 @@ namespace MAT_NS_BEGIN {
         int                                  durationMs = -1;
         bool                                 fromMemory = false;
 
+        PipelineTimes                        pipelineTimes;
+
+        /**
+        * Remember a packaged record, interning its tenant token
+        */
+        void addRecord(StorageRecordId const& id, std::string const& tenantToken)
+        {
+            // An upload rarely spans more than a couple of tenants
+            uint32_t tenant = static_cast<uint32_t>(tenantTokens.size());
+            while (tenant > 0 && tenantTokens[tenant - 1] != tenantToken)
+            {
+                tenant--;
+            }
+            if (tenant == 0)
+            {
+                tenantTokens.push_back(tenantToken);
+                tenant = static_cast<uint32_t>(tenantTokens.size());
+            }
+            recordIds.push_back(id);
+            recordTenants.push_back(tenant - 1);
+        }
+
+        /**
+        * Number of packaged records per tenant token
+        */
+        std::map<std::string, size_t> getRecordCountPerTenant() const
+        {
+            std::vector<size_t> counts(tenantTokens.size());
+            for (uint32_t tenant : recordTenants)
+            {
+                counts[tenant]++;
+            }
+            std::map<std::string, size_t> result;
+            for (size_t i = 0; i < tenantTokens.size(); i++)
+            {
+                result[tenantTokens[i]] = counts[i];
+            }
+            return result;
+        }
+
         EventsUploadContext() noexcept : 
             EventsUploadContext(std::unique_ptr<ISplicer>(new BondSplicer()))
         {
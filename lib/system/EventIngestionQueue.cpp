@@ -0,0 +1,234 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "EventIngestionQueue.hpp"
+
+#include "pal/PAL.hpp"
+#include "utils/StringUtils.hpp"
+
+#include <chrono>
+#include <exception>
+
+namespace MAT_NS_BEGIN
+{
+    /* Upper bound on a single idle wait. Guards against a lost wake-up turning into a stall. */
+    static constexpr unsigned IDLE_WAIT_MS = 10;
+
+    EventIngestionQueue::EventIngestionQueue(size_t capacity, size_t threadCount, IngestionBackpressure policy, Handler handler) :
+        m_ring(capacity),
+        m_policy(policy),
+        m_handler(std::move(handler)),
+        m_running(true),
+        m_sleepingConsumers(0),
+        m_waitingProducers(0),
+        m_pushed(0),
+        m_handled(0),
+        m_dropped(0),
+        m_spilled(0),
+        m_maxQueued(0)
+    {
+        if (threadCount == 0)
+        {
+            threadCount = 1;
+        }
+        m_threads.reserve(threadCount);
+        for (size_t i = 0; i < threadCount; i++)
+        {
+            m_threads.emplace_back(&EventIngestionQueue::threadFunc, this);
+        }
+        LOG_TRACE("Ingestion queue started: capacity=%zu, threads=%zu", m_ring.capacity(), threadCount);
+    }
+
+    EventIngestionQueue::~EventIngestionQueue()
+    {
+        Stop();
+    }
+
+    IngestionBackpressure EventIngestionQueue::ParsePolicy(const std::string& value)
+    {
+        std::string policy = toLower(value);
+        if (policy == "drop")
+        {
+            return IngestionBackpressure::Drop;
+        }
+        if (policy == "spill")
+        {
+            return IngestionBackpressure::Spill;
+        }
+        return IngestionBackpressure::Block;
+    }
+
+    EventIngestionQueue::PushResult EventIngestionQueue::Push(std::unique_ptr<IncomingEventContext>& event)
+    {
+        if (!m_running.load(std::memory_order_acquire))
+        {
+            m_spilled.fetch_add(1, std::memory_order_relaxed);
+            return PushResult::Spilled;
+        }
+
+        IncomingEventContext* item = event.get();
+        // Count the event before publishing it so that Drain never observes
+        // m_handled catching up with an m_pushed that excludes a queued item.
+        m_pushed.fetch_add(1, std::memory_order_acq_rel);
+        while (!m_ring.try_push(item))
+        {
+            if (m_policy == IngestionBackpressure::Drop || m_policy == IngestionBackpressure::Spill || !m_running.load(std::memory_order_acquire))
+            {
+                m_pushed.fetch_sub(1, std::memory_order_acq_rel);
+                if (m_policy == IngestionBackpressure::Drop)
+                {
+                    m_dropped.fetch_add(1, std::memory_order_relaxed);
+                    return PushResult::Dropped;
+                }
+                m_spilled.fetch_add(1, std::memory_order_relaxed);
+                return PushResult::Spilled;
+            }
+
+            // Block: park until a consumer frees a slot.
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_waitingProducers.fetch_add(1, std::memory_order_seq_cst);
+            if (m_ring.size() >= m_ring.capacity())
+            {
+                m_notFull.wait_for(lock, std::chrono::milliseconds(IDLE_WAIT_MS));
+            }
+            m_waitingProducers.fetch_sub(1, std::memory_order_seq_cst);
+        }
+        event.release();
+        const size_t queued = m_ring.size();
+        size_t maxQueued = m_maxQueued.load(std::memory_order_relaxed);
+        while (queued > maxQueued && !m_maxQueued.compare_exchange_weak(maxQueued, queued, std::memory_order_relaxed))
+        {
+        }
+        wakeConsumers();
+        return PushResult::Queued;
+    }
+
+    void EventIngestionQueue::wakeConsumers()
+    {
+        // Producers only touch the mutex when a pipeline thread is actually
+        // parked, which keeps the steady-state push path lock-free.
+        if (m_sleepingConsumers.load(std::memory_order_seq_cst) > 0)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_notEmpty.notify_one();
+        }
+    }
+
+    void EventIngestionQueue::Drain()
+    {
+        // A handler calling back into Flush would otherwise wait for itself.
+        const auto thisId = std::this_thread::get_id();
+        for (const auto& thread : m_threads)
+        {
+            if (thread.get_id() == thisId)
+            {
+                return;
+            }
+        }
+        const uint64_t target = m_pushed.load(std::memory_order_acquire);
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (m_handled.load(std::memory_order_acquire) < target)
+        {
+            m_notEmpty.notify_all();
+            m_drained.wait_for(lock, std::chrono::milliseconds(IDLE_WAIT_MS));
+        }
+    }
+
+    void EventIngestionQueue::Stop()
+    {
+        if (!m_running.exchange(false))
+        {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_notEmpty.notify_all();
+            m_notFull.notify_all();
+        }
+        const auto thisId = std::this_thread::get_id();
+        for (auto& thread : m_threads)
+        {
+            if (thread.joinable())
+            {
+                if (thread.get_id() == thisId)
+                {
+                    thread.detach();
+                }
+                else
+                {
+                    thread.join();
+                }
+            }
+        }
+        m_threads.clear();
+
+        // Anything still queued was published after the consumers exited.
+        IncomingEventContext* item = nullptr;
+        while (m_ring.try_pop(item))
+        {
+            std::unique_ptr<IncomingEventContext> owned(item);
+            m_handler(*owned);
+            m_handled.fetch_add(1, std::memory_order_acq_rel);
+        }
+        LOG_TRACE("Ingestion queue stopped: dropped=%llu, spilled=%llu",
+                  static_cast<unsigned long long>(GetDroppedCount()),
+                  static_cast<unsigned long long>(GetSpilledCount()));
+    }
+
+    void EventIngestionQueue::threadFunc()
+    {
+        for (;;)
+        {
+            IncomingEventContext* item = nullptr;
+            if (m_ring.try_pop(item))
+            {
+                if (m_waitingProducers.load(std::memory_order_seq_cst) > 0)
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_notFull.notify_all();
+                }
+
+                std::unique_ptr<IncomingEventContext> owned(item);
+                // Same containment as the worker thread: a throwing decorator or
+                // data inspector must not terminate the host process.
+                try
+                {
+                    m_handler(*owned);
+                }
+                catch (const std::exception& ex)
+                {
+                    LOG_ERROR("Unhandled exception in ingestion pipeline: %s", ex.what());
+                }
+                catch (...)
+                {
+                    LOG_ERROR("Unhandled non-standard exception in ingestion pipeline");
+                }
+                owned.reset();
+                m_handled.fetch_add(1, std::memory_order_acq_rel);
+                if (m_ring.empty())
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_drained.notify_all();
+                }
+                continue;
+            }
+
+            if (!m_running.load(std::memory_order_acquire))
+            {
+                break;
+            }
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_sleepingConsumers.fetch_add(1, std::memory_order_seq_cst);
+            if (m_ring.empty() && m_running.load(std::memory_order_acquire))
+            {
+                m_drained.notify_all();
+                m_notEmpty.wait_for(lock, std::chrono::milliseconds(IDLE_WAIT_MS));
+            }
+            m_sleepingConsumers.fetch_sub(1, std::memory_order_seq_cst);
+        }
+    }
+
+}
+MAT_NS_END
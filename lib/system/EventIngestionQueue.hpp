@@ -0,0 +1,161 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef EVENTINGESTIONQUEUE_HPP
+#define EVENTINGESTIONQUEUE_HPP
+
+#include "system/Contexts.hpp"
+#include "utils/BoundedRingQueue.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace MAT_NS_BEGIN
+{
+    /// <summary>
+    /// What the ingestion queue does when a producer finds the ring full.
+    /// </summary>
+    enum class IngestionBackpressure
+    {
+        /// Producer waits until a pipeline thread frees a slot.
+        Block,
+        /// Event is discarded and reported as EVT_DROPPED.
+        Drop,
+        /// Event bypasses the ring and is processed on the producer thread.
+        Spill
+    };
+
+    /// <summary>
+    /// IncomingEventContext that owns its CsProtocol record, so that it can
+    /// outlive the Logger call frame that produced it.
+    /// </summary>
+    class QueuedEventContext : public IncomingEventContext
+    {
+       public:
+        QueuedEventContext(IncomingEventContext& other) :
+            IncomingEventContext(),
+            ownedRecord(other.keepSource ? *other.source : std::move(*other.source))
+        {
+            record = std::move(other.record);
+            policyBitFlags = other.policyBitFlags;
+            pipelineTimes = other.pipelineTimes;
+            source = &ownedRecord;
+        }
+
+        ::CsProtocol::Record ownedRecord;
+    };
+
+    /// <summary>
+    /// Multi-producer ingestion ring placed in front of the telemetry system.
+    /// Logging threads push events without taking the LogManager lock; one or
+    /// more pipeline threads drain the ring and run the handler, which performs
+    /// the work LogManagerImpl::sendEvent used to do on the caller's thread.
+    /// </summary>
+    class EventIngestionQueue
+    {
+       public:
+        using Handler = std::function<void(IncomingEventContext&)>;
+
+        enum class PushResult
+        {
+            Queued,
+            Dropped,
+            Spilled
+        };
+
+        EventIngestionQueue(size_t capacity, size_t threadCount, IngestionBackpressure policy, Handler handler);
+        ~EventIngestionQueue();
+
+        EventIngestionQueue(const EventIngestionQueue&) = delete;
+        EventIngestionQueue& operator=(const EventIngestionQueue&) = delete;
+
+        /// <summary>
+        /// Hands an event to the pipeline. On Dropped and Spilled the context is
+        /// returned to the caller untouched, which then reports or processes it.
+        /// </summary>
+        PushResult Push(std::unique_ptr<IncomingEventContext>& event);
+
+        /// <summary>
+        /// Blocks until every event pushed before the call has been handled.
+        /// </summary>
+        void Drain();
+
+        /// <summary>
+        /// Drains outstanding events and joins the pipeline threads. Events
+        /// pushed after Stop are spilled to the producer thread.
+        /// </summary>
+        void Stop();
+
+        size_t GetQueuedCount() const
+        {
+            return m_ring.size();
+        }
+
+        /// <summary>
+        /// Most events seen queued at once.
+        /// </summary>
+        size_t GetMaxQueuedCount() const
+        {
+            return m_maxQueued.load(std::memory_order_relaxed);
+        }
+
+        size_t GetCapacity() const
+        {
+            return m_ring.capacity();
+        }
+
+        uint64_t GetDroppedCount() const
+        {
+            return m_dropped.load(std::memory_order_relaxed);
+        }
+
+        uint64_t GetSpilledCount() const
+        {
+            return m_spilled.load(std::memory_order_relaxed);
+        }
+
+        IngestionBackpressure GetPolicy() const
+        {
+            return m_policy;
+        }
+
+        /// <summary>
+        /// Parses the CFG_STR_INGESTION_BACKPRESSURE value. Unknown values map to Block.
+        /// </summary>
+        static IngestionBackpressure ParsePolicy(const std::string& value);
+
+       protected:
+        void threadFunc();
+        void wakeConsumers();
+
+        BoundedRingQueue<IncomingEventContext*> m_ring;
+        const IngestionBackpressure m_policy;
+        Handler m_handler;
+
+        std::atomic<bool> m_running;
+        std::atomic<size_t> m_sleepingConsumers;
+        std::atomic<size_t> m_waitingProducers;
+        std::atomic<uint64_t> m_pushed;
+        std::atomic<uint64_t> m_handled;
+        std::atomic<uint64_t> m_dropped;
+        std::atomic<uint64_t> m_spilled;
+        std::atomic<size_t> m_maxQueued;
+
+        std::mutex m_mutex;
+        std::condition_variable m_notEmpty;
+        std::condition_variable m_notFull;
+        std::condition_variable m_drained;
+        std::vector<std::thread> m_threads;
+    };
+
+}
+MAT_NS_END
+
+#endif
@@ -10,7 +10,9 @@
 #include "EventPropertiesStorage.hpp"
 #include "DebugEvents.hpp"
 #include "ILogManager.hpp"
+#include "utils/PropertyNameTable.hpp"
 #include "utils/StringUtils.hpp"
+#include "utils/Utils.hpp"
 #include <string>
 #include <algorithm>
 #include <cctype>
@@ -25,6 +27,28 @@ namespace MAT_NS_BEGIN {
 
     const char* const DefaultEventName = "undefined";
 
+    namespace {
+        // Explicit instantiations are exempt from access checks, so this one
+        // can name the private storage member without the public header
+        // having to befriend SDK internals.
+        typedef EventPropertiesStorage* EventProperties::* StorageMember;
+
+        StorageMember GetStorageMember();
+
+        template <StorageMember Member>
+        struct StorageMemberAccess
+        {
+            friend StorageMember GetStorageMember() { return Member; }
+        };
+
+        template struct StorageMemberAccess<&EventProperties::m_storage>;
+    }
+
+    EventPropertiesStorage const& GetEventPropertiesStorage(EventProperties const& properties)
+    {
+        return *(properties.*GetStorageMember());
+    }
+
     EventProperties::EventProperties(const std::string& name, const std::map<std::string, EventProperty> &properties) :
         EventProperties(name)
     {
@@ -33,18 +57,25 @@ namespace MAT_NS_BEGIN {
 
     EventProperties& EventProperties::operator+=(const std::map<std::string, EventProperty> &properties)
     {
+        PropertyNameTable& names = PropertyNameTable::GetInstance();
         for (auto &kv : properties)
         {
-            auto key = kv.first;
-            auto val = kv.second;
-            m_storage->properties[key] = val;
+            PropertyNameTable::Id nameId;
+            EventRejectedReason isValidPropertyName = names.Validate(kv.first, nameId);
+            if (isValidPropertyName != REJECTED_REASON_OK && m_storage->invalidNameReason == REJECTED_REASON_OK)
+            {
+                m_storage->invalidNameReason = isValidPropertyName;
+            }
+            m_storage->properties.set(kv.first, kv.second, nameId);
         }
+        m_storage->OnPropertiesChanged();
         return (*this);
     }
 
     EventProperties& EventProperties::operator=(const std::map<std::string, EventProperty> &properties)
     {
         m_storage->properties.clear();
+        m_storage->invalidNameReason = REJECTED_REASON_OK;
         (*this) += properties;
         return (*this);
     }
@@ -141,14 +172,20 @@ namespace MAT_NS_BEGIN {
     {
         m_storage->properties.clear();
         m_storage->propertiesPartB.clear();
+        m_storage->invalidNameReason = REJECTED_REASON_OK;
 
+        PropertyNameTable& names = PropertyNameTable::GetInstance();
         for (auto &kv : properties)
         {
-            auto key = kv.first;
-            auto val = kv.second;
-
-            m_storage->properties[key] = val;
+            PropertyNameTable::Id nameId;
+            EventRejectedReason isValidPropertyName = names.Validate(kv.first, nameId);
+            if (isValidPropertyName != REJECTED_REASON_OK && m_storage->invalidNameReason == REJECTED_REASON_OK)
+            {
+                m_storage->invalidNameReason = isValidPropertyName;
+            }
+            m_storage->properties.set(kv.first, kv.second, nameId);
         }
+        m_storage->OnPropertiesChanged();
 
         return (*this);
     }
@@ -335,20 +372,34 @@ namespace MAT_NS_BEGIN {
 
     std::tuple<bool, uint8_t> EventProperties::TryGetLevel() const
     {
-        const auto& findResult = GetProperties().find(COMMONFIELDS_EVENT_LEVEL);
-        if (findResult == GetProperties().cend())
+        const auto property = m_storage->properties.find(COMMONFIELDS_EVENT_LEVEL);
+        if (property == nullptr)
             return std::make_tuple<bool, uint8_t>(false, 0);
-        
-        const auto& property = findResult->second;
-        if (property.type != EventProperty::TYPE_INT64)
+
+        if (property->type != EventProperty::TYPE_INT64)
             return std::make_tuple<bool, uint8_t>(false, 0);
 
-        const auto& value = property.as_int64;
+        const auto& value = property->as_int64;
         if (value < 0 || value > UINT8_MAX)
             return std::make_tuple<bool, uint8_t>(false, 0);
         return std::make_tuple<bool, uint8_t>(true, static_cast<uint8_t>(value));
     }
 
+    static bool acceptPropertyName(const string& name, PropertyNameTable::Id& nameId)
+    {
+        EventRejectedReason isValidPropertyName = PropertyNameTable::GetInstance().Validate(name, nameId);
+        if (isValidPropertyName != REJECTED_REASON_OK)
+        {
+            LOG_ERROR("Context name is invalid: %s", name.c_str());
+            DebugEvent evt;
+            evt.type = DebugEventType::EVT_REJECTED;
+            evt.param1 = isValidPropertyName;
+            ILogManager::DispatchEventBroadcast(evt);
+            return false;
+        }
+        return true;
+    }
+
     /// <summary>
     /// Specify a property of an event
     /// It creates a new property if none exists or overwrites an existing one
@@ -358,39 +409,62 @@ namespace MAT_NS_BEGIN {
     /// </summary>
     void EventProperties::SetProperty(const string& name, EventProperty prop)
     {
-        EventRejectedReason isValidPropertyName = validatePropertyName(name);
-        if (isValidPropertyName != REJECTED_REASON_OK)
+        PropertyNameTable::Id nameId;
+        if (!acceptPropertyName(name, nameId))
         {
-            LOG_ERROR("Context name is invalid: %s", name.c_str());
-            DebugEvent evt;
-            evt.type = DebugEventType::EVT_REJECTED;
-            evt.param1 = isValidPropertyName;
-            ILogManager::DispatchEventBroadcast(evt);
             return;
         }
 
-        m_storage->properties[name] = prop;
+        m_storage->SetProperty(name, nameId, prop);
     }
 
-    //
-    void EventProperties::SetProperty(const std::string& name, char const*  value, PiiKind piiKind, DataCategory category) { SetProperty(name, EventProperty(value, piiKind, category)); }
-    void EventProperties::SetProperty(const std::string& name, const std::string&  value, PiiKind piiKind, DataCategory category) { SetProperty(name, EventProperty(value, piiKind, category)); }
-    void EventProperties::SetProperty(const std::string& name, double       value, PiiKind piiKind, DataCategory category) { SetProperty(name, EventProperty(value, piiKind, category)); }
-    void EventProperties::SetProperty(const std::string& name, int64_t      value, PiiKind piiKind, DataCategory category) { SetProperty(name, EventProperty(value, piiKind, category)); }
-    void EventProperties::SetProperty(const std::string& name, bool         value, PiiKind piiKind, DataCategory category) { SetProperty(name, EventProperty(value, piiKind, category)); }
-    void EventProperties::SetProperty(const std::string& name, time_ticks_t value, PiiKind piiKind, DataCategory category) { SetProperty(name, EventProperty(value, piiKind, category)); }
-    void EventProperties::SetProperty(const std::string& name, GUID_t       value, PiiKind piiKind, DataCategory category) { SetProperty(name, EventProperty(value, piiKind, category)); }
+    // The typed setters write straight into the flat storage, without
+    // building an intermediate EventProperty and its heap copy.
+    void EventProperties::SetProperty(const std::string& name, char const*  value, PiiKind piiKind, DataCategory category)
+    {
+        PropertyNameTable::Id nameId;
+        if (acceptPropertyName(name, nameId))
+        {
+            m_storage->SetProperty(name, nameId, (value != nullptr) ? value : "", (value != nullptr) ? strlen(value) : 0, piiKind, category);
+        }
+    }
 
-    void EventProperties::SetProperty(const std::string& name, std::vector<int64_t>&     value, PiiKind piiKind, DataCategory category) { SetProperty(name, EventProperty(value, piiKind, category)); }
-    void EventProperties::SetProperty(const std::string& name, std::vector<double>&      value, PiiKind piiKind, DataCategory category) { SetProperty(name, EventProperty(value, piiKind, category)); }
-    void EventProperties::SetProperty(const std::string& name, std::vector<GUID_t>&      value, PiiKind piiKind, DataCategory category) { SetProperty(name, EventProperty(value, piiKind, category)); }
-    void EventProperties::SetProperty(const std::string& name, std::vector<std::string>& value, PiiKind piiKind, DataCategory category) { SetProperty(name, EventProperty(value, piiKind, category)); }
+    void EventProperties::SetProperty(const std::string& name, const std::string&  value, PiiKind piiKind, DataCategory category)
+    {
+        PropertyNameTable::Id nameId;
+        if (acceptPropertyName(name, nameId))
+        {
+            // EventProperty stops at the first NUL, keep doing the same
+            m_storage->SetProperty(name, nameId, value.c_str(), strlen(value.c_str()), piiKind, category);
+        }
+    }
+
+    template <typename T>
+    static inline void setTypedProperty(EventPropertiesStorage& storage, const std::string& name, T const& value, PiiKind piiKind, DataCategory category)
+    {
+        PropertyNameTable::Id nameId;
+        if (acceptPropertyName(name, nameId))
+        {
+            storage.SetProperty(name, nameId, value, piiKind, category);
+        }
+    }
+
+    void EventProperties::SetProperty(const std::string& name, double       value, PiiKind piiKind, DataCategory category) { setTypedProperty(*m_storage, name, value, piiKind, category); }
+    void EventProperties::SetProperty(const std::string& name, int64_t      value, PiiKind piiKind, DataCategory category) { setTypedProperty(*m_storage, name, value, piiKind, category); }
+    void EventProperties::SetProperty(const std::string& name, bool         value, PiiKind piiKind, DataCategory category) { setTypedProperty(*m_storage, name, value, piiKind, category); }
+    void EventProperties::SetProperty(const std::string& name, time_ticks_t value, PiiKind piiKind, DataCategory category) { setTypedProperty(*m_storage, name, value, piiKind, category); }
+    void EventProperties::SetProperty(const std::string& name, GUID_t       value, PiiKind piiKind, DataCategory category) { setTypedProperty(*m_storage, name, value, piiKind, category); }
+
+    void EventProperties::SetProperty(const std::string& name, std::vector<int64_t>&     value, PiiKind piiKind, DataCategory category) { setTypedProperty(*m_storage, name, value, piiKind, category); }
+    void EventProperties::SetProperty(const std::string& name, std::vector<double>&      value, PiiKind piiKind, DataCategory category) { setTypedProperty(*m_storage, name, value, piiKind, category); }
+    void EventProperties::SetProperty(const std::string& name, std::vector<GUID_t>&      value, PiiKind piiKind, DataCategory category) { setTypedProperty(*m_storage, name, value, piiKind, category); }
+    void EventProperties::SetProperty(const std::string& name, std::vector<std::string>& value, PiiKind piiKind, DataCategory category) { setTypedProperty(*m_storage, name, value, piiKind, category); }
 
     const map<string, EventProperty>& EventProperties::GetProperties(DataCategory category) const
     {
         if (category == DataCategory_PartC)
         {
-            return m_storage->properties;
+            return m_storage->GetPropertiesMap();
         }
         else
         {
@@ -403,9 +477,29 @@ namespace MAT_NS_BEGIN {
     /// </summary>
     size_t EventProperties::erase(const std::string& key, DataCategory category)
     {
-        size_t result = 0;
-        auto &props = (category == DataCategory_PartC) ? m_storage->properties : m_storage->propertiesPartB;
-        result = props.erase(key);
+        size_t result = (category == DataCategory_PartC) ? m_storage->EraseProperty(key) : m_storage->propertiesPartB.erase(key);
+        if (result != 0 && m_storage->invalidNameReason != REJECTED_REASON_OK)
+        {
+            // The rejected name may be the one that was erased. Interned names
+            // carry their cached result, the others are validated again.
+            PropertyNameTable& names = PropertyNameTable::GetInstance();
+            EventRejectedReason isValidPropertyName = REJECTED_REASON_OK;
+            for (auto const& entry : m_storage->properties)
+            {
+                isValidPropertyName = (entry.nameId != PropertyNameTable::InvalidId)
+                    ? names.GetValidation(entry.nameId)
+                    : validatePropertyName(entry.GetName());
+                if (isValidPropertyName != REJECTED_REASON_OK)
+                {
+                    break;
+                }
+            }
+            for (auto it = m_storage->propertiesPartB.cbegin(); isValidPropertyName == REJECTED_REASON_OK && it != m_storage->propertiesPartB.cend(); ++it)
+            {
+                isValidPropertyName = names.Validate(it->first);
+            }
+            m_storage->invalidNameReason = isValidPropertyName;
+        }
         return result;
     }
 
@@ -416,7 +510,7 @@ namespace MAT_NS_BEGIN {
     const map<string, pair<string, PiiKind> > EventProperties::GetPiiProperties(DataCategory category) const
     {
         std::map<string, pair<string, PiiKind> > pIIExtensions;
-        auto &props = (category == DataCategory_PartC) ? m_storage->properties : m_storage->propertiesPartB;
+        auto &props = (category == DataCategory_PartC) ? m_storage->GetPropertiesMap() : m_storage->propertiesPartB;
         for (const auto &kv : props)
         {
             auto k = kv.first;
@@ -481,7 +575,7 @@ namespace MAT_NS_BEGIN {
             return result;
         };
         size_t i = 0;
-        for(auto &props : { m_storage->properties, m_storage->propertiesPartB })
+        for(auto &props : { m_storage->GetPropertiesMap(), m_storage->propertiesPartB })
             for (auto &kv : props)
             {
                 auto k = kv.first;
@@ -3,15 +3,21 @@
 // SPDX-License-Identifier: Apache-2.0
 //
 #pragma once
+#include <cstdint>
 #include <map>
+#include <mutex>
 #include <string>
+#include <utility>
 
 #include "Enums.hpp"
 #include "EventProperty.hpp"
+#include "FlatPropertyMap.hpp"
 #include "ctmacros.hpp"
 
 namespace MAT_NS_BEGIN {
 
+    class EventProperties;
+
     struct EventPropertiesStorage
     {
        std::string      eventName;
@@ -22,9 +28,92 @@ namespace MAT_NS_BEGIN {
        uint64_t         eventPolicyBitflags = {};
        int64_t          timestampInMillis = {};
 
-       std::map<std::string, EventProperty> properties;
+       FlatPropertyMap                      properties;
        std::map<std::string, EventProperty> propertiesPartB;
 
+       /* First failure among names added without SetProperty (operator+=,
+          initializer lists). EventPropertiesDecorator checks it once per
+          event instead of validating every name again. */
+       EventRejectedReason invalidNameReason = REJECTED_REASON_OK;
+
+       /* GetProperties() hands out a std::map, which is built from the flat
+          properties on first use. Callers may keep the reference, so once it
+          is handed out every change of the properties is applied to it too,
+          as it was when the map was the storage itself. */
+       mutable std::map<std::string, EventProperty> propertiesMap;
+       mutable uint64_t                             propertiesMapVersion = UINT64_MAX;
+       mutable std::mutex                           propertiesMapLock;
+
+       const std::map<std::string, EventProperty>& GetPropertiesMap() const
+       {
+          std::lock_guard<std::mutex> lock(propertiesMapLock);
+          if (propertiesMapVersion != properties.version())
+          {
+             properties.ToMap(propertiesMap);
+             propertiesMapVersion = properties.version();
+          }
+          return propertiesMap;
+       }
+
+       /* Sets a property, whose name was interned as nameId, and forwards it
+          to a handed out map. */
+       template <typename... TArgs>
+       void SetProperty(const std::string& name, PropertyNameTable::Id nameId, TArgs&&... args)
+       {
+          uint64_t versionBefore = properties.version();
+          properties.set(name, std::forward<TArgs>(args)..., nameId);
+          OnPropertyChanged(name, versionBefore);
+       }
+
+       size_t EraseProperty(const std::string& name)
+       {
+          uint64_t versionBefore = properties.version();
+          size_t result = properties.erase(name);
+          OnPropertyChanged(name, versionBefore);
+          return result;
+       }
+
+       /* Applies the change of one property to a handed out map. Mutators do
+          not race with GetProperties(), so the unlocked check only skips the
+          lock for bags whose map was never asked for. */
+       void OnPropertyChanged(const std::string& name, uint64_t versionBefore)
+       {
+          if (propertiesMapVersion == UINT64_MAX)
+          {
+             return;
+          }
+          std::lock_guard<std::mutex> lock(propertiesMapLock);
+          if (propertiesMapVersion == versionBefore)
+          {
+             auto entry = properties.find(name);
+             if (entry == nullptr)
+             {
+                propertiesMap.erase(name);
+             }
+             else
+             {
+                propertiesMap[name] = entry->ToEventProperty();
+             }
+          }
+          else
+          {
+             properties.ToMap(propertiesMap);
+          }
+          propertiesMapVersion = properties.version();
+       }
+
+       /* Rebuilds a handed out map after changes of many properties. */
+       void OnPropertiesChanged()
+       {
+          if (propertiesMapVersion == UINT64_MAX)
+          {
+             return;
+          }
+          std::lock_guard<std::mutex> lock(propertiesMapLock);
+          properties.ToMap(propertiesMap);
+          propertiesMapVersion = properties.version();
+       }
+
        EventPropertiesStorage() noexcept {}
 
        EventPropertiesStorage(const EventPropertiesStorage& other) noexcept
@@ -38,6 +127,7 @@ namespace MAT_NS_BEGIN {
           timestampInMillis = other.timestampInMillis;
           properties = other.properties;
           propertiesPartB = other.propertiesPartB;
+          invalidNameReason = other.invalidNameReason;
        }
 
        EventPropertiesStorage(EventPropertiesStorage&& other) noexcept 
@@ -51,6 +141,7 @@ namespace MAT_NS_BEGIN {
           timestampInMillis = std::move(other.timestampInMillis);
           properties = std::move(other.properties);
           propertiesPartB = std::move(other.propertiesPartB);
+          invalidNameReason = other.invalidNameReason;
        }
 
        EventPropertiesStorage& operator=(const EventPropertiesStorage& other) noexcept
@@ -64,9 +155,15 @@ namespace MAT_NS_BEGIN {
           eventPopSample = other.eventPopSample;
           eventPolicyBitflags = other.eventPolicyBitflags;
           timestampInMillis = other.timestampInMillis;
+          invalidNameReason = other.invalidNameReason;
+          OnPropertiesChanged();
 
           return *this;
        }
     };
 
+    /* Storage of an event, for SDK internals that read it directly instead
+       of going through the public interface (defined in EventProperties.cpp). */
+    EventPropertiesStorage const& GetEventPropertiesStorage(EventProperties const& properties);
+
 } MAT_NS_END
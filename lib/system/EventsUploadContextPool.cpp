@@ -0,0 +1,76 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "EventsUploadContextPool.hpp"
+
+namespace MAT_NS_BEGIN
+{
+    constexpr size_t EventsUploadContextPool::DefaultMaxIdle;
+    constexpr uint64_t EventsUploadContextPool::PlainSplicerKey;
+
+    EventsUploadContextPool::EventsUploadContextPool(size_t maxIdle) :
+        m_state(std::make_shared<State>())
+    {
+        m_state->maxIdle = maxIdle;
+        // Returning a context never allocates
+        m_state->idle.reserve(maxIdle);
+    }
+
+    size_t EventsUploadContextPool::GetIdleCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_state->lock);
+        return m_state->idle.size();
+    }
+
+    std::unique_ptr<EventsUploadContext> EventsUploadContextPool::takeIdle(uint64_t splicerKey)
+    {
+        std::lock_guard<std::mutex> lock(m_state->lock);
+        auto& idle = m_state->idle;
+        // Newest first, it is the most likely to still be in cache
+        for (auto it = idle.rbegin(); it != idle.rend(); ++it)
+        {
+            if (it->splicerKey == splicerKey)
+            {
+                std::unique_ptr<EventsUploadContext> ctx = std::move(it->ctx);
+                idle.erase(std::next(it).base());
+                return ctx;
+            }
+        }
+        return nullptr;
+    }
+
+    EventsUploadContextPtr EventsUploadContextPool::track(uint64_t splicerKey, std::unique_ptr<EventsUploadContext>&& ctx)
+    {
+        // The deleter owns the context from here on, even if shared_ptr throws
+        std::weak_ptr<State> state = m_state;
+        return EventsUploadContextPtr(ctx.release(), [state, splicerKey](EventsUploadContext* released) { recycle(state, splicerKey, released); });
+    }
+
+    void EventsUploadContextPool::recycle(std::weak_ptr<State> const& state, uint64_t splicerKey, EventsUploadContext* ctx) noexcept
+    {
+        std::unique_ptr<EventsUploadContext> owned(ctx);
+        std::shared_ptr<State> pool = state.lock();
+        if (pool == nullptr || owned->splicer == nullptr || pool->maxIdle == 0)
+        {
+            return;
+        }
+
+        // Releases the HTTP objects, outside of the lock
+        owned->reset();
+
+        // Deleted once the lock is released
+        std::unique_ptr<EventsUploadContext> evicted;
+        {
+            std::lock_guard<std::mutex> lock(pool->lock);
+            auto& idle = pool->idle;
+            if (idle.size() >= pool->maxIdle)
+            {
+                evicted = std::move(idle.front().ctx);
+                idle.erase(idle.begin());
+            }
+            idle.push_back(IdleContext { splicerKey, std::move(owned) });
+        }
+    }
+
+} MAT_NS_END
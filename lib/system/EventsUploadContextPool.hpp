@@ -0,0 +1,92 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef EVENTSUPLOADCONTEXTPOOL_HPP
+#define EVENTSUPLOADCONTEXTPOOL_HPP
+
+#include "system/Contexts.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace MAT_NS_BEGIN
+{
+    /// <summary>
+    /// Recycles EventsUploadContext objects between uploads. When the last
+    /// reference to a context is dropped, the context is reset and kept for the
+    /// next upload, together with its splicer and the capacity of its buffers.
+    /// Idle contexts are keyed by the settings their splicer was built with,
+    /// and the oldest one makes room when the pool is full, so contexts built
+    /// for a previous configuration age out. Contexts may outlive the pool,
+    /// they are then deleted.
+    /// </summary>
+    class EventsUploadContextPool
+    {
+    public:
+        static constexpr size_t DefaultMaxIdle = 8;
+
+        /// <summary>
+        /// Key of contexts whose splicer does not compress.
+        /// </summary>
+        static constexpr uint64_t PlainSplicerKey = 0;
+
+        explicit EventsUploadContextPool(size_t maxIdle = DefaultMaxIdle);
+
+        EventsUploadContextPool(EventsUploadContextPool const&) = delete;
+        EventsUploadContextPool& operator=(EventsUploadContextPool const&) = delete;
+
+        /// <summary>
+        /// Takes an idle context released under splicerKey, or creates one around
+        /// the splicer returned by makeSplicer. Callers give a different key to
+        /// every splicer configuration. Returns nullptr when a new context is
+        /// needed and makeSplicer returns nullptr.
+        /// </summary>
+        template <typename TMakeSplicer>
+        EventsUploadContextPtr Acquire(uint64_t splicerKey, TMakeSplicer&& makeSplicer)
+        {
+            std::unique_ptr<EventsUploadContext> ctx = takeIdle(splicerKey);
+            if (ctx == nullptr)
+            {
+                std::unique_ptr<ISplicer> splicer = makeSplicer();
+                if (splicer == nullptr)
+                {
+                    return nullptr;
+                }
+                ctx.reset(new EventsUploadContext(std::move(splicer)));
+            }
+            return track(splicerKey, std::move(ctx));
+        }
+
+        /// <summary>
+        /// Number of contexts waiting for reuse.
+        /// </summary>
+        size_t GetIdleCount() const;
+
+    protected:
+        struct IdleContext
+        {
+            uint64_t splicerKey;
+            std::unique_ptr<EventsUploadContext> ctx;
+        };
+
+        struct State
+        {
+            std::mutex lock;
+            size_t maxIdle;
+            // Oldest first
+            std::vector<IdleContext> idle;
+        };
+
+        std::unique_ptr<EventsUploadContext> takeIdle(uint64_t splicerKey);
+        EventsUploadContextPtr track(uint64_t splicerKey, std::unique_ptr<EventsUploadContext>&& ctx);
+        static void recycle(std::weak_ptr<State> const& state, uint64_t splicerKey, EventsUploadContext* ctx) noexcept;
+
+        std::shared_ptr<State> m_state;
+    };
+
+} MAT_NS_END
+
+#endif
@@ -0,0 +1,476 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "FlatPropertyMap.hpp"
+#include "utils/PropertyNameTable.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace MAT_NS_BEGIN
+{
+    constexpr size_t FlatPropertyMap::InlineCapacity;
+
+    static const size_t GuidSize = 16;
+
+    // Same order as std::less<std::string>
+    static int compareName(FlatPropertyMap::Entry const& entry, std::string const& name)
+    {
+        size_t size = std::min<size_t>(entry.nameSize, name.size());
+        int result = (size == 0) ? 0 : memcmp(entry.name, name.data(), size);
+        if (result != 0)
+        {
+            return result;
+        }
+        if (entry.nameSize == name.size())
+        {
+            return 0;
+        }
+        return (entry.nameSize < name.size()) ? -1 : 1;
+    }
+
+    EventProperty FlatPropertyMap::Entry::ToEventProperty() const
+    {
+        PiiKind pii = piiKind;
+        DataCategory category = static_cast<DataCategory>(dataCategory);
+        switch (type)
+        {
+        case EventProperty::TYPE_STRING:
+            return EventProperty(GetString().data, pii, category);
+        case EventProperty::TYPE_INT64:
+            return EventProperty(as_int64, pii, category);
+        case EventProperty::TYPE_DOUBLE:
+            return EventProperty(as_double, pii, category);
+        case EventProperty::TYPE_TIME:
+            return EventProperty(time_ticks_t(as_time_ticks), pii, category);
+        case EventProperty::TYPE_BOOLEAN:
+            return EventProperty(as_bool, pii, category);
+        case EventProperty::TYPE_GUID:
+            return EventProperty(GetGuid(), pii, category);
+        case EventProperty::TYPE_INT64_ARRAY:
+        {
+            std::vector<int64_t> values(GetArray<int64_t>(), GetArray<int64_t>() + as_ref.count);
+            return EventProperty(values, pii, category);
+        }
+        case EventProperty::TYPE_DOUBLE_ARRAY:
+        {
+            std::vector<double> values(GetArray<double>(), GetArray<double>() + as_ref.count);
+            return EventProperty(values, pii, category);
+        }
+        case EventProperty::TYPE_GUID_ARRAY:
+        {
+            std::vector<GUID_t> values;
+            values.reserve(as_ref.count);
+            for (size_t i = 0; i < as_ref.count; i++)
+            {
+                values.push_back(GetGuid(i));
+            }
+            return EventProperty(values, pii, category);
+        }
+        case EventProperty::TYPE_STRING_ARRAY:
+        {
+            std::vector<std::string> values;
+            values.reserve(as_ref.count);
+            for (size_t i = 0; i < as_ref.count; i++)
+            {
+                Slice const& value = GetArray<Slice>()[i];
+                values.emplace_back(value.data, value.size);
+            }
+            return EventProperty(values, pii, category);
+        }
+        default:
+            return EventProperty();
+        }
+    }
+
+    FlatPropertyMap::FlatPropertyMap() noexcept :
+        m_entries(m_inline),
+        m_size(0),
+        m_capacity(InlineCapacity),
+        m_garbage(0),
+        m_version(0)
+    {
+    }
+
+    FlatPropertyMap::FlatPropertyMap(FlatPropertyMap const& other) :
+        FlatPropertyMap()
+    {
+        reserve(other.m_size);
+        for (size_t i = 0; i < other.m_size; i++)
+        {
+            Entry& entry = m_entries[i];
+            Entry const& source = other.m_entries[i];
+            entry = source;
+            if (source.nameId == PropertyNameTable::InvalidId)
+            {
+                entry.name = m_arena.copyString(source.name, source.nameSize);
+            }
+            copyPayload(entry, source);
+        }
+        m_size = other.m_size;
+    }
+
+    FlatPropertyMap::FlatPropertyMap(FlatPropertyMap&& other) noexcept :
+        FlatPropertyMap()
+    {
+        moveFrom(other);
+    }
+
+    FlatPropertyMap& FlatPropertyMap::operator=(FlatPropertyMap const& other)
+    {
+        if (this != &other)
+        {
+            FlatPropertyMap copy(other);
+            uint64_t version = std::max(m_version, other.m_version);
+            moveFrom(copy);
+            m_version = version + 1;
+        }
+        return *this;
+    }
+
+    FlatPropertyMap& FlatPropertyMap::operator=(FlatPropertyMap&& other) noexcept
+    {
+        if (this != &other)
+        {
+            uint64_t version = std::max(m_version, other.m_version);
+            moveFrom(other);
+            m_version = version + 1;
+        }
+        return *this;
+    }
+
+    void FlatPropertyMap::moveFrom(FlatPropertyMap& other) noexcept
+    {
+        if (other.m_entries == other.m_inline)
+        {
+            std::copy(other.m_inline, other.m_inline + other.m_size, m_inline);
+            m_entries = m_inline;
+            m_capacity = InlineCapacity;
+            m_heap.clear();
+        }
+        else
+        {
+            m_heap = std::move(other.m_heap);
+            m_entries = m_heap.data();
+            m_capacity = other.m_capacity;
+        }
+        m_size = other.m_size;
+        m_arena = std::move(other.m_arena);
+        m_garbage = other.m_garbage;
+        m_version = other.m_version;
+
+        other.m_heap.clear();
+        other.m_entries = other.m_inline;
+        other.m_size = 0;
+        other.m_capacity = InlineCapacity;
+        other.m_garbage = 0;
+        other.m_version++;
+    }
+
+    void FlatPropertyMap::reserve(size_t capacity)
+    {
+        if (capacity <= m_capacity)
+        {
+            return;
+        }
+        std::vector<Entry> heap(std::max(capacity, m_capacity * 2));
+        std::copy(m_entries, m_entries + m_size, heap.begin());
+        m_heap.swap(heap);
+        m_entries = m_heap.data();
+        m_capacity = m_heap.size();
+    }
+
+    FlatPropertyMap::Entry const* FlatPropertyMap::find(std::string const& name) const
+    {
+        Entry const* it = std::lower_bound(begin(), end(), name,
+            [](Entry const& entry, std::string const& key) { return compareName(entry, key) < 0; });
+        if (it != end() && compareName(*it, name) == 0)
+        {
+            return it;
+        }
+        return nullptr;
+    }
+
+    size_t FlatPropertyMap::payloadSize(Entry const& entry) noexcept
+    {
+        switch (entry.type)
+        {
+        case EventProperty::TYPE_STRING:
+            return entry.as_ref.count + 1;
+        case EventProperty::TYPE_GUID:
+            return GuidSize;
+        case EventProperty::TYPE_INT64_ARRAY:
+            return entry.as_ref.count * sizeof(int64_t);
+        case EventProperty::TYPE_DOUBLE_ARRAY:
+            return entry.as_ref.count * sizeof(double);
+        case EventProperty::TYPE_GUID_ARRAY:
+            return entry.as_ref.count * GuidSize;
+        case EventProperty::TYPE_STRING_ARRAY:
+        {
+            size_t size = entry.as_ref.count * sizeof(Slice);
+            for (size_t i = 0; i < entry.as_ref.count; i++)
+            {
+                size += entry.GetArray<Slice>()[i].size + 1;
+            }
+            return size;
+        }
+        default:
+            return 0;
+        }
+    }
+
+    void FlatPropertyMap::release(Entry const& entry) noexcept
+    {
+        m_garbage += payloadSize(entry);
+    }
+
+    void FlatPropertyMap::compactIfWasteful()
+    {
+        // A long-lived bag whose values keep being replaced would otherwise
+        // grow its arena without bound.
+        if (m_garbage > Arena::DefaultBlockSize && m_garbage * 2 > m_arena.size())
+        {
+            uint64_t version = m_version;
+            FlatPropertyMap copy(*this);
+            moveFrom(copy);
+            m_version = version;
+        }
+    }
+
+    void FlatPropertyMap::copyPayload(Entry& entry, Entry const& source)
+    {
+        switch (source.type)
+        {
+        case EventProperty::TYPE_STRING:
+            entry.as_ref.data = m_arena.copyString(source.GetString().data, source.as_ref.count);
+            break;
+        case EventProperty::TYPE_GUID:
+            entry.as_ref.data = m_arena.copyArray(source.GetGuidBytes(), GuidSize);
+            break;
+        case EventProperty::TYPE_INT64_ARRAY:
+            entry.as_ref.data = m_arena.copyArray(source.GetArray<int64_t>(), source.as_ref.count);
+            break;
+        case EventProperty::TYPE_DOUBLE_ARRAY:
+            entry.as_ref.data = m_arena.copyArray(source.GetArray<double>(), source.as_ref.count);
+            break;
+        case EventProperty::TYPE_GUID_ARRAY:
+            entry.as_ref.data = m_arena.copyArray(source.GetGuidBytes(), source.as_ref.count * GuidSize);
+            break;
+        case EventProperty::TYPE_STRING_ARRAY:
+        {
+            Slice* values = static_cast<Slice*>(m_arena.allocate(sizeof(Slice) * source.as_ref.count, alignof(Slice)));
+            for (size_t i = 0; i < source.as_ref.count; i++)
+            {
+                Slice const& value = source.GetArray<Slice>()[i];
+                values[i].data = m_arena.copyString(value.data, value.size);
+                values[i].size = value.size;
+            }
+            entry.as_ref.data = values;
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    FlatPropertyMap::Entry& FlatPropertyMap::slot(std::string const& name, PropertyNameTable::Id nameId, PiiKind piiKind, DataCategory category, uint8_t type)
+    {
+        compactIfWasteful();
+
+        Entry* it = std::lower_bound(m_entries, m_entries + m_size, name,
+            [](Entry const& entry, std::string const& key) { return compareName(entry, key) < 0; });
+        if (it != m_entries + m_size && compareName(*it, name) == 0)
+        {
+            release(*it);
+        }
+        else
+        {
+            size_t index = static_cast<size_t>(it - m_entries);
+            reserve(m_size + 1);
+            it = m_entries + index;
+            std::copy_backward(it, m_entries + m_size, m_entries + m_size + 1);
+            m_size++;
+
+            // Names were validated, and so interned, before they get here
+            PropertyNameTable& names = PropertyNameTable::GetInstance();
+            if (nameId == PropertyNameTable::InvalidId)
+            {
+                nameId = names.Find(name);
+            }
+            it->nameId = nameId;
+            if (nameId != PropertyNameTable::InvalidId)
+            {
+                it->name = names.GetName(nameId).data();
+            }
+            else
+            {
+                it->name = m_arena.copyString(name.data(), name.size());
+            }
+            it->nameSize = static_cast<uint32_t>(name.size());
+        }
+
+        it->type = type;
+        it->dataCategory = static_cast<uint8_t>(category);
+        it->piiKind = piiKind;
+        it->as_ref.data = nullptr;
+        it->as_ref.count = 0;
+        m_version++;
+        return *it;
+    }
+
+    void FlatPropertyMap::set(std::string const& name, EventProperty const& property, PropertyNameTable::Id nameId)
+    {
+        switch (property.type)
+        {
+        case EventProperty::TYPE_STRING:
+            set(name, property.as_string, strlen(property.as_string), property.piiKind, property.dataCategory, nameId);
+            break;
+        case EventProperty::TYPE_INT64:
+            set(name, property.as_int64, property.piiKind, property.dataCategory, nameId);
+            break;
+        case EventProperty::TYPE_DOUBLE:
+            set(name, property.as_double, property.piiKind, property.dataCategory, nameId);
+            break;
+        case EventProperty::TYPE_TIME:
+            set(name, property.as_time_ticks, property.piiKind, property.dataCategory, nameId);
+            break;
+        case EventProperty::TYPE_BOOLEAN:
+            set(name, property.as_bool, property.piiKind, property.dataCategory, nameId);
+            break;
+        case EventProperty::TYPE_GUID:
+            set(name, property.as_guid, property.piiKind, property.dataCategory, nameId);
+            break;
+        case EventProperty::TYPE_INT64_ARRAY:
+            set(name, *property.as_longArray, property.piiKind, property.dataCategory, nameId);
+            break;
+        case EventProperty::TYPE_DOUBLE_ARRAY:
+            set(name, *property.as_doubleArray, property.piiKind, property.dataCategory, nameId);
+            break;
+        case EventProperty::TYPE_GUID_ARRAY:
+            set(name, *property.as_guidArray, property.piiKind, property.dataCategory, nameId);
+            break;
+        case EventProperty::TYPE_STRING_ARRAY:
+            set(name, *property.as_stringArray, property.piiKind, property.dataCategory, nameId);
+            break;
+        default:
+            break;
+        }
+    }
+
+    void FlatPropertyMap::set(std::string const& name, char const* value, size_t size, PiiKind piiKind, DataCategory category, PropertyNameTable::Id nameId)
+    {
+        Entry& entry = slot(name, nameId, piiKind, category, EventProperty::TYPE_STRING);
+        entry.as_ref.data = m_arena.copyString(value, size);
+        entry.as_ref.count = size;
+    }
+
+    void FlatPropertyMap::set(std::string const& name, int64_t value, PiiKind piiKind, DataCategory category, PropertyNameTable::Id nameId)
+    {
+        slot(name, nameId, piiKind, category, EventProperty::TYPE_INT64).as_int64 = value;
+    }
+
+    void FlatPropertyMap::set(std::string const& name, double value, PiiKind piiKind, DataCategory category, PropertyNameTable::Id nameId)
+    {
+        slot(name, nameId, piiKind, category, EventProperty::TYPE_DOUBLE).as_double = value;
+    }
+
+    void FlatPropertyMap::set(std::string const& name, bool value, PiiKind piiKind, DataCategory category, PropertyNameTable::Id nameId)
+    {
+        slot(name, nameId, piiKind, category, EventProperty::TYPE_BOOLEAN).as_bool = value;
+    }
+
+    void FlatPropertyMap::set(std::string const& name, time_ticks_t value, PiiKind piiKind, DataCategory category, PropertyNameTable::Id nameId)
+    {
+        slot(name, nameId, piiKind, category, EventProperty::TYPE_TIME).as_time_ticks = value.ticks;
+    }
+
+    void FlatPropertyMap::set(std::string const& name, GUID_t const& value, PiiKind piiKind, DataCategory category, PropertyNameTable::Id nameId)
+    {
+        uint8_t bytes[GuidSize];
+        value.to_bytes(bytes);
+        Entry& entry = slot(name, nameId, piiKind, category, EventProperty::TYPE_GUID);
+        entry.as_ref.data = m_arena.copyArray(bytes, GuidSize);
+        entry.as_ref.count = 1;
+    }
+
+    void FlatPropertyMap::set(std::string const& name, std::vector<int64_t> const& value, PiiKind piiKind, DataCategory category, PropertyNameTable::Id nameId)
+    {
+        Entry& entry = slot(name, nameId, piiKind, category, EventProperty::TYPE_INT64_ARRAY);
+        entry.as_ref.data = m_arena.copyArray(value.data(), value.size());
+        entry.as_ref.count = value.size();
+    }
+
+    void FlatPropertyMap::set(std::string const& name, std::vector<double> const& value, PiiKind piiKind, DataCategory category, PropertyNameTable::Id nameId)
+    {
+        Entry& entry = slot(name, nameId, piiKind, category, EventProperty::TYPE_DOUBLE_ARRAY);
+        entry.as_ref.data = m_arena.copyArray(value.data(), value.size());
+        entry.as_ref.count = value.size();
+    }
+
+    void FlatPropertyMap::set(std::string const& name, std::vector<GUID_t> const& value, PiiKind piiKind, DataCategory category, PropertyNameTable::Id nameId)
+    {
+        Entry& entry = slot(name, nameId, piiKind, category, EventProperty::TYPE_GUID_ARRAY);
+        uint8_t* bytes = static_cast<uint8_t*>(m_arena.allocate(value.size() * GuidSize, 1));
+        for (size_t i = 0; i < value.size(); i++)
+        {
+            uint8_t(&guid)[GuidSize] = *reinterpret_cast<uint8_t(*)[GuidSize]>(bytes + i * GuidSize);
+            value[i].to_bytes(guid);
+        }
+        entry.as_ref.data = bytes;
+        entry.as_ref.count = value.size();
+    }
+
+    void FlatPropertyMap::set(std::string const& name, std::vector<std::string> const& value, PiiKind piiKind, DataCategory category, PropertyNameTable::Id nameId)
+    {
+        Entry& entry = slot(name, nameId, piiKind, category, EventProperty::TYPE_STRING_ARRAY);
+        Slice* values = static_cast<Slice*>(m_arena.allocate(sizeof(Slice) * value.size(), alignof(Slice)));
+        for (size_t i = 0; i < value.size(); i++)
+        {
+            values[i].data = m_arena.copyString(value[i].data(), value[i].size());
+            values[i].size = value[i].size();
+        }
+        entry.as_ref.data = values;
+        entry.as_ref.count = value.size();
+    }
+
+    size_t FlatPropertyMap::erase(std::string const& name)
+    {
+        Entry const* found = find(name);
+        if (found == nullptr)
+        {
+            return 0;
+        }
+        Entry* it = m_entries + (found - m_entries);
+        release(*it);
+        if (it->nameId == PropertyNameTable::InvalidId)
+        {
+            m_garbage += it->nameSize + 1;
+        }
+        std::copy(it + 1, m_entries + m_size, it);
+        m_size--;
+        m_version++;
+        return 1;
+    }
+
+    void FlatPropertyMap::clear() noexcept
+    {
+        std::vector<Entry>().swap(m_heap);
+        m_entries = m_inline;
+        m_size = 0;
+        m_capacity = InlineCapacity;
+        m_arena.clear();
+        m_garbage = 0;
+        m_version++;
+    }
+
+    void FlatPropertyMap::ToMap(std::map<std::string, EventProperty>& out) const
+    {
+        out.clear();
+        for (Entry const& entry : *this)
+        {
+            out.emplace_hint(out.end(), entry.GetName(), entry.ToEventProperty());
+        }
+    }
+
+} MAT_NS_END
@@ -0,0 +1,184 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef FLATPROPERTYMAP_HPP
+#define FLATPROPERTYMAP_HPP
+
+#include "mat/config.h"
+#include "Enums.hpp"
+#include "EventProperty.hpp"
+#include "utils/Arena.hpp"
+#include "utils/PropertyNameTable.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace MAT_NS_BEGIN
+{
+    /// <summary>
+    /// Property bag of one event, kept as a vector of entries sorted by name.
+    /// The first InlineCapacity entries live inside the object itself, and
+    /// string, GUID and array payloads are copied into a per-event arena, so
+    /// a typical event costs a couple of allocations instead of a tree node
+    /// and payload allocation per property.
+    ///
+    /// Interned property names point into PropertyNameTable and are never
+    /// copied. Iteration order matches std::map&lt;std::string, ...&gt;.
+    /// </summary>
+    class FlatPropertyMap
+    {
+       public:
+        static constexpr size_t InlineCapacity = 16;
+
+        struct Slice
+        {
+            char const* data;
+            size_t      size;
+        };
+
+        /// <summary>
+        /// One property. Entries are plain data pointing into the arena of
+        /// the map that owns them and are only valid while it is unchanged.
+        /// </summary>
+        struct Entry
+        {
+            char const*  name;
+            uint32_t     nameSize;
+            // Interned ID of the name, InvalidId if the name is in the arena
+            PropertyNameTable::Id nameId;
+            uint8_t      type;          // EventProperty::TYPE_*
+            uint8_t      dataCategory;  // DataCategory
+            PiiKind      piiKind;
+            union
+            {
+                int64_t  as_int64;
+                double   as_double;
+                bool     as_bool;
+                uint64_t as_time_ticks;
+                // Strings (NUL-terminated), GUIDs and arrays
+                struct
+                {
+                    void const* data;
+                    size_t      count;
+                } as_ref;
+            };
+
+            std::string GetName() const
+            {
+                return std::string(name, nameSize);
+            }
+
+            Slice GetString() const
+            {
+                return Slice { static_cast<char const*>(as_ref.data), as_ref.count };
+            }
+
+            /// <summary>
+            /// GUIDs are kept in their 16-byte wire form, see GUID_t::to_bytes.
+            /// </summary>
+            uint8_t const* GetGuidBytes(size_t index = 0) const
+            {
+                return static_cast<uint8_t const*>(as_ref.data) + index * 16;
+            }
+
+            GUID_t GetGuid(size_t index = 0) const
+            {
+                return GUID_t(GetGuidBytes(index));
+            }
+
+            template <typename T>
+            T const* GetArray() const
+            {
+                return static_cast<T const*>(as_ref.data);
+            }
+
+            /// <summary>
+            /// Rebuilds the public representation of the value.
+            /// </summary>
+            EventProperty ToEventProperty() const;
+        };
+
+        typedef Entry const* const_iterator;
+
+        FlatPropertyMap() noexcept;
+        FlatPropertyMap(FlatPropertyMap const& other);
+        FlatPropertyMap(FlatPropertyMap&& other) noexcept;
+        FlatPropertyMap& operator=(FlatPropertyMap const& other);
+        FlatPropertyMap& operator=(FlatPropertyMap&& other) noexcept;
+        ~FlatPropertyMap() = default;
+
+        const_iterator begin() const noexcept { return m_entries; }
+        const_iterator end() const noexcept { return m_entries + m_size; }
+        size_t size() const noexcept { return m_size; }
+        bool empty() const noexcept { return m_size == 0; }
+
+        /// <summary>
+        /// Returns the entry for a name, or nullptr.
+        /// </summary>
+        Entry const* find(std::string const& name) const;
+
+        /// <summary>
+        /// Sets a property. Callers that already interned the name pass its
+        /// ID, which saves looking the name up in PropertyNameTable again.
+        /// </summary>
+        void set(std::string const& name, EventProperty const& property, PropertyNameTable::Id nameId = PropertyNameTable::InvalidId);
+        void set(std::string const& name, char const* value, size_t size, PiiKind piiKind, DataCategory category, PropertyNameTable::Id nameId = PropertyNameTable::InvalidId);
+        void set(std::string const& name, int64_t value, PiiKind piiKind, DataCategory category, PropertyNameTable::Id nameId = PropertyNameTable::InvalidId);
+        void set(std::string const& name, double value, PiiKind piiKind, DataCategory category, PropertyNameTable::Id nameId = PropertyNameTable::InvalidId);
+        void set(std::string const& name, bool value, PiiKind piiKind, DataCategory category, PropertyNameTable::Id nameId = PropertyNameTable::InvalidId);
+        void set(std::string const& name, time_ticks_t value, PiiKind piiKind, DataCategory category, PropertyNameTable::Id nameId = PropertyNameTable::InvalidId);
+        void set(std::string const& name, GUID_t const& value, PiiKind piiKind, DataCategory category, PropertyNameTable::Id nameId = PropertyNameTable::InvalidId);
+        void set(std::string const& name, std::vector<int64_t> const& value, PiiKind piiKind, DataCategory category, PropertyNameTable::Id nameId = PropertyNameTable::InvalidId);
+        void set(std::string const& name, std::vector<double> const& value, PiiKind piiKind, DataCategory category, PropertyNameTable::Id nameId = PropertyNameTable::InvalidId);
+        void set(std::string const& name, std::vector<GUID_t> const& value, PiiKind piiKind, DataCategory category, PropertyNameTable::Id nameId = PropertyNameTable::InvalidId);
+        void set(std::string const& name, std::vector<std::string> const& value, PiiKind piiKind, DataCategory category, PropertyNameTable::Id nameId = PropertyNameTable::InvalidId);
+
+        size_t erase(std::string const& name);
+
+        void clear() noexcept;
+
+        /// <summary>
+        /// Counter bumped by every change, for caches derived from the map.
+        /// </summary>
+        uint64_t version() const noexcept { return m_version; }
+
+        /// <summary>
+        /// Copies the properties into the public map representation.
+        /// </summary>
+        void ToMap(std::map<std::string, EventProperty>& out) const;
+
+        /// <summary>
+        /// Bytes of arena memory in use, including payloads that were
+        /// overwritten or erased but not yet reclaimed.
+        /// </summary>
+        size_t arenaSize() const noexcept { return m_arena.size(); }
+
+       protected:
+        Entry& slot(std::string const& name, PropertyNameTable::Id nameId, PiiKind piiKind, DataCategory category, uint8_t type);
+        void copyPayload(Entry& entry, Entry const& source);
+        void reserve(size_t capacity);
+        void release(Entry const& entry) noexcept;
+        void moveFrom(FlatPropertyMap& other) noexcept;
+        void compactIfWasteful();
+
+        static size_t payloadSize(Entry const& entry) noexcept;
+
+        Entry                 m_inline[InlineCapacity];
+        std::vector<Entry>    m_heap;
+        Entry*                m_entries;
+        size_t                m_size;
+        size_t                m_capacity;
+        Arena                 m_arena;
+        // Arena bytes held by replaced or erased values; once they outweigh
+        // the live ones the arena is rebuilt.
+        size_t                m_garbage;
+        uint64_t              m_version;
+    };
+
+} MAT_NS_END
+
+#endif
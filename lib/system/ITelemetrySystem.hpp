@@ -41,9 +41,14 @@ namespace MAT_NS_BEGIN {
 
         virtual EventsUploadContextPtr createEventsUploadContext() = 0;
 
+        // Per-stage latencies, false when the system does not measure them
+        virtual bool getPipelineStats(PipelineStats& stats, bool reset) = 0;
+
         // Debug functionality
         virtual bool DispatchEvent(DebugEvent evt) override = 0;
 
+        virtual bool HasListeners(DebugEventType type) const = 0;
+
         // Core sendEvent
         virtual void sendEvent(IncomingEventContextPtr const& event) = 0;
 
@@ -120,6 +120,18 @@ namespace MAT_NS_BEGIN {
             LOG_TRACE("Stopped.");
             stopTimes[3] = GetUptimeMs() - stopTimes[3];
 
+            // Final pipeline latencies, while storage can still report its depth
+            if (pipelineStats.IsEnabled() && HasListeners(DebugEventType::EVT_PIPELINE_STATS))
+            {
+                PipelineStats pipeline;
+                getPipelineStats(pipeline, false);
+                DebugEvent evt(DebugEventType::EVT_PIPELINE_STATS);
+                evt.param1 = pipeline.stages.size();
+                evt.data = &pipeline;
+                evt.size = sizeof(pipeline);
+                DispatchEvent(evt);
+            }
+
             // stop storage
             stopTimes[4] = GetUptimeMs();
             storage.stop();
@@ -165,39 +177,44 @@ namespace MAT_NS_BEGIN {
         tpm.allUploadsFinished >> stats.onStop >> this->flushTaskDispatcher;
 
         // On an arbitrary user thread
-        this->sending >> bondSerializer.serialize >> this->incomingEventPrepared;
+        this->sending >> pipelineStats.serializing >> bondSerializer.serialize >> pipelineStats.serialized >> this->incomingEventPrepared;
 
         // On the inner worker thread
-        this->preparedIncomingEvent >> storage.storeRecord >> stats.onIncomingEventAccepted >> tpm.eventArrived;
+        this->preparedIncomingEvent >> pipelineStats.storing >> storage.storeRecord >> pipelineStats.stored >> stats.onIncomingEventAccepted >> tpm.eventArrived;
 
 
-        storage.storeRecordFailed >> stats.onIncomingEventFailed;
+        storage.storeRecordFailed >> pipelineStats.storeFailed >> stats.onIncomingEventFailed;
 
-        tpm.initiateUpload >> storage.retrieveEvents;
+        tpm.initiateUpload >> pipelineStats.retrieving >> storage.retrieveEvents;
+        tpm.prepareConnection >> hcm.prepareConnection;
 
         storage.retrievedEvent >> packager.addEventToPackage;
-        storage.retrievalFinished >> packager.finalizePackage;
+        storage.retrievalFinished >> pipelineStats.packaging >> packager.finalizePackage;
 
-        storage.retrievalFailed >> tpm.nothingToUpload;
-        packager.emptyPackage >> tpm.nothingToUpload;
+        storage.retrievalFailed >> pipelineStats.uploadAbandoned >> tpm.nothingToUpload;
+        packager.emptyPackage >> pipelineStats.uploadAbandoned >> tpm.nothingToUpload;
+        packager.packagingFailed >> pipelineStats.uploadAbandoned >> storage.releaseRecords >> stats.onPackagingFailed >> tpm.packagingFailed;
 
         packager.packagedEvents >>
 #ifdef HAVE_MAT_ZLIB
-        compression.compress >>
+        pipelineStats.compressing >> compression.compress >>
 #endif
-        httpEncoder.encode >> clockSkewDelta.encode >> stats.onUploadStarted >> hcm.sendRequest;
+        pipelineStats.encoding >> httpEncoder.encode >> clockSkewDelta.encode >> stats.onUploadStarted >> pipelineStats.uploading >> hcm.sendRequest;
 
 #ifdef HAVE_MAT_ZLIB
-        compression.compressionFailed >> storage.releaseRecords >> stats.onPackagingFailed >> tpm.packagingFailed;
+        compression.compressionFailed >> pipelineStats.uploadAbandoned >> storage.releaseRecords >> stats.onPackagingFailed >> tpm.packagingFailed;
 #endif
 
-        hcm.requestDone >> clockSkewDelta.decode >> httpDecoder.decode;
+        hcm.requestDone >> pipelineStats.decoding >> clockSkewDelta.decode >> httpDecoder.decode;
 
-        httpDecoder.eventsAccepted >> storage.deleteRecords >> stats.onUploadSuccessful >> tpm.eventsUploadSuccessful;
-        httpDecoder.eventsRejected >> storage.deleteRecords >> stats.onUploadRejected >> tpm.eventsUploadRejected;
-        httpDecoder.temporaryNetworkFailure >> storage.releaseRecords >> stats.onUploadFailed >> tpm.eventsUploadFailed;
-        httpDecoder.temporaryServerFailure >> storage.releaseRecordsIncRetryCount >> stats.onUploadFailed >> tpm.eventsUploadFailed;
-        httpDecoder.requestAborted >> storage.releaseRecords >> stats.onUploadFailed >> tpm.eventsUploadAborted;
+        httpDecoder.eventsAccepted >> pipelineStats.delivered >> storage.deleteRecords >> stats.onUploadSuccessful >> tpm.eventsUploadSuccessful;
+        httpDecoder.eventsRejected >> pipelineStats.decoded >> storage.deleteRecords >> stats.onUploadRejected >> tpm.eventsUploadRejected;
+        httpDecoder.temporaryNetworkFailure >> pipelineStats.decoded >> storage.releaseRecords >> stats.onUploadFailed >> tpm.eventsUploadFailed;
+        httpDecoder.temporaryServerFailure >> pipelineStats.decoded >> storage.releaseRecordsIncRetryCount >> stats.onUploadFailed >> tpm.eventsUploadFailed;
+        httpDecoder.requestAborted >> pipelineStats.decoded >> storage.releaseRecords >> stats.onUploadFailed >> tpm.eventsUploadAborted;
+#ifdef HAVE_MAT_ZLIB
+        httpDecoder.contentEncodingRejected >> compression.contentEncodingRejected;
+#endif
 
 
         //
@@ -245,6 +262,24 @@ namespace MAT_NS_BEGIN {
         preparedIncomingEventAsync(event);
     }
 
+    bool TelemetrySystem::getPipelineStats(PipelineStats& stats, bool reset)
+    {
+        if (!TelemetrySystemBase::getPipelineStats(stats, reset))
+        {
+            return false;
+        }
+        PipelineQueueStats stored;
+        stored.name = "storage";
+        stored.depth = storage.GetRecordCount();
+        stats.queues.push_back(stored);
+
+        PipelineQueueStats requests;
+        requests.name = "http";
+        requests.depth = hcm.requestCount();
+        stats.queues.push_back(requests);
+        return true;
+    }
+
     void TelemetrySystem::handleFlushTaskDispatcher()
     {
         signalDone();
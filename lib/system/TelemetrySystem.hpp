@@ -56,6 +56,7 @@ namespace MAT_NS_BEGIN {
 
         virtual bool upload() override;
         virtual void handleIncomingEventPrepared(IncomingEventContextPtr const& event) override;
+        virtual bool getPipelineStats(PipelineStats& stats, bool reset) override;
 
     protected:
 
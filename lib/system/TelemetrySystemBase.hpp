@@ -6,8 +6,11 @@
 #define TELEMETRYSYSTEMBASE_HPP
 
 #include "system/ITelemetrySystem.hpp"
+#include "system/EventsUploadContextPool.hpp"
 #include "ITaskDispatcher.hpp"
+#include "packager/DeflateSplicer.hpp"
 #include "stats/Statistics.hpp"
+#include "stats/PipelineStatsCollector.hpp"
 #include <functional>
 
 namespace MAT_NS_BEGIN {
@@ -34,7 +37,8 @@ namespace MAT_NS_BEGIN {
             m_config(runtimeConfig),
             m_isStarted(false),
             m_isPaused(false),
-            stats(*this, taskDispatcher)
+            stats(*this, taskDispatcher),
+            pipelineStats(runtimeConfig.HasConfig(CFG_BOOL_ENABLE_PIPELINE_STATS) && runtimeConfig[CFG_BOOL_ENABLE_PIPELINE_STATS])
         {
             onStart  = []() noexcept { return true; };
             onStop   = []() noexcept { return true; };
@@ -164,7 +168,44 @@ namespace MAT_NS_BEGIN {
 
         EventsUploadContextPtr createEventsUploadContext() override
         {
-            return std::make_shared<EventsUploadContext>();
+#ifdef HAVE_MAT_ZLIB
+            std::string const& contentEncoding = m_config.GetHttpRequestContentEncoding();
+            if (m_config.IsHttpRequestCompressionEnabled() && m_config[CFG_MAP_HTTP][CFG_BOOL_HTTP_COMPRESSION_STREAMING] &&
+                (contentEncoding == "deflate" || contentEncoding == "gzip"))
+            {
+                // Contexts made for other settings (gzip or deflate, level) are not reused
+                DeflateParameters const parameters = DeflateParameters::FromConfig(m_config);
+                EventsUploadContextPtr ctx = m_uploadContexts.Acquire(parameters.GetKey(), [&parameters]() -> std::unique_ptr<ISplicer>
+                {
+                    std::unique_ptr<DeflateSplicer> splicer(new DeflateSplicer(parameters));
+                    if (!splicer->good())
+                    {
+                        return nullptr;
+                    }
+                    return std::unique_ptr<ISplicer>(splicer.release());
+                });
+                if (ctx != nullptr)
+                {
+                    // Used for the Content-Encoding header once the body is spliced
+                    ctx->contentEncoding = parameters.GetContentEncoding();
+                    return ctx;
+                }
+            }
+#endif
+            return m_uploadContexts.Acquire(EventsUploadContextPool::PlainSplicerKey, []() -> std::unique_ptr<ISplicer>
+            {
+                return std::unique_ptr<ISplicer>(new BondSplicer());
+            });
+        }
+
+        virtual bool getPipelineStats(PipelineStats& stats, bool reset) override
+        {
+            if (!pipelineStats.IsEnabled())
+            {
+                return false;
+            }
+            pipelineStats.GetStats(stats, reset);
+            return true;
         }
 
         virtual bool DispatchEvent(DebugEvent evt) override
@@ -172,6 +213,11 @@ namespace MAT_NS_BEGIN {
             return m_logManager.DispatchEvent(std::move(evt));
         }
 
+        virtual bool HasListeners(DebugEventType type) const override
+        {
+            return m_logManager.HasListeners(type);
+        }
+
     protected:
         std::mutex              m_lock;
         ILogManager &           m_logManager;
@@ -181,6 +227,8 @@ namespace MAT_NS_BEGIN {
         PAL::Event              m_done;
         BondSerializer          bondSerializer;
         Statistics              stats;
+        PipelineStatsCollector  pipelineStats;
+        EventsUploadContextPool m_uploadContexts;
 
         std::function<bool(void)>                                  onStart;
         std::function<bool(void)>                                  onStop;
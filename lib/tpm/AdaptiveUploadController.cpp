@@ -0,0 +1,146 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "AdaptiveUploadController.hpp"
+
+#include <algorithm>
+
+namespace MAT_NS_BEGIN {
+
+    // Weight of the newest sample in the smoothed round trip time and
+    // throughput, as for the TCP round trip time estimator
+    static constexpr double SmoothingFactor = 0.125;
+
+    // Delays shorter than this are dropped once uploads succeed again
+    static constexpr int64_t MinUploadDelayMs = 100;
+
+    constexpr int64_t AdaptiveUploadController::MaxUploadDelayMs;
+
+    AdaptiveUploadController::AdaptiveUploadController(unsigned minUploadSizeBytes, unsigned targetRttMs)
+      : m_minUploadSize(minUploadSizeBytes),
+        m_targetRttMs(targetRttMs)
+    {
+    }
+
+    void AdaptiveUploadController::setLimits(unsigned maxUploadSizeBytes, unsigned maxUploadsInFlight)
+    {
+        m_maxUploadSize = std::max(maxUploadSizeBytes, m_minUploadSize);
+        m_maxInFlight = std::max(maxUploadsInFlight, 1u);
+        if (m_uploadSize == 0)
+        {
+            // Start halfway, the first uploads tell which way to go
+            m_uploadSize = m_maxUploadSize / 2;
+        }
+        clamp();
+    }
+
+    bool AdaptiveUploadController::onUploadFinished(UploadObservation const& observation)
+    {
+        unsigned const uploadSize = m_uploadSize;
+        unsigned const inFlight = m_inFlight;
+        int64_t const delayMs = m_delayMs;
+
+        switch (observation.outcome)
+        {
+        case UploadOutcome::Accepted:
+            if (observation.durationMs >= 0)
+            {
+                double rttMs = static_cast<double>(observation.durationMs);
+                m_rttMs = (m_rttMs == 0) ? rttMs : m_rttMs + SmoothingFactor * (rttMs - m_rttMs);
+                if (observation.durationMs > 0 && observation.bytes > 0)
+                {
+                    double throughputBps = static_cast<double>(observation.bytes) * 1000 / rttMs;
+                    m_throughputBps = (m_throughputBps == 0) ? throughputBps : m_throughputBps + SmoothingFactor * (throughputBps - m_throughputBps);
+                }
+            }
+            m_delayMs = (m_delayMs / 2 < MinUploadDelayMs) ? 0 : m_delayMs / 2;
+            if (observation.durationMs > static_cast<int>(m_targetRttMs))
+            {
+                decreaseUploadSize();
+                m_acceptedInWindow = 0;
+                break;
+            }
+            m_uploadSize += m_minUploadSize;
+            if (++m_acceptedInWindow >= m_inFlight)
+            {
+                m_acceptedInWindow = 0;
+                m_inFlight++;
+            }
+            break;
+
+        case UploadOutcome::ServerError:
+            if (observation.statusCode == 429 || observation.statusCode == 503 || observation.retryAfterMs > 0)
+            {
+                decreaseUploadSize();
+                throttle(observation.retryAfterMs);
+            }
+            else if (observation.statusCode == 408)
+            {
+                // Request timeout: the package took too long
+                decreaseUploadSize();
+            }
+            else
+            {
+                m_inFlight = std::max(m_inFlight / 2, 1u);
+            }
+            m_acceptedInWindow = 0;
+            break;
+
+        case UploadOutcome::NetworkError:
+            decreaseUploadSize();
+            m_inFlight = 1;
+            m_acceptedInWindow = 0;
+            break;
+
+        case UploadOutcome::Rejected:
+            // The payload was refused, which says nothing about capacity
+            if (observation.retryAfterMs > 0)
+            {
+                throttle(observation.retryAfterMs);
+            }
+            break;
+
+        case UploadOutcome::Aborted:
+            break;
+        }
+
+        clamp();
+        return (uploadSize != m_uploadSize) || (inFlight != m_inFlight) || (delayMs != m_delayMs);
+    }
+
+    UploadControllerState AdaptiveUploadController::getState() const
+    {
+        UploadControllerState state;
+        state.maxUploadSizeBytes = m_uploadSize;
+        state.maxUploadsInFlight = m_inFlight;
+        state.uploadDelayMs = static_cast<size_t>(m_delayMs);
+        state.rttMs = static_cast<size_t>(m_rttMs);
+        state.throughputBps = static_cast<size_t>(m_throughputBps);
+        return state;
+    }
+
+    void AdaptiveUploadController::decreaseUploadSize()
+    {
+        m_uploadSize /= 2;
+    }
+
+    void AdaptiveUploadController::throttle(int64_t retryAfterMs)
+    {
+        m_inFlight = std::max(m_inFlight / 2, 1u);
+        int64_t delayMs = (m_delayMs == 0) ? static_cast<int64_t>(m_targetRttMs) : m_delayMs * 2;
+        m_delayMs = std::max(delayMs, retryAfterMs);
+    }
+
+    void AdaptiveUploadController::clamp()
+    {
+        if (m_maxUploadSize != 0)
+        {
+            m_uploadSize = std::min(std::max(m_uploadSize, m_minUploadSize), m_maxUploadSize);
+        }
+        m_inFlight = std::min(std::max(m_inFlight, 1u), m_maxInFlight);
+        m_delayMs = std::min(std::max<int64_t>(m_delayMs, 0), MaxUploadDelayMs);
+    }
+
+} MAT_NS_END
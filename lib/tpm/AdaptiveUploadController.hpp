@@ -0,0 +1,69 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef ADAPTIVEUPLOADCONTROLLER_HPP
+#define ADAPTIVEUPLOADCONTROLLER_HPP
+
+#include "tpm/IUploadController.hpp"
+
+namespace MAT_NS_BEGIN {
+
+
+/// <summary>
+/// Upload controller with additive increase and multiplicative decrease.
+/// Every accepted upload within the target round trip time grows the
+/// package by one step, and every window of accepted uploads allows one
+/// more upload in flight. Slow uploads, timeouts and network errors halve
+/// the package, throttling (429, 503 or Retry-After) halves the uploads in
+/// flight as well and stretches the interval until uploads succeed again.
+/// </summary>
+class AdaptiveUploadController : public IUploadController {
+  public:
+    /// <summary>
+    /// Longest delay the controller adds before an upload.
+    /// </summary>
+    static constexpr int64_t MaxUploadDelayMs = 300000;
+
+    /// <summary>
+    /// Initializes the controller.
+    /// </summary>
+    /// <param name="minUploadSizeBytes">Smallest package size, also the increase step</param>
+    /// <param name="targetRttMs">Round trip time above which packages shrink</param>
+    AdaptiveUploadController(unsigned minUploadSizeBytes, unsigned targetRttMs);
+
+    bool good() const
+    {
+        return (m_minUploadSize > 0) && (m_targetRttMs > 0);
+    }
+
+    virtual void setLimits(unsigned maxUploadSizeBytes, unsigned maxUploadsInFlight) override;
+
+    virtual bool onUploadFinished(UploadObservation const& observation) override;
+
+    virtual UploadControllerState getState() const override;
+
+  protected:
+    void decreaseUploadSize();
+    void throttle(int64_t retryAfterMs);
+    void clamp();
+
+    unsigned m_minUploadSize;
+    unsigned m_targetRttMs;
+
+    unsigned m_maxUploadSize { 0 };
+    unsigned m_maxInFlight { 1 };
+
+    // 0 until the first limits arrive
+    unsigned m_uploadSize { 0 };
+    unsigned m_inFlight { 1 };
+    unsigned m_acceptedInWindow { 0 };
+    int64_t  m_delayMs { 0 };
+
+    double   m_rttMs { 0 };
+    double   m_throughputBps { 0 };
+};
+
+
+} MAT_NS_END
+#endif
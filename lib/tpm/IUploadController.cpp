@@ -0,0 +1,43 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "IUploadController.hpp"
+#include "AdaptiveUploadController.hpp"
+#include <sstream>
+
+namespace MAT_NS_BEGIN {
+
+
+std::unique_ptr<IUploadController> IUploadController::createFromConfig(std::string const& config)
+{
+    std::unique_ptr<IUploadController> result;
+
+    std::istringstream is(config);
+    // Force the classic "C" locale
+    is.imbue(std::locale::classic());
+
+    char kind = (char)is.get();
+    if (is.get() != ',') {
+        return result;
+    }
+
+    if (kind == 'A') {
+        // "A,minUploadSizeBytes,targetRttMs"
+        char sep = 0;
+        unsigned minUploadSizeBytes, targetRttMs;
+        is >> minUploadSizeBytes >> sep >> targetRttMs;
+        if (!is.fail() && is.get() == EOF && sep == ',') {
+            result.reset(new AdaptiveUploadController(minUploadSizeBytes, targetRttMs));
+            if (!static_cast<AdaptiveUploadController*>(result.get())->good()) {
+                result.reset();
+            }
+        }
+    }
+
+    return result;
+}
+
+
+} MAT_NS_END
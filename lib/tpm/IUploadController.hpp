@@ -0,0 +1,77 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef IUPLOADCONTROLLER_HPP
+#define IUPLOADCONTROLLER_HPP
+
+#include "pal/PAL.hpp"
+#include "DebugEvents.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace MAT_NS_BEGIN {
+
+/// <summary>
+/// How an upload ended, as seen by the transmission policy manager.
+/// </summary>
+enum class UploadOutcome
+{
+    Accepted,
+    Rejected,
+    ServerError,
+    NetworkError,
+    Aborted
+};
+
+/// <summary>
+/// What one finished upload tells about the link and the collector.
+/// </summary>
+struct UploadObservation
+{
+    UploadOutcome outcome      = UploadOutcome::Aborted;
+    unsigned      statusCode   = 0;
+    int           durationMs   = -1;
+    size_t        bytes        = 0;
+    // Server-requested delay from the Retry-After header, 0 when absent
+    int64_t       retryAfterMs = 0;
+};
+
+/// <summary>
+/// Interface for controllers tuning package size, upload interval and
+/// number of uploads in flight from the outcome of earlier uploads. The
+/// transmission policy manager serializes all calls.
+/// </summary>
+class IUploadController {
+  public:
+    virtual ~IUploadController() {}
+
+    /// <summary>
+    /// Sets the configured ceilings the controller has to stay within.
+    /// </summary>
+    virtual void setLimits(unsigned maxUploadSizeBytes, unsigned maxUploadsInFlight) = 0;
+
+    /// <summary>
+    /// Adjusts the current decision to a finished upload.
+    /// </summary>
+    /// <returns>True if the decision changed</returns>
+    virtual bool onUploadFinished(UploadObservation const& observation) = 0;
+
+    /// <summary>
+    /// Retrieves the current decision.
+    /// </summary>
+    virtual UploadControllerState getState() const = 0;
+
+    /// <summary>
+    /// Factory for creating new controllers.
+    /// </summary>
+    /// <returns>Smart pointer to the created controller or empty in case
+    /// of errors (bad configuration) or if none is configured</returns>
+    static std::unique_ptr<IUploadController> createFromConfig(std::string const& config);
+};
+
+
+} MAT_NS_END
+#endif
@@ -5,8 +5,10 @@
 
 #include "TransmissionPolicyManager.hpp"
 #include "TransmitProfiles.hpp"
+#include "offline/KillSwitchManager.hpp"
 #include "utils/Utils.hpp"
 
+#include <algorithm>
 #include <limits>
 
 namespace MAT_NS_BEGIN {
@@ -99,6 +101,73 @@ namespace MAT_NS_BEGIN {
         return delay;
     }
 
+    void TransmissionPolicyManager::checkUploadControllerConfigUpdate()
+    {
+        std::string config = m_config[CFG_MAP_TPM][CFG_STR_TPM_UPLOAD_CONTROLLER];
+        if (config != m_uploadControllerConfig)
+        {
+            std::unique_ptr<IUploadController> controller = IUploadController::createFromConfig(config);
+            if (!controller && !config.empty())
+            {
+                LOG_WARN("The new upload controller configuration is invalid, uploads are not tuned");
+            }
+            m_uploadController = std::move(controller);
+            m_uploadControllerConfig = config;
+        }
+    }
+
+    bool TransmissionPolicyManager::getUploadControllerState(UploadControllerState& state)
+    {
+        LOCKGUARD(m_uploadControllerMutex);
+        checkUploadControllerConfigUpdate();
+        if (!m_uploadController)
+        {
+            return false;
+        }
+        uint32_t maxPending = m_config[CFG_INT_MAX_PENDING_REQ];
+        m_uploadController->setLimits(m_config.GetMaximumUploadSizeBytes(), maxPending);
+        state = m_uploadController->getState();
+        return true;
+    }
+
+    void TransmissionPolicyManager::observeUpload(EventsUploadContextPtr const& ctx, UploadOutcome outcome)
+    {
+        UploadObservation observation;
+        observation.outcome = outcome;
+        observation.durationMs = ctx->durationMs;
+        observation.bytes = (ctx->httpRequest != nullptr) ? ctx->httpRequest->GetSizeEstimate() : ctx->body.size();
+        if (ctx->httpResponse != nullptr)
+        {
+            observation.statusCode = ctx->httpResponse->GetStatusCode();
+            std::string retryAfter = ctx->httpResponse->GetHeaders().getIgnoreCase("Retry-After");
+            int64_t seconds = 0;
+            if (!retryAfter.empty() && KillSwitchManager::tryParseSeconds(retryAfter, seconds))
+            {
+                observation.retryAfterMs = seconds * 1000;
+            }
+        }
+
+        UploadControllerState state;
+        {
+            LOCKGUARD(m_uploadControllerMutex);
+            if (!m_uploadController || !m_uploadController->onUploadFinished(observation))
+            {
+                return;
+            }
+            state = m_uploadController->getState();
+        }
+        LOG_TRACE("Upload tuned: size=%u in-flight=%u delay=%u ms rtt=%u ms",
+            static_cast<unsigned>(state.maxUploadSizeBytes), static_cast<unsigned>(state.maxUploadsInFlight),
+            static_cast<unsigned>(state.uploadDelayMs), static_cast<unsigned>(state.rttMs));
+
+        ILogManager& logManager = m_system.getLogManager();
+        if (logManager.HasListeners(EVT_UPLOAD_TUNED))
+        {
+            DebugEvent evt(EVT_UPLOAD_TUNED, state.maxUploadSizeBytes, state.maxUploadsInFlight, &state, sizeof(state));
+            logManager.DispatchEvent(evt);
+        }
+    }
+
     // If delayInMs is negative, do not schedule.
     void TransmissionPolicyManager::scheduleUpload(const std::chrono::milliseconds& delay, EventLatency latency, bool force)
     {
@@ -175,6 +244,11 @@ namespace MAT_NS_BEGIN {
             m_runningLatency = latency;
             LOG_TRACE("SCHED upload %d ms for lat=%d", delay.count(), m_runningLatency);
             m_scheduledUpload = PAL::scheduleTask(&m_taskDispatcher, static_cast<unsigned>(delay.count()), this, &TransmissionPolicyManager::uploadAsync, latency);
+            if (delay.count() > 0)
+            {
+                // Let the HTTP client connect while the upload waits
+                prepareConnection(m_config.GetCollectorUrl());
+            }
         }
     }
 
@@ -216,10 +290,50 @@ namespace MAT_NS_BEGIN {
         }
 #endif
 
-        auto ctx = m_system.createEventsUploadContext();
-        ctx->requestedMinLatency = m_runningLatency;
-        addUpload(ctx);
-        initiateUpload(ctx);
+        UploadControllerState tuning;
+        bool tuned = getUploadControllerState(tuning);
+        unsigned maxUploadSize = tuned ? static_cast<unsigned>(tuning.maxUploadSizeBytes) : 0;
+        size_t window = pipelineWindow(tuned ? &tuning : nullptr);
+        if (window <= 1)
+        {
+            auto ctx = m_system.createEventsUploadContext();
+            ctx->requestedMinLatency = m_runningLatency;
+            ctx->maxUploadSize = maxUploadSize;
+            addUpload(ctx);
+            initiateUpload(ctx);
+            return;
+        }
+
+        // Keep packaging while the previous upload is on the wire. Storage
+        // hands out the highest latency first and every package stops at the
+        // next latency, so RealTime records never queue behind a Normal batch.
+        bool pipelined = false;
+        for (;;)
+        {
+            size_t count = uploadCount();
+            if (pipelined && count >= window)
+            {
+                break;
+            }
+            auto ctx = m_system.createEventsUploadContext();
+            ctx->requestedMinLatency = m_runningLatency;
+            ctx->singleLatency = true;
+            ctx->pipelined = pipelined;
+            ctx->maxUploadSize = maxUploadSize;
+            if (count + 1 >= window)
+            {
+                // The last slot is kept for latencies above Normal
+                ctx->requestedMinLatency = std::max(ctx->requestedMinLatency, EventLatency_RealTime);
+            }
+            addUpload(ctx);
+            initiateUpload(ctx);
+            // Finished already: nothing left to send, or it failed
+            if (!isUploadActive(ctx) || m_isPaused || m_scheduledUploadAborted)
+            {
+                break;
+            }
+            pipelined = true;
+        }
     }
 
     void TransmissionPolicyManager::finishUpload(EventsUploadContextPtr const& ctx, const std::chrono::milliseconds& nextUpload)
@@ -240,7 +354,13 @@ namespace MAT_NS_BEGIN {
         {
             LOG_TRACE("Scheduling upload in %d ms", nextUpload.count());
             EventLatency proposed = calculateNewPriority();
-            scheduleUpload(nextUpload, proposed); // reschedule uploadAsync again
+            std::chrono::milliseconds delay = nextUpload;
+            UploadControllerState tuning;
+            if (getUploadControllerState(tuning))
+            {
+                delay = std::max(delay, std::chrono::milliseconds { static_cast<int64_t>(tuning.uploadDelayMs) });
+            }
+            scheduleUpload(delay, proposed); // reschedule uploadAsync again
         }
     }
 
@@ -386,7 +506,8 @@ namespace MAT_NS_BEGIN {
     {
         LOG_TRACE("No stored events to send at the moment");
         resetBackoff();
-        if (ctx->requestedMinLatency == EventLatency_Normal)
+        // Uploads still in flight schedule the next round when they finish
+        if (ctx->pipelined || ctx->requestedMinLatency == EventLatency_Normal)
         {
             finishUpload(ctx, std::chrono::milliseconds{ -1 });
         }
@@ -403,22 +524,27 @@ namespace MAT_NS_BEGIN {
 
     void TransmissionPolicyManager::handleEventsUploadSuccessful(EventsUploadContextPtr const& ctx)
     {
+        observeUpload(ctx, UploadOutcome::Accepted);
         resetBackoff();
         finishUpload(ctx, std::chrono::milliseconds{});
     }
 
     void TransmissionPolicyManager::handleEventsUploadRejected(EventsUploadContextPtr const& ctx)
     {
+        observeUpload(ctx, UploadOutcome::Rejected);
         finishUpload(ctx, increaseBackoff());
     }
 
     void TransmissionPolicyManager::handleEventsUploadFailed(EventsUploadContextPtr const& ctx)
     {
+        // Server errors keep the response, network errors have none
+        observeUpload(ctx, (ctx->httpResponse != nullptr) ? UploadOutcome::ServerError : UploadOutcome::NetworkError);
         finishUpload(ctx, increaseBackoff());
     }
 
     void TransmissionPolicyManager::handleEventsUploadAborted(EventsUploadContextPtr const& ctx)
     {
+        observeUpload(ctx, UploadOutcome::Aborted);
         finishUpload(ctx, std::chrono::milliseconds{ -1 });
     }
 
@@ -473,6 +599,23 @@ namespace MAT_NS_BEGIN {
         return m_activeUploads.size();
     }
 
+    bool TransmissionPolicyManager::isUploadActive(EventsUploadContextPtr const& ctx) const
+    {
+        LOCKGUARD(m_activeUploads_lock);
+        return m_activeUploads.find(ctx) != m_activeUploads.cend();
+    }
+
+    size_t TransmissionPolicyManager::pipelineWindow(UploadControllerState const* tuning)
+    {
+        uint32_t maxPending = m_config[CFG_INT_MAX_PENDING_REQ];
+        if (tuning != nullptr)
+        {
+            return std::min<size_t>(tuning->maxUploadsInFlight, maxPending);
+        }
+        uint32_t window = m_config[CFG_MAP_TPM][CFG_INT_TPM_MAX_PIPELINED_UPLOADS];
+        return std::min(window, maxPending);
+    }
+
     bool TransmissionPolicyManager::isUploadInProgress() const noexcept
     {
         // unfinished uploads that haven't processed callbacks or pending upload task
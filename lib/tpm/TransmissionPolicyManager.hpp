@@ -9,6 +9,7 @@
 
 #include "api/IRuntimeConfig.hpp"
 #include "backoff/IBackoff.hpp"
+#include "tpm/IUploadController.hpp"
 #include "pal/PAL.hpp"
 
 #include "system/Contexts.hpp"
@@ -56,6 +57,18 @@ constexpr const char* const DefaultBackoffConfig = "E,3000,300000,2,1";
         void resetBackoff();
         std::chrono::milliseconds increaseBackoff();
 
+        void checkUploadControllerConfigUpdate();
+
+        /// <summary>
+        /// Retrieves the decision of the upload controller, if one is configured.
+        /// </summary>
+        bool getUploadControllerState(UploadControllerState& state);
+
+        /// <summary>
+        /// Tells the upload controller how an upload ended.
+        /// </summary>
+        void observeUpload(EventsUploadContextPtr const& ctx, UploadOutcome outcome);
+
         void uploadAsync(EventLatency priority);
         void finishUpload(EventsUploadContextPtr const& ctx, const std::chrono::milliseconds& nextUpload);
         bool updateTimersIfNecessary();
@@ -87,6 +100,10 @@ constexpr const char* const DefaultBackoffConfig = "E,3000,300000,2,1";
         std::recursive_mutex             m_backoffMutex;
         std::string                      m_backoffConfig { DefaultBackoffConfig };
         std::unique_ptr<IBackoff>        m_backoff;
+
+        std::mutex                       m_uploadControllerMutex;
+        std::string                      m_uploadControllerConfig;
+        std::unique_ptr<IUploadController> m_uploadController;
         DeviceStateHandler               m_deviceStateHandler;
 
         std::atomic<bool>                m_isPaused { true };
@@ -130,6 +147,18 @@ constexpr const char* const DefaultBackoffConfig = "E,3000,300000,2,1";
         /// <returns></returns>
         size_t uploadCount() const noexcept;
 
+        /// <summary>
+        /// Whether the upload has not finished yet.
+        /// </summary>
+        bool isUploadActive(EventsUploadContextPtr const& ctx) const;
+
+        /// <summary>
+        /// Number of uploads one scheduled upload may prepare back to back,
+        /// see CFG_INT_TPM_MAX_PIPELINED_UPLOADS, or as the upload controller
+        /// decided.
+        /// </summary>
+        size_t pipelineWindow(UploadControllerState const* tuning);
+
         std::chrono::milliseconds        m_timerdelay { std::chrono::seconds { 2 } };
         EventLatency                     m_runningLatency { EventLatency_RealTime };
         TimerArray                       m_timers;
@@ -145,6 +174,7 @@ constexpr const char* const DefaultBackoffConfig = "E,3000,300000,2,1";
         RouteSink<TransmissionPolicyManager, IncomingEventContextPtr const&> eventArrived{ this, &TransmissionPolicyManager::handleEventArrived };
 
         RouteSource<EventsUploadContextPtr const&>                           initiateUpload;
+        RouteSource<std::string const&>                                      prepareConnection;
         RouteSink<TransmissionPolicyManager, EventsUploadContextPtr const&>  nothingToUpload{ this, &TransmissionPolicyManager::handleNothingToUpload };
         RouteSink<TransmissionPolicyManager, EventsUploadContextPtr const&>  packagingFailed{ this, &TransmissionPolicyManager::handlePackagingFailed };
         RouteSink<TransmissionPolicyManager, EventsUploadContextPtr const&>  eventsUploadSuccessful{ this, &TransmissionPolicyManager::handleEventsUploadSuccessful };
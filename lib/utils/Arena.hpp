@@ -0,0 +1,180 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include "mat/config.h"
+#include "ctmacros.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+namespace MAT_NS_BEGIN
+{
+    /// <summary>
+    /// Bump allocator for short-lived payloads that all die together, such
+    /// as the strings and arrays of one event. Memory comes from a chain of
+    /// blocks that only grows; nothing is freed until the arena is cleared
+    /// or destroyed. Moving an arena keeps every pointer it handed out valid.
+    /// </summary>
+    class Arena
+    {
+       public:
+        static constexpr size_t DefaultBlockSize = 512;
+        static constexpr size_t MaxBlockSize = 16 * 1024;
+
+        explicit Arena(size_t blockSize = DefaultBlockSize) noexcept :
+            m_head(nullptr),
+            m_offset(0),
+            m_blockSize(blockSize),
+            m_size(0)
+        {
+        }
+
+        ~Arena()
+        {
+            clear();
+        }
+
+        Arena(Arena const&) = delete;
+        Arena& operator=(Arena const&) = delete;
+
+        Arena(Arena&& other) noexcept :
+            m_head(other.m_head),
+            m_offset(other.m_offset),
+            m_blockSize(other.m_blockSize),
+            m_size(other.m_size)
+        {
+            other.m_head = nullptr;
+            other.m_offset = 0;
+            other.m_size = 0;
+        }
+
+        Arena& operator=(Arena&& other) noexcept
+        {
+            if (this != &other)
+            {
+                clear();
+                std::swap(m_head, other.m_head);
+                std::swap(m_offset, other.m_offset);
+                std::swap(m_size, other.m_size);
+                m_blockSize = other.m_blockSize;
+            }
+            return *this;
+        }
+
+        /// <summary>
+        /// Returns size bytes aligned to alignment, which must be a power of
+        /// two no larger than alignof(std::max_align_t).
+        /// </summary>
+        void* allocate(size_t size, size_t alignment = alignof(std::max_align_t))
+        {
+            size_t offset = (m_offset + alignment - 1) & ~(alignment - 1);
+            if (m_head == nullptr || offset + size > m_head->capacity)
+            {
+                addBlock(size);
+                offset = 0;
+            }
+            m_offset = offset + size;
+            m_size += size;
+            return m_head->data() + offset;
+        }
+
+        /// <summary>
+        /// Copies size characters and a terminating NUL.
+        /// </summary>
+        char const* copyString(char const* value, size_t size)
+        {
+            char* result = static_cast<char*>(allocate(size + 1, 1));
+            if (size != 0)
+            {
+                memcpy(result, value, size);
+            }
+            result[size] = 0;
+            return result;
+        }
+
+        template <typename T>
+        T const* copyArray(T const* items, size_t count)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Arena only holds trivially copyable items");
+            T* result = static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+            if (count != 0)
+            {
+                memcpy(static_cast<void*>(result), items, sizeof(T) * count);
+            }
+            return result;
+        }
+
+        /// <summary>
+        /// Releases every block. Pointers handed out before become invalid.
+        /// </summary>
+        void clear() noexcept
+        {
+            while (m_head != nullptr)
+            {
+                Block* previous = m_head->previous;
+                delete[] reinterpret_cast<char*>(m_head);
+                m_head = previous;
+            }
+            m_offset = 0;
+            m_size = 0;
+        }
+
+        /// <summary>
+        /// Bytes handed out since the arena was created or cleared.
+        /// </summary>
+        size_t size() const noexcept
+        {
+            return m_size;
+        }
+
+       protected:
+        struct Block
+        {
+            Block* previous;
+            size_t capacity;
+
+            char* data() noexcept
+            {
+                return reinterpret_cast<char*>(this) + HeaderSize;
+            }
+        };
+
+        // Keeps the data that follows the header maximally aligned.
+        static constexpr size_t HeaderSize = (sizeof(Block) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+
+        void addBlock(size_t size)
+        {
+            // Each block is twice the previous one, so an event with many
+            // payloads needs only a few allocations. Oversized payloads get
+            // a block of their own.
+            size_t capacity = (m_head == nullptr) ? m_blockSize : m_head->capacity * 2;
+            if (capacity > MaxBlockSize)
+            {
+                capacity = MaxBlockSize;
+            }
+            if (capacity < size)
+            {
+                capacity = size;
+            }
+            Block* block = reinterpret_cast<Block*>(new char[HeaderSize + capacity]);
+            block->previous = m_head;
+            block->capacity = capacity;
+            m_head = block;
+        }
+
+        Block* m_head;
+        size_t m_offset;
+        size_t m_blockSize;
+        size_t m_size;
+    };
+
+} MAT_NS_END
+
+#endif
@@ -0,0 +1,177 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef BOUNDEDRINGQUEUE_HPP
+#define BOUNDEDRINGQUEUE_HPP
+
+#include "mat/config.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace MAT_NS_BEGIN
+{
+    /// <summary>
+    /// Bounded lock-free queue over a power-of-two ring of slots. Every slot
+    /// carries a sequence number that tells producers and consumers whether it
+    /// is free or filled for the current lap, so push and pop only contend on
+    /// a single compare-and-swap of the enqueue or dequeue cursor.
+    ///
+    /// Any number of producers and consumers may use the queue concurrently.
+    /// Neither push nor pop ever blocks: a full or empty queue is reported to
+    /// the caller, which decides how to wait.
+    /// </summary>
+    template <typename T>
+    class BoundedRingQueue
+    {
+       public:
+        /// <summary>
+        /// Creates a queue able to hold at least <paramref name="capacity"/> items.
+        /// Capacity is rounded up to the next power of two (minimum 2).
+        /// </summary>
+        explicit BoundedRingQueue(size_t capacity) :
+            m_mask(roundUpToPowerOfTwo(capacity) - 1),
+            m_slots(new Slot[m_mask + 1])
+        {
+            for (size_t i = 0; i <= m_mask; i++)
+            {
+                m_slots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+            m_enqueue.position.store(0, std::memory_order_relaxed);
+            m_dequeue.position.store(0, std::memory_order_relaxed);
+        }
+
+        BoundedRingQueue(const BoundedRingQueue&) = delete;
+        BoundedRingQueue& operator=(const BoundedRingQueue&) = delete;
+
+        /// <summary>
+        /// Attempts to append an item. Returns false if the queue is full,
+        /// in which case <paramref name="item"/> is left untouched.
+        /// </summary>
+        bool try_push(T& item)
+        {
+            Slot* slot;
+            size_t pos = m_enqueue.position.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                slot = &m_slots[pos & m_mask];
+                size_t seq = slot->sequence.load(std::memory_order_acquire);
+                intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+                if (diff == 0)
+                {
+                    if (m_enqueue.position.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    pos = m_enqueue.position.load(std::memory_order_relaxed);
+                }
+            }
+            slot->value = std::move(item);
+            slot->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        /// <summary>
+        /// Attempts to remove the oldest item. Returns false if the queue is empty.
+        /// </summary>
+        bool try_pop(T& item)
+        {
+            Slot* slot;
+            size_t pos = m_dequeue.position.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                slot = &m_slots[pos & m_mask];
+                size_t seq = slot->sequence.load(std::memory_order_acquire);
+                intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+                if (diff == 0)
+                {
+                    if (m_dequeue.position.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    pos = m_dequeue.position.load(std::memory_order_relaxed);
+                }
+            }
+            item = std::move(slot->value);
+            slot->value = T();
+            slot->sequence.store(pos + m_mask + 1, std::memory_order_release);
+            return true;
+        }
+
+        /// <summary>
+        /// Approximate number of queued items. Exact only when the queue is quiescent.
+        /// </summary>
+        size_t size() const
+        {
+            size_t head = m_dequeue.position.load(std::memory_order_acquire);
+            size_t tail = m_enqueue.position.load(std::memory_order_acquire);
+            return (tail > head) ? (tail - head) : 0;
+        }
+
+        bool empty() const
+        {
+            return size() == 0;
+        }
+
+        size_t capacity() const
+        {
+            return m_mask + 1;
+        }
+
+       private:
+        static size_t roundUpToPowerOfTwo(size_t value)
+        {
+            size_t result = 2;
+            while (result < value)
+            {
+                result <<= 1;
+            }
+            return result;
+        }
+
+        struct Slot
+        {
+            std::atomic<size_t> sequence;
+            T value;
+        };
+
+        // Padding keeps the producer and consumer cursors on separate cache
+        // lines so that enqueueing threads do not invalidate the consumer's
+        // line. Explicit padding (rather than alignas) keeps the queue usable
+        // with plain operator new on pre-C++17 toolchains.
+        static constexpr size_t CacheLineSize = 64;
+
+        struct PaddedCursor
+        {
+            char leading[CacheLineSize];
+            std::atomic<size_t> position;
+        };
+
+        const size_t m_mask;
+        std::unique_ptr<Slot[]> m_slots;
+        PaddedCursor m_enqueue;
+        PaddedCursor m_dequeue;
+    };
+
+}
+MAT_NS_END
+
+#endif
@@ -0,0 +1,139 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "PropertyNameTable.hpp"
+#include "utils/Utils.hpp"
+
+#include <functional>
+
+namespace MAT_NS_BEGIN
+{
+    constexpr PropertyNameTable::Id PropertyNameTable::InvalidId;
+    constexpr size_t PropertyNameTable::Capacity;
+    constexpr size_t PropertyNameTable::SlotCount;
+
+    PropertyNameTable& PropertyNameTable::GetInstance()
+    {
+        // Intentionally leaked: events may still be built during static destruction.
+        static PropertyNameTable* instance = new PropertyNameTable();
+        return *instance;
+    }
+
+    PropertyNameTable::PropertyNameTable() :
+        m_slots(new std::atomic<Id>[SlotCount]),
+        m_entries(new std::atomic<Entry*>[Capacity]),
+        m_count(0)
+    {
+        for (size_t i = 0; i < SlotCount; i++)
+        {
+            m_slots[i].store(InvalidId, std::memory_order_relaxed);
+        }
+        for (size_t i = 0; i < Capacity; i++)
+        {
+            m_entries[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    PropertyNameTable::~PropertyNameTable()
+    {
+        Id count = m_count.load(std::memory_order_acquire);
+        for (Id i = 0; i < count; i++)
+        {
+            delete m_entries[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    PropertyNameTable::Id PropertyNameTable::find(std::string const& name, size_t hash, size_t& slot) const
+    {
+        slot = hash & (SlotCount - 1);
+        for (;;)
+        {
+            Id id = m_slots[slot].load(std::memory_order_acquire);
+            if (id == InvalidId)
+            {
+                return InvalidId;
+            }
+            Entry const* entry = m_entries[id - 1].load(std::memory_order_relaxed);
+            if (entry->hash == hash && entry->name == name)
+            {
+                return id;
+            }
+            slot = (slot + 1) & (SlotCount - 1);
+        }
+    }
+
+    PropertyNameTable::Id PropertyNameTable::Find(std::string const& name) const
+    {
+        size_t slot;
+        return find(name, std::hash<std::string>()(name), slot);
+    }
+
+    PropertyNameTable::Id PropertyNameTable::Intern(std::string const& name)
+    {
+        size_t hash = std::hash<std::string>()(name);
+        size_t slot;
+        Id id = find(name, hash, slot);
+        if (id != InvalidId)
+        {
+            return id;
+        }
+
+        // Once the table is full, unknown names never take the lock
+        if (m_count.load(std::memory_order_acquire) == Capacity)
+        {
+            return InvalidId;
+        }
+
+        std::lock_guard<std::mutex> lock(m_insertLock);
+        // Another thread may have added it, or taken our slot, meanwhile
+        id = find(name, hash, slot);
+        if (id != InvalidId)
+        {
+            return id;
+        }
+        Id count = m_count.load(std::memory_order_relaxed);
+        if (count == Capacity)
+        {
+            return InvalidId;
+        }
+
+        m_entries[count].store(new Entry{ name, hash, validatePropertyName(name) }, std::memory_order_relaxed);
+        id = count + 1;
+        m_count.store(id, std::memory_order_release);
+        m_slots[slot].store(id, std::memory_order_release);
+        return id;
+    }
+
+    EventRejectedReason PropertyNameTable::Validate(std::string const& name)
+    {
+        Id id;
+        return Validate(name, id);
+    }
+
+    EventRejectedReason PropertyNameTable::Validate(std::string const& name, Id& id)
+    {
+        id = Intern(name);
+        if (id == InvalidId)
+        {
+            return validatePropertyName(name);
+        }
+        return GetValidation(id);
+    }
+
+    std::string const& PropertyNameTable::GetName(Id id) const
+    {
+        return m_entries[id - 1].load(std::memory_order_acquire)->name;
+    }
+
+    EventRejectedReason PropertyNameTable::GetValidation(Id id) const
+    {
+        return m_entries[id - 1].load(std::memory_order_acquire)->validation;
+    }
+
+    size_t PropertyNameTable::size() const
+    {
+        return m_count.load(std::memory_order_acquire);
+    }
+
+} MAT_NS_END
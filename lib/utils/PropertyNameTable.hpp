@@ -0,0 +1,100 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef PROPERTYNAMETABLE_HPP
+#define PROPERTYNAMETABLE_HPP
+
+#include "mat/config.h"
+#include "Enums.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace MAT_NS_BEGIN
+{
+    /// <summary>
+    /// Process-wide table of interned property names. Each distinct name is
+    /// validated once and gets a stable ID; later lookups are lock-free and
+    /// return the cached validation result instead of rescanning the name.
+    ///
+    /// The table only grows. Once it holds Capacity names, new names are no
+    /// longer interned (Intern returns InvalidId) and callers validate them
+    /// directly, so a stream of generated names cannot exhaust memory.
+    /// </summary>
+    class PropertyNameTable
+    {
+       public:
+        typedef uint32_t Id;
+
+        static constexpr Id InvalidId = 0;
+        static constexpr size_t Capacity = 4096;
+
+        /// <summary>
+        /// The shared table. It is never destroyed, so it stays usable while
+        /// other statics are torn down at process exit.
+        /// </summary>
+        static PropertyNameTable& GetInstance();
+
+        PropertyNameTable();
+        ~PropertyNameTable();
+
+        PropertyNameTable(const PropertyNameTable&) = delete;
+        PropertyNameTable& operator=(const PropertyNameTable&) = delete;
+
+        /// <summary>
+        /// Returns the ID of an interned name, or InvalidId if it is unknown.
+        /// </summary>
+        Id Find(std::string const& name) const;
+
+        /// <summary>
+        /// Returns the ID of a name, interning and validating it on first use.
+        /// Returns InvalidId if the table is full.
+        /// </summary>
+        Id Intern(std::string const& name);
+
+        /// <summary>
+        /// Validation result of a name, cached in the table when possible.
+        /// </summary>
+        EventRejectedReason Validate(std::string const& name);
+
+        /// <summary>
+        /// Same as Validate(name), also returning the ID of the name (InvalidId
+        /// if the table is full) so that callers storing it need not look the
+        /// name up again.
+        /// </summary>
+        EventRejectedReason Validate(std::string const& name, Id& id);
+
+        std::string const& GetName(Id id) const;
+
+        EventRejectedReason GetValidation(Id id) const;
+
+        size_t size() const;
+
+       protected:
+        struct Entry
+        {
+            std::string         name;
+            size_t              hash;
+            EventRejectedReason validation;
+        };
+
+        static constexpr size_t SlotCount = Capacity * 2;
+
+        Id find(std::string const& name, size_t hash, size_t& slot) const;
+
+        // Open-addressed index of IDs; 0 marks an empty slot. A slot is
+        // published only after its entry, so readers never take the lock.
+        std::unique_ptr<std::atomic<Id>[]>     m_slots;
+        std::unique_ptr<std::atomic<Entry*>[]> m_entries;
+        std::atomic<Id>                        m_count;
+        std::mutex                             m_insertLock;
+    };
+
+} MAT_NS_END
+
+#endif
@@ -0,0 +1,47 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "RecordIdAllocator.hpp"
+
+#include <random>
+
+namespace MAT_NS_BEGIN
+{
+    static char const s_alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+    RecordIdAllocator& RecordIdAllocator::GetInstance()
+    {
+        // Intentionally leaked: events may still be logged during static destruction.
+        static RecordIdAllocator* instance = []() {
+            std::random_device rd;
+            uint64_t prefix = (static_cast<uint64_t>(rd()) << 32) | rd();
+            return new RecordIdAllocator(prefix);
+        }();
+        return *instance;
+    }
+
+    RecordIdAllocator::RecordIdAllocator(uint64_t prefix) :
+        m_prefix(prefix & ((uint64_t(1) << PrefixBits) - 1)),
+        m_counter(0)
+    {
+    }
+
+    std::string RecordIdAllocator::Next()
+    {
+        uint64_t counter = m_counter.fetch_add(1, std::memory_order_relaxed) & ((uint64_t(1) << CounterBits) - 1);
+
+        // 90 bits: prefix in the high bits, counter in the low ones, six bits per character
+        char id[IdLength];
+        uint64_t low = counter;
+        uint64_t high = m_prefix;
+        for (size_t i = IdLength; i-- > 0;)
+        {
+            id[i] = s_alphabet[low & 0x3F];
+            low = (low >> 6) | ((high & 0x3F) << (CounterBits - 6));
+            high >>= 6;
+        }
+        return std::string(id, IdLength);
+    }
+
+} MAT_NS_END
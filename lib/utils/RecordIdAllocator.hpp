@@ -0,0 +1,62 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef RECORDIDALLOCATOR_HPP
+#define RECORDIDALLOCATOR_HPP
+
+#include "mat/config.h"
+#include "ctmacros.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace MAT_NS_BEGIN
+{
+    /// <summary>
+    /// Allocates storage record IDs from a 64-bit counter. IDs combine a
+    /// random per-process prefix with the counter, so IDs of records that
+    /// were persisted by earlier runs do not collide with new ones.
+    ///
+    /// IDs are IdLength characters of URL-safe base64, short enough to fit
+    /// the small-string buffer of common std::string implementations: every
+    /// copy of an ID through storage, packaging and stats stays allocation
+    /// free, unlike a 36-character UUID string.
+    /// </summary>
+    class RecordIdAllocator
+    {
+       public:
+        static constexpr size_t IdLength = 15;
+
+        /// <summary>
+        /// The shared allocator, seeded from a random device.
+        /// </summary>
+        static RecordIdAllocator& GetInstance();
+
+        /// <summary>
+        /// Creates an allocator with the given prefix. Only the low PrefixBits
+        /// bits are used.
+        /// </summary>
+        explicit RecordIdAllocator(uint64_t prefix);
+
+        RecordIdAllocator(const RecordIdAllocator&) = delete;
+        RecordIdAllocator& operator=(const RecordIdAllocator&) = delete;
+
+        /// <summary>
+        /// Returns the next ID. Thread-safe and lock-free.
+        /// </summary>
+        std::string Next();
+
+       protected:
+        static constexpr unsigned CounterBits = 44;
+        static constexpr unsigned PrefixBits = IdLength * 6 - CounterBits;
+
+        uint64_t              m_prefix;
+        std::atomic<uint64_t> m_counter;
+    };
+
+} MAT_NS_END
+
+#endif
@@ -50,7 +50,9 @@ namespace testing {
         }
 
         MOCK_METHOD0(getContext, ISemanticContext&());
+        MOCK_METHOD2(getPipelineStats, bool(PipelineStats& stats, bool reset));
         MOCK_METHOD1(DispatchEvent, bool(DebugEvent evt));
+        MOCK_CONST_METHOD1(HasListeners, bool(DebugEventType type));
         MOCK_METHOD1(sendEvent, void(IncomingEventContextPtr const& event));
         MOCK_METHOD0(startAsync, void());
         MOCK_METHOD0(stopAsync, void());
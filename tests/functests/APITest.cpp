@@ -15,6 +15,7 @@
 
 #include <atomic>
 #include <cassert>
+#include <chrono>
 #include <LogManager.hpp>
 
 #include "PayloadDecoder.hpp"
@@ -857,6 +858,103 @@ TEST(APITest, C_API_Test)
     ASSERT_EQ(capi_get_client(handle), nullptr);
 }
 
+TEST(APITest, C_API_LogBatch_Test)
+{
+    TestDebugEventListener debugListener;
+
+    const char* config = JSON_CONFIG(
+        {
+            "cacheFilePath": "MyOfflineStorage.db",
+            "config" : {
+                "host": "*"
+            },
+            "stats" : {
+                "interval": 0
+            },
+            "name" : "C-API-Client-Batch",
+            "version" : "1.0.0",
+            "primaryToken" : "7c8b1796cbc44bd5a03803c01c2b9d61-b6e370dd-28d9-4a52-9556-762543cf7aa7-6991",
+            "maxTeardownUploadTimeInSec" : 0,
+            "hostMode" : false,
+            "minimumTraceLevel" : 0,
+            "sdkmode" : 0
+        }
+    );
+
+    evt_prop event1[] = TELEMETRY_EVENT
+    (
+        _STR(COMMONFIELDS_EVENT_NAME, EVENT_NAME_PURE_C),
+        _STR(COMMONFIELDS_IKEY, TEST_TOKEN),
+        _INT("index", 1)
+    );
+    evt_prop event2[] = TELEMETRY_EVENT
+    (
+        _STR(COMMONFIELDS_EVENT_NAME, EVENT_NAME_PURE_C),
+        _STR(COMMONFIELDS_IKEY, TEST_TOKEN2),
+        _INT("index", 2)
+    );
+    evt_prop* events[] = { event1, event2, event1 };
+
+    std::vector<std::string> iKeys;
+    debugListener.OnLogX = [&](::CsProtocol::Record& record)
+    {
+        iKeys.push_back(record.iKey);
+        EXPECT_EQ(record.data[0].properties.count(COMMONFIELDS_IKEY), 0u);
+    };
+
+    evt_handle_t handle = evt_open(config);
+    ASSERT_NE(handle, 0);
+    capi_client *client = capi_get_client(handle);
+    ASSERT_NE(client, nullptr);
+    evt_pause(handle);
+    client->logmanager->AddEventListener(EVT_LOG_EVENT, debugListener);
+
+    // Same token and source share a handle, a different source does not
+    evt_logger_t logger = evt_get_logger(handle, TEST_TOKEN2, nullptr);
+    EXPECT_NE(logger, 0);
+    EXPECT_EQ(evt_get_logger(handle, TEST_TOKEN2, ""), logger);
+    EXPECT_NE(evt_get_logger(handle, TEST_TOKEN2, "source"), logger);
+    EXPECT_EQ(evt_get_logger(0, TEST_TOKEN2, nullptr), 0);
+
+    // Logger handle: the iKey of the events is ignored
+    EXPECT_EQ(evt_log_batch(handle, logger, 3, events), EOK);
+    ASSERT_EQ(iKeys.size(), 3u);
+    for (const auto& iKey : iKeys)
+    {
+        EXPECT_THAT(std::string("o:") + TEST_TOKEN2, testing::HasSubstr(iKey));
+    }
+
+    // No logger handle: every event goes to its own iKey
+    iKeys.clear();
+    evt_context_t ctx;
+    evt_log_batch_data_t data;
+    data.logger = 0;
+    data.events = events;
+    ctx.call = EVT_OP_LOG_BATCH;
+    ctx.handle = handle;
+    ctx.data = &data;
+    ctx.size = 3;
+    EXPECT_EQ(evt_api_call(&ctx), EOK);
+    EXPECT_EQ(ctx.size, 3u);
+    ASSERT_EQ(iKeys.size(), 3u);
+    EXPECT_THAT(std::string("o:") + TEST_TOKEN, testing::HasSubstr(iKeys[0]));
+    EXPECT_THAT(std::string("o:") + TEST_TOKEN2, testing::HasSubstr(iKeys[1]));
+    EXPECT_THAT(std::string("o:") + TEST_TOKEN, testing::HasSubstr(iKeys[2]));
+
+    // Unknown logger handle
+    EXPECT_EQ(evt_log_batch(handle, logger + 100, 3, events), ENOENT);
+    EXPECT_EQ(iKeys.size(), 3u);
+
+    // Teardown destroys the loggers, so handles issued before it are rejected
+    evt_flushAndTeardown(handle);
+    EXPECT_EQ(evt_log_batch(handle, logger, 3, events), ENOENT);
+    EXPECT_EQ(iKeys.size(), 3u);
+
+    client->logmanager->RemoveEventListener(EVT_LOG_EVENT, debugListener);
+    evt_close(handle);
+    ASSERT_EQ(capi_get_client(handle), nullptr);
+}
+
 #ifdef HAVE_MAT_JSONHPP
 #if defined(_WIN32)
 TEST(APITest, UTC_Callback_Test)
@@ -672,6 +672,79 @@ TEST_F(BasicFuncTests, sendSamePriorityNormalEvents)
     FlushAndTeardown();
 }
 
+class PipelineStatsListener : public DebugEventListener
+{
+public:
+    std::atomic<size_t> delivered { 0 };
+
+    virtual void OnDebugEvent(DebugEvent& evt) override
+    {
+        if (evt.type == EVT_PIPELINE_STATS && evt.data != nullptr)
+        {
+            auto stats = static_cast<PipelineStats const*>(evt.data);
+            delivered = stats->stages[PipelineStage_Delivery].count;
+        }
+    }
+};
+
+TEST_F(BasicFuncTests, pipelineStatsAreOffByDefault)
+{
+    CleanStorage();
+    Initialize();
+
+    PipelineStats stats;
+    EXPECT_EQ(LogManager::GetPipelineStats(stats), STATUS_ENOSYS);
+
+    FlushAndTeardown();
+}
+
+TEST_F(BasicFuncTests, pipelineStatsCoverEveryStage)
+{
+    CleanStorage();
+    auto& configuration = LogManager::GetLogConfiguration();
+    configuration[CFG_BOOL_ENABLE_PIPELINE_STATS] = true;
+    Initialize();
+    PipelineStatsListener listener;
+    LogManager::AddEventListener(EVT_PIPELINE_STATS, listener);
+
+    EventProperties event("first_event");
+    event.SetProperty("property", "value");
+    logger->LogEvent(event);
+    EventProperties event2("second_event");
+    event2.SetProperty("property", "value2");
+    logger->LogEvent(event2);
+    waitForEvents(3, 3);
+
+    // The server has the events before their responses are decoded
+    PipelineStats stats;
+    for (int i = 0; i < 300; i++)
+    {
+        ASSERT_EQ(LogManager::GetPipelineStats(stats), STATUS_SUCCESS);
+        if (stats.stages[PipelineStage_Delivery].count >= 3)
+        {
+            break;
+        }
+        PAL::sleep(10);
+    }
+    for (auto stage : { PipelineStage_Submit, PipelineStage_Dispatch, PipelineStage_Serialize, PipelineStage_Store, PipelineStage_Retrieve,
+                        PipelineStage_Package, PipelineStage_Encode, PipelineStage_Send, PipelineStage_Decode })
+    {
+        EXPECT_GE(stats.stages[stage].count, 1u) << stats.stages[stage].name;
+    }
+    EXPECT_EQ(stats.stages[PipelineStage_Submit].count, 2u);
+    EXPECT_GE(stats.stages[PipelineStage_Delivery].count, 3u);
+    EXPECT_EQ(stats.stages[PipelineStage_Store].active, 0u);
+    EXPECT_GE(stats.stages[PipelineStage_Send].maxActive, 1u);
+    ASSERT_EQ(stats.queues.size(), 2u);
+    EXPECT_STREQ(stats.queues[0].name, "storage");
+    EXPECT_STREQ(stats.queues[1].name, "http");
+
+    FlushAndTeardown();
+    configuration[CFG_BOOL_ENABLE_PIPELINE_STATS] = false;
+    LogManager::RemoveEventListener(EVT_PIPELINE_STATS, listener);
+    EXPECT_GE(listener.delivered.load(), 3u);
+}
+
 TEST_F(BasicFuncTests, sendDifferentPriorityEvents)
 {
     CleanStorage();
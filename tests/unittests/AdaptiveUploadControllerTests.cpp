@@ -0,0 +1,193 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "common/Common.hpp"
+#include "tpm/AdaptiveUploadController.hpp"
+
+using namespace testing;
+using namespace MAT;
+
+namespace {
+
+    UploadObservation accepted(int durationMs, size_t bytes)
+    {
+        UploadObservation observation;
+        observation.outcome = UploadOutcome::Accepted;
+        observation.statusCode = 200;
+        observation.durationMs = durationMs;
+        observation.bytes = bytes;
+        return observation;
+    }
+
+    UploadObservation failed(UploadOutcome outcome, unsigned statusCode, int64_t retryAfterMs = 0)
+    {
+        UploadObservation observation;
+        observation.outcome = outcome;
+        observation.statusCode = statusCode;
+        observation.retryAfterMs = retryAfterMs;
+        return observation;
+    }
+
+}
+
+TEST(AdaptiveUploadControllerTests, CreateFromConfig_ParsesOrRejects)
+{
+    EXPECT_THAT(IUploadController::createFromConfig(""), IsNull());
+    EXPECT_THAT(IUploadController::createFromConfig("A,65536,2000"), NotNull());
+    EXPECT_THAT(IUploadController::createFromConfig("A,65536"), IsNull());
+    EXPECT_THAT(IUploadController::createFromConfig("A,0,2000"), IsNull());
+    EXPECT_THAT(IUploadController::createFromConfig("A,65536,2000,"), IsNull());
+    EXPECT_THAT(IUploadController::createFromConfig("X,65536,2000"), IsNull());
+}
+
+TEST(AdaptiveUploadControllerTests, StartsHalfwayWithinLimits)
+{
+    AdaptiveUploadController controller(1000, 2000);
+    EXPECT_THAT(controller.getState().maxUploadSizeBytes, Eq(0u));
+    controller.setLimits(100000, 4);
+    auto state = controller.getState();
+    EXPECT_THAT(state.maxUploadSizeBytes, Eq(50000u));
+    EXPECT_THAT(state.maxUploadsInFlight, Eq(1u));
+    EXPECT_THAT(state.uploadDelayMs, Eq(0u));
+
+    // Smaller ceilings apply right away
+    controller.setLimits(20000, 4);
+    EXPECT_THAT(controller.getState().maxUploadSizeBytes, Eq(20000u));
+}
+
+TEST(AdaptiveUploadControllerTests, FastUploads_GrowAdditivelyUpToLimits)
+{
+    AdaptiveUploadController controller(1000, 2000);
+    controller.setLimits(10000, 3);
+
+    EXPECT_THAT(controller.onUploadFinished(accepted(100, 5000)), true);
+    auto state = controller.getState();
+    EXPECT_THAT(state.maxUploadSizeBytes, Eq(6000u));
+    EXPECT_THAT(state.maxUploadsInFlight, Eq(2u));
+    EXPECT_THAT(state.rttMs, Eq(100u));
+    EXPECT_THAT(state.throughputBps, Eq(50000u));
+
+    // One more in flight per window of accepted uploads
+    controller.onUploadFinished(accepted(100, 5000));
+    EXPECT_THAT(controller.getState().maxUploadsInFlight, Eq(2u));
+    controller.onUploadFinished(accepted(100, 5000));
+    EXPECT_THAT(controller.getState().maxUploadsInFlight, Eq(3u));
+
+    for (int i = 0; i < 10; i++)
+    {
+        controller.onUploadFinished(accepted(100, 5000));
+    }
+    state = controller.getState();
+    EXPECT_THAT(state.maxUploadSizeBytes, Eq(10000u));
+    EXPECT_THAT(state.maxUploadsInFlight, Eq(3u));
+    EXPECT_THAT(controller.onUploadFinished(accepted(100, 5000)), false);
+}
+
+TEST(AdaptiveUploadControllerTests, SlowUploadsAndNetworkErrors_HalveThePackage)
+{
+    AdaptiveUploadController controller(1000, 2000);
+    controller.setLimits(64000, 4);
+    for (int i = 0; i < 3; i++)
+    {
+        controller.onUploadFinished(accepted(100, 1000));
+    }
+    EXPECT_THAT(controller.getState().maxUploadSizeBytes, Eq(35000u));
+    EXPECT_THAT(controller.getState().maxUploadsInFlight, Eq(3u));
+
+    EXPECT_THAT(controller.onUploadFinished(accepted(3000, 35000)), true);
+    EXPECT_THAT(controller.getState().maxUploadSizeBytes, Eq(17500u));
+    EXPECT_THAT(controller.getState().maxUploadsInFlight, Eq(3u));
+
+    controller.onUploadFinished(failed(UploadOutcome::NetworkError, 0));
+    EXPECT_THAT(controller.getState().maxUploadSizeBytes, Eq(8750u));
+    EXPECT_THAT(controller.getState().maxUploadsInFlight, Eq(1u));
+
+    controller.onUploadFinished(failed(UploadOutcome::ServerError, 408));
+    EXPECT_THAT(controller.getState().maxUploadSizeBytes, Eq(4375u));
+
+    for (int i = 0; i < 10; i++)
+    {
+        controller.onUploadFinished(failed(UploadOutcome::NetworkError, 0));
+    }
+    EXPECT_THAT(controller.getState().maxUploadSizeBytes, Eq(1000u));
+}
+
+TEST(AdaptiveUploadControllerTests, Throttling_HonorsRetryAfterAndRecovers)
+{
+    AdaptiveUploadController controller(1000, 2000);
+    controller.setLimits(64000, 4);
+    for (int i = 0; i < 6; i++)
+    {
+        controller.onUploadFinished(accepted(100, 1000));
+    }
+    EXPECT_THAT(controller.getState().maxUploadsInFlight, Eq(4u));
+
+    // 429 without Retry-After: start from the target round trip time
+    controller.onUploadFinished(failed(UploadOutcome::ServerError, 429));
+    auto state = controller.getState();
+    EXPECT_THAT(state.maxUploadsInFlight, Eq(2u));
+    EXPECT_THAT(state.uploadDelayMs, Eq(2000u));
+
+    // Retry-After wins over the doubled delay
+    controller.onUploadFinished(failed(UploadOutcome::ServerError, 503, 30000));
+    state = controller.getState();
+    EXPECT_THAT(state.maxUploadsInFlight, Eq(1u));
+    EXPECT_THAT(state.uploadDelayMs, Eq(30000u));
+
+    controller.onUploadFinished(failed(UploadOutcome::ServerError, 503, 3600000));
+    EXPECT_THAT(controller.getState().uploadDelayMs, Eq(static_cast<size_t>(AdaptiveUploadController::MaxUploadDelayMs)));
+
+    // Rejected payloads and aborts leave capacity alone
+    EXPECT_THAT(controller.onUploadFinished(failed(UploadOutcome::Rejected, 400)), false);
+    EXPECT_THAT(controller.onUploadFinished(failed(UploadOutcome::Aborted, 0)), false);
+
+    int successes = 0;
+    while (controller.getState().uploadDelayMs != 0)
+    {
+        controller.onUploadFinished(accepted(100, 1000));
+        successes++;
+    }
+    EXPECT_THAT(successes, Le(12));
+}
+
+TEST(AdaptiveUploadControllerTests, SimulatedLinks_SettleAroundTargetRtt)
+{
+    // The round trip time grows with the package on a link of fixed bandwidth
+    struct Link
+    {
+        double bytesPerMs;
+        int    latencyMs;
+    };
+    for (Link link : { Link { 50.0, 200 }, Link { 500.0, 50 }, Link { 20000.0, 20 } })
+    {
+        AdaptiveUploadController controller(16384, 2000);
+        controller.setLimits(2097152, 4);
+        unsigned maxRttMs = 0;
+        for (int i = 0; i < 300; i++)
+        {
+            size_t bytes = controller.getState().maxUploadSizeBytes;
+            int rttMs = link.latencyMs + static_cast<int>(bytes / link.bytesPerMs);
+            if (i >= 200)
+            {
+                maxRttMs = std::max(maxRttMs, static_cast<unsigned>(rttMs));
+            }
+            controller.onUploadFinished(accepted(rttMs, bytes));
+        }
+        auto state = controller.getState();
+        size_t idealBytes = static_cast<size_t>((2000 - link.latencyMs) * link.bytesPerMs);
+        if (idealBytes >= 2097152)
+        {
+            // Fast link: as large as allowed, far below the target
+            EXPECT_THAT(state.maxUploadSizeBytes, Eq(2097152u));
+            EXPECT_THAT(maxRttMs, Lt(2000u));
+        }
+        else
+        {
+            // Slow link: oscillates between half the ideal size and one step above it
+            EXPECT_THAT(state.maxUploadSizeBytes, AllOf(Ge(idealBytes / 2 - 16384), Le(idealBytes + 16384)));
+            EXPECT_THAT(maxRttMs, Le(2000u + static_cast<unsigned>(16384 / link.bytesPerMs) + 1));
+        }
+    }
+}
@@ -0,0 +1,174 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "common/Common.hpp"
+#include "pal/PAL.hpp"
+#include "pal/BinaryTrace.hpp"
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace testing;
+
+namespace PAL_NS_BEGIN
+{
+    namespace detail
+    {
+        extern bool isLoggingInited;
+    }
+} PAL_NS_END
+
+namespace
+{
+    const char* const kComponent = "BinaryTraceTests";
+
+    std::vector<std::string> decodeLines(const std::string& trace, const std::string& filter)
+    {
+        std::istringstream in(trace);
+        std::ostringstream out;
+        EXPECT_TRUE(PAL::detail::decode_binary_trace(in, out));
+
+        std::vector<std::string> lines;
+        std::istringstream text(out.str());
+        std::string line;
+        while (std::getline(text, line))
+        {
+            if (line.find(filter) != std::string::npos)
+            {
+                lines.push_back(line);
+            }
+        }
+        return lines;
+    }
+
+    std::string messageOf(const std::string& line)
+    {
+        return line.substr(line.rfind('|') + 1);
+    }
+}
+
+TEST(BinaryTraceTests, PacksArgumentsByType)
+{
+    PAL::detail::BinaryTraceArgs args;
+    int value = 0;
+    enum { Three = 3 };
+    PAL::detail::encodeTraceArgs(args, -1, 2u, 0.5, "str", &value, nullptr, Three, std::string("x"));
+
+    std::string tags;
+    for (size_t i = 0; i < args.size();)
+    {
+        const char tag = static_cast<char>(args.data()[i++]);
+        tags.push_back(tag);
+        if (tag == 's')
+        {
+            uint16_t length = 0;
+            memcpy(&length, args.data() + i, sizeof(length));
+            i += sizeof(length) + length;
+        }
+        else if (tag != '?')
+        {
+            i += 8;
+        }
+    }
+    EXPECT_EQ(tags, "iudsppi?");
+}
+
+TEST(BinaryTraceTests, LongStringsAreTruncated)
+{
+    PAL::detail::BinaryTraceArgs args;
+    std::string longString(1000, 'a');
+    PAL::detail::encodeTraceArgs(args, longString.c_str(), longString.c_str());
+    EXPECT_LE(args.size(), PAL::detail::BinaryTraceArgs::Capacity);
+    // The first string is cut at MaxStringLength, the second at the capacity
+    EXPECT_EQ(args.size(), PAL::detail::BinaryTraceArgs::Capacity);
+}
+
+TEST(BinaryTraceTests, DecoderRendersTracePoints)
+{
+    std::stringstream trace;
+    PAL::detail::binary_trace_start(trace);
+    int value = 0;
+    PAL::detail::trace(PAL::Info, kComponent, "value=%d name=%s size=%zu ratio=%.2f", -5, "abc", size_t(7), 0.5);
+    PAL::detail::trace(PAL::Error, kComponent, "%% %5d|%-4s|%*d|%.2s|%llu|%x", 42, "ab", 3, 7, "abcdef", 123456789012ULL, 255u);
+    PAL::detail::trace(PAL::Warning, kComponent, "missing %d %s", 1);
+    PAL::detail::trace(PAL::Detail, kComponent, "pointer %p", static_cast<void*>(&value));
+    PAL::detail::binary_trace_stop();
+
+    auto lines = decodeLines(trace.str(), std::string("|") + kComponent + "|");
+    ASSERT_EQ(lines.size(), 4u);
+    EXPECT_THAT(lines[0], HasSubstr("|I|BinaryTraceTests|"));
+    EXPECT_EQ(messageOf(lines[0]), "value=-5 name=abc size=7 ratio=0.50");
+    EXPECT_THAT(lines[1], HasSubstr("|E|BinaryTraceTests|% "));
+    EXPECT_THAT(lines[1], HasSubstr("   42|ab  |  7|ab|123456789012|ff"));
+    EXPECT_EQ(messageOf(lines[2]), "missing 1 <?>");
+    EXPECT_THAT(messageOf(lines[3]), StartsWith("pointer 0x"));
+}
+
+TEST(BinaryTraceTests, ThreadsWriteToTheirOwnRings)
+{
+    std::stringstream trace;
+    PAL::detail::binary_trace_start(trace);
+    const int threadCount = 8;
+    const int perThread = 1000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; t++)
+    {
+        threads.emplace_back([t]() {
+            for (int i = 0; i < perThread; i++)
+            {
+                PAL::detail::trace(PAL::Info, kComponent, "thread %d event %d", t, i);
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    PAL::detail::binary_trace_stop();
+
+    auto lines = decodeLines(trace.str(), std::string("|") + kComponent + "|");
+    EXPECT_EQ(lines.size(), static_cast<size_t>(threadCount * perThread));
+    EXPECT_EQ(messageOf(lines.front()).substr(0, 7), "thread ");
+}
+
+TEST(BinaryTraceTests, FullRingCountsDroppedTracePoints)
+{
+    std::stringstream trace;
+    PAL::detail::binary_trace_start(trace);
+    const size_t count = 10000;
+    std::string payload(400, 'x');
+    for (size_t i = 0; i < count; i++)
+    {
+        PAL::detail::trace(PAL::Info, kComponent, "%s", payload.c_str());
+    }
+    PAL::detail::binary_trace_stop();
+
+    auto events = decodeLines(trace.str(), std::string("|") + kComponent + "|");
+    size_t dropped = 0;
+    for (const auto& line : decodeLines(trace.str(), "trace points dropped"))
+    {
+        dropped += std::stoul(messageOf(line));
+    }
+    EXPECT_GT(dropped, 0u);
+    EXPECT_LT(events.size(), count);
+    EXPECT_GE(events.size() + dropped, count);
+}
+
+TEST(BinaryTraceTests, DecoderRejectsOtherInput)
+{
+    std::istringstream in("2024-01-01T00:00:00.000Z|00000001|I|MATSDK|text trace");
+    std::ostringstream out;
+    EXPECT_FALSE(PAL::detail::decode_binary_trace(in, out));
+
+    std::stringstream trace;
+    PAL::detail::binary_trace_start(trace);
+    PAL::detail::trace(PAL::Info, kComponent, "truncated %d", 1);
+    PAL::detail::binary_trace_stop();
+    std::string truncated = trace.str();
+    truncated.pop_back();
+    std::istringstream truncatedIn(truncated);
+    EXPECT_FALSE(PAL::detail::decode_binary_trace(truncatedIn, out));
+}
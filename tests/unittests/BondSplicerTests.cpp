@@ -17,6 +17,14 @@ class ShadowBondSplicer : protected MAT::BondSplicer
 {
   public:
     using MAT::BondSplicer::addTenantToken;
+    using MAT::BondSplicer::addRecord;
+    using MAT::BondSplicer::getSizeEstimate;
+    using MAT::BondSplicer::clear;
+
+    size_t segmentsCapacity() const
+    {
+        return m_segments.capacity();
+    }
 
     void addCsRecord(size_t dataPackageIndex, ::CsProtocol::Record& record)
     {
@@ -143,3 +151,73 @@ TEST_F(BondSplicerTests, splice_TwoDataPackagesWithOneNonEmptyRecordEach_SizeTwe
 
    EXPECT_THAT(bs.splice().size(), size_t { 20 });
 }
+
+TEST_F(BondSplicerTests, addRecord_MovedBlob_TakesOwnership)
+{
+   std::vector<uint8_t> blob { 1, 2, bond_lite::BT_STOP };
+   uint8_t const* data = blob.data();
+   auto tokenIndex = bs.addTenantToken("tenant1");
+   bs.addRecord(tokenIndex, std::move(blob));
+
+   EXPECT_THAT(blob, IsEmpty());
+   std::vector<uint8_t> output = bs.splice();
+   EXPECT_THAT(output, ElementsAre(1, 2, bond_lite::BT_STOP));
+   EXPECT_NE(output.data(), data);
+}
+
+TEST_F(BondSplicerTests, splice_MovedAndCopiedBlobs_SameOutput)
+{
+   ShadowBondSplicer copied;
+   std::vector<std::vector<uint8_t>> blobs {
+      { 1, bond_lite::BT_STOP },
+      { 2, 2, bond_lite::BT_STOP },
+      { 3, 3, 3, bond_lite::BT_STOP },
+      { 4, bond_lite::BT_STOP } };
+
+   auto first = bs.addTenantToken("tenant1");
+   auto second = bs.addTenantToken("tenant2");
+   copied.addTenantToken("tenant1");
+   copied.addTenantToken("tenant2");
+   for (size_t i = 0; i < blobs.size(); i++)
+   {
+      size_t index = (i % 2 == 0) ? first : second;
+      copied.addRecord(index, blobs[i]);
+      bs.addRecord(index, std::vector<uint8_t>(blobs[i]));
+   }
+
+   EXPECT_THAT(bs.getSizeEstimate(), Eq(copied.getSizeEstimate()));
+   std::vector<uint8_t> expected { 1, bond_lite::BT_STOP, 3, 3, 3, bond_lite::BT_STOP,
+                                   2, 2, bond_lite::BT_STOP, 4, bond_lite::BT_STOP };
+   EXPECT_THAT(bs.splice(), Eq(expected));
+   EXPECT_THAT(bs.splice(), Eq(copied.splice()));
+}
+
+TEST_F(BondSplicerTests, clear_KeepsCapacityForNextPackage)
+{
+   auto index = bs.addTenantToken("tenant1");
+   for (uint8_t i = 0; i < 10; i++)
+   {
+      bs.addRecord(index, std::vector<uint8_t> { i, bond_lite::BT_STOP });
+   }
+   size_t capacity = bs.segmentsCapacity();
+   bs.clear();
+   EXPECT_THAT(bs.getSizeEstimate(), Eq(ShadowBondSplicer().getSizeEstimate()));
+   EXPECT_THAT(bs.segmentsCapacity(), Eq(capacity));
+
+   index = bs.addTenantToken("tenant2");
+   bs.addRecord(index, std::vector<uint8_t> { 7, bond_lite::BT_STOP });
+   ShadowBondSplicer fresh;
+   fresh.addRecord(fresh.addTenantToken("tenant2"), std::vector<uint8_t> { 7, bond_lite::BT_STOP });
+   EXPECT_THAT(bs.splice(), Eq(fresh.splice()));
+}
+
+TEST_F(BondSplicerTests, clear_ReleasesCapacityPastHighWaterMark)
+{
+   auto index = bs.addTenantToken("tenant1");
+   for (size_t i = 0; i <= BondSplicer::MaxRetainedSegments; i++)
+   {
+      bs.addRecord(index, std::vector<uint8_t> { bond_lite::BT_STOP });
+   }
+   bs.clear();
+   EXPECT_THAT(bs.segmentsCapacity(), Eq(0u));
+}
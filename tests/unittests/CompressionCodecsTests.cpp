@@ -0,0 +1,172 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "common/Common.hpp"
+#include "compression/CompressionCodecs.hpp"
+#include "bond/All.hpp"
+#include "bond/generated/CsProtocol_writers.hpp"
+#include "PayloadDecoder.hpp"
+
+using namespace testing;
+using namespace MAT;
+
+class CompressionCodecsTests : public Test {
+  protected:
+    /// <summary>
+    /// Serialized CS records shaped like captured uploads: a handful of
+    /// iKeys and event names, the same Part A fields on every record and
+    /// a few properties with changing values. Every ext vector is filled,
+    /// as PayloadDecoder expects.
+    /// </summary>
+    static std::vector<std::vector<uint8_t>> makeRecords(size_t count)
+    {
+        static char const* const names[] = { "App.Launch", "App.PageView", "App.Click", "Perf.Frame", "Net.Request" };
+        std::vector<std::vector<uint8_t>> records;
+        uint32_t seed = 20240607;
+        for (size_t i = 0; i < count; i++)
+        {
+            seed = seed * 1103515245 + 12345;
+            ::CsProtocol::Record record;
+            record.ver = "3.0";
+            record.name = names[seed % 5];
+            record.time = 1717718400000LL + static_cast<int64_t>(i) * 37;
+            record.iKey = (seed & 0x100) ? "o:7c8b1796cbc44bd5a03803c01c2b9d61" : "o:0c21c15bdccc48c99678a748488bb87f";
+            record.extApp.resize(1);
+            record.extApp[0].id = "com.contoso.telemetry.sample";
+            record.extApp[0].ver = "10.2.1234.0";
+            record.extApp[0].locale = "en-US";
+            record.extDevice.resize(1);
+            record.extDevice[0].localId = "s:4FA8C68A-4F2D-4D1E-9B7B-2A7A3D7E1C11";
+            record.extDevice[0].make = "Contoso";
+            record.extDevice[0].model = "Surface 9";
+            record.extOs.resize(1);
+            record.extOs[0].name = "Windows Desktop";
+            record.extOs[0].ver = "10.0.22631.3593.amd64fre.ni_release.220506-1250";
+            record.extProtocol.resize(1);
+            record.extUser.resize(1);
+            record.extNet.resize(1);
+            record.extNet[0].type = "Wifi";
+            record.extSdk.resize(1);
+            record.extSdk[0].libVer = "EVT-Windows-C++-No-3.7.62.1";
+            record.extSdk[0].seq = static_cast<int64_t>(i) + 1;
+            record.data.resize(1);
+            auto& properties = record.data[0].properties;
+            properties["EventInfo.Sequence"].type = ::CsProtocol::ValueKind::ValueInt64;
+            properties["EventInfo.Sequence"].longValue = static_cast<int64_t>(i);
+            properties["PageName"].stringValue = std::string("page-") + std::to_string(seed % 97);
+            properties["DurationMs"].type = ::CsProtocol::ValueKind::ValueDouble;
+            properties["DurationMs"].doubleValue = (seed % 100000) / 100.0;
+            properties["CorrelationId"].stringValue = std::to_string(seed) + "-" + std::to_string(seed ^ 0x5bd1e995);
+
+            std::vector<uint8_t> blob;
+            bond_lite::CompactBinaryProtocolWriter writer(blob);
+            bond_lite::Serialize(writer, record);
+            records.push_back(std::move(blob));
+        }
+        return records;
+    }
+
+    static std::vector<uint8_t> concat(std::vector<std::vector<uint8_t>> const& records, size_t begin, size_t end)
+    {
+        std::vector<uint8_t> body;
+        for (size_t i = begin; i < end; i++)
+        {
+            body.insert(body.end(), records[i].begin(), records[i].end());
+        }
+        return body;
+    }
+
+    static void expectRoundTrip(ICompressionCodec& codec, std::vector<uint8_t> const& payload)
+    {
+        std::vector<uint8_t> compressed;
+        ASSERT_TRUE(codec.Compress(payload, compressed));
+        std::vector<uint8_t> decompressed;
+        ASSERT_TRUE(codec.Decompress(compressed, decompressed));
+        EXPECT_THAT(decompressed, Eq(payload));
+    }
+};
+
+TEST_F(CompressionCodecsTests, Create_ZlibEncodings_RoundTrip)
+{
+    std::vector<uint8_t> payload = concat(makeRecords(20), 0, 20);
+    for (char const* encoding : { "deflate", "gzip" })
+    {
+        std::unique_ptr<ICompressionCodec> codec = CompressionCodecFactory::Create(encoding, -1, std::vector<uint8_t>());
+        ASSERT_THAT(codec, NotNull());
+        EXPECT_THAT(codec->GetContentEncoding(), StrEq(encoding));
+        expectRoundTrip(*codec, payload);
+        // The codec is reused for every request
+        expectRoundTrip(*codec, std::vector<uint8_t>(payload.begin(), payload.begin() + payload.size() / 2));
+    }
+}
+
+TEST_F(CompressionCodecsTests, Create_UnknownEncoding_ReturnsNull)
+{
+    EXPECT_THAT(CompressionCodecFactory::Create("br", 0, std::vector<uint8_t>()), IsNull());
+    EXPECT_THAT(CompressionCodecFactory::Create("", 0, std::vector<uint8_t>()), IsNull());
+}
+
+TEST_F(CompressionCodecsTests, LoadDictionary_MissingFile_ReturnsEmpty)
+{
+    EXPECT_THAT(CompressionCodecFactory::LoadDictionary(""), IsEmpty());
+    EXPECT_THAT(CompressionCodecFactory::LoadDictionary("no/such/dictionary.zdict"), IsEmpty());
+}
+
+TEST_F(CompressionCodecsTests, DecodeRequest_FollowsContentEncoding)
+{
+    std::vector<uint8_t> payload = concat(makeRecords(3), 0, 3);
+    std::string expected;
+    ASSERT_TRUE(exporters::DecodeRequest(payload, expected, false));
+
+    std::unique_ptr<ICompressionCodec> codec = CompressionCodecFactory::Create("gzip", -1, std::vector<uint8_t>());
+    std::vector<uint8_t> compressed;
+    ASSERT_TRUE(codec->Compress(payload, compressed));
+
+    std::string decoded;
+    EXPECT_TRUE(exporters::DecodeRequest(compressed, decoded, "gzip"));
+    EXPECT_THAT(decoded, Eq(expected));
+    EXPECT_TRUE(exporters::DecodeRequest(payload, decoded, ""));
+    EXPECT_THAT(decoded, Eq(expected));
+    EXPECT_FALSE(exporters::DecodeRequest(compressed, decoded, "br"));
+}
+
+#ifdef HAVE_MAT_ZSTD
+TEST_F(CompressionCodecsTests, Zstd_RoundTrip)
+{
+    std::unique_ptr<ICompressionCodec> codec = CompressionCodecFactory::Create("zstd", 3, std::vector<uint8_t>());
+    ASSERT_THAT(codec, NotNull());
+    EXPECT_THAT(codec->GetContentEncoding(), StrEq("zstd"));
+    expectRoundTrip(*codec, concat(makeRecords(20), 0, 20));
+    expectRoundTrip(*codec, std::vector<uint8_t>());
+}
+
+TEST_F(CompressionCodecsTests, Zstd_TrainedDictionary_ShrinksSmallRequests)
+{
+    std::vector<std::vector<uint8_t>> records = makeRecords(1200);
+    std::vector<std::vector<uint8_t>> samples(records.begin(), records.begin() + 1000);
+    std::vector<uint8_t> dictionary;
+    ASSERT_TRUE(ZstdCodec::TrainDictionary(samples, 16 * 1024, dictionary));
+    EXPECT_THAT(dictionary, SizeIs(AllOf(Gt(0u), Le(16u * 1024))));
+
+    // A small request of records that were not in the training set
+    std::vector<uint8_t> payload = concat(records, 1100, 1105);
+    std::unique_ptr<ICompressionCodec> plain = CompressionCodecFactory::Create("zstd", 3, std::vector<uint8_t>());
+    std::unique_ptr<ICompressionCodec> primed = CompressionCodecFactory::Create("zstd", 3, dictionary);
+    ASSERT_THAT(primed, NotNull());
+
+    std::vector<uint8_t> plainBody, primedBody;
+    ASSERT_TRUE(plain->Compress(payload, plainBody));
+    ASSERT_TRUE(primed->Compress(payload, primedBody));
+    EXPECT_THAT(primedBody.size(), Lt(plainBody.size() / 2));
+    expectRoundTrip(*primed, payload);
+
+    std::string expected, decoded;
+    ASSERT_TRUE(exporters::DecodeRequest(payload, expected, false));
+    EXPECT_TRUE(exporters::DecodeRequest(primedBody, decoded, "zstd", dictionary));
+    EXPECT_THAT(decoded, Eq(expected));
+    // Without the dictionary the body cannot be read
+    EXPECT_FALSE(exporters::DecodeRequest(primedBody, decoded, "zstd"));
+}
+#endif
@@ -180,3 +180,105 @@ TEST(ContextFieldsProviderTests, SetEventExperimentIds_EmptyExperimentIdsRemoves
 	provider.SetEventExperimentIds("Rodgers", "");
 	EXPECT_THAT(provider.GetCommonContextEventToConfigIds().size(), 0);
 }
+
+TEST(ContextFieldsProviderTests, WriteToRecord_SeesChangesAfterEarlierWrites)
+{
+    ContextFieldsProvider parent(nullptr);
+    ContextFieldsProvider child(&parent);
+    parent.SetCommonField(COMMONFIELDS_APP_NAME, "parentName");
+    parent.SetCustomField("inherited", "one");
+
+    ::CsProtocol::Record record1;
+    child.writeToRecord(record1);
+    EXPECT_THAT(record1.extApp[0].name, Eq("parentName"));
+    EXPECT_THAT(record1.data[0].properties["inherited"].stringValue, Eq("one"));
+
+    // A change in the parent reaches the child's next record
+    parent.SetCommonField(COMMONFIELDS_APP_NAME, "renamed");
+    parent.SetCustomField("inherited", "two");
+    ::CsProtocol::Record record2;
+    child.writeToRecord(record2);
+    EXPECT_THAT(record2.extApp[0].name, Eq("renamed"));
+    EXPECT_THAT(record2.data[0].properties["inherited"].stringValue, Eq("two"));
+
+    // The child's AppInfo.Id names the app when the child has no name of its own
+    child.SetCommonField(COMMONFIELDS_APP_ID, "childId");
+    ::CsProtocol::Record record3;
+    child.writeToRecord(record3);
+    EXPECT_THAT(record3.extApp[0].id, Eq("childId"));
+    EXPECT_THAT(record3.extApp[0].name, Eq("childId"));
+
+    // Detached from the parent
+    child.SetParentContext(nullptr);
+    ::CsProtocol::Record record4;
+    child.writeToRecord(record4);
+    EXPECT_THAT(record4.extApp[0].id, Eq("childId"));
+    EXPECT_THAT(record4.data[0].properties.count("inherited"), Eq(0u));
+}
+
+TEST(ContextFieldsProviderTests, WriteToRecord_SeesChangesThroughFieldMaps)
+{
+    ContextFieldsProvider parent(nullptr);
+    ContextFieldsProvider child(&parent);
+    auto& commonFields = parent.GetCommonFields();
+    auto& customFields = parent.GetCustomFields();
+
+    // A snapshot taken between handing out the maps and writing to them
+    ::CsProtocol::Record before;
+    child.writeToRecord(before);
+    EXPECT_THAT(before.data[0].properties.count("viaMap"), Eq(0u));
+
+    commonFields[COMMONFIELDS_APP_NAME] = EventProperty("mapName");
+    customFields["viaMap"] = EventProperty("one");
+    ::CsProtocol::Record after;
+    child.writeToRecord(after);
+    EXPECT_THAT(after.extApp[0].name, Eq("mapName"));
+    EXPECT_THAT(after.data[0].properties["viaMap"].stringValue, Eq("one"));
+
+    customFields["viaMap"] = EventProperty("two");
+    ::CsProtocol::Record again;
+    child.writeToRecord(again);
+    EXPECT_THAT(again.data[0].properties["viaMap"].stringValue, Eq("two"));
+}
+
+TEST(ContextFieldsProviderTests, WriteToRecord_CommonOnlySkipsOwnCustomFields)
+{
+    ContextFieldsProvider parent(nullptr);
+    ContextFieldsProvider child(&parent);
+    parent.SetCustomField("shared", "parent");
+    child.SetCustomField("shared", "child");
+    child.SetCustomField("own", int64_t(5));
+
+    ::CsProtocol::Record full;
+    child.writeToRecord(full);
+    EXPECT_THAT(full.data[0].properties["shared"].stringValue, Eq("child"));
+    EXPECT_THAT(full.data[0].properties["own"].longValue, Eq(5));
+
+    ::CsProtocol::Record common;
+    child.writeToRecord(common, true);
+    EXPECT_THAT(common.data[0].properties["shared"].stringValue, Eq("parent"));
+    EXPECT_THAT(common.data[0].properties.count("own"), Eq(0u));
+}
+
+TEST(ContextFieldsProviderTests, WriteToRecord_EventExperimentIdsOverrideCommonOnes)
+{
+    ContextFieldsProvider ctx(nullptr);
+    ctx.SetAppExperimentIds("common");
+    ctx.SetEventExperimentIds("special", "perEvent");
+
+    ::CsProtocol::Record record;
+    record.name = "special";
+    ctx.writeToRecord(record);
+    EXPECT_THAT(record.extApp[0].expId, Eq("perEvent"));
+
+    ::CsProtocol::Record other;
+    other.name = "other";
+    ctx.writeToRecord(other);
+    EXPECT_THAT(other.extApp[0].expId, Eq("common"));
+
+    ctx.ClearExperimentIds();
+    ::CsProtocol::Record cleared;
+    cleared.name = "special";
+    ctx.writeToRecord(cleared);
+    EXPECT_THAT(cleared.extApp[0].expId, IsEmpty());
+}
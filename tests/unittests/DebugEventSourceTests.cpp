@@ -5,7 +5,12 @@
 
 #include "common/Common.hpp"
 #include <DebugEvents.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <functional>
+#include <mutex>
+#include <thread>
 
 using namespace testing;
 using namespace MAT;
@@ -15,7 +20,7 @@ class TestDebugEventSource : public DebugEventSource
 public:
    using DebugEventSource::listeners;
    using DebugEventSource::cascaded;
-   using DebugEventSource::seq;
+   using DebugEventSource::sequence;
 };
 
 class TestDebugEventListener : public DebugEventListener
@@ -38,7 +43,7 @@ TEST(DebugEventSourceTests, Constructor_ZeroListeners)
 TEST(DebugEventSourceTests, Constructor_SeqZero)
 {
    TestDebugEventSource source;
-   ASSERT_EQ(source.seq, size_t { 0 });
+   ASSERT_EQ(source.sequence(), uint64_t { 0 });
 }
 
 TEST(DebugEventSourceTests, Constructor_ZeroCascaded)
@@ -218,3 +223,198 @@ TEST(DebugEventSourceTests, DispatchEvent_OneEventToCascadedAndToSource_Listener
 }
 
 
+
+TEST(DebugEventSourceTests, CopyConstructor_CopiedSourceDispatchesToSameListeners)
+{
+   TestDebugEventSource source;
+   TestDebugEventSource anotherSource;
+   TestDebugEventListener listener;
+   int calls = 0;
+   listener.OnDebugEventOverride = [&calls](DebugEvent&) noexcept { calls++; };
+   source.AddEventListener(EVT_LOG_EVENT, listener);
+   source.AttachEventSource(anotherSource);
+   source.DispatchEvent(DebugEvent { EVT_LOG_EVENT });
+
+   TestDebugEventSource copy(source);
+   EXPECT_EQ(copy.listeners.size(), size_t { 1 });
+   EXPECT_EQ(copy.cascaded.size(), size_t { 1 });
+   EXPECT_EQ(copy.sequence(), uint64_t { 1 });
+   EXPECT_TRUE(copy.HasListeners(EVT_LOG_EVENT));
+
+   source.RemoveEventListener(EVT_LOG_EVENT, listener);
+   EXPECT_TRUE(copy.DispatchEvent(DebugEvent { EVT_LOG_EVENT }));
+   EXPECT_EQ(calls, 2);
+   EXPECT_EQ(copy.sequence(), uint64_t { 2 });
+   copy.RemoveEventListener(EVT_LOG_EVENT, listener);
+}
+
+TEST(DebugEventSourceTests, DispatchEvent_NoListeners_DoesNotIncrementSequenceNumber)
+{
+   TestDebugEventSource source;
+   source.DispatchEvent(DebugEvent { EVT_LOG_EVENT });
+   ASSERT_EQ(source.sequence(), uint64_t { 0 });
+}
+
+TEST(DebugEventSourceTests, HasListeners_FollowsListenersAndCascadedSources)
+{
+   TestDebugEventSource source;
+   TestDebugEventSource anotherSource;
+   TestDebugEventListener listener;
+   EXPECT_FALSE(source.HasListeners(EVT_LOG_EVENT));
+
+   source.AddEventListener(EVT_LOG_EVENT, listener);
+   EXPECT_TRUE(source.HasListeners(EVT_LOG_EVENT));
+   EXPECT_FALSE(source.HasListeners(EVT_DROPPED));
+   source.RemoveEventListener(EVT_LOG_EVENT, listener);
+   EXPECT_FALSE(source.HasListeners(EVT_LOG_EVENT));
+
+   source.AttachEventSource(anotherSource);
+   EXPECT_FALSE(source.HasListeners(EVT_DROPPED));
+   anotherSource.AddEventListener(EVT_DROPPED, listener);
+   EXPECT_TRUE(source.HasListeners(EVT_DROPPED));
+   source.DetachEventSource(anotherSource);
+   EXPECT_FALSE(source.HasListeners(EVT_DROPPED));
+}
+
+TEST(DebugEventSourceTests, RemoveEventListener_FromWithinListener_StopsFurtherCalls)
+{
+   TestDebugEventSource source;
+   TestDebugEventListener listener;
+   int calls = 0;
+   listener.OnDebugEventOverride = [&](DebugEvent&) { calls++; source.RemoveEventListener(EVT_LOG_EVENT, listener); };
+   source.AddEventListener(EVT_LOG_EVENT, listener);
+
+   EXPECT_TRUE(source.DispatchEvent(DebugEvent { EVT_LOG_EVENT }));
+   EXPECT_FALSE(source.DispatchEvent(DebugEvent { EVT_LOG_EVENT }));
+   EXPECT_EQ(calls, 1);
+}
+
+TEST(DebugEventSourceTests, AddQueuedEventListener_DeliversOnOtherThreadWithoutData)
+{
+   TestDebugEventSource source;
+   TestDebugEventListener listener;
+   std::mutex lock;
+   std::condition_variable delivered;
+   std::vector<DebugEvent> events;
+   std::thread::id listenerThread;
+   listener.OnDebugEventOverride = [&](DebugEvent& evt) {
+      std::lock_guard<std::mutex> guard(lock);
+      events.push_back(evt);
+      listenerThread = std::this_thread::get_id();
+      delivered.notify_all();
+   };
+   source.AddQueuedEventListener(EVT_LOG_EVENT, listener, 16);
+   EXPECT_TRUE(source.HasListeners(EVT_LOG_EVENT));
+
+   int payload = 42;
+   EXPECT_TRUE(source.DispatchEvent(DebugEvent { EVT_LOG_EVENT, 7, 8, &payload, sizeof(payload) }));
+   EXPECT_TRUE(source.DispatchEvent(DebugEvent { EVT_LOG_EVENT, 9 }));
+   {
+      std::unique_lock<std::mutex> guard(lock);
+      ASSERT_TRUE(delivered.wait_for(guard, std::chrono::seconds(5), [&]() { return events.size() == 2; }));
+   }
+   source.RemoveEventListener(EVT_LOG_EVENT, listener);
+
+   EXPECT_NE(listenerThread, std::this_thread::get_id());
+   EXPECT_EQ(events[0].seq, uint64_t { 1 });
+   EXPECT_EQ(events[0].param1, size_t { 7 });
+   EXPECT_EQ(events[0].param2, size_t { 8 });
+   EXPECT_EQ(events[0].data, nullptr);
+   EXPECT_EQ(events[0].size, sizeof(payload));
+   EXPECT_EQ(events[1].param1, size_t { 9 });
+   EXPECT_EQ(source.GetDroppedEventCount(), uint64_t { 0 });
+}
+
+TEST(DebugEventSourceTests, AddQueuedEventListener_SlowListener_DropsAndCountsOverflow)
+{
+   TestDebugEventSource source;
+   TestDebugEventListener listener;
+   std::mutex gate;
+   std::atomic<int> calls { 0 };
+   listener.OnDebugEventOverride = [&](DebugEvent&) {
+      std::lock_guard<std::mutex> guard(gate);
+      calls++;
+   };
+
+   {
+      // The listener is stuck on the gate: the first event is taken off the
+      // queue, the next 4 wait in it and the rest are dropped.
+      std::unique_lock<std::mutex> closed(gate);
+      source.AddQueuedEventListener(EVT_DROPPED, listener, 4);
+      source.DispatchEvent(DebugEvent { EVT_DROPPED });
+      while (source.GetDroppedEventCount() == 0)
+      {
+         source.DispatchEvent(DebugEvent { EVT_DROPPED });
+         std::this_thread::yield();
+      }
+      for (int i = 0; i < 10; i++)
+      {
+         EXPECT_TRUE(source.DispatchEvent(DebugEvent { EVT_DROPPED }));
+      }
+   }
+   // Removing discards what is still queued
+   source.RemoveEventListener(EVT_DROPPED, listener);
+   EXPECT_EQ(static_cast<uint64_t>(calls.load()) + source.GetDroppedEventCount(), source.sequence());
+   EXPECT_GE(source.GetDroppedEventCount(), uint64_t { 11 });
+}
+
+TEST(DebugEventSourceTests, RemoveEventListener_WaitsForCallsInProgress)
+{
+   TestDebugEventSource source;
+   TestDebugEventListener listener;
+   std::atomic<bool> inside { false };
+   std::atomic<bool> removed { false };
+   std::atomic<bool> calledAfterRemove { false };
+   listener.OnDebugEventOverride = [&](DebugEvent&) {
+      inside = true;
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      calledAfterRemove = calledAfterRemove || removed;
+   };
+   source.AddEventListener(EVT_LOG_EVENT, listener);
+
+   std::thread dispatcher([&]() { source.DispatchEvent(DebugEvent { EVT_LOG_EVENT }); });
+   while (!inside)
+   {
+      std::this_thread::yield();
+   }
+   source.RemoveEventListener(EVT_LOG_EVENT, listener);
+   removed = true;
+   dispatcher.join();
+   EXPECT_FALSE(calledAfterRemove);
+}
+
+TEST(DebugEventSourceTests, DispatchEvent_ConcurrentWithListenerChanges)
+{
+   TestDebugEventSource source;
+   TestDebugEventSource cascadedSource;
+   TestDebugEventListener listener;
+   std::atomic<uint64_t> seen { 0 };
+   listener.OnDebugEventOverride = [&](DebugEvent&) { seen++; };
+   cascadedSource.AddEventListener(EVT_LOG_EVENT, listener);
+
+   std::atomic<bool> done { false };
+   std::vector<std::thread> dispatchers;
+   for (int t = 0; t < 4; t++)
+   {
+      dispatchers.emplace_back([&]() {
+         while (!done)
+         {
+            source.DispatchEvent(DebugEvent { EVT_LOG_EVENT });
+         }
+      });
+   }
+   for (int i = 0; i < 500 || seen == 0; i++)
+   {
+      source.AddEventListener(EVT_LOG_EVENT, listener);
+      source.AttachEventSource(cascadedSource);
+      source.RemoveEventListener(EVT_LOG_EVENT, listener);
+      source.DetachEventSource(cascadedSource);
+   }
+   done = true;
+   for (auto& thread : dispatchers)
+   {
+      thread.join();
+   }
+   EXPECT_FALSE(source.HasListeners(EVT_LOG_EVENT));
+   EXPECT_GT(seen.load(), uint64_t { 0 });
+}
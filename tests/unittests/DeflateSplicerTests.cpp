@@ -0,0 +1,159 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "common/Common.hpp"
+#include "config/RuntimeConfig_Default.hpp"
+#include "packager/BondSplicer.hpp"
+#include "packager/DeflateSplicer.hpp"
+
+#include <utils/ZlibUtils.hpp>
+#include "zlib.h"
+#undef compress
+
+using namespace testing;
+using namespace MAT;
+
+class DeflateSplicerTests : public Test {
+  protected:
+    ILogConfiguration     logConfig;
+    RuntimeConfig_Default config;
+
+    DeflateSplicerTests() :
+        config(logConfig)
+    {
+    }
+
+    static std::vector<uint8_t> inflate(std::vector<uint8_t> const& body, bool isGzip = false)
+    {
+        std::vector<uint8_t> inflated;
+        EXPECT_TRUE(ZlibUtils::InflateVector(body, inflated, isGzip));
+        return inflated;
+    }
+};
+
+static std::vector<uint8_t> const record1 = { 1, 1, 1, 1, 1, 1, 1, 1, 0 };
+static std::vector<uint8_t> const record2 = { 2, 2, 2, 2, 2, 2, 0 };
+static std::vector<uint8_t> const record3 = { 3, 3, 3, 3, 3, 0 };
+
+TEST_F(DeflateSplicerTests, splice_InflatesToRecordsInArrivalOrder)
+{
+    DeflateSplicer splicer(DeflateParameters::FromConfig(config));
+    ASSERT_TRUE(splicer.good());
+
+    size_t tenant1 = splicer.addTenantToken("tenant1");
+    size_t tenant2 = splicer.addTenantToken("tenant2");
+    splicer.addRecord(tenant1, record1);
+    splicer.addRecord(tenant2, record2);
+    splicer.addRecord(tenant1, record3);
+
+    std::vector<uint8_t> expected;
+    expected.insert(expected.end(), record1.begin(), record1.end());
+    expected.insert(expected.end(), record2.begin(), record2.end());
+    expected.insert(expected.end(), record3.begin(), record3.end());
+
+    EXPECT_TRUE(splicer.isCompressed());
+    EXPECT_THAT(inflate(splicer.splice()), Eq(expected));
+}
+
+TEST_F(DeflateSplicerTests, getSizeEstimate_MatchesUncompressedSplicer)
+{
+    DeflateSplicer deflateSplicer(DeflateParameters::FromConfig(config));
+    BondSplicer bondSplicer;
+    for (ISplicer* splicer : std::initializer_list<ISplicer*> { &deflateSplicer, &bondSplicer })
+    {
+        size_t tenant = splicer->addTenantToken("tenant1");
+        splicer->addRecord(tenant, record1);
+        splicer->addRecord(tenant, record2);
+    }
+    EXPECT_THAT(deflateSplicer.getSizeEstimate(), Eq(bondSplicer.getSizeEstimate()));
+    EXPECT_FALSE(bondSplicer.isCompressed());
+}
+
+TEST_F(DeflateSplicerTests, addRecord_MovedBlob_IsReleased)
+{
+    DeflateSplicer splicer(DeflateParameters::FromConfig(config));
+    size_t tenant = splicer.addTenantToken("tenant1");
+
+    std::vector<uint8_t> blob(record1);
+    splicer.addRecord(tenant, std::move(blob));
+    EXPECT_THAT(blob.capacity(), Eq(0u));
+    EXPECT_THAT(inflate(splicer.splice()), Eq(record1));
+}
+
+TEST_F(DeflateSplicerTests, clear_StreamIsReusedForNextPackage)
+{
+    DeflateSplicer splicer(DeflateParameters::FromConfig(config));
+    size_t tenant = splicer.addTenantToken("tenant1");
+    splicer.addRecord(tenant, record1);
+    EXPECT_THAT(inflate(splicer.splice()), Eq(record1));
+
+    splicer.clear();
+    EXPECT_THAT(splicer.getSizeEstimate(), Eq(8u));
+
+    tenant = splicer.addTenantToken("tenant2");
+    splicer.addRecord(tenant, record2);
+    EXPECT_THAT(inflate(splicer.splice()), Eq(record2));
+}
+
+TEST_F(DeflateSplicerTests, splice_LargeBodySpansManyOutputChunks)
+{
+    DeflateSplicer splicer(DeflateParameters::FromConfig(config));
+    size_t tenant = splicer.addTenantToken("tenant1");
+
+    // Poorly compressible records so the output outgrows its first chunk
+    std::vector<uint8_t> expected;
+    uint32_t seed = 12345;
+    for (int i = 0; i < 200; i++)
+    {
+        std::vector<uint8_t> record(1000);
+        for (auto& byte : record)
+        {
+            seed = seed * 1103515245 + 12345;
+            byte = static_cast<uint8_t>(seed >> 16);
+        }
+        record.back() = 0;
+        expected.insert(expected.end(), record.begin(), record.end());
+        splicer.addRecord(tenant, std::move(record));
+    }
+
+    EXPECT_THAT(inflate(splicer.splice()), Eq(expected));
+}
+
+TEST_F(DeflateSplicerTests, FromConfig_HonorsGzipLevelAndStrategy)
+{
+    config[CFG_MAP_HTTP]["contentEncoding"] = "gzip";
+    config[CFG_MAP_HTTP][CFG_INT_HTTP_COMPRESSION_LEVEL] = 9;
+    config[CFG_MAP_HTTP][CFG_STR_HTTP_COMPRESSION_STRATEGY] = "huffman";
+
+    DeflateParameters parameters = DeflateParameters::FromConfig(config);
+    EXPECT_THAT(parameters.windowBits, Eq(MAX_WBITS | 16));
+    EXPECT_THAT(parameters.level, Eq(9));
+    EXPECT_THAT(parameters.strategy, Eq(Z_HUFFMAN_ONLY));
+    EXPECT_THAT(parameters.GetContentEncoding(), StrEq("gzip"));
+
+    DeflateSplicer splicer(parameters);
+    size_t tenant = splicer.addTenantToken("tenant1");
+    splicer.addRecord(tenant, record1);
+    EXPECT_THAT(inflate(splicer.splice(), true), Eq(record1));
+
+    config[CFG_MAP_HTTP]["contentEncoding"] = "deflate";
+    config[CFG_MAP_HTTP][CFG_INT_HTTP_COMPRESSION_LEVEL] = -1;
+    config[CFG_MAP_HTTP][CFG_STR_HTTP_COMPRESSION_STRATEGY] = "default";
+    EXPECT_THAT(DeflateParameters::FromConfig(config).GetContentEncoding(), StrEq("deflate"));
+}
+
+TEST_F(DeflateSplicerTests, FromConfig_IgnoresInvalidValues)
+{
+    config[CFG_MAP_HTTP][CFG_INT_HTTP_COMPRESSION_LEVEL] = 42;
+    config[CFG_MAP_HTTP][CFG_STR_HTTP_COMPRESSION_STRATEGY] = "fastest";
+
+    DeflateParameters parameters = DeflateParameters::FromConfig(config);
+    EXPECT_THAT(parameters.windowBits, Eq(-MAX_WBITS));
+    EXPECT_THAT(parameters.level, Eq(Z_DEFAULT_COMPRESSION));
+    EXPECT_THAT(parameters.strategy, Eq(Z_DEFAULT_STRATEGY));
+
+    config[CFG_MAP_HTTP][CFG_INT_HTTP_COMPRESSION_LEVEL] = -1;
+    config[CFG_MAP_HTTP][CFG_STR_HTTP_COMPRESSION_STRATEGY] = "default";
+}
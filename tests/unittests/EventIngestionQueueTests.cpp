@@ -0,0 +1,287 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "common/Common.hpp"
+#include "system/EventIngestionQueue.hpp"
+#include "utils/BoundedRingQueue.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace testing;
+using namespace MAT;
+
+namespace
+{
+    std::unique_ptr<IncomingEventContext> makeEvent(const std::string& id)
+    {
+        std::unique_ptr<IncomingEventContext> event(new IncomingEventContext());
+        event->record.id = id;
+        return event;
+    }
+
+    /// Holds pipeline threads inside the handler until released.
+    class Gate
+    {
+       public:
+        void wait()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_entered++;
+            m_cv.notify_all();
+            m_cv.wait(lock, [this]() { return m_open; });
+        }
+
+        void waitEntered(size_t count)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this, count]() { return m_entered >= count; });
+        }
+
+        void open()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_open = true;
+            m_cv.notify_all();
+        }
+
+       private:
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+        size_t m_entered = 0;
+        bool m_open = false;
+    };
+}
+
+TEST(BoundedRingQueueTests, RoundsCapacityToPowerOfTwo)
+{
+    BoundedRingQueue<int> queue(100);
+    EXPECT_EQ(queue.capacity(), 128u);
+    BoundedRingQueue<int> tiny(0);
+    EXPECT_EQ(tiny.capacity(), 2u);
+}
+
+TEST(BoundedRingQueueTests, PushPopIsFifoAndReportsFull)
+{
+    BoundedRingQueue<int> queue(4);
+    for (int i = 0; i < 4; i++)
+    {
+        int value = i;
+        EXPECT_TRUE(queue.try_push(value));
+    }
+    int extra = 42;
+    EXPECT_FALSE(queue.try_push(extra));
+    EXPECT_EQ(extra, 42);
+    EXPECT_EQ(queue.size(), 4u);
+
+    for (int i = 0; i < 4; i++)
+    {
+        int value = -1;
+        EXPECT_TRUE(queue.try_pop(value));
+        EXPECT_EQ(value, i);
+    }
+    int value = -1;
+    EXPECT_FALSE(queue.try_pop(value));
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(BoundedRingQueueTests, MultipleProducersDeliverEveryItemOnce)
+{
+    constexpr int producers = 8;
+    constexpr int perProducer = 10000;
+    BoundedRingQueue<int> queue(256);
+    std::vector<std::atomic<int>> seen(producers * perProducer);
+    for (auto& s : seen)
+    {
+        s = 0;
+    }
+
+    std::atomic<bool> done(false);
+    std::thread consumer([&]() {
+        int value;
+        for (;;)
+        {
+            if (queue.try_pop(value))
+            {
+                seen[value]++;
+            }
+            else if (done)
+            {
+                if (!queue.try_pop(value))
+                    break;
+                seen[value]++;
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++)
+    {
+        threads.emplace_back([&queue, p]() {
+            for (int i = 0; i < perProducer; i++)
+            {
+                int value = p * perProducer + i;
+                while (!queue.try_push(value))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+    done = true;
+    consumer.join();
+
+    for (auto& s : seen)
+    {
+        EXPECT_EQ(s.load(), 1);
+    }
+}
+
+TEST(EventIngestionQueueTests, ParsePolicy)
+{
+    EXPECT_EQ(EventIngestionQueue::ParsePolicy("block"), IngestionBackpressure::Block);
+    EXPECT_EQ(EventIngestionQueue::ParsePolicy("DROP"), IngestionBackpressure::Drop);
+    EXPECT_EQ(EventIngestionQueue::ParsePolicy("spill"), IngestionBackpressure::Spill);
+    EXPECT_EQ(EventIngestionQueue::ParsePolicy("unknown"), IngestionBackpressure::Block);
+}
+
+TEST(EventIngestionQueueTests, DrainWaitsForAllEventsInOrder)
+{
+    std::vector<std::string> handled;
+    EventIngestionQueue queue(16, 1, IngestionBackpressure::Block,
+                              [&handled](IncomingEventContext& event) { handled.push_back(event.record.id); });
+    for (int i = 0; i < 100; i++)
+    {
+        auto event = makeEvent(std::to_string(i));
+        EXPECT_EQ(queue.Push(event), EventIngestionQueue::PushResult::Queued);
+        EXPECT_EQ(event, nullptr);
+    }
+    queue.Drain();
+    ASSERT_EQ(handled.size(), 100u);
+    for (int i = 0; i < 100; i++)
+    {
+        EXPECT_EQ(handled[i], std::to_string(i));
+    }
+}
+
+TEST(EventIngestionQueueTests, DropPolicyReturnsEventWhenFull)
+{
+    Gate gate;
+    EventIngestionQueue queue(2, 1, IngestionBackpressure::Drop, [&gate](IncomingEventContext&) { gate.wait(); });
+
+    auto first = makeEvent("first");
+    EXPECT_EQ(queue.Push(first), EventIngestionQueue::PushResult::Queued);
+    gate.waitEntered(1);
+
+    auto a = makeEvent("a");
+    auto b = makeEvent("b");
+    EXPECT_EQ(queue.Push(a), EventIngestionQueue::PushResult::Queued);
+    EXPECT_EQ(queue.Push(b), EventIngestionQueue::PushResult::Queued);
+
+    auto overflow = makeEvent("overflow");
+    EXPECT_EQ(queue.Push(overflow), EventIngestionQueue::PushResult::Dropped);
+    ASSERT_NE(overflow, nullptr);
+    EXPECT_EQ(overflow->record.id, "overflow");
+    EXPECT_EQ(queue.GetDroppedCount(), 1u);
+
+    gate.open();
+    queue.Drain();
+}
+
+TEST(EventIngestionQueueTests, SpillPolicyHandsEventBackWhenFull)
+{
+    Gate gate;
+    EventIngestionQueue queue(2, 1, IngestionBackpressure::Spill, [&gate](IncomingEventContext&) { gate.wait(); });
+
+    auto first = makeEvent("first");
+    queue.Push(first);
+    gate.waitEntered(1);
+    auto a = makeEvent("a");
+    auto b = makeEvent("b");
+    queue.Push(a);
+    queue.Push(b);
+
+    auto overflow = makeEvent("overflow");
+    EXPECT_EQ(queue.Push(overflow), EventIngestionQueue::PushResult::Spilled);
+    EXPECT_NE(overflow, nullptr);
+    EXPECT_EQ(queue.GetSpilledCount(), 1u);
+
+    gate.open();
+    queue.Drain();
+}
+
+TEST(EventIngestionQueueTests, BlockPolicyWaitsForFreeSlot)
+{
+    Gate gate;
+    std::atomic<int> handled(0);
+    EventIngestionQueue queue(2, 1, IngestionBackpressure::Block, [&](IncomingEventContext&) {
+        gate.wait();
+        handled++;
+    });
+
+    auto first = makeEvent("first");
+    queue.Push(first);
+    gate.waitEntered(1);
+    auto a = makeEvent("a");
+    auto b = makeEvent("b");
+    queue.Push(a);
+    queue.Push(b);
+
+    std::atomic<bool> pushed(false);
+    std::thread producer([&]() {
+        auto blocked = makeEvent("blocked");
+        EXPECT_EQ(queue.Push(blocked), EventIngestionQueue::PushResult::Queued);
+        pushed = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(pushed);
+
+    gate.open();
+    producer.join();
+    EXPECT_TRUE(pushed);
+    queue.Drain();
+    EXPECT_EQ(handled, 4);
+}
+
+TEST(EventIngestionQueueTests, StopHandlesQueuedEventsAndSpillsLateOnes)
+{
+    std::atomic<int> handled(0);
+    EventIngestionQueue queue(64, 2, IngestionBackpressure::Block, [&handled](IncomingEventContext&) { handled++; });
+    for (int i = 0; i < 50; i++)
+    {
+        auto event = makeEvent(std::to_string(i));
+        queue.Push(event);
+    }
+    queue.Stop();
+    EXPECT_EQ(handled, 50);
+
+    auto late = makeEvent("late");
+    EXPECT_EQ(queue.Push(late), EventIngestionQueue::PushResult::Spilled);
+    EXPECT_NE(late, nullptr);
+}
+
+TEST(EventIngestionQueueTests, QueuedEventContextOwnsRecord)
+{
+    ::CsProtocol::Record record;
+    record.name = "owned";
+    IncomingEventContext event("id", "token", EventLatency_Normal, EventPersistence_Normal, &record);
+    event.policyBitFlags = 7;
+
+    QueuedEventContext queued(event);
+    EXPECT_EQ(queued.source, &queued.ownedRecord);
+    EXPECT_EQ(queued.ownedRecord.name, "owned");
+    EXPECT_EQ(queued.record.id, "id");
+    EXPECT_EQ(queued.record.tenantToken, "token");
+    EXPECT_EQ(queued.policyBitFlags, 7u);
+}
@@ -596,3 +596,60 @@ TEST(EventPropertiesDecoratorTests, Decorate_ScrubIp_ExplicitlyEnabled)
     EXPECT_TRUE(decorator.decorate(record, latency, props));
     EXPECT_TRUE(record.flags & RECORD_FLAGS_EVENTTAG_SCRUB_IP);
 }
+
+TEST(EventPropertiesDecoratorTests, Decorate_InvalidNameInInitializerList_Rejected)
+{
+    NullLogManager logManager;
+    EventPropertiesDecorator decorator(logManager);
+    Record record;
+    EventProperties props("TestEvent", { { "valid.name", 1 }, { ".invalid", 2 } });
+    EventLatency latency = EventLatency::EventLatency_Normal;
+
+    EXPECT_FALSE(decorator.decorate(record, latency, props));
+
+    // Dropping the offending name makes the event valid again
+    props.erase(".invalid");
+    EXPECT_TRUE(decorator.decorate(record, latency, props));
+    EXPECT_THAT(record.data[0].properties, SizeIs(1));
+}
+
+TEST(EventPropertiesDecoratorTests, Decorate_InvalidNameInMap_Rejected)
+{
+    NullLogManager logManager;
+    EventPropertiesDecorator decorator(logManager);
+    Record record;
+    std::map<std::string, EventProperty> properties { { "name with spaces", 1 } };
+    EventProperties props("TestEvent", properties);
+    EventLatency latency = EventLatency::EventLatency_Normal;
+
+    EXPECT_FALSE(decorator.decorate(record, latency, props));
+
+    props = std::map<std::string, EventProperty> { { "name_without_spaces", 1 } };
+    EXPECT_TRUE(decorator.decorate(record, latency, props));
+}
+
+TEST(EventPropertiesDecoratorTests, Decorate_EventPropertiesOverrideExistingFields)
+{
+    NullLogManager logManager;
+    EventPropertiesDecorator decorator(logManager);
+    Record record;
+    record.data.resize(1);
+    record.data[0].properties["b.context"].stringValue = "context";
+    record.data[0].properties["d.shared"].stringValue = "context";
+
+    EventProperties props("TestEvent");
+    props.SetProperty("a.first", "event");
+    props.SetProperty("d.shared", "event");
+    props.SetProperty("e.partB", "event", PiiKind_None, DataCategory_PartB);
+    props.SetProperty("z.last", int64_t { 42 });
+    EventLatency latency = EventLatency::EventLatency_Normal;
+
+    ASSERT_TRUE(decorator.decorate(record, latency, props));
+    auto const& ext = record.data[0].properties;
+    EXPECT_THAT(ext.at("a.first").stringValue, Eq("event"));
+    EXPECT_THAT(ext.at("b.context").stringValue, Eq("context"));
+    EXPECT_THAT(ext.at("d.shared").stringValue, Eq("event"));
+    EXPECT_THAT(ext.at("z.last").longValue, Eq(42));
+    ASSERT_THAT(record.baseData, SizeIs(1));
+    EXPECT_THAT(record.baseData[0].properties.at("e.partB").stringValue, Eq("event"));
+}
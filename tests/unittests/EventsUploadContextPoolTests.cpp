@@ -0,0 +1,208 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "common/Common.hpp"
+#include "system/EventsUploadContextPool.hpp"
+#include "compression/DeflateStream.hpp"
+
+#include <vector>
+
+using namespace testing;
+using namespace MAT;
+
+namespace
+{
+    std::unique_ptr<ISplicer> makeBondSplicer()
+    {
+        return std::unique_ptr<ISplicer>(new BondSplicer());
+    }
+
+    class CompressedSplicer : public BondSplicer
+    {
+    public:
+        bool isCompressed() const override
+        {
+            return true;
+        }
+    };
+
+    class CountingObjectPool : public IHttpObjectPool
+    {
+    public:
+        size_t requests = 0;
+        size_t responses = 0;
+
+        void ReleaseRequest(IHttpRequest* request, std::vector<uint8_t>& body) noexcept override
+        {
+            requests++;
+            body.swap(request->GetBody());
+            body.clear();
+            delete request;
+        }
+
+        void ReleaseResponse(IHttpResponse* response) noexcept override
+        {
+            responses++;
+            delete response;
+        }
+    };
+}
+
+TEST(EventsUploadContextPoolTests, Acquire_ReusesReleasedContextReset)
+{
+    EventsUploadContextPool pool;
+    auto ctx = pool.Acquire(EventsUploadContextPool::PlainSplicerKey, makeBondSplicer);
+    ASSERT_THAT(ctx, NotNull());
+    EventsUploadContext* raw = ctx.get();
+    ISplicer* splicer = ctx->splicer.get();
+
+    ctx->requestedMinLatency = EventLatency_RealTime;
+    ctx->maxUploadSize = 1000;
+    ctx->latency = EventLatency_RealTime;
+    ctx->packageIds["tenant"] = 0;
+    ctx->addRecord("r1", "tenant");
+    ctx->recordTimestamps.push_back(1);
+    ctx->body.assign(4096, 0xAA);
+    ctx->compressed = true;
+    ctx->contentEncoding = "gzip";
+    ctx->httpRequestId = "REQ-1";
+    ctx->durationMs = 10;
+    ctx->fromMemory = true;
+    ctx.reset();
+    EXPECT_THAT(pool.GetIdleCount(), Eq(1u));
+
+    ctx = pool.Acquire(EventsUploadContextPool::PlainSplicerKey, makeBondSplicer);
+    EXPECT_THAT(ctx.get(), Eq(raw));
+    EXPECT_THAT(ctx->splicer.get(), Eq(splicer));
+    EXPECT_THAT(pool.GetIdleCount(), Eq(0u));
+    EXPECT_THAT(ctx->requestedMinLatency, Eq(EventLatency_Unspecified));
+    EXPECT_THAT(ctx->maxUploadSize, Eq(0u));
+    EXPECT_THAT(ctx->latency, Eq(EventLatency_Unspecified));
+    EXPECT_THAT(ctx->packageIds, IsEmpty());
+    EXPECT_THAT(ctx->recordIds, IsEmpty());
+    EXPECT_THAT(ctx->tenantTokens, IsEmpty());
+    EXPECT_THAT(ctx->recordTimestamps, IsEmpty());
+    EXPECT_THAT(ctx->body, IsEmpty());
+    EXPECT_THAT(ctx->body.capacity(), Ge(4096u));
+    EXPECT_FALSE(ctx->compressed);
+    EXPECT_THAT(ctx->contentEncoding, IsEmpty());
+    EXPECT_THAT(ctx->httpRequestId, IsEmpty());
+    EXPECT_THAT(ctx->durationMs, Eq(-1));
+    EXPECT_FALSE(ctx->fromMemory);
+}
+
+TEST(EventsUploadContextPoolTests, Acquire_KeepsCompressedAndPlainSplicersApart)
+{
+    EventsUploadContextPool pool;
+    auto plain = pool.Acquire(EventsUploadContextPool::PlainSplicerKey, makeBondSplicer);
+    EventsUploadContext* raw = plain.get();
+    plain.reset();
+
+    auto compressed = pool.Acquire(1, []() { return std::unique_ptr<ISplicer>(new CompressedSplicer()); });
+    EXPECT_THAT(compressed.get(), Ne(raw));
+    EXPECT_TRUE(compressed->splicer->isCompressed());
+    EXPECT_THAT(pool.GetIdleCount(), Eq(1u));
+
+    auto none = pool.Acquire(1, []() { return std::unique_ptr<ISplicer>(); });
+    EXPECT_THAT(none, IsNull());
+}
+
+TEST(EventsUploadContextPoolTests, Acquire_DoesNotReuseContextOfOtherSettings)
+{
+    EventsUploadContextPool pool;
+    auto makeCompressed = []() { return std::unique_ptr<ISplicer>(new CompressedSplicer()); };
+    auto deflate = pool.Acquire(1, makeCompressed);
+    EventsUploadContext* raw = deflate.get();
+    deflate.reset();
+
+    auto gzip = pool.Acquire(2, makeCompressed);
+    EXPECT_THAT(gzip.get(), Ne(raw));
+    gzip.reset();
+    EXPECT_THAT(pool.GetIdleCount(), Eq(2u));
+
+    deflate = pool.Acquire(1, makeCompressed);
+    EXPECT_THAT(deflate.get(), Eq(raw));
+}
+
+TEST(EventsUploadContextPoolTests, Release_EvictsOldestWhenFull)
+{
+    EventsUploadContextPool pool(2);
+    auto stale = pool.Acquire(1, makeBondSplicer);
+    auto first = pool.Acquire(2, makeBondSplicer);
+    auto second = pool.Acquire(2, makeBondSplicer);
+    EventsUploadContext* firstRaw = first.get();
+    EventsUploadContext* secondRaw = second.get();
+    stale.reset();
+    first.reset();
+    second.reset();
+    EXPECT_THAT(pool.GetIdleCount(), Eq(2u));
+
+    // The context of the old settings made room
+    second = pool.Acquire(2, makeBondSplicer);
+    first = pool.Acquire(2, makeBondSplicer);
+    EXPECT_THAT(second.get(), Eq(secondRaw));
+    EXPECT_THAT(first.get(), Eq(firstRaw));
+    EXPECT_THAT(pool.GetIdleCount(), Eq(0u));
+}
+
+TEST(EventsUploadContextPoolTests, DeflateParameters_KeyDiffersPerSetting)
+{
+    DeflateParameters deflate { -1, -15, 0 };
+    DeflateParameters gzip { -1, 15 | 16, 0 };
+    DeflateParameters fast { 1, -15, 0 };
+    EXPECT_THAT(deflate.GetKey(), Ne(EventsUploadContextPool::PlainSplicerKey));
+    EXPECT_THAT(deflate.GetKey(), Ne(gzip.GetKey()));
+    EXPECT_THAT(deflate.GetKey(), Ne(fast.GetKey()));
+    EXPECT_THAT(deflate.GetKey(), Eq((DeflateParameters { -1, -15, 0 }).GetKey()));
+}
+
+TEST(EventsUploadContextPoolTests, Release_KeepsAtMostMaxIdle)
+{
+    EventsUploadContextPool pool(2);
+    std::vector<EventsUploadContextPtr> contexts;
+    for (int i = 0; i < 5; i++)
+    {
+        contexts.push_back(pool.Acquire(EventsUploadContextPool::PlainSplicerKey, makeBondSplicer));
+    }
+    contexts.clear();
+    EXPECT_THAT(pool.GetIdleCount(), Eq(2u));
+}
+
+TEST(EventsUploadContextPoolTests, Release_ReturnsHttpObjectsToTheirPool)
+{
+    auto objectPool = std::make_shared<CountingObjectPool>();
+    EventsUploadContextPool pool;
+    auto ctx = pool.Acquire(EventsUploadContextPool::PlainSplicerKey, makeBondSplicer);
+    ctx->httpObjectPool = objectPool;
+    ctx->httpRequest = new SimpleHttpRequest("REQ-1");
+    ctx->httpResponse = new SimpleHttpResponse("REQ-1");
+    ctx->body.assign(4096, 0xAA);
+    ctx->httpRequest->SetBody(ctx->body);
+    ctx.reset();
+
+    EXPECT_THAT(objectPool->requests, Eq(1u));
+    EXPECT_THAT(objectPool->responses, Eq(1u));
+
+    ctx = pool.Acquire(EventsUploadContextPool::PlainSplicerKey, makeBondSplicer);
+    EXPECT_THAT(ctx->body, IsEmpty());
+    EXPECT_THAT(ctx->body.capacity(), Ge(4096u));
+    EXPECT_THAT(ctx->httpRequest, IsNull());
+    EXPECT_THAT(ctx->httpResponse, IsNull());
+    EXPECT_THAT(ctx->httpObjectPool, IsNull());
+}
+
+TEST(EventsUploadContextPoolTests, Release_AfterPoolIsGoneDeletesContext)
+{
+    auto objectPool = std::make_shared<CountingObjectPool>();
+    EventsUploadContextPtr ctx;
+    {
+        EventsUploadContextPool pool;
+        ctx = pool.Acquire(EventsUploadContextPool::PlainSplicerKey, makeBondSplicer);
+    }
+    ctx->httpObjectPool = objectPool;
+    ctx->httpRequest = new SimpleHttpRequest("REQ-1");
+    ctx.reset();
+    EXPECT_THAT(objectPool->requests, Eq(1u));
+}
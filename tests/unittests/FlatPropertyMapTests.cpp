@@ -0,0 +1,196 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "common/Common.hpp"
+#include "system/FlatPropertyMap.hpp"
+#include "EventProperties.hpp"
+
+using namespace testing;
+using namespace MAT;
+
+TEST(ArenaTests, Allocate_AlignsAndGrows)
+{
+    Arena arena(64);
+    EXPECT_THAT(arena.size(), Eq(0u));
+
+    char const* text = arena.copyString("abc", 3);
+    EXPECT_THAT(text, StrEq("abc"));
+    int64_t values[] = { 1, 2, 3 };
+    int64_t const* copy = arena.copyArray(values, 3);
+    EXPECT_THAT(reinterpret_cast<uintptr_t>(copy) % alignof(int64_t), Eq(0u));
+    EXPECT_THAT(copy[2], Eq(3));
+
+    // Larger than a block: gets a block of its own, earlier data stays put
+    std::string large(1000, 'x');
+    char const* big = arena.copyString(large.data(), large.size());
+    EXPECT_THAT(std::string(big), Eq(large));
+    EXPECT_THAT(text, StrEq("abc"));
+    EXPECT_THAT(arena.size(), Eq(4u + 3 * sizeof(int64_t) + 1001u));
+
+    Arena moved(std::move(arena));
+    EXPECT_THAT(arena.size(), Eq(0u));
+    EXPECT_THAT(text, StrEq("abc"));
+    moved.clear();
+    EXPECT_THAT(moved.size(), Eq(0u));
+}
+
+TEST(FlatPropertyMapTests, Set_KeepsEntriesSortedLikeStdMap)
+{
+    std::vector<std::string> names = { "b", "a.b", "A", "a", "ab", "Z_9", "a.a" };
+    FlatPropertyMap flat;
+    std::map<std::string, EventProperty> expected;
+    int64_t i = 0;
+    for (auto const& name : names)
+    {
+        flat.set(name, i, PiiKind_None, DataCategory_PartC);
+        expected[name] = i++;
+    }
+
+    ASSERT_THAT(flat.size(), Eq(expected.size()));
+    auto it = expected.begin();
+    for (auto const& entry : flat)
+    {
+        EXPECT_THAT(entry.GetName(), Eq(it->first));
+        EXPECT_THAT(entry.as_int64, Eq(it->second.as_int64));
+        ++it;
+    }
+    ASSERT_THAT(flat.find("ab"), NotNull());
+    EXPECT_THAT(flat.find("ab")->as_int64, Eq(4));
+    EXPECT_THAT(flat.find("abc"), IsNull());
+}
+
+TEST(FlatPropertyMapTests, ToMap_RoundTripsEveryType)
+{
+    std::vector<int64_t> longs = { 1, -2, 3 };
+    std::vector<double> doubles = { 1.5, -2.25 };
+    std::vector<GUID_t> guids = { GUID_t("00010203-0405-0607-0809-0A0B0C0D0E0F"), GUID_t("FFEEDDCC-BBAA-9988-7766-554433221100") };
+    std::vector<std::string> strings = { "one", "", "three" };
+
+    std::map<std::string, EventProperty> expected;
+    expected["string"] = EventProperty("value", PiiKind_Identity);
+    expected["int64"] = EventProperty(int64_t(-42));
+    expected["double"] = EventProperty(3.25, PiiKind_None, DataCategory_PartB);
+    expected["time"] = EventProperty(time_ticks_t(uint64_t(637000000000000000)));
+    expected["bool"] = EventProperty(true);
+    expected["guid"] = EventProperty(guids[1]);
+    expected["longs"] = EventProperty(longs);
+    expected["doubles"] = EventProperty(doubles);
+    expected["guids"] = EventProperty(guids);
+    expected["strings"] = EventProperty(strings);
+
+    FlatPropertyMap flat;
+    for (auto const& kv : expected)
+    {
+        flat.set(kv.first, kv.second);
+    }
+    std::map<std::string, EventProperty> actual;
+    flat.ToMap(actual);
+    ASSERT_THAT(actual.size(), Eq(expected.size()));
+    for (auto const& kv : expected)
+    {
+        EXPECT_THAT(actual[kv.first], Eq(kv.second)) << kv.first;
+        EXPECT_THAT(actual[kv.first].dataCategory, Eq(kv.second.dataCategory)) << kv.first;
+    }
+
+    // Copies own their payloads
+    FlatPropertyMap copy(flat);
+    flat.clear();
+    EXPECT_THAT(flat.empty(), IsTrue());
+    copy.ToMap(actual);
+    EXPECT_THAT(actual, SizeIs(expected.size()));
+    EXPECT_THAT(actual["strings"], Eq(expected["strings"]));
+}
+
+TEST(FlatPropertyMapTests, SetAndErase_GrowPastInlineCapacity)
+{
+    FlatPropertyMap flat;
+    size_t count = FlatPropertyMap::InlineCapacity * 3;
+    for (size_t i = 0; i < count; i++)
+    {
+        std::string name = "Property_" + std::to_string(count - i);
+        flat.set(name, name.data(), name.size(), PiiKind_None, DataCategory_PartC);
+    }
+    EXPECT_THAT(flat.size(), Eq(count));
+    EXPECT_THAT(flat.erase("Property_1"), Eq(1u));
+    EXPECT_THAT(flat.erase("Property_1"), Eq(0u));
+    EXPECT_THAT(flat.size(), Eq(count - 1));
+
+    FlatPropertyMap moved(std::move(flat));
+    EXPECT_THAT(flat.size(), Eq(0u));
+    ASSERT_THAT(moved.find("Property_20"), NotNull());
+    EXPECT_THAT(moved.find("Property_20")->GetString().data, StrEq("Property_20"));
+}
+
+TEST(FlatPropertyMapTests, Set_RepeatedOverwrites_ReclaimArena)
+{
+    FlatPropertyMap flat;
+    std::string value(100, 'v');
+    for (int i = 0; i < 10000; i++)
+    {
+        flat.set("Reused.Name", value.data(), value.size(), PiiKind_None, DataCategory_PartC);
+    }
+    EXPECT_THAT(flat.size(), Eq(1u));
+    EXPECT_THAT(flat.arenaSize(), Lt(4096u));
+    EXPECT_THAT(flat.find("Reused.Name")->GetString().data, StrEq(value));
+}
+
+TEST(FlatPropertyMapTests, Version_ChangesOnEveryUpdate)
+{
+    FlatPropertyMap flat;
+    uint64_t version = flat.version();
+    flat.set("a", int64_t(1), PiiKind_None, DataCategory_PartC);
+    EXPECT_THAT(flat.version(), Gt(version));
+    version = flat.version();
+    flat.erase("a");
+    EXPECT_THAT(flat.version(), Gt(version));
+    version = flat.version();
+    flat = FlatPropertyMap();
+    EXPECT_THAT(flat.version(), Gt(version));
+}
+
+TEST(FlatPropertyMapTests, EventProperties_GetPropertiesFollowsUpdates)
+{
+    EventProperties props("Contoso.Event");
+    props.SetProperty("first", "one");
+    EXPECT_THAT(props.GetProperties().at("first").to_string(), Eq("one"));
+    props.SetProperty("first", int64_t(1));
+    props.SetProperty("second", 2.5);
+    auto const& properties = props.GetProperties();
+    EXPECT_THAT(properties.at("first").as_int64, Eq(1));
+    EXPECT_THAT(properties.at("second").as_double, Eq(2.5));
+    props.erase("first");
+    EXPECT_THAT(props.GetProperties().count("first"), Eq(0u));
+    EXPECT_THAT(props.GetProperties().count("second"), Eq(1u));
+}
+
+TEST(FlatPropertyMapTests, EventProperties_HeldPropertiesSeeLaterChanges)
+{
+    EventProperties props("Contoso.Event");
+    props.SetProperty("first", "one");
+    auto const& properties = props.GetProperties();
+    ASSERT_THAT(properties.count("first"), Eq(1u));
+
+    props.SetProperty("first", int64_t(1));
+    props.SetProperty("second", 2.5);
+    EXPECT_THAT(properties.at("first").as_int64, Eq(1));
+    EXPECT_THAT(properties.at("second").as_double, Eq(2.5));
+
+    props.erase("first");
+    EXPECT_THAT(properties.count("first"), Eq(0u));
+
+    props += std::map<std::string, EventProperty> { { "third", EventProperty("three") } };
+    EXPECT_THAT(properties.at("third").to_string(), Eq("three"));
+
+    props = std::map<std::string, EventProperty> { { "fourth", EventProperty(true) } };
+    EXPECT_THAT(properties.count("third"), Eq(0u));
+    EXPECT_TRUE(properties.at("fourth").as_bool);
+
+    EventProperties other("Contoso.Other");
+    other.SetProperty("fifth", "five");
+    props = other;
+    EXPECT_THAT(properties.count("fourth"), Eq(0u));
+    EXPECT_THAT(properties.at("fifth").to_string(), Eq("five"));
+    EXPECT_THAT(&props.GetProperties(), Eq(&properties));
+}
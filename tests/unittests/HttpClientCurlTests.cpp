@@ -13,6 +13,11 @@
 #include "http/HttpClient_Curl.hpp"
 #include "config/RuntimeConfig_Default.hpp"
 
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
 using namespace testing;
 using namespace MAT;
 
@@ -106,11 +111,13 @@ TEST_F(HttpClientCurlHeaderTests, CapturesResponseHeadersAndBody)
     CurlHttpOperation operation("GET", m_url, nullptr, requestHeaders, requestBody);
 
     ASSERT_EQ(operation.Send(), 200L);
-    const auto responseHeaders = operation.GetResponseHeaders();
+    HttpHeaders responseHeaders;
+    operation.GetResponseHeaders(responseHeaders);
     const auto responseBody = operation.GetResponseBody();
 
     ASSERT_EQ(responseHeaders.count("X-MAT-Test"), 1u);
-    EXPECT_EQ(responseHeaders.at("X-MAT-Test"), "header-value");
+    EXPECT_EQ(responseHeaders.get("X-MAT-Test"), "header-value");
+    EXPECT_EQ(responseHeaders.getIgnoreCase("x-mat-test"), "header-value");
     EXPECT_EQ(std::string(responseBody.begin(), responseBody.end()), "body-value");
 }
 
@@ -298,4 +305,419 @@ TEST_F(HttpClientCurlResponseCapTests, AcceptsLargeResponseUnderCap)
     EXPECT_EQ(m_bodySize, bodySize);
 }
 
+// --- curl_multi engine ---
+
+TEST_F(HttpClientCurlTests, UsesMultiEngineByDefault)
+{
+    EXPECT_TRUE(m_client.IsMultiEngineEnabled());
+}
+
+// --- Request and response reuse ---
+
+TEST_F(HttpClientCurlTests, ObjectPool_ReusesReleasedRequestWithNewId)
+{
+    auto pool = m_client.GetObjectPool();
+    ASSERT_THAT(pool, NotNull());
+
+    IHttpRequest* first = m_client.CreateRequest();
+    const std::string firstId = first->GetId();
+    first->SetMethod("POST");
+    first->SetUrl("http://localhost/collect");
+    first->GetHeaders().set("APIKey", "tenant");
+    std::vector<uint8_t> body(4096, 0xAA);
+    first->SetBody(body);
+    EXPECT_EQ(first->GetBody().size(), 4096u);
+    first->SetLatency(EventLatency_RealTime);
+
+    // The emptied body buffer comes back for the next request
+    std::vector<uint8_t> recycled;
+    pool->ReleaseRequest(first, recycled);
+    EXPECT_TRUE(recycled.empty());
+    EXPECT_GE(recycled.capacity(), 4096u);
+
+    IHttpRequest* second = m_client.CreateRequest();
+    EXPECT_EQ(second, first);
+    EXPECT_NE(second->GetId(), firstId);
+    EXPECT_TRUE(second->GetHeaders().empty());
+    EXPECT_TRUE(second->GetBody().empty());
+    EXPECT_EQ(second->GetSizeEstimate(), std::string("GET").size());
+
+    // A fresh request for the one still in use
+    IHttpRequest* third = m_client.CreateRequest();
+    EXPECT_NE(third, second);
+    EXPECT_NE(third->GetId(), second->GetId());
+
+    // A body the caller still holds is left alone
+    std::vector<uint8_t> pending(16, 0x55);
+    pool->ReleaseRequest(second, pending);
+    EXPECT_EQ(pending.size(), 16u);
+    pool->ReleaseRequest(third, recycled);
+}
+
+TEST_F(HttpClientCurlTests, ObjectPool_OutlivesClient)
+{
+    std::shared_ptr<IHttpObjectPool> pool;
+    IHttpRequest* request = nullptr;
+    {
+        HttpClient_Curl client;
+        pool = client.GetObjectPool();
+        request = client.CreateRequest();
+    }
+    std::vector<uint8_t> body;
+    pool->ReleaseRequest(request, body);
+    pool.reset();
+}
+
+TEST(CurlHandlePoolTests, ReusesReleasedHandlesUpToLimit)
+{
+    const HttpClient_Curl client;
+    (void)client; // Initialize curl globally.
+    CurlHandlePool pool(1);
+    CURL* first = pool.Acquire();
+    CURL* second = pool.Acquire();
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+    pool.Release(first);
+    pool.Release(second); // Over the idle limit: cleaned up.
+    EXPECT_EQ(pool.GetIdleCount(), 1u);
+    EXPECT_EQ(pool.Acquire(), first);
+    EXPECT_EQ(pool.GetIdleCount(), 0u);
+    pool.Release(first);
+}
+
+class CurlMultiEngineTests : public ::testing::Test,
+                             public HttpServer::Callback
+{
+protected:
+    HttpClient_Curl m_client; // Keeps curl globally initialized
+    HttpServer m_server;
+    std::string m_url;
+    const std::map<std::string, std::string> m_headers;
+    const std::vector<uint8_t> m_body;
+    std::atomic<unsigned> m_delayMs { 0 };
+    int m_silentSocket { -1 };
+
+    std::mutex m_lock;
+    std::condition_variable m_cv;
+    std::vector<long> m_codes;
+    std::vector<bool> m_aborted;
+
+    void SetUp() override
+    {
+        const int port = m_server.addListeningPort(0);
+        std::ostringstream address;
+        address << "127.0.0.1:" << port;
+        m_url = "http://" + address.str() + "/multi/";
+        m_server.setServerName(address.str());
+        m_server.addHandler("/multi/", *this);
+        m_server.start();
+    }
+
+    void TearDown() override
+    {
+        m_server.stop();
+        if (m_silentSocket >= 0)
+        {
+            ::close(m_silentSocket);
+        }
+    }
+
+    int onHttpRequest(HttpServer::Request const&, HttpServer::Response& response) override
+    {
+        if (m_delayMs > 0)
+        {
+            PAL::sleep(m_delayMs);
+        }
+        response.content = "ok";
+        return 200;
+    }
+
+    std::shared_ptr<CurlHttpOperation> makeOperation(CurlMultiEngine& engine, std::string const& url = std::string())
+    {
+        return std::make_shared<CurlHttpOperation>("POST", url.empty() ? m_url : url, nullptr, m_headers, m_body,
+            false, HTTP_CONN_TIMEOUT, true, "", engine.GetHandlePool());
+    }
+
+    /// Listening socket that is never accepted from: the kernel completes the
+    /// TCP handshake, the request is sent, and no response ever arrives.
+    std::string silentUrl()
+    {
+        m_silentSocket = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t len = sizeof(addr);
+        if (::bind(m_silentSocket, reinterpret_cast<sockaddr*>(&addr), len) != 0 || ::listen(m_silentSocket, 8) != 0
+            || ::getsockname(m_silentSocket, reinterpret_cast<sockaddr*>(&addr), &len) != 0)
+        {
+            return std::string();
+        }
+        return "http://127.0.0.1:" + std::to_string(ntohs(addr.sin_port)) + "/silent/";
+    }
+
+    CurlMultiEngine::DoneCallback recorder()
+    {
+        return [this](std::shared_ptr<CurlHttpOperation> operation) {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_codes.push_back(operation->GetResponseCode());
+            m_aborted.push_back(operation->WasAborted());
+            m_cv.notify_all();
+        };
+    }
+
+    bool waitForResponses(size_t count, unsigned timeoutMs = 10000)
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        return m_cv.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this, count]() { return m_codes.size() >= count; });
+    }
+};
+
+TEST_F(CurlMultiEngineTests, CompletesManyRequestsOnOneThreadAndReusesHandles)
+{
+    CurlMultiEngine engine;
+    ASSERT_TRUE(engine.IsValid());
+    engine.SetMaxActiveTransfers(2);
+
+    constexpr size_t count = 20;
+    for (size_t i = 0; i < count; i++)
+    {
+        engine.Submit(makeOperation(engine), recorder());
+    }
+    ASSERT_TRUE(waitForResponses(count));
+    for (long code : m_codes)
+    {
+        EXPECT_EQ(code, 200L);
+    }
+    // Completed operations handed their easy handles back to the pool.
+    EXPECT_GE(engine.GetHandlePool()->GetIdleCount(), 1u);
+    EXPECT_EQ(engine.GetActiveCount(), 0u);
+}
+
+TEST_F(CurlMultiEngineTests, ReusesConnectionForSequentialRequests)
+{
+    CurlMultiEngine engine;
+    auto first = makeOperation(engine);
+    engine.Submit(first, recorder());
+    ASSERT_TRUE(waitForResponses(1));
+
+    long connects = -1;
+    auto second = makeOperation(engine);
+    engine.Submit(second, [&connects, this](std::shared_ptr<CurlHttpOperation> operation) {
+        curl_easy_getinfo(operation->GetHandle(), CURLINFO_NUM_CONNECTS, &connects);
+        recorder()(operation);
+    });
+    ASSERT_TRUE(waitForResponses(2));
+    EXPECT_EQ(m_codes[1], 200L);
+    EXPECT_EQ(connects, 0L);
+}
+
+TEST_F(CurlMultiEngineTests, HonorsMaxActiveTransfers)
+{
+    CurlMultiEngine engine;
+    engine.SetMaxActiveTransfers(1);
+    m_delayMs = 200;
+    for (int i = 0; i < 3; i++)
+    {
+        engine.Submit(makeOperation(engine), recorder());
+    }
+    PAL::sleep(50);
+    EXPECT_LE(engine.GetActiveCount(), 1u);
+    EXPECT_GE(engine.GetQueuedCount(), 1u);
+    ASSERT_TRUE(waitForResponses(3));
+}
+
+TEST_F(CurlMultiEngineTests, ConnectOnlyDoesNotWaitForATransferSlot)
+{
+    const std::string url = silentUrl();
+    ASSERT_FALSE(url.empty());
+    CurlMultiEngine engine;
+    engine.SetMaxActiveTransfers(1);
+    engine.Submit(makeOperation(engine, url), recorder());
+    PAL::sleep(50);
+
+    engine.SubmitConnect(makeOperation(engine), recorder());
+    ASSERT_TRUE(waitForResponses(1, 2000));
+    EXPECT_EQ(m_codes[0], static_cast<long>(CURLE_OK));
+    EXPECT_EQ(engine.GetActiveCount(), 1u);
+    engine.AbortAll();
+    ASSERT_TRUE(waitForResponses(2));
+}
+
+TEST_F(CurlMultiEngineTests, AbortCompletesRunningAndQueuedTransfers)
+{
+    const std::string url = silentUrl();
+    ASSERT_FALSE(url.empty());
+    CurlMultiEngine engine;
+    engine.SetMaxActiveTransfers(1);
+    engine.Submit(makeOperation(engine, url), recorder());
+    engine.Submit(makeOperation(engine, url), recorder());
+    PAL::sleep(100);
+
+    auto start = PAL::getMonotonicTimeMs();
+    engine.AbortAll();
+    ASSERT_TRUE(waitForResponses(2, 2000));
+    EXPECT_LT(PAL::getMonotonicTimeMs() - start, 900);
+    EXPECT_TRUE(m_aborted[0]);
+    EXPECT_TRUE(m_aborted[1]);
+    EXPECT_EQ(m_codes[0], static_cast<long>(CURLE_ABORTED_BY_CALLBACK));
+}
+
+TEST_F(CurlMultiEngineTests, DestructionCompletesOutstandingTransfers)
+{
+    const std::string url = silentUrl();
+    ASSERT_FALSE(url.empty());
+    {
+        CurlMultiEngine engine;
+        engine.Submit(makeOperation(engine, url), recorder());
+        PAL::sleep(50);
+    }
+    std::lock_guard<std::mutex> lock(m_lock);
+    ASSERT_EQ(m_codes.size(), 1u);
+    EXPECT_TRUE(m_aborted[0]);
+}
+
+class HttpClientCurlConnectionTests : public ::testing::Test,
+                                      public HttpServer::Callback,
+                                      public IHttpResponseCallback
+{
+protected:
+    HttpServer      m_server;
+    HttpClient_Curl m_client;
+    std::unique_ptr<IHttpRequest> m_request;
+    std::string     m_url;
+
+    std::mutex      m_lock;
+    std::condition_variable m_cv;
+    std::vector<std::string> m_methods;
+    unsigned        m_statusCode {0};
+
+    void SetUp() override
+    {
+        const int port = m_server.addListeningPort(0);
+        std::ostringstream address;
+        address << "127.0.0.1:" << port;
+        m_url = "http://" + address.str() + "/connection/";
+        m_server.setServerName(address.str());
+        m_server.addHandler("/connection/", *this);
+        m_server.start();
+    }
+
+    void TearDown() override
+    {
+        m_server.stop();
+        m_request.reset();
+    }
+
+    int onHttpRequest(HttpServer::Request const& request, HttpServer::Response& response) override
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_methods.push_back(request.method);
+        m_cv.notify_all();
+        response.content = "ok";
+        return 200;
+    }
+
+    void OnHttpResponse(IHttpResponse* response) override
+    {
+        std::unique_ptr<IHttpResponse> owned(response);
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_statusCode = owned->GetStatusCode();
+        m_cv.notify_all();
+    }
+
+    void applySettings(bool preconnect)
+    {
+        ILogConfiguration config;
+        config[CFG_MAP_HTTP][CFG_BOOL_HTTP_PRECONNECT] = preconnect;
+        config[CFG_MAP_HTTP][CFG_INT_HTTP_IDLE_CONNECTION_TIMEOUT] = 60;
+        m_client.ApplySettings(config);
+    }
+
+    bool waitForWarmUps(size_t count)
+    {
+        for (int i = 0; i < 100 && m_client.GetConnectionStats().warmUps < count; i++)
+        {
+            PAL::sleep(50);
+        }
+        return m_client.GetConnectionStats().warmUps >= count;
+    }
+
+    unsigned sendAndWait()
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        m_statusCode = 0;
+        m_request.reset(m_client.CreateRequest());
+        m_request->SetMethod("POST");
+        m_request->SetUrl(m_url);
+        lock.unlock();
+        m_client.SendRequestAsync(m_request.get(), this);
+        lock.lock();
+        m_cv.wait_for(lock, std::chrono::seconds(10), [this]() { return m_statusCode != 0; });
+        return m_statusCode;
+    }
+};
+
+TEST_F(HttpClientCurlConnectionTests, PrepareConnection_ConnectsWithoutSendingARequest)
+{
+    applySettings(true);
+    m_client.PrepareConnection(m_url);
+    ASSERT_TRUE(waitForWarmUps(1));
+
+    EXPECT_EQ(sendAndWait(), 200u);
+    auto stats = m_client.GetConnectionStats();
+    EXPECT_EQ(stats.warmUps, 1u);
+    EXPECT_EQ(stats.requests, 1u);
+
+    std::lock_guard<std::mutex> lock(m_lock);
+    ASSERT_EQ(m_methods.size(), 1u);
+    EXPECT_EQ(m_methods[0], "POST");
+}
+
+TEST_F(HttpClientCurlConnectionTests, PrepareConnection_CountsOnlyEstablishedConnections)
+{
+    // A port that was bound and released without listening refuses connections
+    int sock = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    ASSERT_EQ(::bind(sock, reinterpret_cast<sockaddr*>(&addr), len), 0);
+    ASSERT_EQ(::getsockname(sock, reinterpret_cast<sockaddr*>(&addr), &len), 0);
+    ::close(sock);
+
+    applySettings(true);
+    m_client.PrepareConnection("http://127.0.0.1:" + std::to_string(ntohs(addr.sin_port)) + "/refused/");
+    EXPECT_FALSE(waitForWarmUps(1));
+    EXPECT_EQ(m_client.GetConnectionStats().warmUps, 0u);
+}
+
+TEST_F(HttpClientCurlConnectionTests, PrepareConnection_SkipsOriginWithOpenConnection)
+{
+    applySettings(true);
+    EXPECT_EQ(sendAndWait(), 200u);
+    m_client.PrepareConnection(m_url);
+    m_client.PrepareConnection(m_url + "other/");
+    EXPECT_EQ(sendAndWait(), 200u);
+
+    auto stats = m_client.GetConnectionStats();
+    EXPECT_EQ(stats.warmUps, 0u);
+    EXPECT_EQ(stats.requests, 2u);
+    EXPECT_EQ(stats.newConnections, 1u);
+    EXPECT_EQ(stats.reusedConnections, 1u);
+}
+
+TEST_F(HttpClientCurlConnectionTests, PrepareConnection_DisabledByDefault)
+{
+    ILogConfiguration config;
+    m_client.ApplySettings(config);
+    m_client.PrepareConnection(m_url);
+    EXPECT_EQ(sendAndWait(), 200u);
+
+    auto stats = m_client.GetConnectionStats();
+    EXPECT_EQ(stats.warmUps, 0u);
+    EXPECT_EQ(stats.newConnections, 1u);
+    std::lock_guard<std::mutex> lock(m_lock);
+    EXPECT_EQ(m_methods.size(), 1u);
+}
+
 #endif // MATSDK_PAL_CPP11 && !_MSC_VER && HAVE_MAT_DEFAULT_HTTP_CLIENT
@@ -62,7 +62,7 @@ TEST_F(HttpClientManagerTests, HandlesRequestFlow)
     auto ctx = std::make_shared<EventsUploadContext>();
     ctx->httpRequestId = req->GetId();
     ctx->httpRequest = req;
-    ctx->recordIdsAndTenantIds["r1"] = "t1"; ctx->recordIdsAndTenantIds["r2"] = "t1";
+    ctx->addRecord("r1", "t1"); ctx->addRecord("r2", "t1");
     ctx->latency = EventLatency_Normal;
     ctx->packageIds["tenant1-token"] = 0;
 
@@ -98,7 +98,7 @@ TEST_F(HttpClientManagerTests, CancelAllRequests_TimesOutInsteadOfHanging)
     auto ctx = std::make_shared<EventsUploadContext>();
     ctx->httpRequestId = req->GetId();
     ctx->httpRequest = req;
-    ctx->recordIdsAndTenantIds["r1"] = "t1";
+    ctx->addRecord("r1", "t1");
     ctx->latency = EventLatency_Normal;
     ctx->packageIds["tenant1-token"] = 0;
 
@@ -138,7 +138,7 @@ TEST_F(HttpClientManagerTests, CancelAllRequests_UsesBoundedCancelCapability)
     auto ctx = std::make_shared<EventsUploadContext>();
     ctx->httpRequestId = req->GetId();
     ctx->httpRequest = req;
-    ctx->recordIdsAndTenantIds["r1"] = "t1";
+    ctx->addRecord("r1", "t1");
     ctx->latency = EventLatency_Normal;
     ctx->packageIds["tenant1-token"] = 0;
 
@@ -156,3 +156,34 @@ TEST_F(HttpClientManagerTests, CancelAllRequests_UsesBoundedCancelCapability)
     EXPECT_CALL(*this, resultRequestDone(ctx)).WillOnce(Return());
     callback->OnHttpResponse(new SimpleHttpResponse("bounded"));
 }
+
+TEST_F(HttpClientManagerTests, ReusesCallbackOfFinishedRequest)
+{
+    IHttpResponseCallback* callbacks[2] = {};
+    std::weak_ptr<EventsUploadContext> released;
+    for (auto& callback : callbacks)
+    {
+        SimpleHttpRequest* req = new SimpleHttpRequest("reuse");
+        auto ctx = std::make_shared<EventsUploadContext>();
+        ctx->httpRequestId = req->GetId();
+        ctx->httpRequest = req;
+        ctx->addRecord("r1", "t1");
+        ctx->latency = EventLatency_Normal;
+        ctx->packageIds["tenant1-token"] = 0;
+
+        EXPECT_CALL(httpClientMock, SendRequestAsync(ctx->httpRequest, _))
+            .WillOnce(SaveArg<1>(&callback));
+        hcm.sendRequest(ctx);
+        ASSERT_THAT(callback, NotNull());
+
+        // Matching any context, so that the expectation holds no reference
+        EXPECT_CALL(*this, resultRequestDone(_)).WillOnce(Return());
+        released = ctx;
+        ctx.reset();
+        callback->OnHttpResponse(new SimpleHttpResponse("reuse"));
+        // The idle callback does not keep the upload alive
+        EXPECT_TRUE(released.expired());
+    }
+    EXPECT_THAT(callbacks[1], Eq(callbacks[0]));
+    EXPECT_THAT(hcm.requestCount(), Eq(0u));
+}
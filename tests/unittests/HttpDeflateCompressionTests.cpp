@@ -4,6 +4,7 @@
 //
 
 #include "common/Common.hpp"
+#include "compression/CompressionCodecs.hpp"
 #include "compression/HttpDeflateCompression.hpp"
 #include "config/RuntimeConfig_Default.hpp"
 
@@ -83,6 +84,7 @@ TEST_F(HttpDeflateCompressionTests, CompressesCorrectly)
 
     EXPECT_THAT(inflated, Eq(testPayload));
     EXPECT_THAT(event->compressed, true);
+    EXPECT_THAT(event->contentEncoding, Eq("deflate"));
 }
 
 TEST_F(HttpDeflateCompressionTests, WorksMultipleTimes)
@@ -173,5 +175,99 @@ TEST_F(HttpDeflateCompressionTests, CompressesGzipCorrectly)
 
     EXPECT_THAT(inflated, Eq(testPayload));
     EXPECT_THAT(event->compressed, true);
+    EXPECT_THAT(event->contentEncoding, Eq("gzip"));
     config[CFG_MAP_HTTP]["contentEncoding"] = "deflate";
 }
+
+TEST_F(HttpDeflateCompressionTests, SkipsBodyCompressedWhilePackaging)
+{
+    config[CFG_MAP_HTTP][CFG_BOOL_HTTP_COMPRESSION] = true;
+    EventsUploadContextPtr event = std::make_shared<EventsUploadContext>();
+    event->body = testPayload;
+    event->compressed = true;
+
+    EXPECT_CALL(*this, resultSucceeded(event)).Times(1);
+    input(event);
+
+    EXPECT_THAT(event->body, Eq(testPayload));
+    EXPECT_THAT(event->compressed, true);
+}
+
+TEST_F(HttpDeflateCompressionTests, HonorsCompressionLevel)
+{
+    config[CFG_MAP_HTTP][CFG_BOOL_HTTP_COMPRESSION] = true;
+    std::vector<uint8_t> payload(4096, 7);
+
+    config[CFG_MAP_HTTP][CFG_INT_HTTP_COMPRESSION_LEVEL] = 0;
+    EventsUploadContextPtr stored = std::make_shared<EventsUploadContext>();
+    stored->body = payload;
+    EXPECT_CALL(*this, resultSucceeded(stored)).Times(1);
+    input(stored);
+
+    config[CFG_MAP_HTTP][CFG_INT_HTTP_COMPRESSION_LEVEL] = 9;
+    EventsUploadContextPtr best = std::make_shared<EventsUploadContext>();
+    best->body = payload;
+    EXPECT_CALL(*this, resultSucceeded(best)).Times(1);
+    input(best);
+
+    // Level 0 stores the data without compressing it
+    EXPECT_THAT(stored->body, SizeIs(Gt(payload.size())));
+    EXPECT_THAT(best->body, SizeIs(Lt(payload.size() / 10)));
+    for (auto const& event : { stored, best })
+    {
+        std::vector<uint8_t> inflated;
+        ZlibUtils::InflateVector(event->body, inflated, false);
+        EXPECT_THAT(inflated, Eq(payload));
+    }
+    config[CFG_MAP_HTTP][CFG_INT_HTTP_COMPRESSION_LEVEL] = -1;
+}
+
+TEST_F(HttpDeflateCompressionTests, UnavailableContentEncodingFallsBackToDeflate)
+{
+    config[CFG_MAP_HTTP][CFG_BOOL_HTTP_COMPRESSION] = true;
+    config[CFG_MAP_HTTP]["contentEncoding"] = "br";
+    HttpDeflateCompression fallbackCompression(config);
+    config[CFG_MAP_HTTP]["contentEncoding"] = "deflate";
+
+    EventsUploadContextPtr event = std::make_shared<EventsUploadContext>();
+    event->body = testPayload;
+    fallbackCompression.compress(event);
+
+    std::vector<uint8_t> inflated;
+    ZlibUtils::InflateVector(event->body, inflated, false);
+    EXPECT_THAT(inflated, Eq(testPayload));
+    EXPECT_THAT(event->compressed, true);
+    EXPECT_THAT(event->contentEncoding, Eq("deflate"));
+}
+
+#ifdef HAVE_MAT_ZSTD
+TEST_F(HttpDeflateCompressionTests, UsesZstdUntilCollectorRejectsIt)
+{
+    config[CFG_MAP_HTTP][CFG_BOOL_HTTP_COMPRESSION] = true;
+    config[CFG_MAP_HTTP]["contentEncoding"] = "zstd";
+    HttpDeflateCompression zstdCompression(config);
+    config[CFG_MAP_HTTP]["contentEncoding"] = "deflate";
+
+    EventsUploadContextPtr event = std::make_shared<EventsUploadContext>();
+    event->body = testPayload;
+    zstdCompression.compress(event);
+    EXPECT_THAT(event->compressed, true);
+    EXPECT_THAT(event->contentEncoding, Eq("zstd"));
+
+    std::vector<uint8_t> decompressed;
+    std::unique_ptr<ICompressionCodec> codec = CompressionCodecFactory::Create("zstd", 0, std::vector<uint8_t>());
+    ASSERT_TRUE(codec->Decompress(event->body, decompressed));
+    EXPECT_THAT(decompressed, Eq(testPayload));
+
+    // HTTP 415: the retried body goes out as deflate
+    zstdCompression.contentEncodingRejected(event);
+    EventsUploadContextPtr retry = std::make_shared<EventsUploadContext>();
+    retry->body = testPayload;
+    zstdCompression.compress(retry);
+
+    std::vector<uint8_t> inflated;
+    ZlibUtils::InflateVector(retry->body, inflated, false);
+    EXPECT_THAT(inflated, Eq(testPayload));
+    EXPECT_THAT(retry->contentEncoding, Eq("deflate"));
+}
+#endif
@@ -0,0 +1,186 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "common/Common.hpp"
+#include "http/HttpHeaderParser.hpp"
+
+#include <random>
+
+using namespace testing;
+using namespace MAT;
+
+namespace {
+
+    int Parse(std::string const& block, HttpHeaders& headers)
+    {
+        return HttpHeaderParser::Parse(block.data(), block.size(), headers);
+    }
+
+}
+
+TEST(HttpHeaderParserTests, ParseStatusLine_AcceptsVersionsAndRejectsGarbage)
+{
+    EXPECT_THAT(HttpHeaderParser::ParseStatusLine("HTTP/1.1 200 OK", 15), Eq(200));
+    EXPECT_THAT(HttpHeaderParser::ParseStatusLine("HTTP/1.0 503", 12), Eq(503));
+    EXPECT_THAT(HttpHeaderParser::ParseStatusLine("HTTP/2 204 ", 11), Eq(204));
+    EXPECT_THAT(HttpHeaderParser::ParseStatusLine("HTTP/1.1 20", 11), Eq(0));
+    EXPECT_THAT(HttpHeaderParser::ParseStatusLine("HTTP/1.1 2000", 13), Eq(0));
+    EXPECT_THAT(HttpHeaderParser::ParseStatusLine("HTTP/1.1 2x0 OK", 15), Eq(0));
+    EXPECT_THAT(HttpHeaderParser::ParseStatusLine("HTTP-1.1 200 OK", 15), Eq(0));
+    EXPECT_THAT(HttpHeaderParser::ParseStatusLine("HTTP/", 5), Eq(0));
+}
+
+TEST(HttpHeaderParserTests, Parse_SplitsNamesAndTrimsValues)
+{
+    HttpHeaders headers;
+    headers.add("Stale", "value");
+    int status = Parse(
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: application/json\r\n"
+        "Retry-After:120\r\n"
+        "X-Padded  :  \t padded value \t\r\n"
+        "X-Empty:\r\n"
+        "not a header line\r\n"
+        ": no name\r\n"
+        "X-Colon: a:b:c\r\n"
+        "\r\n",
+        headers);
+
+    EXPECT_THAT(status, Eq(200));
+    EXPECT_THAT(headers.size(), Eq(5u));
+    EXPECT_THAT(headers.has("Stale"), IsFalse());
+    EXPECT_THAT(headers.get("Content-Type"), Eq("application/json"));
+    EXPECT_THAT(headers.get("Retry-After"), Eq("120"));
+    EXPECT_THAT(headers.get("X-Padded"), Eq("padded value"));
+    EXPECT_THAT(headers.has("X-Empty"), IsTrue());
+    EXPECT_THAT(headers.get("X-Empty"), Eq(""));
+    EXPECT_THAT(headers.get("X-Colon"), Eq("a:b:c"));
+}
+
+TEST(HttpHeaderParserTests, Parse_BareLineFeedsAndMissingFinalNewline)
+{
+    HttpHeaders headers;
+    EXPECT_THAT(Parse("HTTP/1.1 404 Not Found\nA: 1\nB: 2", headers), Eq(404));
+    EXPECT_THAT(headers.get("A"), Eq("1"));
+    EXPECT_THAT(headers.get("B"), Eq("2"));
+
+    EXPECT_THAT(Parse("", headers), Eq(0));
+    EXPECT_THAT(headers.empty(), IsTrue());
+}
+
+TEST(HttpHeaderParserTests, Parse_InterimResponse_KeepsOnlyFinalHeaders)
+{
+    // What curl collects for a POST sent with "Expect: 100-continue"
+    HttpHeaders headers;
+    int status = Parse(
+        "HTTP/1.1 100 Continue\r\n"
+        "X-Interim: yes\r\n"
+        "\r\n"
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Length: 2\r\n"
+        "\r\n",
+        headers);
+    EXPECT_THAT(status, Eq(200));
+    EXPECT_THAT(headers.has("X-Interim"), IsFalse());
+    EXPECT_THAT(headers.get("Content-Length"), Eq("2"));
+}
+
+TEST(HttpHeaderParserTests, Parse_FoldedLines_AreJoinedToPreviousValue)
+{
+    HttpHeaders headers;
+    Parse(
+        "HTTP/1.1 200 OK\r\n"
+        "X-Folded: first\r\n"
+        "   second\r\n"
+        "\tthird  \r\n"
+        "X-Next: next\r\n"
+        "\r\n"
+        " orphan\r\n",
+        headers);
+    EXPECT_THAT(headers.get("X-Folded"), Eq("first second third"));
+    EXPECT_THAT(headers.get("X-Next"), Eq("next"));
+    EXPECT_THAT(headers.size(), Eq(2u));
+}
+
+TEST(HttpHeaderParserTests, Parse_RepeatedHeaders_KeepEveryValue)
+{
+    HttpHeaders headers;
+    Parse(
+        "HTTP/1.1 200 OK\r\n"
+        "kill-tokens: tenant-1:all\r\n"
+        "Kill-Tokens: tenant-2\r\n"
+        "kill-tokens: tenant-3\r\n"
+        "kill-duration: 300\r\n"
+        "\r\n",
+        headers);
+    std::vector<std::string> tokens;
+    EXPECT_THAT(headers.getAll("kill-tokens", tokens), Eq(3u));
+    EXPECT_THAT(tokens, UnorderedElementsAre("tenant-1:all", "tenant-2", "tenant-3"));
+    EXPECT_THAT(headers.getIgnoreCase("KILL-DURATION"), Eq("300"));
+}
+
+TEST(HttpHeaderParserTests, HttpHeaders_GetAndHasAreCaseSensitive)
+{
+    HttpHeaders headers;
+    headers.add("Retry-After", "120");
+    EXPECT_THAT(headers.get("Retry-After"), Eq("120"));
+    EXPECT_THAT(headers.get("retry-after"), Eq(""));
+    EXPECT_THAT(headers.has("Retry-After"), IsTrue());
+    EXPECT_THAT(headers.has("RETRY-AFTER"), IsFalse());
+}
+
+TEST(HttpHeaderParserTests, HttpHeaders_IgnoreCaseLookup)
+{
+    HttpHeaders headers;
+    headers.add("Retry-After", "120");
+    headers.add("retry-after", "60");
+    EXPECT_THAT(headers.getIgnoreCase("Retry-After"), Eq("120"));
+    EXPECT_THAT(headers.getIgnoreCase("retry-after"), Eq("60"));
+    EXPECT_THAT(headers.getIgnoreCase("RETRY-AFTER"), Eq("120"));
+    EXPECT_THAT(headers.getIgnoreCase("Retry_After"), Eq(""));
+    EXPECT_THAT(headers.getIgnoreCase("Retry-Afte"), Eq(""));
+    std::vector<std::string> values;
+    EXPECT_THAT(headers.getAll("RETRY-after", values), Eq(2u));
+    // '@' and '`' differ only in bit 0x20, like letters do, but are not letters
+    headers.add("X@", "at");
+    EXPECT_THAT(headers.getIgnoreCase("X`"), Eq(""));
+}
+
+TEST(HttpHeaderParserTests, Parse_RandomInput_ProducesWellFormedHeaders)
+{
+    // Mixes header-ish fragments with random bytes; fixed seed for reproducibility
+    static char const* fragments[] = { "HTTP/1.1 ", "200", " OK", "\r\n", "\n", "\r", ":", " ", "\t", "Name", "value", "HTTP/2 ", "\0", "kill-tokens" };
+    std::mt19937 random(12345);
+    HttpHeaders headers;
+    for (int round = 0; round < 5000; round++)
+    {
+        std::string block;
+        size_t pieces = random() % 64;
+        for (size_t i = 0; i < pieces; i++)
+        {
+            if (random() % 4 == 0)
+            {
+                block.push_back(static_cast<char>(random() & 0xFF));
+            }
+            else
+            {
+                char const* fragment = fragments[random() % (sizeof(fragments) / sizeof(fragments[0]))];
+                block.append(fragment, (fragment[0] == 0) ? 1 : strlen(fragment));
+            }
+        }
+
+        int status = Parse(block, headers);
+        ASSERT_THAT(status, AllOf(Ge(0), Le(999)));
+        for (auto const& header : headers)
+        {
+            ASSERT_THAT(header.first.empty(), IsFalse());
+            ASSERT_THAT(header.first.find_first_of("\n:"), Eq(std::string::npos));
+            ASSERT_THAT(header.second.find('\n'), Eq(std::string::npos));
+            ASSERT_THAT(header.first.size() + header.second.size(), Le(block.size()));
+            char first = header.first[0];
+            ASSERT_THAT(first != ' ' && first != '\t', IsTrue());
+        }
+    }
+}
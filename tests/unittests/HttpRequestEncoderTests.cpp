@@ -92,6 +92,28 @@ TEST_F(HttpRequestEncoderTests, AddsCompressionHeader)
     EXPECT_THAT(req->m_headers, Contains(Pair("Content-Encoding", "deflate")));
 }
 
+TEST_F(HttpRequestEncoderTests, CompressionHeaderFollowsCodec)
+{
+    EventsUploadContextPtr ctx = std::make_shared<EventsUploadContext>();
+    ctx->compressed = true;
+    ctx->contentEncoding = "zstd";
+    encoder.encode(ctx);
+    SimpleHttpRequest const* req = static_cast<SimpleHttpRequest*>(ctx->httpRequest);
+    EXPECT_THAT(req->m_headers, Contains(Pair("Content-Encoding", "zstd")));
+    EXPECT_THAT(req->m_headers, Not(Contains(Pair("Content-Encoding", "deflate"))));
+}
+
+TEST_F(HttpRequestEncoderTests, AddsGzipCompressionHeader)
+{
+    EventsUploadContextPtr ctx = std::make_shared<EventsUploadContext>();
+    ctx->compressed = true;
+    ctx->contentEncoding = "gzip";
+    encoder.encode(ctx);
+    SimpleHttpRequest const* req = static_cast<SimpleHttpRequest*>(ctx->httpRequest);
+    EXPECT_THAT(req->m_headers, Contains(Pair("Content-Encoding", "gzip")));
+    EXPECT_THAT(req->m_headers, Not(Contains(Pair("Content-Encoding", "deflate"))));
+}
+
 TEST_F(HttpRequestEncoderTests, BuildsApiKeyCorrectly)
 {
     EventsUploadContextPtr ctx = std::make_shared<EventsUploadContext>();
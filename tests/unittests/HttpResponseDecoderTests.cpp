@@ -20,6 +20,7 @@ class HttpResponseDecoderTests : public StrictMock<Test> {
     RouteSink<HttpResponseDecoderTests, EventsUploadContextPtr const&> temporaryNetworkFailure{this, &HttpResponseDecoderTests::resultTemporaryNetworkFailure};
     RouteSink<HttpResponseDecoderTests, EventsUploadContextPtr const&> temporaryServerFailure{this, &HttpResponseDecoderTests::resultTemporaryServerFailure};
     RouteSink<HttpResponseDecoderTests, EventsUploadContextPtr const&> requestAborted{this, &HttpResponseDecoderTests::resultRequestAborted};
+    RouteSink<HttpResponseDecoderTests, EventsUploadContextPtr const&> contentEncodingRejected{this, &HttpResponseDecoderTests::resultContentEncodingRejected};
 
   protected:
     HttpResponseDecoderTests() :
@@ -31,6 +32,7 @@ class HttpResponseDecoderTests : public StrictMock<Test> {
         decoder.temporaryNetworkFailure >> temporaryNetworkFailure;
         decoder.temporaryServerFailure  >> temporaryServerFailure;
         decoder.requestAborted          >> requestAborted;
+        decoder.contentEncodingRejected >> contentEncodingRejected;
     }
 
     MOCK_METHOD1(resultEventsAccepted,          void(EventsUploadContextPtr const &));
@@ -38,6 +40,7 @@ class HttpResponseDecoderTests : public StrictMock<Test> {
     MOCK_METHOD1(resultTemporaryNetworkFailure, void(EventsUploadContextPtr const &));
     MOCK_METHOD1(resultTemporaryServerFailure,  void(EventsUploadContextPtr const &));
     MOCK_METHOD1(resultRequestAborted,          void(EventsUploadContextPtr const &));
+    MOCK_METHOD1(resultContentEncodingRejected, void(EventsUploadContextPtr const &));
 
     std::atomic<unsigned> reqId{0};
 
@@ -72,6 +75,36 @@ TEST_F(HttpResponseDecoderTests, RejectsRejected)
     decoder.decode(ctx);
 }
 
+TEST_F(HttpResponseDecoderTests, UnsupportedContentEncodingIsRetried)
+{
+    auto ctx = createContextWith(HttpResult_OK, 415, "");
+    ctx->compressed = true;
+    ctx->contentEncoding = "zstd";
+    {
+        InSequence seq;
+        EXPECT_CALL(*this, resultContentEncodingRejected(ctx)).WillOnce(Return());
+        EXPECT_CALL(*this, resultTemporaryNetworkFailure(ctx)).WillOnce(Return());
+    }
+    decoder.decode(ctx);
+}
+
+TEST_F(HttpResponseDecoderTests, UnsupportedDeflateIsRejected)
+{
+    auto ctx = createContextWith(HttpResult_OK, 415, "");
+    ctx->compressed = true;
+    EXPECT_CALL(*this, resultEventsRejected(ctx)).WillOnce(Return());
+    decoder.decode(ctx);
+}
+
+TEST_F(HttpResponseDecoderTests, UnsupportedGzipIsRejected)
+{
+    auto ctx = createContextWith(HttpResult_OK, 415, "");
+    ctx->compressed = true;
+    ctx->contentEncoding = "gzip";
+    EXPECT_CALL(*this, resultEventsRejected(ctx)).WillOnce(Return());
+    decoder.decode(ctx);
+}
+
 TEST_F(HttpResponseDecoderTests, UnderstandsTemporaryServerFailures)
 {
     auto ctx = createContextWith(HttpResult_OK, 500, "{error:500,detail:\"Bad karma\"}");
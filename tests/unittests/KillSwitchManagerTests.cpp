@@ -285,3 +285,16 @@ TEST(KillSwitchManagerTests, handleResponse_EmptyKillToken_IsRejected)
     ASSERT_FALSE(manager.isActive());
     ASSERT_FALSE(manager.isTokenBlocked(""));
 }
+
+TEST(KillSwitchManagerTests, handleResponse_HeaderNamesInOtherCase_AreHonored)
+{
+    // HTTP header names are case-insensitive; a proxy may rewrite them.
+    KillSwitchManager manager;
+    HttpHeaders headers;
+    headers.add("Kill-Tokens", "tenant-token-1");
+    headers.add("KILL-TOKENS", "tenant-token-2");
+    headers.add("Kill-Duration", "300");
+    ASSERT_TRUE(manager.handleResponse(headers));
+    ASSERT_TRUE(manager.isTokenBlocked("tenant-token-1"));
+    ASSERT_TRUE(manager.isTokenBlocked("tenant-token-2"));
+}
@@ -4,7 +4,11 @@
 //
 #include "api/LogManagerImpl.hpp"
 #include "common/Common.hpp"
+#include <chrono>
 #include <future>
+#include <set>
+#include <thread>
+#include <vector>
 
 using namespace testing;
 using namespace MAT;
@@ -22,6 +26,7 @@ class TestLogManagerImpl : public LogManagerImpl
     }
 
     using LogManagerImpl::m_httpClient;
+    using LogManagerImpl::m_taskDispatcher;
     // using LogManagerImpl::m_ownHttpClient;
     using LogManagerImpl::InitializeModules;
     using LogManagerImpl::m_modules;
@@ -143,6 +148,160 @@ TEST(LogManagerImplTests, WaitOnResume)
     logManager.EndActivity();
 }
 
+class ThreadRecordingDecorator : public IDecoratorModule
+{
+   public:
+    bool decorate(::CsProtocol::Record& record) override
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        names.push_back(record.name);
+        threads.insert(std::this_thread::get_id());
+        return true;
+    }
+
+    std::mutex mutex;
+    std::vector<std::string> names;
+    std::set<std::thread::id> threads;
+};
+
+TEST(LogManagerImplTests, IngestionQueue_EventsProcessedOnPipelineThread)
+{
+    ILogConfiguration configuration;
+    configuration[CFG_MAP_INGESTION][CFG_BOOL_INGESTION_ENABLED] = true;
+    configuration[CFG_MAP_INGESTION][CFG_INT_INGESTION_QUEUE_SIZE] = 64;
+    auto decorator = std::make_shared<ThreadRecordingDecorator>();
+    configuration.AddModule(CFG_MODULE_DECORATOR, decorator);
+    TestLogManagerImpl logManager{configuration};
+    logManager.PauseTransmission();
+
+    auto logger = logManager.GetLogger("ingestion");
+    for (int i = 0; i < 20; i++)
+    {
+        logger->LogEvent("Ingested" + std::to_string(i));
+    }
+    logManager.Flush();
+    {
+        std::lock_guard<std::mutex> lock(decorator->mutex);
+        ASSERT_EQ(decorator->names.size(), 20u);
+        EXPECT_EQ(decorator->names.front(), "Ingested0");
+        EXPECT_EQ(decorator->names.back(), "Ingested19");
+        EXPECT_EQ(decorator->threads.count(std::this_thread::get_id()), 0u);
+    }
+    logManager.FlushAndTeardown();
+}
+
+TEST(LogManagerImplTests, TaskPool_SharedWorkerThreadByDefault)
+{
+    ILogConfiguration configuration;
+    TestLogManagerImpl logManager{configuration};
+    EXPECT_EQ(logManager.m_taskDispatcher, PAL::getDefaultTaskDispatcher());
+    logManager.FlushAndTeardown();
+}
+
+TEST(LogManagerImplTests, TaskPool_OwnPoolWhenConfigured)
+{
+    ILogConfiguration configuration;
+    configuration[CFG_MAP_TASK_POOL][CFG_INT_TASK_POOL_THREADS] = 4;
+    TestLogManagerImpl logManager{configuration};
+    ASSERT_NE(logManager.m_taskDispatcher, nullptr);
+    EXPECT_NE(logManager.m_taskDispatcher, PAL::getDefaultTaskDispatcher());
+
+    logManager.PauseTransmission();
+    auto logger = logManager.GetLogger("pool");
+    for (int i = 0; i < 20; i++)
+    {
+        logger->LogEvent("Pooled" + std::to_string(i));
+    }
+    logManager.Flush();
+    logManager.FlushAndTeardown();
+}
+
+TEST(LogManagerImplTests, IngestionQueue_DisabledByDefault)
+{
+    ILogConfiguration configuration;
+    auto decorator = std::make_shared<ThreadRecordingDecorator>();
+    configuration.AddModule(CFG_MODULE_DECORATOR, decorator);
+    TestLogManagerImpl logManager{configuration};
+    logManager.PauseTransmission();
+    logManager.GetLogger("ingestion")->LogEvent("Inline");
+    {
+        std::lock_guard<std::mutex> lock(decorator->mutex);
+        ASSERT_EQ(decorator->names.size(), 1u);
+        EXPECT_EQ(decorator->threads.count(std::this_thread::get_id()), 1u);
+    }
+    logManager.FlushAndTeardown();
+}
+
+TEST(LogManagerImplTests, GetLogger_ReturnsSameLoggerIgnoringCase)
+{
+    ILogConfiguration configuration;
+    TestLogManagerImpl logManager{configuration};
+    logManager.PauseTransmission();
+
+    auto logger = logManager.GetLogger("Token", "Source");
+    ASSERT_NE(logger, nullptr);
+    EXPECT_EQ(logManager.GetLogger("token", "source"), logger);
+    EXPECT_EQ(logManager.GetLogger("TOKEN", "SOURCE"), logger);
+    EXPECT_NE(logManager.GetLogger("token", "other"), logger);
+
+    logManager.FlushAndTeardown();
+    EXPECT_EQ(logManager.GetLogger("token", "source"), nullptr);
+}
+
+class RecordReadingListener : public DebugEventListener
+{
+   public:
+    void OnDebugEvent(DebugEvent& evt) override
+    {
+        auto record = static_cast<::CsProtocol::Record*>(evt.data);
+        names.push_back(record->name);
+        dataCount.push_back(record->data.size());
+        hasProperty.push_back(!record->data.empty() && record->data[0].properties.count("Key") != 0);
+    }
+
+    std::vector<std::string> names;
+    std::vector<size_t> dataCount;
+    std::vector<bool> hasProperty;
+};
+
+TEST(LogManagerImplTests, IngestionQueue_LogEventListenerSeesRecord)
+{
+    ILogConfiguration configuration;
+    configuration[CFG_MAP_INGESTION][CFG_BOOL_INGESTION_ENABLED] = true;
+    configuration[CFG_MAP_INGESTION][CFG_INT_INGESTION_QUEUE_SIZE] = 64;
+    auto decorator = std::make_shared<ThreadRecordingDecorator>();
+    configuration.AddModule(CFG_MODULE_DECORATOR, decorator);
+    TestLogManagerImpl logManager{configuration};
+    logManager.PauseTransmission();
+    RecordReadingListener listener;
+    logManager.AddEventListener(DebugEventType::EVT_LOG_EVENT, listener);
+
+    auto logger = logManager.GetLogger("ingestion");
+    for (int i = 0; i < 5; i++)
+    {
+        EventProperties props("Ingested" + std::to_string(i));
+        props.SetProperty("Key", "Value");
+        logger->LogEvent(props);
+    }
+    logManager.Flush();
+    logManager.RemoveEventListener(DebugEventType::EVT_LOG_EVENT, listener);
+
+    ASSERT_EQ(listener.names.size(), 5u);
+    for (size_t i = 0; i < 5; i++)
+    {
+        EXPECT_EQ(listener.names[i], "Ingested" + std::to_string(i));
+        EXPECT_EQ(listener.dataCount[i], 1u);
+        EXPECT_TRUE(listener.hasProperty[i]);
+    }
+    {
+        // The pipeline still got the full record
+        std::lock_guard<std::mutex> lock(decorator->mutex);
+        ASSERT_EQ(decorator->names.size(), 5u);
+        EXPECT_EQ(decorator->names.back(), "Ingested4");
+    }
+    logManager.FlushAndTeardown();
+}
+
 class LogManagerModuleTests : public ::testing::Test
 {
    public:
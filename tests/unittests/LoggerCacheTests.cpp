@@ -0,0 +1,132 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "common/Common.hpp"
+#include "api/LoggerCache.hpp"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace testing;
+using namespace MAT;
+
+namespace
+{
+    // Only used as an address, never dereferenced
+    ILogger* fakeLogger(size_t i)
+    {
+        return reinterpret_cast<ILogger*>(static_cast<uintptr_t>(0x1000 + i * 16));
+    }
+}
+
+TEST(LoggerCacheTests, EmptyCacheFindsNothing)
+{
+    LoggerCache cache;
+    EXPECT_EQ(cache.Find("token", "source"), nullptr);
+    EXPECT_EQ(cache.GetSize(), 0u);
+}
+
+TEST(LoggerCacheTests, FindIgnoresCase)
+{
+    LoggerCache cache;
+    auto entry = cache.Add("token", "source", fakeLogger(1));
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(entry->logger, fakeLogger(1));
+
+    EXPECT_EQ(cache.Find("token", "source"), entry);
+    EXPECT_EQ(cache.Find("TOKEN", "Source"), entry);
+    EXPECT_EQ(cache.Find("token", ""), nullptr);
+    EXPECT_EQ(cache.Find("token", "sourc"), nullptr);
+    EXPECT_EQ(cache.Find("other", "source"), nullptr);
+    EXPECT_EQ(LoggerCache::Hash("TOKEN", "Source"), LoggerCache::Hash("token", "source"));
+}
+
+TEST(LoggerCacheTests, AddReturnsExistingEntry)
+{
+    LoggerCache cache;
+    auto entry = cache.Add("token", "", fakeLogger(1));
+    EXPECT_EQ(cache.Add("token", "", fakeLogger(2)), entry);
+    EXPECT_EQ(entry->logger, fakeLogger(1));
+    EXPECT_EQ(cache.GetSize(), 1u);
+}
+
+TEST(LoggerCacheTests, GrowingKeepsAllEntries)
+{
+    LoggerCache cache;
+    std::vector<LoggerCache::Entry*> entries;
+    for (size_t i = 0; i < 1000; i++)
+    {
+        entries.push_back(cache.Add("token" + std::to_string(i), "source", fakeLogger(i)));
+    }
+    EXPECT_EQ(cache.GetSize(), 1000u);
+    for (size_t i = 0; i < 1000; i++)
+    {
+        EXPECT_EQ(cache.Find("TOKEN" + std::to_string(i), "SOURCE"), entries[i]);
+    }
+}
+
+TEST(LoggerCacheTests, ClearDropsEntries)
+{
+    LoggerCache cache;
+    cache.Add("token", "source", fakeLogger(1));
+    cache.Clear();
+    EXPECT_EQ(cache.Find("token", "source"), nullptr);
+    EXPECT_EQ(cache.GetSize(), 0u);
+
+    auto entry = cache.Add("token", "source", fakeLogger(2));
+    EXPECT_EQ(cache.Find("token", "source"), entry);
+    EXPECT_EQ(entry->logger, fakeLogger(2));
+}
+
+TEST(LoggerCacheTests, ClearKeepsDroppedEntriesUntilNextClear)
+{
+    LoggerCache cache;
+    auto dropped = cache.Add("token", "source", fakeLogger(1));
+    cache.Clear();
+    // A Find racing with the Clear may still read the entry
+    cache.Add("token", "source", fakeLogger(2));
+    EXPECT_EQ(dropped->logger, fakeLogger(1));
+    EXPECT_EQ(dropped->tenantToken, "token");
+
+    cache.Clear();
+    cache.Clear();
+    EXPECT_EQ(cache.GetSize(), 0u);
+}
+
+TEST(LoggerCacheTests, ReadersSeeEntriesWhileTableGrows)
+{
+    LoggerCache cache;
+    auto first = cache.Add("first", "", fakeLogger(0));
+
+    std::atomic<bool> done(false);
+    std::atomic<size_t> misses(0);
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; t++)
+    {
+        readers.emplace_back([&]() {
+            while (!done.load())
+            {
+                if (cache.Find("FIRST", "") != first)
+                {
+                    misses++;
+                }
+            }
+        });
+    }
+
+    // The single writer is serialized by construction here
+    for (size_t i = 1; i < 5000; i++)
+    {
+        cache.Add("token" + std::to_string(i), "", fakeLogger(i));
+    }
+    done = true;
+    for (auto& reader : readers)
+    {
+        reader.join();
+    }
+    EXPECT_EQ(misses.load(), 0u);
+    EXPECT_EQ(cache.GetSize(), 5000u);
+}
@@ -21,7 +21,7 @@ public:
     using Logger::CanEventPropertiesBeSent;
 
     bool SubmitCalled = {};
-    void submit(::CsProtocol::Record&, const EventProperties&) override
+    void submit(::CsProtocol::Record&, const EventProperties&, DebugEventType) override
     {
         SubmitCalled = true;
     }
@@ -294,6 +294,51 @@ TEST_F(MemoryStorageTests, GetAndReserveSome)
     EXPECT_EQ(totalCount - howMany, storage.GetRecordCount());
 }
 
+TEST_F(MemoryStorageTests, GetRecordsOldestFirst)
+{
+    MemoryStorage storage(testLogManager, *testConfig);
+    std::vector<StorageRecordId> stored;
+    for (int i = 0; i < 200; i++)
+    {
+        StorageRecord record{ PAL::generateUuidString(), "token", EventLatency_Normal, EventPersistence_Normal, i, { 1, 2, 3 } };
+        stored.push_back(record.id);
+        storage.StoreRecord(record);
+    }
+
+    std::vector<StorageRecordId> read;
+    storage.GetAndReserveRecords([&read](StorageRecord&& record) {
+        read.push_back(record.id);
+        return read.size() < 50;
+    }, 1000);
+    ASSERT_THAT(read.size(), Eq(50u));
+    EXPECT_THAT(storage.GetReservedCount(), Eq(49u));
+    EXPECT_THAT(std::vector<StorageRecordId>(read.begin(), read.end() - 1), ElementsAreArray(stored.begin(), stored.begin() + 49));
+
+    // Released records are older than anything queued, so they are read first again
+    HttpHeaders headers;
+    bool fromMemory = true;
+    std::vector<StorageRecordId> released(stored.begin() + 10, stored.begin() + 20);
+    storage.ReleaseRecords(released, true, headers, fromMemory);
+    std::vector<StorageRecordId> deleted(stored.begin(), stored.begin() + 10);
+    deleted.push_back(stored[100]);
+    storage.DeleteRecords(deleted, headers, fromMemory);
+    EXPECT_THAT(storage.GetReservedCount(), Eq(29u));
+    EXPECT_THAT(storage.GetRecordCount(), Eq(200u - 49 - 1 + 10));
+
+    auto records = storage.GetRecords();
+    ASSERT_THAT(records.size(), Eq(160u));
+    for (size_t i = 0; i < 10; i++)
+    {
+        EXPECT_THAT(records[i].id, Eq(stored[10 + i]));
+        EXPECT_THAT(records[i].retryCount, Eq(1));
+        EXPECT_THAT(records[i].blob, ElementsAre(1, 2, 3));
+    }
+    EXPECT_THAT(records[10].id, Eq(stored[49]));
+    EXPECT_THAT(records[61].id, Eq(stored[101]));
+    EXPECT_THAT(records.back().id, Eq(stored.back()));
+    EXPECT_THAT(storage.GetSize(), Eq(0u));
+}
+
 // This method is not implemented for RAM storage
 TEST_F(MemoryStorageTests, StoreSetting)
 {
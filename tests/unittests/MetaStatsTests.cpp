@@ -41,12 +41,12 @@ TEST_F(MetaStatsTests, GenerateStartEvent)
     stats.updateOnStorageOpened("MyStorage/Normal");
     stats.updateOnPostData(postDataLength, false);
 
-    std::map<std::string, std::string> recordIdAndTenantid;
-    recordIdAndTenantid["r"] = "t";
-    stats.updateOnPackageSentSucceeded(recordIdAndTenantid, EventLatency_Normal,        0,   333, std::vector<unsigned>{ 1333 },          false);
-    stats.updateOnPackageSentSucceeded(recordIdAndTenantid, EventLatency_Normal,     1,   444, std::vector<unsigned>{ 1444, 2444 },    false);
-    stats.updateOnPackageSentSucceeded(recordIdAndTenantid, EventLatency_RealTime,       3,  5555, std::vector<unsigned>{ 15, 255, 3555 }, false);
-    stats.updateOnPackageSentSucceeded(recordIdAndTenantid, EventLatency_Max,  0,   666, std::vector<unsigned>{ 666 },           false);
+    std::map<std::string, size_t> countOnTenant;
+    countOnTenant["t"] = 1;
+    stats.updateOnPackageSentSucceeded(countOnTenant, EventLatency_Normal,        0,   333, std::vector<unsigned>{ 1333 },          false);
+    stats.updateOnPackageSentSucceeded(countOnTenant, EventLatency_Normal,     1,   444, std::vector<unsigned>{ 1444, 2444 },    false);
+    stats.updateOnPackageSentSucceeded(countOnTenant, EventLatency_RealTime,       3,  5555, std::vector<unsigned>{ 15, 255, 3555 }, false);
+    stats.updateOnPackageSentSucceeded(countOnTenant, EventLatency_Max,  0,   666, std::vector<unsigned>{ 666 },           false);
     stats.updateOnPackageFailed(500);
     stats.updateOnPackageFailed(500);
     stats.updateOnPackageRetry(500, 2);
@@ -69,9 +69,9 @@ TEST_F(MetaStatsTests, GenerateStopEvent)
     EXPECT_CALL(runtimeConfigMock, GetMetaStatsSendIntervalSec()).WillRepeatedly(Return(0));
     EXPECT_CALL(runtimeConfigMock, GetMetaStatsTenantToken()).WillRepeatedly(Return("metastats-tenant-token"));
     stats.updateOnPostData(16, false);
-    std::map<std::string, std::string> recordIdAndTenantid;
-    recordIdAndTenantid["r"] = "t";
-    stats.updateOnPackageSentSucceeded(recordIdAndTenantid, EventLatency_RealTime, 1, 99, std::vector<unsigned>{ 100, 101, 102, 103, 104, 105, 106 }, false);
+    std::map<std::string, size_t> countOnTenant;
+    countOnTenant["t"] = 1;
+    stats.updateOnPackageSentSucceeded(countOnTenant, EventLatency_RealTime, 1, 99, std::vector<unsigned>{ 100, 101, 102, 103, 104, 105, 106 }, false);
     stats.updateOnPackageFailed(501);
     stats.updateOnPackageFailed(403);
     stats.updateOnPackageRetry(505, 2);
@@ -102,9 +102,9 @@ TEST_F(MetaStatsTests, NoNewDataOrMetastatsOnlyGenerateNoEvents)
     stats.updateOnEventIncoming("s",123, EventLatency_RealTime, true);
     stats.updateOnEventIncoming("s",123, EventLatency_Normal, true);
     stats.updateOnPostData(123, true);
-    std::map<std::string, std::string> recordIdAndTenantid;
-    recordIdAndTenantid["r"] = "t";
-    stats.updateOnPackageSentSucceeded(recordIdAndTenantid, EventLatency_RealTime, 0, 123, std::vector<unsigned>{ 1234 }, true);
+    std::map<std::string, size_t> countOnTenant;
+    countOnTenant["t"] = 1;
+    stats.updateOnPackageSentSucceeded(countOnTenant, EventLatency_RealTime, 0, 123, std::vector<unsigned>{ 1234 }, true);
     events = stats.generateStatsEvent(ACT_STATS_ROLLUP_KIND_ONGOING);
     //EXPECT_THAT(events, SizeIs(0));
     events = stats.generateStatsEvent(ACT_STATS_ROLLUP_KIND_ONGOING);
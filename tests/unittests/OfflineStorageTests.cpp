@@ -13,7 +13,7 @@ protected:
     StorageObserver         offlineStorage;
 
     RouteSink<OfflineStorageTests, IncomingEventContextPtr const&>                             storeRecordFailed{ this, &OfflineStorageTests::resultStoreRecordFailed };
-    RouteSink<OfflineStorageTests, EventsUploadContextPtr const&, StorageRecord const&, bool&> retrievedEvent{ this, &OfflineStorageTests::resultRetrievedEvent };
+    RouteSink<OfflineStorageTests, EventsUploadContextPtr const&, StorageRecord&, bool&> retrievedEvent{ this, &OfflineStorageTests::resultRetrievedEvent };
     RouteSink<OfflineStorageTests, EventsUploadContextPtr const&>                              retrievalFinished{ this, &OfflineStorageTests::resultRetrievalFinished };
     RouteSink<OfflineStorageTests, EventsUploadContextPtr const&>                              retrievalFailed{ this, &OfflineStorageTests::resultRetrievalFailed };
 
@@ -38,7 +38,7 @@ protected:
     }
 
     MOCK_METHOD1(resultStoreRecordFailed, void(IncomingEventContextPtr const &));
-    MOCK_METHOD3(resultRetrievedEvent, void(EventsUploadContextPtr const &, StorageRecord const &, bool&));
+    MOCK_METHOD3(resultRetrievedEvent, void(EventsUploadContextPtr const &, StorageRecord &, bool&));
     MOCK_METHOD1(resultRetrievalFinished, void(EventsUploadContextPtr const &));
     MOCK_METHOD1(resultRetrievalFailed, void(EventsUploadContextPtr const &));
 
@@ -133,11 +133,7 @@ TEST_F(OfflineStorageTests, DeleteRecordsIsForwarded)
     auto ctx = std::make_shared<EventsUploadContext>();
     HttpHeaders test;
     bool fromMemory = false;
-    std::vector<std::string> recordIds;
-    for (const auto& element : ctx->recordIdsAndTenantIds)
-    {
-        recordIds.push_back(element.first);
-    }
+    std::vector<std::string> recordIds = ctx->recordIds;
     ctx->fromMemory = fromMemory;
     EXPECT_CALL(offlineStorageMock, DeleteRecords(recordIds, test, fromMemory)).WillOnce(Return());
     EXPECT_THAT(offlineStorage.deleteRecords(ctx), true);
@@ -148,11 +144,7 @@ TEST_F(OfflineStorageTests, ReleaseRecordsIsForwarded)
     auto ctx = std::make_shared<EventsUploadContext>();
     HttpHeaders test;
     bool fromMemory = false;
-    std::vector<std::string> recordIds;
-    for (const auto& element : ctx->recordIdsAndTenantIds)
-    {
-        recordIds.push_back(element.first);
-    }
+    std::vector<std::string> recordIds = ctx->recordIds;
     ctx->fromMemory = fromMemory;
     EXPECT_CALL(offlineStorageMock, ReleaseRecords(recordIds, false, test, fromMemory))
         .WillOnce(Return());
@@ -17,6 +17,7 @@
 #endif
 
 #include "NullObjects.hpp"
+#include "sqlite3.h"
 
 using namespace testing;
 using namespace MAT;
@@ -581,6 +582,110 @@ TEST_F(OfflineStorageTests_SQLite, StoreThousandEventsTakesLessThanASecond)
 
 #endif  // NDEBUG
 
+TEST_F(OfflineStorageTests_SQLite, StoreRecordsStoresWholeBatch)
+{
+    initializeStorage();
+    // Not a multiple of the multi-row chunk size, so the single-row tail is exercised too.
+    std::vector<StorageRecord> records;
+    for (int i = 0; i < 1000 + 7; ++i) {
+        records.push_back({std::to_string(i), "token", EventLatency_Normal, EventPersistence_Normal, 1 + i, StorageBlob(16, static_cast<uint8_t>(i))});
+    }
+    EXPECT_THAT(offlineStorage->StoreRecords(records), records.size());
+    EXPECT_THAT(offlineStorage->GetRecordCount(EventLatency_Unspecified), records.size());
+
+    TestRecordConsumer consumer;
+    EXPECT_THAT(offlineStorage->GetAndReserveRecords(consumer, 10000, EventLatency_Normal, 2000), true);
+    ASSERT_THAT(consumer.records.size(), records.size());
+    for (size_t i = 0; i < records.size(); ++i) {
+        EXPECT_THAT(consumer.records[i].id, records[i].id);
+        EXPECT_THAT(consumer.records[i].blob, records[i].blob);
+    }
+}
+
+TEST_F(OfflineStorageTests_SQLite, StoreRecordsReportsPartialFailureOnce)
+{
+    initializeStorage();
+    std::vector<StorageRecord> records;
+    for (int i = 0; i < 40; ++i) {
+        records.push_back({std::to_string(i), "token", EventLatency_Normal, EventPersistence_Normal, 1 + i, {}});
+    }
+    records[3].id.clear();
+    records[35].timestamp = -1;
+
+    EXPECT_CALL(observerMock, OnStorageFailed("Invalid parameters")).Times(1);
+    EXPECT_THAT(offlineStorage->StoreRecords(records), 38u);
+    EXPECT_THAT(offlineStorage->GetRecordCount(EventLatency_Unspecified), 38u);
+    // The caller's batch is left untouched.
+    EXPECT_THAT(records[3].id, StrEq(""));
+    EXPECT_THAT(records[4].id, StrEq("4"));
+}
+
+TEST_F(OfflineStorageTests_SQLite, StoreRecordsEmptyBatchIsNoop)
+{
+    initializeStorage();
+    std::vector<StorageRecord> records;
+    EXPECT_THAT(offlineStorage->StoreRecords(records), 0u);
+    EXPECT_THAT(offlineStorage->GetRecordCount(EventLatency_Unspecified), 0u);
+}
+
+TEST_F(OfflineStorageTests_SQLite, StoreRecordsChecksSizeLimitOncePerBatch)
+{
+    EXPECT_CALL(configMock, GetOfflineStorageMaximumSizeBytes())
+        .WillRepeatedly(Return(100 * 1024)); // 100 KB
+    configMock[CFG_BOOL_ENABLE_DB_DROP_IF_FULL] = true;
+    initializeStorage(false);
+
+    std::vector<StorageRecord> records;
+    // 160 KB of payload: over the limit, so the oldest events are trimmed.
+    for (int i = 0; i < 20; ++i) {
+        records.push_back({std::to_string(i), "token", EventLatency_Normal, EventPersistence_Normal, 1 + i, StorageBlob(8 * 1024)});
+    }
+    EXPECT_THAT(offlineStorage->StoreRecords(records), records.size());
+
+    // The batch overshoots the limit and is trimmed once, after the commit.
+    auto remaining = offlineStorage->GetRecordCount(EventLatency_Unspecified);
+    EXPECT_THAT(remaining, Lt(records.size()));
+    EXPECT_THAT(remaining, Gt(0u));
+}
+
+// Registered as an SQLite auto extension, which runs for every new connection
+static sqlite3* s_openedDb = nullptr;
+static int captureOpenedDb(sqlite3* db, char const**, sqlite3_api_routines const*)
+{
+    s_openedDb = db;
+    return SQLITE_OK;
+}
+
+static int countCommit(void* commits)
+{
+    ++*static_cast<int*>(commits);
+    return 0;
+}
+
+TEST_F(OfflineStorageTests_SQLite, StoreRecordsCommitsBatchInOneTransaction)
+{
+    s_openedDb = nullptr;
+    sqlite3_auto_extension(reinterpret_cast<void (*)(void)>(captureOpenedDb));
+    initializeStorage();
+    sqlite3_cancel_auto_extension(reinterpret_cast<void (*)(void)>(captureOpenedDb));
+    ASSERT_THAT(s_openedDb, NotNull());
+
+    // Several executions of the multi-row insert
+    constexpr int count = 200;
+    std::vector<StorageRecord> records;
+    for (int i = 0; i < count; ++i) {
+        records.push_back({"b" + std::to_string(i), "token", EventLatency_Normal, EventPersistence_Normal, 1 + i, StorageBlob(256)});
+    }
+
+    int commits = 0;
+    sqlite3_commit_hook(s_openedDb, countCommit, &commits);
+    EXPECT_THAT(offlineStorage->StoreRecords(records), static_cast<size_t>(count));
+    sqlite3_commit_hook(s_openedDb, nullptr, nullptr);
+
+    EXPECT_THAT(commits, Eq(1));
+    EXPECT_THAT(offlineStorage->GetRecordCount(EventLatency_Normal), static_cast<size_t>(count));
+}
+
 TEST_F(OfflineStorageTests_SQLite, OnInvalidFilename)
 {
     initializeStorage();
@@ -828,6 +933,61 @@ TEST_F(OfflineStorageTests_SQLite, TrimmingAlwaysDropsAtLeastOneEvent)
     EXPECT_THAT(consumer.records[1].id, StrEq("new"));
 }
 
+TEST_F(OfflineStorageTests_SQLite, TrimmingDropsAboutAQuarterOfTheOldestEvents)
+{
+    EXPECT_CALL(configMock, GetOfflineStorageMaximumSizeBytes())
+        .WillRepeatedly(Return(1024 * 1024)); // 1 MB
+    initializeStorage(false);
+
+    constexpr int count = 4000;
+    std::vector<StorageRecord> batch;
+    batch.push_back({"critical", "token", EventLatency_Normal, EventPersistence_Critical, 1, StorageBlob(300)});
+    for (int i = 1; i < count; ++i) {
+        batch.push_back({"id" + std::to_string(i), "token", EventLatency_Normal, EventPersistence_Normal, 1 + i, StorageBlob(300)});
+    }
+    ASSERT_THAT(offlineStorage->StoreRecords(batch), static_cast<size_t>(count));
+    ASSERT_THAT(offlineStorage->GetSize(), Gt(1024u * 1024));
+
+    EXPECT_THAT(offlineStorage->ResizeDb(), true);
+    EXPECT_THAT(offlineStorage->GetSize(), Le(1024u * 1024));
+    size_t left = offlineStorage->GetRecordCount(EventLatency_Unspecified);
+    EXPECT_THAT(left, Lt(static_cast<size_t>(count)));
+    EXPECT_THAT(left, Ge(static_cast<size_t>(count) / 2));
+
+    // The critical event outlives the oldest normal ones, which go first
+    auto records = offlineStorage->GetRecords(true, EventLatency_Normal);
+    ASSERT_THAT(records.size(), left);
+    EXPECT_THAT(records[0].id, StrEq("critical"));
+    EXPECT_THAT(records[1].id, StrEq("id" + std::to_string(count - left + 1)));
+}
+
+TEST_F(OfflineStorageTests_SQLite, DeletesLeaveFreePagesForIdleReclaim)
+{
+    initializeStorage();
+    std::vector<StorageRecord> batch;
+    std::vector<StorageRecordId> ids;
+    for (int i = 0; i < 200; ++i) {
+        ids.push_back("id" + std::to_string(i));
+        batch.push_back({ids.back(), "token", EventLatency_Normal, EventPersistence_Normal, 1 + i, StorageBlob(4096)});
+    }
+    ASSERT_THAT(offlineStorage->StoreRecords(batch), 200u);
+    size_t fullSize = offlineStorage->GetSize();
+
+    // The upload completion only moves pages to the free list
+    HttpHeaders headers;
+    bool fromMemory = false;
+    offlineStorage->DeleteRecords(ids, headers, fromMemory);
+    EXPECT_THAT(offlineStorage->GetSize(), fullSize);
+
+    size_t freePages = offlineStorage->ReclaimFreePages(16);
+    EXPECT_THAT(freePages, Gt(0u));
+    EXPECT_THAT(offlineStorage->GetSize(), Lt(fullSize));
+    EXPECT_THAT(offlineStorage->ReclaimFreePages(16), freePages - 16);
+
+    EXPECT_THAT(offlineStorage->ReclaimFreePages(0), 0u);
+    EXPECT_THAT(offlineStorage->GetSize(), Lt(fullSize / 4));
+}
+
 TEST_F(OfflineStorageTests_SQLite, SqliteDbInstancesAreCounted)
 {
     OfflineStorage_SQLiteNoAutoCommit offline2(*logManager, configMock, true);
@@ -0,0 +1,380 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "mat/config.h"
+#ifdef HAVE_MAT_STORAGE
+
+#include "common/Common.hpp"
+#include "common/MockIOfflineStorageObserver.hpp"
+#include "common/MockIRuntimeConfig.hpp"
+#include "utils/Utils.hpp"
+#include "offline/OfflineStorage_Segment.hpp"
+#include <stdio.h>
+#include <fstream>
+
+#include "NullObjects.hpp"
+
+using namespace testing;
+using namespace MAT;
+using namespace PAL;
+
+char const* const TEST_SEGMENT_STORAGE_FILENAME = "OfflineStorageTests_Segment.db";
+
+struct OfflineStorageTests_Segment : public Test
+{
+    StrictMock<MockIRuntimeConfig>            configMock;
+    StrictMock<MockIOfflineStorageObserver>   observerMock;
+    ILogManager *                             logManager;
+    std::unique_ptr<OfflineStorage_Segment>   offlineStorage;
+    std::string                               storageFilename;
+
+    virtual void SetUp() override
+    {
+        static NullLogManager nullLogManager;
+        logManager = &nullLogManager;
+
+        storageFilename = MAT::GetAppLocalTempDirectory() + TEST_SEGMENT_STORAGE_FILENAME;
+        configMock["cacheFilePath"] = storageFilename;
+        removeFiles();
+    }
+
+    virtual void TearDown() override
+    {
+        if (offlineStorage)
+        {
+            offlineStorage->Shutdown();
+            offlineStorage.reset();
+        }
+        removeFiles();
+    }
+
+    void initializeStorage(unsigned maxSize = UINT_MAX, char const* opened = "Segment/Default")
+    {
+        EXPECT_CALL(configMock, GetOfflineStorageMaximumSizeBytes()).WillRepeatedly(Return(maxSize));
+        offlineStorage.reset(new OfflineStorage_Segment(*logManager, configMock));
+        EXPECT_CALL(observerMock, OnStorageOpened(StrEq(opened)))
+            .RetiresOnSaturation();
+        offlineStorage->Initialize(observerMock);
+    }
+
+    void reopenStorage(unsigned maxSize = UINT_MAX)
+    {
+        offlineStorage->Shutdown();
+        initializeStorage(maxSize);
+    }
+
+    std::string segmentFilename(unsigned seq)
+    {
+        char name[24];
+        snprintf(name, sizeof(name), ".seg.%016x", seq);
+        return storageFilename + name;
+    }
+
+    void removeFiles()
+    {
+        for (unsigned seq = 1; seq < 256; seq++)
+        {
+            ::remove(segmentFilename(seq).c_str());
+        }
+        for (char const* suffix : { ".seg", ".seg.tmp", ".seg.acks", ".seg.acks.tmp", ".seg.settings", ".seg.settings.tmp" })
+        {
+            ::remove((storageFilename + suffix).c_str());
+        }
+    }
+
+    std::vector<StorageRecord> reserveAll(EventLatency minLatency = EventLatency_Unspecified)
+    {
+        std::vector<StorageRecord> records;
+        offlineStorage->GetAndReserveRecords([&records](StorageRecord&& record) {
+            records.push_back(std::move(record));
+            return true;
+        }, 100000, minLatency);
+        return records;
+    }
+
+    static bool fileExists(std::string const& filename)
+    {
+        return std::ifstream(filename).good();
+    }
+};
+
+TEST_F(OfflineStorageTests_Segment, StoredRecordIsReturnedWithAllFields)
+{
+    initializeStorage();
+    StorageRecord record{ "guid", "token", EventLatency_Normal, EventPersistence_Critical, 7, { 5, 4, 3, 2, 1 } };
+    ASSERT_THAT(offlineStorage->StoreRecord(record), true);
+    EXPECT_THAT(fileExists(segmentFilename(1)), true);
+
+    auto records = reserveAll();
+    ASSERT_THAT(records, SizeIs(1));
+    EXPECT_THAT(records[0].id, StrEq("guid"));
+    EXPECT_THAT(records[0].tenantToken, StrEq("token"));
+    EXPECT_THAT(records[0].latency, EventLatency_Normal);
+    EXPECT_THAT(records[0].persistence, EventPersistence_Critical);
+    EXPECT_THAT(records[0].timestamp, 7);
+    EXPECT_THAT(records[0].blob, StorageBlob({ 5, 4, 3, 2, 1 }));
+    EXPECT_THAT(records[0].retryCount, 0);
+    EXPECT_THAT(reserveAll(), IsEmpty());
+}
+
+TEST_F(OfflineStorageTests_Segment, RecordsAreReturnedByLatencyPersistenceAndAge)
+{
+    initializeStorage();
+    std::vector<StorageRecord> batch {
+        { "normal-new", "token", EventLatency_Normal,   EventPersistence_Normal,   3, {} },
+        { "normal-old", "token", EventLatency_Normal,   EventPersistence_Normal,   1, {} },
+        { "critical",   "token", EventLatency_Normal,   EventPersistence_Critical, 9, {} },
+        { "realtime",   "token", EventLatency_RealTime, EventPersistence_Normal,   5, {} },
+    };
+    ASSERT_THAT(offlineStorage->StoreRecords(batch), 4u);
+    EXPECT_THAT(offlineStorage->GetRecordCount(EventLatency_Normal), 3u);
+    EXPECT_THAT(offlineStorage->GetRecordCount(EventLatency_RealTime), 1u);
+
+    auto records = reserveAll();
+    ASSERT_THAT(records, SizeIs(4));
+    EXPECT_THAT(records[0].id, StrEq("realtime"));
+    EXPECT_THAT(records[1].id, StrEq("critical"));
+    EXPECT_THAT(records[2].id, StrEq("normal-old"));
+    EXPECT_THAT(records[3].id, StrEq("normal-new"));
+}
+
+TEST_F(OfflineStorageTests_Segment, StoreRecordsReportsInvalidRecords)
+{
+    initializeStorage();
+    std::vector<StorageRecord> batch {
+        { "guid1", "token", EventLatency_Normal, EventPersistence_Normal, 1, {} },
+        { "",      "token", EventLatency_Normal, EventPersistence_Normal, 1, {} },
+    };
+    EXPECT_CALL(observerMock, OnStorageFailed(StrEq("Invalid parameters")));
+    EXPECT_THAT(offlineStorage->StoreRecords(batch), 1u);
+}
+
+TEST_F(OfflineStorageTests_Segment, StoringSameIdReplacesRecord)
+{
+    initializeStorage();
+    ASSERT_THAT(offlineStorage->StoreRecord({ "guid", "token", EventLatency_Normal, EventPersistence_Normal, 1, { 1 } }), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({ "guid", "token", EventLatency_Normal, EventPersistence_Normal, 2, { 2 } }), true);
+    EXPECT_THAT(offlineStorage->GetRecordCount(EventLatency_Unspecified), 1u);
+
+    reopenStorage();
+    auto records = reserveAll();
+    ASSERT_THAT(records, SizeIs(1));
+    EXPECT_THAT(records[0].blob, StorageBlob({ 2 }));
+}
+
+TEST_F(OfflineStorageTests_Segment, ReleaseRecordsDeletesRecordsOverMaxRetryCount)
+{
+    initializeStorage();
+    ASSERT_THAT(offlineStorage->StoreRecord({ "guid",  "token", EventLatency_RealTime, EventPersistence_Normal, 1, {11} }), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({ "guid2", "token", EventLatency_Normal,   EventPersistence_Normal, 1, {22} }), true);
+
+    int const MaxRetryCount = 2;
+    EXPECT_CALL(configMock, GetMaximumRetryCount()).WillRepeatedly(Return(MaxRetryCount));
+    HttpHeaders headers;
+    bool fromMemory = false;
+    for (int i = 0; i <= MaxRetryCount; ++i) {
+        auto records = reserveAll(EventLatency_RealTime);
+        ASSERT_THAT(records, SizeIs(1));
+        EXPECT_THAT(records[0].retryCount, i);
+        std::map<std::string, size_t> droppedRecords { { "token", 1 } };
+        EXPECT_CALL(observerMock, OnStorageRecordsDropped(droppedRecords))
+            .Times((i == MaxRetryCount) ? 1 : 0);
+        offlineStorage->ReleaseRecords({ "guid" }, true, headers, fromMemory);
+    }
+
+    auto records = reserveAll();
+    ASSERT_THAT(records, SizeIs(1));
+    EXPECT_THAT(records[0].id, StrEq("guid2"));
+}
+
+TEST_F(OfflineStorageTests_Segment, DeletesAndRetryCountsSurviveReopen)
+{
+    initializeStorage();
+    ASSERT_THAT(offlineStorage->StoreRecord({ "guid1", "token", EventLatency_Normal, EventPersistence_Normal, 1, {} }), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({ "guid2", "token", EventLatency_Normal, EventPersistence_Normal, 2, {} }), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({ "guid3", "token", EventLatency_Normal, EventPersistence_Normal, 3, {} }), true);
+
+    HttpHeaders headers;
+    bool fromMemory = false;
+    ASSERT_THAT(reserveAll(), SizeIs(3));
+    offlineStorage->DeleteRecords({ "guid1" }, headers, fromMemory);
+    offlineStorage->ReleaseRecords({ "guid2" }, false, headers, fromMemory);
+    EXPECT_CALL(configMock, GetMaximumRetryCount()).WillRepeatedly(Return(5));
+    offlineStorage->ReleaseRecords({ "guid3" }, true, headers, fromMemory);
+
+    reopenStorage();
+    auto records = reserveAll();
+    ASSERT_THAT(records, SizeIs(2));
+    EXPECT_THAT(records[0].id, StrEq("guid2"));
+    EXPECT_THAT(records[0].retryCount, 0);
+    EXPECT_THAT(records[1].id, StrEq("guid3"));
+    EXPECT_THAT(records[1].retryCount, 1);
+}
+
+TEST_F(OfflineStorageTests_Segment, LeasesDoNotSurviveReopen)
+{
+    initializeStorage();
+    ASSERT_THAT(offlineStorage->StoreRecord({ "guid", "token", EventLatency_Normal, EventPersistence_Normal, 1, {} }), true);
+    ASSERT_THAT(reserveAll(), SizeIs(1));
+
+    reopenStorage();
+    EXPECT_THAT(reserveAll(), SizeIs(1));
+}
+
+TEST_F(OfflineStorageTests_Segment, DeleteRecordsByFilter)
+{
+    initializeStorage();
+    ASSERT_THAT(offlineStorage->StoreRecord({ "guid1", "tokenA", EventLatency_Normal,   EventPersistence_Normal, 1, {} }), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({ "guid2", "tokenB", EventLatency_Normal,   EventPersistence_Normal, 2, {} }), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({ "guid3", "tokenB", EventLatency_RealTime, EventPersistence_Normal, 3, {} }), true);
+
+    // Unknown columns, bad numbers and empty filters delete nothing
+    offlineStorage->DeleteRecords({ { "bogus", "1" } });
+    offlineStorage->DeleteRecords({ { "latency", "1 OR 1=1" } });
+    offlineStorage->DeleteRecords(std::map<std::string, std::string> {});
+    EXPECT_THAT(offlineStorage->GetRecordCount(EventLatency_Unspecified), 3u);
+
+    offlineStorage->DeleteRecords({ { "tenant_token", "tokenB" }, { "latency", std::to_string(EventLatency_Normal) } });
+    auto records = reserveAll();
+    ASSERT_THAT(records, SizeIs(2));
+    EXPECT_THAT(records[0].id, StrEq("guid3"));
+    EXPECT_THAT(records[1].id, StrEq("guid1"));
+}
+
+TEST_F(OfflineStorageTests_Segment, GetRecordsReturnsLowestLatencyOutsideOfShutdown)
+{
+    initializeStorage();
+    ASSERT_THAT(offlineStorage->StoreRecord({ "normal2",  "token", EventLatency_Normal,   EventPersistence_Normal, 2, {} }), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({ "normal1",  "token", EventLatency_Normal,   EventPersistence_Normal, 1, {} }), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({ "realtime", "token", EventLatency_RealTime, EventPersistence_Normal, 3, {} }), true);
+
+    auto records = offlineStorage->GetRecords(false, EventLatency_Normal);
+    ASSERT_THAT(records, SizeIs(2));
+    EXPECT_THAT(records[0].id, StrEq("normal1"));
+    EXPECT_THAT(offlineStorage->GetRecords(true, EventLatency_Normal), SizeIs(3));
+}
+
+TEST_F(OfflineStorageTests_Segment, StoredSettingsSurviveReopen)
+{
+    initializeStorage();
+    EXPECT_THAT(offlineStorage->GetSetting("name"), StrEq(""));
+    EXPECT_THAT(offlineStorage->StoreSetting("name", "value"), true);
+    EXPECT_THAT(offlineStorage->StoreSetting("other", "x"), true);
+    EXPECT_THAT(offlineStorage->DeleteSetting("other"), true);
+
+    reopenStorage();
+    EXPECT_THAT(offlineStorage->GetSetting("name"), StrEq("value"));
+    EXPECT_THAT(offlineStorage->GetSetting("other"), StrEq(""));
+}
+
+TEST_F(OfflineStorageTests_Segment, TornTailIsSkippedOnReopen)
+{
+    initializeStorage();
+    ASSERT_THAT(offlineStorage->StoreRecord({ "guid1", "token", EventLatency_Normal, EventPersistence_Normal, 1, StorageBlob(100, 1) }), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({ "guid2", "token", EventLatency_Normal, EventPersistence_Normal, 2, StorageBlob(100, 2) }), true);
+    offlineStorage->Shutdown();
+
+    // Flip the last byte of the second record and leave half a record behind it
+    {
+        std::fstream file(segmentFilename(1), std::ios::in | std::ios::out | std::ios::binary);
+        file.seekg(-1, std::ios::end);
+        char last = static_cast<char>(file.get());
+        file.seekp(-1, std::ios::end);
+        file.put(static_cast<char>(~last));
+        file.seekp(0, std::ios::end);
+        file.write("\x40\x00\x00\x00\x01\x02", 6);
+    }
+
+    initializeStorage();
+    EXPECT_THAT(offlineStorage->GetRecordCount(EventLatency_Unspecified), 1u);
+    ASSERT_THAT(offlineStorage->StoreRecord({ "guid3", "token", EventLatency_Normal, EventPersistence_Normal, 3, {} }), true);
+    EXPECT_THAT(offlineStorage->GetSegmentCount(), 2u);
+
+    reopenStorage();
+    auto records = reserveAll();
+    ASSERT_THAT(records, SizeIs(2));
+    EXPECT_THAT(records[0].id, StrEq("guid1"));
+    EXPECT_THAT(records[0].blob, StorageBlob(100, 1));
+    EXPECT_THAT(records[1].id, StrEq("guid3"));
+}
+
+TEST_F(OfflineStorageTests_Segment, CorruptManifestStartsOverClean)
+{
+    initializeStorage();
+    ASSERT_THAT(offlineStorage->StoreRecord({ "guid", "token", EventLatency_Normal, EventPersistence_Normal, 1, {} }), true);
+    offlineStorage->Shutdown();
+    {
+        std::ofstream file(storageFilename + ".seg", std::ios::binary | std::ios::trunc);
+        file << "garbage";
+    }
+
+    EXPECT_CALL(observerMock, OnStorageFailed(_));
+    initializeStorage(UINT_MAX, "Segment/Clean");
+    EXPECT_THAT(offlineStorage->GetRecordCount(EventLatency_Unspecified), 0u);
+    EXPECT_THAT(fileExists(segmentFilename(1)), false);
+    ASSERT_THAT(offlineStorage->StoreRecord({ "guid", "token", EventLatency_Normal, EventPersistence_Normal, 1, {} }), true);
+}
+
+TEST_F(OfflineStorageTests_Segment, DeadSegmentsAreRemovedAndSparseOnesCompacted)
+{
+    // 64 KiB segments
+    initializeStorage(512 * 1024);
+    HttpHeaders headers;
+    bool fromMemory = false;
+    std::vector<StorageRecordId> ids;
+    for (int i = 0; i < 24; i++)
+    {
+        ids.push_back("guid" + std::to_string(i));
+        ASSERT_THAT(offlineStorage->StoreRecord({ ids.back(), "token", EventLatency_Normal, EventPersistence_Normal, 1 + i, StorageBlob(8 * 1024, static_cast<uint8_t>(i)) }), true);
+    }
+    EXPECT_THAT(offlineStorage->GetSegmentCount(), 4u);
+
+    // The first segment is left with a single record, the second one with none
+    std::vector<StorageRecordId> deleted(ids.begin() + 1, ids.begin() + 14);
+    offlineStorage->DeleteRecords(deleted, headers, fromMemory);
+    EXPECT_THAT(offlineStorage->GetSegmentCount(), 2u);
+    EXPECT_THAT(fileExists(segmentFilename(1)), false);
+    EXPECT_THAT(fileExists(segmentFilename(2)), false);
+    EXPECT_THAT(offlineStorage->GetSize(), Lt(12u * 8 * 1024));
+
+    reopenStorage(512 * 1024);
+    auto records = reserveAll();
+    ASSERT_THAT(records, SizeIs(11));
+    EXPECT_THAT(records[0].id, StrEq("guid0"));
+    EXPECT_THAT(records[0].blob, StorageBlob(8 * 1024, 0));
+    EXPECT_THAT(records[1].id, StrEq("guid14"));
+}
+
+TEST_F(OfflineStorageTests_Segment, ExceededStorageSizeDropsOldestEventsWithLowestPriority)
+{
+    configMock[CFG_BOOL_ENABLE_DB_DROP_IF_FULL] = true;
+    initializeStorage(100 * 1024);
+
+    ASSERT_THAT(offlineStorage->StoreRecord({ "critical", "token", EventLatency_Normal, EventPersistence_Critical, 1, StorageBlob(34 * 1024) }), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({ "old",      "token", EventLatency_Normal, EventPersistence_Normal,   2, StorageBlob(34 * 1024) }), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({ "new",      "token", EventLatency_Normal, EventPersistence_Normal,   3, StorageBlob(34 * 1024) }), true);
+
+    EXPECT_THAT(offlineStorage->GetSize(), Le(100u * 1024));
+    auto records = reserveAll();
+    ASSERT_THAT(records, SizeIs(2));
+    EXPECT_THAT(records[0].id, StrEq("critical"));
+    EXPECT_THAT(records[1].id, StrEq("new"));
+}
+
+TEST_F(OfflineStorageTests_Segment, APICallsAreHarmlessAfterStorageIsShutdown)
+{
+    initializeStorage();
+    offlineStorage->Shutdown();
+    HttpHeaders headers;
+    bool fromMemory = false;
+    EXPECT_CALL(observerMock, OnStorageOpenFailed(_));
+    EXPECT_THAT(offlineStorage->StoreRecord({ "guid", "token", EventLatency_Normal, EventPersistence_Normal, 1, {} }), false);
+    EXPECT_THAT(reserveAll(), IsEmpty());
+    offlineStorage->DeleteRecords({ "guid" }, headers, fromMemory);
+    offlineStorage->ReleaseRecords({ "guid" }, true, headers, fromMemory);
+    EXPECT_THAT(offlineStorage->StoreSetting("name", "value"), false);
+    offlineStorage.reset();
+}
+
+#endif // HAVE_MAT_STORAGE
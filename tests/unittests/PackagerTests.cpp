@@ -3,6 +3,7 @@
 #include "common/Common.hpp"
 #include "common/MockIRuntimeConfig.hpp"
 #include "utils/StringUtils.hpp"
+#include "packager/DeflateSplicer.hpp"
 #include "packager/Packager.hpp"
 #include "bond/All.hpp"
 #include "CsProtocol_types.hpp"
@@ -19,6 +20,7 @@ class PackagerTests : public StrictMock<Test> {
 
     RouteSink<PackagerTests, EventsUploadContextPtr const&> emptyPackage{this, &PackagerTests::resultEmptyPackage};
     RouteSink<PackagerTests, EventsUploadContextPtr const&> packagedEvents{this, &PackagerTests::resultPackagedEvents};
+    RouteSink<PackagerTests, EventsUploadContextPtr const&> packagingFailed{this, &PackagerTests::resultPackagingFailed};
 
   protected:
     PackagerTests()
@@ -26,12 +28,30 @@ class PackagerTests : public StrictMock<Test> {
     {
         packager.emptyPackage   >> emptyPackage;
         packager.packagedEvents >> packagedEvents;
+        packager.packagingFailed >> packagingFailed;
     }
 
     MOCK_METHOD1(resultEmptyPackage,   void(EventsUploadContextPtr const &));
     MOCK_METHOD1(resultPackagedEvents, void(EventsUploadContextPtr const &));
+    MOCK_METHOD1(resultPackagingFailed, void(EventsUploadContextPtr const &));
 };
 
+namespace {
+    class FailingSplicer : public BondSplicer
+    {
+      public:
+        std::vector<uint8_t> splice() const override
+        {
+            return {};
+        }
+
+        void spliceInto(std::vector<uint8_t>& output) const override
+        {
+            output.clear();
+        }
+    };
+}
+
 
 TEST_F(PackagerTests, EmptyInputResultsInEmptyPackage)
 {
@@ -57,13 +77,8 @@ TEST_F(PackagerTests, PackagesEventsByTenant)
     packager.finalizePackage(ctx);
 
     EXPECT_THAT(ctx->body, Not(IsEmpty()));
-    EXPECT_THAT(ctx->recordIdsAndTenantIds, SizeIs(1));
-    std::vector<std::string> recordIds;
-    for (const auto& element : ctx->recordIdsAndTenantIds)
-    {
-        recordIds.push_back(element.first);
-    }
-    EXPECT_THAT(recordIds, Contains("r1"));
+    EXPECT_THAT(ctx->recordIds, ElementsAre("r1"));
+    EXPECT_THAT(ctx->tenantTokens, ElementsAre("tenant1-token"));
     EXPECT_THAT(ctx->packageIds, SizeIs(1));
     EXPECT_THAT(ctx->packageIds, Contains(Key("tenant1-token")));
 
@@ -74,6 +89,8 @@ TEST_F(PackagerTests, PackagesEventsByTenant)
         .RetiresOnSaturation();
 
     wantMore = true;
+    // The first package took ownership of the blob.
+    record1.blob = std::vector<uint8_t>{1, 1, 1, 0};
     packager.addEventToPackage(ctx, record1, wantMore);
     StorageRecord record2("r2", "tenant2-token", EventLatency_Normal, EventPersistence_Normal, 1234567891, std::vector<uint8_t>{2, 2, 2, 0});
     packager.addEventToPackage(ctx, record2, wantMore);
@@ -83,15 +100,9 @@ TEST_F(PackagerTests, PackagesEventsByTenant)
     packager.finalizePackage(ctx);
 
     EXPECT_THAT(ctx->body, Not(IsEmpty()));
-    EXPECT_THAT(ctx->recordIdsAndTenantIds, SizeIs(2));
-
-    recordIds.clear();
-    for (const auto& element : ctx->recordIdsAndTenantIds)
-    {
-        recordIds.push_back(element.first);
-    }
-    EXPECT_THAT(recordIds, Contains("r1"));
-    EXPECT_THAT(recordIds, Contains("r2"));
+    EXPECT_THAT(ctx->recordIds, ElementsAre("r1", "r2"));
+    EXPECT_THAT(ctx->tenantTokens, ElementsAre("tenant1-token", "tenant2-token"));
+    EXPECT_THAT(ctx->recordTenants, ElementsAre(0u, 1u));
     EXPECT_THAT(ctx->packageIds, SizeIs(2));
     EXPECT_THAT(ctx->packageIds, Contains(Key("tenant1-token")));
     EXPECT_THAT(ctx->packageIds, Contains(Key("tenant2-token")));
@@ -111,6 +122,66 @@ TEST_F(PackagerTests, UsesPriorityOfTheFirstEvent)
     EXPECT_THAT(ctx->latency, EventLatency_Normal);
 }
 
+TEST_F(PackagerTests, MovesRecordBlobIntoPackage)
+{
+    auto ctx = std::make_shared<EventsUploadContext>();
+    EXPECT_CALL(runtimeConfigMock, GetMaximumUploadSizeBytes())
+        .WillOnce(Return(100000))
+        .RetiresOnSaturation();
+
+    StorageRecord record("r1", "tenant1-token", EventLatency_Normal, EventPersistence_Normal, 1234567890, std::vector<uint8_t>{1, 1, 1, 0});
+    uint8_t const* blobData = record.blob.data();
+    bool wantMore = true;
+    packager.addEventToPackage(ctx, record, wantMore);
+    EXPECT_THAT(record.blob, IsEmpty());
+    EXPECT_THAT(record.id, Eq("r1"));
+    EXPECT_THAT(ctx->recordIds, Contains("r1"));
+
+    EXPECT_CALL(*this, resultPackagedEvents(ctx))
+        .WillOnce(Return());
+    packager.finalizePackage(ctx);
+    EXPECT_THAT(ctx->body, ElementsAre(1, 1, 1, 0));
+    EXPECT_NE(ctx->body.data(), blobData);
+}
+
+#ifdef HAVE_MAT_ZLIB
+TEST_F(PackagerTests, StreamingSplicerDeliversCompressedBody)
+{
+    DeflateParameters parameters { -1 /*Z_DEFAULT_COMPRESSION*/, -15 /*raw deflate*/, 0 /*Z_DEFAULT_STRATEGY*/ };
+    auto ctx = std::make_shared<EventsUploadContext>(std::unique_ptr<ISplicer>(new DeflateSplicer(parameters)));
+    EXPECT_CALL(runtimeConfigMock, GetMaximumUploadSizeBytes())
+        .WillOnce(Return(100000))
+        .RetiresOnSaturation();
+
+    StorageRecord record("r1", "tenant1-token", EventLatency_Normal, EventPersistence_Normal, 1234567890, std::vector<uint8_t>{1, 1, 1, 0});
+    bool wantMore = true;
+    packager.addEventToPackage(ctx, record, wantMore);
+
+    EXPECT_CALL(*this, resultPackagedEvents(ctx))
+        .WillOnce(Return());
+    packager.finalizePackage(ctx);
+    EXPECT_THAT(ctx->compressed, true);
+    EXPECT_THAT(ctx->body, Not(IsEmpty()));
+}
+#endif
+
+TEST_F(PackagerTests, EmptySplicedBodyFailsPackaging)
+{
+    auto ctx = std::make_shared<EventsUploadContext>(std::unique_ptr<ISplicer>(new FailingSplicer()));
+    EXPECT_CALL(runtimeConfigMock, GetMaximumUploadSizeBytes())
+        .WillOnce(Return(100000))
+        .RetiresOnSaturation();
+
+    StorageRecord record("r1", "tenant1-token", EventLatency_Normal, EventPersistence_Normal, 1234567890, std::vector<uint8_t>{1, 1, 1, 0});
+    bool wantMore = true;
+    packager.addEventToPackage(ctx, record, wantMore);
+
+    EXPECT_CALL(*this, resultPackagingFailed(ctx))
+        .WillOnce(Return());
+    packager.finalizePackage(ctx);
+    EXPECT_THAT(ctx->compressed, false);
+}
+
 TEST_F(PackagerTests, HonorsMaximumPackageSize)
 {
     unsigned const MaxSize  = 100000;
@@ -160,6 +231,29 @@ TEST_F(PackagerTests, PackagesAtLeastOneEventEvenIfOverSizeLimit)
     EXPECT_THAT(ctx->body, SizeIs(Eq(MaxSize)));
 }
 
+TEST_F(PackagerTests, SingleLatencyPackageStopsAtNextLatency)
+{
+    auto ctx = std::make_shared<EventsUploadContext>();
+    ctx->singleLatency = true;
+    EXPECT_CALL(runtimeConfigMock, GetMaximumUploadSizeBytes())
+        .WillOnce(Return(100000))
+        .RetiresOnSaturation();
+
+    bool wantMore = true;
+    StorageRecord record1("r1", "tenant1-token", EventLatency_RealTime, EventPersistence_Normal, 1234567890, std::vector<uint8_t>{1, 1, 1, 0});
+    packager.addEventToPackage(ctx, record1, wantMore);
+    StorageRecord record2("r2", "tenant1-token", EventLatency_RealTime, EventPersistence_Normal, 1234567891, std::vector<uint8_t>{2, 2, 2, 0});
+    packager.addEventToPackage(ctx, record2, wantMore);
+    EXPECT_THAT(wantMore, true);
+
+    StorageRecord record3("r3", "tenant1-token", EventLatency_Normal, EventPersistence_Normal, 1234567892, std::vector<uint8_t>{3, 3, 3, 0});
+    packager.addEventToPackage(ctx, record3, wantMore);
+    EXPECT_THAT(wantMore, false);
+    EXPECT_THAT(record3.blob, SizeIs(4));
+    EXPECT_THAT(ctx->latency, EventLatency_RealTime);
+    EXPECT_THAT(ctx->recordIds, ElementsAre("r1", "r2"));
+}
+
 TEST_F(PackagerTests, SetsRequestBondFieldsCorrectly)
 {
     auto ctx = std::make_shared<EventsUploadContext>();
@@ -173,7 +267,7 @@ TEST_F(PackagerTests, SetsRequestBondFieldsCorrectly)
     StorageRecord record2("r2", "tenant2-token", EventLatency_Normal, EventPersistence_Normal, 1234567891, std::vector<uint8_t>{0});
     packager.addEventToPackage(ctx, record2, wantMore);
     StorageRecord record3("r3", "tenant1-token", EventLatency_Normal, EventPersistence_Normal, 1234567892, std::vector<uint8_t>{0});
-    packager.addEventToPackage(ctx, record1, wantMore);
+    packager.addEventToPackage(ctx, record3, wantMore);
 
     EXPECT_CALL(*this, resultPackagedEvents(ctx))
         .WillOnce(Return());
@@ -219,7 +313,7 @@ TEST_F(PackagerTests, ForcedTenantIsForced)
     StorageRecord record2("r2", "tenant2-token", EventLatency_Normal, EventPersistence_Normal, 1234567891, std::vector<uint8_t>{0});
     packagerF.addEventToPackage(ctx, record2, wantMore);
     StorageRecord record3("r3", "tenant1-token", EventLatency_Normal, EventPersistence_Normal, 1234567892, std::vector<uint8_t>{0});
-    packagerF.addEventToPackage(ctx, record1, wantMore);
+    packagerF.addEventToPackage(ctx, record3, wantMore);
 
     EXPECT_CALL(*this, resultPackagedEvents(ctx))
         .WillOnce(Return());
@@ -238,3 +332,20 @@ TEST_F(PackagerTests, ForcedTenantIsForced)
     ASSERT_THAT(r.TokenToDataPackagesMap["forced-tenant-token"][0].Records, SizeIs(3));
 */
 }
+
+TEST(EventsUploadContextTests, AddRecordInternsTenantTokens)
+{
+    EventsUploadContext ctx;
+    ctx.addRecord("r1", "t1");
+    ctx.addRecord("r2", "t2");
+    ctx.addRecord("r3", "t1");
+    ctx.addRecord("r4", "t2");
+    EXPECT_THAT(ctx.recordIds, ElementsAre("r1", "r2", "r3", "r4"));
+    EXPECT_THAT(ctx.tenantTokens, ElementsAre("t1", "t2"));
+    EXPECT_THAT(ctx.recordTenants, ElementsAre(0u, 1u, 0u, 1u));
+
+    auto counts = ctx.getRecordCountPerTenant();
+    EXPECT_THAT(counts, SizeIs(2));
+    EXPECT_THAT(counts["t1"], Eq(2u));
+    EXPECT_THAT(counts["t2"], Eq(2u));
+}
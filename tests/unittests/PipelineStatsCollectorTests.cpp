@@ -0,0 +1,221 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "common/Common.hpp"
+#include "stats/PipelineStatsCollector.hpp"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace testing;
+using namespace MAT;
+
+namespace
+{
+    PipelineStageStats statsOf(PipelineStatsCollector& collector, PipelineStage stage, bool reset = false)
+    {
+        PipelineStats stats;
+        collector.GetStats(stats, reset);
+        return stats.stages.at(stage);
+    }
+}
+
+TEST(PipelineStatsCollectorTests, BucketsAreMonotonicAndNarrow)
+{
+    size_t previous = 0;
+    for (uint64_t value = 0; value < (uint64_t(1) << 41); value = value + 1 + value / 7)
+    {
+        const size_t index = PipelineStatsCollector::BucketIndex(value);
+        ASSERT_LT(index, PipelineStatsCollector::BucketCount);
+        ASSERT_GE(index, previous);
+        previous = index;
+        if (value < (uint64_t(1) << PipelineStatsCollector::MaxMagnitude))
+        {
+            const uint64_t upper = PipelineStatsCollector::BucketUpperBound(index);
+            ASSERT_GE(upper, value);
+            ASSERT_LE(upper - value, value / PipelineStatsCollector::SubBucketCount);
+        }
+    }
+    EXPECT_EQ(PipelineStatsCollector::BucketIndex(UINT64_MAX), PipelineStatsCollector::BucketCount - 1);
+    EXPECT_EQ(PipelineStatsCollector::BucketUpperBound(PipelineStatsCollector::BucketCount - 1), (uint64_t(1) << PipelineStatsCollector::MaxMagnitude) - 1);
+}
+
+TEST(PipelineStatsCollectorTests, ReportsEveryStageInOrder)
+{
+    PipelineStatsCollector collector;
+    PipelineStats stats;
+    collector.GetStats(stats);
+    ASSERT_EQ(stats.stages.size(), static_cast<size_t>(PipelineStage_Max));
+    for (size_t i = 0; i < stats.stages.size(); i++)
+    {
+        EXPECT_EQ(stats.stages[i].stage, static_cast<PipelineStage>(i));
+        EXPECT_EQ(stats.stages[i].count, 0u);
+        EXPECT_TRUE(stats.stages[i].buckets.empty());
+    }
+    EXPECT_STREQ(stats.stages[PipelineStage_Serialize].name, "serialize");
+    EXPECT_STREQ(stats.stages[PipelineStage_Delivery].name, "delivery");
+}
+
+TEST(PipelineStatsCollectorTests, PercentilesFollowTheDistribution)
+{
+    PipelineStatsCollector collector;
+    for (int64_t us = 1; us <= 10000; us++)
+    {
+        collector.Record(PipelineStage_Store, us * 1000);
+    }
+
+    auto store = statsOf(collector, PipelineStage_Store);
+    EXPECT_EQ(store.count, 10000u);
+    EXPECT_EQ(store.minNs, 1000u);
+    EXPECT_EQ(store.maxNs, 10000000u);
+    EXPECT_EQ(store.meanNs, 5000500u);
+    EXPECT_NEAR(static_cast<double>(store.p50Ns), 5000000.0, 5000000.0 / 16);
+    EXPECT_NEAR(static_cast<double>(store.p90Ns), 9000000.0, 9000000.0 / 16);
+    EXPECT_NEAR(static_cast<double>(store.p99Ns), 9900000.0, 9900000.0 / 16);
+    EXPECT_LE(store.p999Ns, store.maxNs);
+
+    uint64_t total = 0;
+    for (auto const& bucket : store.buckets)
+    {
+        total += bucket.second;
+    }
+    EXPECT_EQ(total, store.count);
+    EXPECT_EQ(statsOf(collector, PipelineStage_Serialize).count, 0u);
+}
+
+TEST(PipelineStatsCollectorTests, AdvanceMeasuresStagesAndCountsActive)
+{
+    PipelineStatsCollector collector;
+    PipelineTimes times;
+    collector.Advance(times, PipelineStage_Serialize);
+    EXPECT_EQ(statsOf(collector, PipelineStage_Serialize).active, 1u);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    collector.Advance(times, PipelineStage_Store);
+    auto serialize = statsOf(collector, PipelineStage_Serialize);
+    EXPECT_EQ(serialize.count, 1u);
+    EXPECT_GE(serialize.minNs, 2000000u);
+    EXPECT_EQ(serialize.active, 0u);
+    EXPECT_EQ(serialize.maxActive, 1u);
+
+    collector.Advance(times, PipelineStage_Max);
+    EXPECT_EQ(statsOf(collector, PipelineStage_Store).count, 1u);
+    EXPECT_EQ(statsOf(collector, PipelineStage_Store).active, 0u);
+    EXPECT_EQ(times.stageStart, 0);
+}
+
+TEST(PipelineStatsCollectorTests, FirstAdvanceMeasuresLogManagerHops)
+{
+    PipelineStatsCollector collector;
+    PipelineTimes times;
+    const int64_t now = PipelineTimes::Now();
+    times.submitted = now - 3000000;
+    times.queued = now - 2000000;
+    times.dispatched = now - 1000000;
+    collector.Advance(times, PipelineStage_Serialize);
+
+    EXPECT_EQ(statsOf(collector, PipelineStage_Submit).count, 1u);
+    EXPECT_NEAR(static_cast<double>(statsOf(collector, PipelineStage_Submit).maxNs), 1000000.0, 1000000.0 / 16);
+    EXPECT_NEAR(static_cast<double>(statsOf(collector, PipelineStage_Queue).maxNs), 1000000.0, 1000000.0 / 16);
+    EXPECT_GE(statsOf(collector, PipelineStage_Dispatch).maxNs, 1000000u);
+    EXPECT_EQ(times.dispatched, 0);
+
+    // Events sent without the ingestion queue skip the queue stage
+    PipelineTimes direct;
+    direct.submitted = PipelineTimes::Now();
+    direct.dispatched = direct.submitted;
+    collector.Advance(direct, PipelineStage_Serialize);
+    EXPECT_EQ(statsOf(collector, PipelineStage_Submit).count, 2u);
+    EXPECT_EQ(statsOf(collector, PipelineStage_Queue).count, 1u);
+    EXPECT_EQ(statsOf(collector, PipelineStage_Dispatch).count, 2u);
+    EXPECT_EQ(statsOf(collector, PipelineStage_Serialize).active, 2u);
+}
+
+TEST(PipelineStatsCollectorTests, ProbesFollowUploads)
+{
+    PipelineStatsCollector collector;
+    auto ctx = std::make_shared<EventsUploadContext>();
+    ctx->recordTimestamps = { PAL::getUtcSystemTimeMs() - 1000, PAL::getUtcSystemTimeMs() - 2000 };
+
+    EXPECT_TRUE(collector.retrieving(ctx));
+    EXPECT_TRUE(collector.packaging(ctx));
+    EXPECT_TRUE(collector.encoding(ctx));
+    EXPECT_TRUE(collector.uploading(ctx));
+    EXPECT_EQ(statsOf(collector, PipelineStage_Send).active, 1u);
+    EXPECT_TRUE(collector.decoding(ctx));
+    EXPECT_TRUE(collector.delivered(ctx));
+
+    for (auto stage : { PipelineStage_Retrieve, PipelineStage_Package, PipelineStage_Encode, PipelineStage_Send, PipelineStage_Decode })
+    {
+        EXPECT_EQ(statsOf(collector, stage).count, 1u) << PipelineStatsCollector::GetStageName(stage);
+        EXPECT_EQ(statsOf(collector, stage).active, 0u) << PipelineStatsCollector::GetStageName(stage);
+    }
+    EXPECT_EQ(statsOf(collector, PipelineStage_Compress).count, 0u);
+    auto delivery = statsOf(collector, PipelineStage_Delivery);
+    EXPECT_EQ(delivery.count, 2u);
+    EXPECT_GE(delivery.minNs, 1000000000u);
+    EXPECT_GE(delivery.maxNs, 2000000000u);
+
+    // A failed upload leaves its stage without a measurement
+    auto failed = std::make_shared<EventsUploadContext>();
+    collector.retrieving(failed);
+    collector.packaging(failed);
+    collector.uploadAbandoned(failed);
+    EXPECT_EQ(statsOf(collector, PipelineStage_Retrieve).count, 2u);
+    EXPECT_EQ(statsOf(collector, PipelineStage_Package).count, 1u);
+    EXPECT_EQ(statsOf(collector, PipelineStage_Package).active, 0u);
+    EXPECT_EQ(statsOf(collector, PipelineStage_Package).maxActive, 1u);
+}
+
+TEST(PipelineStatsCollectorTests, ResetStartsNewInterval)
+{
+    PipelineStatsCollector collector;
+    collector.Record(PipelineStage_Encode, 100);
+    collector.Record(PipelineStage_Encode, 200);
+    EXPECT_EQ(statsOf(collector, PipelineStage_Encode, true).count, 2u);
+    EXPECT_EQ(statsOf(collector, PipelineStage_Encode).count, 0u);
+
+    collector.Record(PipelineStage_Encode, 50);
+    auto encode = statsOf(collector, PipelineStage_Encode);
+    EXPECT_EQ(encode.count, 1u);
+    EXPECT_EQ(encode.minNs, 50u);
+    EXPECT_EQ(encode.maxNs, 50u);
+}
+
+TEST(PipelineStatsCollectorTests, DisabledCollectorMeasuresNothing)
+{
+    PipelineStatsCollector collector(false);
+    PipelineTimes times;
+    collector.Advance(times, PipelineStage_Serialize);
+    collector.Record(PipelineStage_Store, 100);
+    EXPECT_EQ(times.stageStart, 0);
+    EXPECT_EQ(statsOf(collector, PipelineStage_Serialize).active, 0u);
+    EXPECT_EQ(statsOf(collector, PipelineStage_Store).count, 0u);
+}
+
+TEST(PipelineStatsCollectorTests, ConcurrentRecordingLosesNothing)
+{
+    PipelineStatsCollector collector;
+    const size_t threadCount = 32;
+    const size_t perThread = 20000;
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < threadCount; t++)
+    {
+        threads.emplace_back([&collector, t]() {
+            for (size_t i = 0; i < perThread; i++)
+            {
+                collector.Record(PipelineStage_Serialize, static_cast<int64_t>(t * 1000 + i % 1000));
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    auto serialize = statsOf(collector, PipelineStage_Serialize);
+    EXPECT_EQ(serialize.count, threadCount * perThread);
+    EXPECT_EQ(serialize.minNs, 0u);
+    EXPECT_EQ(serialize.maxNs, (threadCount - 1) * 1000 + 999);
+}
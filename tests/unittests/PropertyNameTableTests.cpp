@@ -0,0 +1,103 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "common/Common.hpp"
+#include "utils/PropertyNameTable.hpp"
+
+#include <thread>
+
+using namespace testing;
+using namespace MAT;
+
+TEST(PropertyNameTableTests, Intern_ReturnsStableIds)
+{
+    PropertyNameTable table;
+    EXPECT_THAT(table.Find("App.Name"), Eq(PropertyNameTable::InvalidId));
+
+    PropertyNameTable::Id appName = table.Intern("App.Name");
+    PropertyNameTable::Id appVersion = table.Intern("App.Version");
+    EXPECT_THAT(appName, Ne(PropertyNameTable::InvalidId));
+    EXPECT_THAT(appVersion, Ne(appName));
+    EXPECT_THAT(table.Intern("App.Name"), Eq(appName));
+    EXPECT_THAT(table.Find("App.Version"), Eq(appVersion));
+    EXPECT_THAT(table.GetName(appName), Eq("App.Name"));
+    EXPECT_THAT(table.size(), Eq(2u));
+}
+
+TEST(PropertyNameTableTests, Validate_CachesResult)
+{
+    PropertyNameTable table;
+    EXPECT_THAT(table.Validate("valid_name.1"), Eq(REJECTED_REASON_OK));
+    EXPECT_THAT(table.Validate(".invalid"), Eq(REJECTED_REASON_VALIDATION_FAILED));
+    EXPECT_THAT(table.Validate(std::string(101, 'a')), Eq(REJECTED_REASON_VALIDATION_FAILED));
+
+    // Rejected names are interned too, so they are not scanned again
+    PropertyNameTable::Id invalid = table.Find(".invalid");
+    ASSERT_THAT(invalid, Ne(PropertyNameTable::InvalidId));
+    EXPECT_THAT(table.GetValidation(invalid), Eq(REJECTED_REASON_VALIDATION_FAILED));
+    EXPECT_THAT(table.Validate(".invalid"), Eq(REJECTED_REASON_VALIDATION_FAILED));
+    EXPECT_THAT(table.size(), Eq(3u));
+}
+
+TEST(PropertyNameTableTests, Validate_ReturnsIdOfName)
+{
+    PropertyNameTable table;
+    PropertyNameTable::Id id = PropertyNameTable::InvalidId;
+    EXPECT_THAT(table.Validate("App.Name", id), Eq(REJECTED_REASON_OK));
+    EXPECT_THAT(id, Eq(table.Find("App.Name")));
+    EXPECT_THAT(table.Validate(".invalid", id), Eq(REJECTED_REASON_VALIDATION_FAILED));
+    EXPECT_THAT(id, Eq(table.Find(".invalid")));
+    EXPECT_THAT(id, Ne(PropertyNameTable::InvalidId));
+}
+
+TEST(PropertyNameTableTests, Intern_FullTable_FallsBackToValidation)
+{
+    PropertyNameTable table;
+    for (size_t i = 0; i < PropertyNameTable::Capacity; i++)
+    {
+        ASSERT_THAT(table.Intern("name" + std::to_string(i)), Eq(i + 1));
+    }
+    EXPECT_THAT(table.Intern("one.more"), Eq(PropertyNameTable::InvalidId));
+    EXPECT_THAT(table.Validate("one.more"), Eq(REJECTED_REASON_OK));
+    EXPECT_THAT(table.Validate("one.more."), Eq(REJECTED_REASON_VALIDATION_FAILED));
+    PropertyNameTable::Id id = 1;
+    EXPECT_THAT(table.Validate("one.more", id), Eq(REJECTED_REASON_OK));
+    EXPECT_THAT(id, Eq(PropertyNameTable::InvalidId));
+    EXPECT_THAT(table.Find("name4095"), Eq(PropertyNameTable::Capacity));
+    EXPECT_THAT(table.size(), Eq(PropertyNameTable::Capacity));
+}
+
+TEST(PropertyNameTableTests, Intern_ConcurrentThreads_AgreeOnIds)
+{
+    PropertyNameTable table;
+    constexpr size_t names = 500;
+    std::vector<std::vector<PropertyNameTable::Id>> ids(4, std::vector<PropertyNameTable::Id>(names));
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < ids.size(); t++)
+    {
+        threads.emplace_back([&table, &ids, t]() {
+            for (size_t i = 0; i < names; i++)
+            {
+                // Every thread walks the names from a different start and direction
+                size_t n = (t % 2 == 0) ? (i + t * 125) % names : names - 1 - (i + t * 125) % names;
+                ids[t][n] = table.Intern("Concurrent.Name" + std::to_string(n));
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_THAT(table.size(), Eq(names));
+    for (size_t t = 1; t < ids.size(); t++)
+    {
+        EXPECT_THAT(ids[t], Eq(ids[0]));
+    }
+    for (size_t n = 0; n < names; n++)
+    {
+        EXPECT_THAT(table.GetName(ids[0][n]), Eq("Concurrent.Name" + std::to_string(n)));
+    }
+}
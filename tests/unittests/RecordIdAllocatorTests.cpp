@@ -0,0 +1,62 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "common/Common.hpp"
+#include "utils/RecordIdAllocator.hpp"
+
+#include <set>
+#include <thread>
+
+using namespace testing;
+using namespace MAT;
+
+TEST(RecordIdAllocatorTests, Next_ReturnsShortDistinctIds)
+{
+    RecordIdAllocator allocator(0x123456789ABCull);
+    std::set<std::string> ids;
+    for (int i = 0; i < 10000; i++)
+    {
+        std::string id = allocator.Next();
+        ASSERT_THAT(id.size(), Eq(RecordIdAllocator::IdLength));
+        ASSERT_THAT(id.find_first_not_of("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"), Eq(std::string::npos)) << id;
+        ids.insert(id);
+    }
+    EXPECT_THAT(ids.size(), Eq(10000u));
+
+    // Counter in the low characters, prefix in the high ones
+    RecordIdAllocator zero(0);
+    EXPECT_THAT(zero.Next(), Eq("AAAAAAAAAAAAAAA"));
+    EXPECT_THAT(zero.Next(), Eq("AAAAAAAAAAAAAAB"));
+    RecordIdAllocator other(1);
+    EXPECT_THAT(other.Next(), Eq("AAAAAAAEAAAAAAA"));
+}
+
+TEST(RecordIdAllocatorTests, Next_ConcurrentThreads_NeverRepeat)
+{
+    RecordIdAllocator& allocator = RecordIdAllocator::GetInstance();
+    constexpr size_t perThread = 5000;
+    std::vector<std::vector<std::string>> ids(4);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < ids.size(); t++)
+    {
+        threads.emplace_back([&allocator, &ids, t]() {
+            for (size_t i = 0; i < perThread; i++)
+            {
+                ids[t].push_back(allocator.Next());
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    std::set<std::string> unique;
+    for (auto const& list : ids)
+    {
+        unique.insert(list.begin(), list.end());
+    }
+    EXPECT_THAT(unique.size(), Eq(ids.size() * perThread));
+}
@@ -0,0 +1,137 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "common/Common.hpp"
+#include "pal/TaskDispatcher.hpp"
+#include "pal/TimerQueue.hpp"
+#include "pal/WorkerThread.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace testing;
+using namespace MAT;
+
+namespace
+{
+    std::unique_ptr<Task> makeTimer(uint64_t targetTime)
+    {
+        std::unique_ptr<Task> task(new Task());
+        task->Type = Task::TimedCall;
+        task->TargetTime = targetTime;
+        return task;
+    }
+
+    std::vector<uint64_t> drain(PAL::TimerQueue& queue)
+    {
+        std::vector<uint64_t> times;
+        while (!queue.empty())
+        {
+            times.push_back(queue.pop()->TargetTime);
+        }
+        return times;
+    }
+
+    class TimerCounter
+    {
+    public:
+        void Increment()
+        {
+            m_count.fetch_add(1);
+        }
+
+        std::atomic<int> m_count { 0 };
+    };
+}
+
+TEST(TimerQueueTests, PopsInDeadlineOrder)
+{
+    std::vector<std::unique_ptr<Task>> tasks;
+    PAL::TimerQueue queue;
+    for (uint64_t time : { 50, 10, 40, 20, 30 })
+    {
+        tasks.push_back(makeTimer(time));
+        queue.push(tasks.back().get());
+    }
+    EXPECT_THAT(queue.size(), Eq(5u));
+    EXPECT_THAT(queue.topTime(), Eq(10u));
+    EXPECT_THAT(drain(queue), ElementsAre(10, 20, 30, 40, 50));
+}
+
+TEST(TimerQueueTests, EqualDeadlinesPopInInsertionOrder)
+{
+    std::vector<std::unique_ptr<Task>> tasks;
+    PAL::TimerQueue queue;
+    for (int i = 0; i < 4; i++)
+    {
+        tasks.push_back(makeTimer(100));
+        queue.push(tasks.back().get());
+    }
+    for (auto& task : tasks)
+    {
+        EXPECT_THAT(queue.pop(), Eq(task.get()));
+    }
+}
+
+TEST(TimerQueueTests, EraseRemovesTopMiddleAndLast)
+{
+    std::vector<std::unique_ptr<Task>> tasks;
+    PAL::TimerQueue queue;
+    for (uint64_t time : { 10, 20, 30, 40, 50, 60, 70 })
+    {
+        tasks.push_back(makeTimer(time));
+        queue.push(tasks.back().get());
+    }
+
+    EXPECT_TRUE(queue.erase(tasks[0].get()));
+    EXPECT_TRUE(queue.erase(tasks[3].get()));
+    EXPECT_TRUE(queue.erase(tasks[6].get()));
+    EXPECT_FALSE(queue.erase(tasks[3].get()));
+    EXPECT_FALSE(queue.contains(tasks[0].get()));
+    EXPECT_TRUE(queue.contains(tasks[1].get()));
+    EXPECT_THAT(drain(queue), ElementsAre(20, 30, 50, 60));
+}
+
+TEST(TimerQueueTests, RandomPushEraseKeepsHeapOrder)
+{
+    std::mt19937 rng(42);
+    std::vector<std::unique_ptr<Task>> tasks;
+    PAL::TimerQueue queue;
+    for (int i = 0; i < 1000; i++)
+    {
+        tasks.push_back(makeTimer(rng() % 500));
+        queue.push(tasks.back().get());
+    }
+    size_t erased = 0;
+    for (size_t i = 0; i < tasks.size(); i += 3)
+    {
+        EXPECT_TRUE(queue.erase(tasks[i].get()));
+        erased++;
+    }
+    EXPECT_THAT(queue.size(), Eq(tasks.size() - erased));
+
+    auto times = drain(queue);
+    EXPECT_THAT(times.size(), Eq(tasks.size() - erased));
+    EXPECT_TRUE(std::is_sorted(times.begin(), times.end()));
+}
+
+TEST(TimerQueueTests, WorkerThreadCancelsPendingTimer)
+{
+    auto dispatcher = PAL::WorkerThreadFactory::Create();
+    TimerCounter cancelled;
+    TimerCounter other;
+    auto handle = PAL::scheduleTask(dispatcher.get(), 100, &cancelled, &TimerCounter::Increment);
+    PAL::scheduleTask(dispatcher.get(), 150, &other, &TimerCounter::Increment);
+    EXPECT_TRUE(handle.Cancel());
+
+    for (int i = 0; i < 500 && other.m_count.load() == 0; ++i)
+        PAL::sleep(10);
+
+    EXPECT_THAT(other.m_count.load(), Eq(1));
+    EXPECT_THAT(cancelled.m_count.load(), Eq(0));
+    dispatcher->Join();
+}
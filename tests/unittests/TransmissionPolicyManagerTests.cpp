@@ -77,6 +77,7 @@ class TransmissionPolicyManagerTests : public StrictMock<Test> {
 
     RouteSink<TransmissionPolicyManagerTests, EventsUploadContextPtr const&> initiateUpload{this, &TransmissionPolicyManagerTests::resultInitiateUpload};
     RouteSink<TransmissionPolicyManagerTests>                                allUploadsFinished{this, &TransmissionPolicyManagerTests::resultAllUploadsFinished};
+    RouteSink<TransmissionPolicyManagerTests, std::string const&>            prepareConnection{this, &TransmissionPolicyManagerTests::resultPrepareConnection};
 
   protected:
     TransmissionPolicyManagerTests()
@@ -84,10 +85,12 @@ class TransmissionPolicyManagerTests : public StrictMock<Test> {
     {
         tpm.initiateUpload     >> initiateUpload;
         tpm.allUploadsFinished >> allUploadsFinished;
+        tpm.prepareConnection  >> prepareConnection;
     }
 
     MOCK_METHOD1(resultInitiateUpload, void(EventsUploadContextPtr const &));
     MOCK_METHOD0(resultAllUploadsFinished, void());
+    MOCK_METHOD1(resultPrepareConnection, void(std::string const&));
 
     virtual void SetUp() override
     {
@@ -233,6 +236,20 @@ TEST_F(TransmissionPolicyManagerTests, NoUploadForNegative)
     TransmitProfiles::reset();
 }
 
+TEST_F(TransmissionPolicyManagerTests, DelayedUploadPreparesConnection)
+{
+    tpm.paused(false);
+
+    EXPECT_CALL(*this, resultPrepareConnection(Not(IsEmpty())))
+        .WillOnce(Return());
+    tpm.scheduleUploadParent(std::chrono::milliseconds{10000}, EventLatency_Normal, false);
+    EXPECT_TRUE(tpm.uploadScheduled());
+
+    // Already scheduled, nothing new to prepare
+    tpm.scheduleUploadParent(std::chrono::milliseconds{20000}, EventLatency_Normal, false);
+    EXPECT_TRUE(tpm.cancelUploadTask());
+}
+
 TEST_F(TransmissionPolicyManagerTests, ImmediateIncomingEventStartsUploadImmediately)
 {
     tpm.paused(false);
@@ -295,6 +312,107 @@ TEST_F(TransmissionPolicyManagerTests, UploadInitiatesUpload)
     EXPECT_THAT(tpm.activeUploads(), Contains(upload));
 }
 
+namespace {
+    class PipelinedUploads
+    {
+      public:
+        explicit PipelinedUploads(int64_t window)
+        {
+            testing::getSystem().getConfig()[CFG_MAP_TPM][CFG_INT_TPM_MAX_PIPELINED_UPLOADS] = window;
+        }
+
+        ~PipelinedUploads()
+        {
+            testing::getSystem().getConfig()[CFG_MAP_TPM][CFG_INT_TPM_MAX_PIPELINED_UPLOADS] = int64_t { 1 };
+        }
+    };
+}
+
+TEST_F(TransmissionPolicyManagerTests, PipelinedUploadPreparesPackagesWhilePreviousAreInFlight)
+{
+    PipelinedUploads pipelined(3);
+    tpm.uploadScheduled(true);
+    tpm.paused(false);
+
+    std::vector<EventsUploadContextPtr> uploads;
+    EXPECT_CALL(*this, resultInitiateUpload(_))
+        .Times(3)
+        .WillRepeatedly(Invoke([&uploads](EventsUploadContextPtr const& ctx) { uploads.push_back(ctx); }));
+    tpm.uploadAsync(EventLatency_Normal);
+
+    ASSERT_THAT(uploads, SizeIs(3));
+    EXPECT_THAT(tpm.activeUploads(), SizeIs(3));
+    for (auto const& ctx : uploads)
+    {
+        EXPECT_THAT(ctx->singleLatency, true);
+    }
+    EXPECT_THAT(uploads[0]->pipelined, false);
+    EXPECT_THAT(uploads[0]->requestedMinLatency, EventLatency_Normal);
+    EXPECT_THAT(uploads[1]->pipelined, true);
+    EXPECT_THAT(uploads[1]->requestedMinLatency, EventLatency_Normal);
+    // Normal data never takes the last slot
+    EXPECT_THAT(uploads[2]->pipelined, true);
+    EXPECT_THAT(uploads[2]->requestedMinLatency, EventLatency_RealTime);
+}
+
+TEST_F(TransmissionPolicyManagerTests, PipelinedUploadIsCappedByMaxPendingRequests)
+{
+    PipelinedUploads pipelined(100);
+    tpm.uploadScheduled(true);
+    tpm.paused(false);
+
+    EXPECT_CALL(*this, resultInitiateUpload(_))
+        .Times(4);
+    tpm.uploadAsync(EventLatency_Normal);
+    EXPECT_THAT(tpm.activeUploads(), SizeIs(4));
+}
+
+TEST_F(TransmissionPolicyManagerTests, PipelinedUploadStopsWhenNothingIsLeft)
+{
+    PipelinedUploads pipelined(4);
+    tpm.uploadScheduled(true);
+    tpm.paused(false);
+
+    EventsUploadContextPtr first;
+    EXPECT_CALL(*this, resultInitiateUpload(_))
+        .WillOnce(SaveArg<0>(&first))
+        .WillOnce(Invoke([this](EventsUploadContextPtr const& ctx) { tpm.nothingToUpload(ctx); }));
+    // The upload still in flight reschedules when it is done
+    EXPECT_CALL(tpm, scheduleUpload(_, _, _))
+        .Times(0);
+    tpm.uploadAsync(EventLatency_RealTime);
+
+    EXPECT_THAT(tpm.activeUploads(), ElementsAre(first));
+}
+
+TEST_F(TransmissionPolicyManagerTests, UploadControllerSizesPackagesAndDelaysAfterThrottling)
+{
+    auto& config = testing::getSystem().getConfig();
+    config[CFG_MAP_TPM][CFG_STR_TPM_UPLOAD_CONTROLLER] = "A,65536,2000";
+    tpm.uploadScheduled(true);
+    tpm.paused(false);
+
+    EventsUploadContextPtr upload;
+    EXPECT_CALL(*this, resultInitiateUpload(_))
+        .WillOnce(SaveArg<0>(&upload));
+    tpm.uploadAsync(EventLatency_Normal);
+    ASSERT_THAT(upload, NotNull());
+    EXPECT_THAT(upload->maxUploadSize, Eq(config.GetMaximumUploadSizeBytes() / 2));
+
+    // 429 with Retry-After: 10 seconds beat the backoff
+    auto response = new SimpleHttpResponse("throttled");
+    response->m_result = HttpResult_OK;
+    response->m_statusCode = 429;
+    response->m_headers.add("Retry-After", "10");
+    upload->httpResponse = response;
+    upload->durationMs = 100;
+    EXPECT_CALL(tpm, scheduleUpload(std::chrono::milliseconds{ 10000 }, _, false))
+        .WillOnce(Return());
+    tpm.eventsUploadFailed(upload);
+
+    config[CFG_MAP_TPM][CFG_STR_TPM_UPLOAD_CONTROLLER] = "";
+}
+
 TEST_F(TransmissionPolicyManagerTests, EmptyUploadCeasesUploadingForRunningLatencyNormal)
 {
     auto upload = tpm.fakeActiveUpload(EventLatency_Normal);
@@ -0,0 +1,329 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "common/Common.hpp"
+#include "pal/TaskDispatcher.hpp"
+#include "pal/WorkStealingTaskDispatcher.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace testing;
+using namespace MAT;
+
+namespace
+{
+    /// Stands in for a pipeline component: tasks bound to one instance share
+    /// a strand and must never overlap.
+    class OrderedComponent
+    {
+       public:
+        void Record(int value)
+        {
+            if (m_inside.exchange(true))
+            {
+                m_overlapped = true;
+            }
+            m_values.push_back(value);
+            std::this_thread::yield();
+            m_inside = false;
+            m_done++;
+        }
+
+        std::vector<int> m_values;
+        std::atomic<bool> m_inside { false };
+        std::atomic<bool> m_overlapped { false };
+        std::atomic<int> m_done { 0 };
+    };
+
+    /// Two instances rendezvous: each task waits for the other to start.
+    class Rendezvous
+    {
+       public:
+        Rendezvous(std::mutex& mutex, std::condition_variable& cv, int& arrived) :
+            m_mutex(mutex), m_cv(cv), m_arrived(arrived)
+        {
+        }
+
+        void Meet(std::atomic<bool>* met)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_arrived++;
+            m_cv.notify_all();
+            *met = m_cv.wait_for(lock, std::chrono::seconds(5), [this]() { return m_arrived >= 2; });
+        }
+
+       private:
+        std::mutex& m_mutex;
+        std::condition_variable& m_cv;
+        int& m_arrived;
+    };
+
+    class Counter
+    {
+       public:
+        void Increment()
+        {
+            m_count.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void Sleep(unsigned ms)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+            m_count.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void Throw()
+        {
+            throw std::runtime_error("task failure");
+        }
+
+        std::atomic<int> m_count { 0 };
+    };
+
+    /// Counts its deletions, whether it ran or was dropped.
+    class CountedTask : public Task
+    {
+       public:
+        CountedTask(std::atomic<int>& ran, std::atomic<int>& deleted) :
+            m_ran(ran), m_deleted(deleted)
+        {
+            Type = Task::Call;
+        }
+
+        ~CountedTask() noexcept override
+        {
+            m_deleted++;
+        }
+
+        void operator()() override
+        {
+            m_ran++;
+        }
+
+       private:
+        std::atomic<int>& m_ran;
+        std::atomic<int>& m_deleted;
+    };
+
+    /// Joins the pool from one of its own tasks, with work left on its own
+    /// strand and on another one.
+    class Joiner
+    {
+       public:
+        explicit Joiner(ITaskDispatcher& dispatcher) :
+            m_dispatcher(dispatcher)
+        {
+        }
+
+        void Join(Counter* other)
+        {
+            PAL::dispatchTask(&m_dispatcher, this, &Joiner::Record);
+            PAL::dispatchTask(&m_dispatcher, other, &Counter::Increment);
+            m_dispatcher.Join();
+            m_joined = true;
+        }
+
+        void Record()
+        {
+            m_afterJoin++;
+        }
+
+        ITaskDispatcher& m_dispatcher;
+        std::atomic<bool> m_joined { false };
+        std::atomic<int> m_afterJoin { 0 };
+    };
+
+    bool waitFor(std::function<bool()> const& condition, unsigned timeoutMs = 5000)
+    {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        while (!condition())
+        {
+            if (std::chrono::steady_clock::now() > deadline)
+            {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+}
+
+TEST(WorkStealingTaskDispatcherTests, RunsEveryTaskFromManyProducers)
+{
+    auto dispatcher = PAL::WorkStealingTaskDispatcherFactory::Create(4);
+    constexpr int producers = 4;
+    constexpr int perProducer = 2500;
+    std::vector<Counter> counters(producers);
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++)
+    {
+        threads.emplace_back([&dispatcher, &counters, p]() {
+            for (int i = 0; i < perProducer; i++)
+            {
+                PAL::dispatchTask(dispatcher.get(), &counters[p], &Counter::Increment);
+            }
+        });
+    }
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+    dispatcher->Join();
+
+    for (auto& counter : counters)
+    {
+        EXPECT_EQ(counter.m_count.load(), perProducer);
+    }
+}
+
+TEST(WorkStealingTaskDispatcherTests, TasksWithSameComponentRunInOrder)
+{
+    auto dispatcher = PAL::WorkStealingTaskDispatcherFactory::Create(4);
+    constexpr int components = 8;
+    constexpr int perComponent = 500;
+    std::vector<OrderedComponent> ordered(components);
+    for (int i = 0; i < perComponent; i++)
+    {
+        for (auto& component : ordered)
+        {
+            PAL::dispatchTask(dispatcher.get(), &component, &OrderedComponent::Record, i);
+        }
+    }
+    dispatcher->Join();
+
+    for (auto& component : ordered)
+    {
+        EXPECT_FALSE(component.m_overlapped.load());
+        ASSERT_EQ(component.m_values.size(), static_cast<size_t>(perComponent));
+        for (int i = 0; i < perComponent; i++)
+        {
+            EXPECT_EQ(component.m_values[i], i);
+        }
+    }
+}
+
+TEST(WorkStealingTaskDispatcherTests, TasksOfDifferentComponentsRunConcurrently)
+{
+    auto dispatcher = PAL::WorkStealingTaskDispatcherFactory::Create(2);
+    std::mutex mutex;
+    std::condition_variable cv;
+    int arrived = 0;
+    Rendezvous first(mutex, cv, arrived);
+    Rendezvous second(mutex, cv, arrived);
+    std::atomic<bool> firstMet(false);
+    std::atomic<bool> secondMet(false);
+
+    PAL::dispatchTask(dispatcher.get(), &first, &Rendezvous::Meet, &firstMet);
+    PAL::dispatchTask(dispatcher.get(), &second, &Rendezvous::Meet, &secondMet);
+    dispatcher->Join();
+
+    EXPECT_TRUE(firstMet.load());
+    EXPECT_TRUE(secondMet.load());
+}
+
+TEST(WorkStealingTaskDispatcherTests, TimedTasksRunInDeadlineOrder)
+{
+    auto dispatcher = PAL::WorkStealingTaskDispatcherFactory::Create(3);
+    OrderedComponent component;
+    PAL::scheduleTask(dispatcher.get(), 90, &component, &OrderedComponent::Record, 3);
+    PAL::scheduleTask(dispatcher.get(), 30, &component, &OrderedComponent::Record, 1);
+    PAL::scheduleTask(dispatcher.get(), 60, &component, &OrderedComponent::Record, 2);
+    PAL::scheduleTask(dispatcher.get(), 0, &component, &OrderedComponent::Record, 0);
+
+    ASSERT_TRUE(waitFor([&component]() { return component.m_done.load() == 4; }));
+    EXPECT_THAT(component.m_values, ElementsAre(0, 1, 2, 3));
+    dispatcher->Join();
+}
+
+TEST(WorkStealingTaskDispatcherTests, CancelledTimerNeverRuns)
+{
+    auto dispatcher = PAL::WorkStealingTaskDispatcherFactory::Create(2);
+    Counter counter;
+    auto cancelled = PAL::scheduleTask(dispatcher.get(), 100, &counter, &Counter::Increment);
+    Counter other;
+    PAL::scheduleTask(dispatcher.get(), 150, &other, &Counter::Increment);
+    EXPECT_TRUE(cancelled.Cancel());
+
+    ASSERT_TRUE(waitFor([&other]() { return other.m_count.load() == 1; }));
+    EXPECT_EQ(counter.m_count.load(), 0);
+    dispatcher->Join();
+}
+
+TEST(WorkStealingTaskDispatcherTests, CancelWaitsForRunningTask)
+{
+    auto dispatcher = PAL::WorkStealingTaskDispatcherFactory::Create(2);
+    Counter counter;
+    auto handle = PAL::scheduleTask(dispatcher.get(), 0, &counter, &Counter::Sleep, 200u);
+    // Let the task start before cancelling it.
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    EXPECT_FALSE(handle.Cancel(10));
+    EXPECT_TRUE(handle.Cancel(2000));
+    EXPECT_EQ(counter.m_count.load(), 1);
+    dispatcher->Join();
+}
+
+TEST(WorkStealingTaskDispatcherTests, ContainsThrowingTask)
+{
+    auto dispatcher = PAL::WorkStealingTaskDispatcherFactory::Create(2);
+    Counter counter;
+    PAL::dispatchTask(dispatcher.get(), &counter, &Counter::Throw);
+    PAL::dispatchTask(dispatcher.get(), &counter, &Counter::Increment);
+    dispatcher->Join();
+    EXPECT_EQ(counter.m_count.load(), 1);
+}
+
+TEST(WorkStealingTaskDispatcherTests, JoinDropsTimersThatAreNotDue)
+{
+    auto dispatcher = PAL::WorkStealingTaskDispatcherFactory::Create(2);
+    Counter counter;
+    PAL::scheduleTask(dispatcher.get(), 60000, &counter, &Counter::Increment);
+    PAL::dispatchTask(dispatcher.get(), &counter, &Counter::Increment);
+    dispatcher->Join();
+    EXPECT_EQ(counter.m_count.load(), 1);
+    // Joining twice (explicitly and from the destructor) is harmless.
+    dispatcher->Join();
+}
+
+TEST(WorkStealingTaskDispatcherTests, DirectlyQueuedTaskRuns)
+{
+    auto dispatcher = PAL::WorkStealingTaskDispatcherFactory::Create(2);
+    std::atomic<int> ran(0);
+    std::atomic<int> deleted(0);
+    dispatcher->Queue(new CountedTask(ran, deleted));
+    dispatcher->Join();
+    EXPECT_EQ(ran.load(), 1);
+    EXPECT_EQ(deleted.load(), 1);
+}
+
+TEST(WorkStealingTaskDispatcherTests, JoinFromWorkerRunsOrFreesEveryTask)
+{
+    std::atomic<int> ran(0);
+    std::atomic<int> deleted(0);
+    {
+        auto dispatcher = PAL::WorkStealingTaskDispatcherFactory::Create(3);
+        Joiner joiner(*dispatcher);
+        Counter counter;
+        CountedTask* timer = new CountedTask(ran, deleted);
+        timer->Type = Task::TimedCall;
+        timer->TargetTime = PAL::getMonotonicTimeMs() + 60000;
+        dispatcher->Queue(timer);
+        PAL::dispatchTask(dispatcher.get(), &joiner, &Joiner::Join, &counter);
+
+        ASSERT_TRUE(waitFor([&joiner]() { return joiner.m_joined.load(); }));
+        EXPECT_EQ(counter.m_count.load(), 1);
+        // Destroying the pool waits for the joining worker to finish
+        dispatcher.reset();
+        EXPECT_EQ(joiner.m_afterJoin.load(), 1);
+    }
+    EXPECT_EQ(ran.load(), 0);
+    EXPECT_EQ(deleted.load(), 1);
+}
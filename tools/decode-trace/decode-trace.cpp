@@ -0,0 +1,35 @@
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Renders a binary trace file (mat-debug-<pid>.bin) as text:
+//
+//   decode-trace mat-debug-1234.bin > mat-debug-1234.log
+//
+#include "BinaryTrace.hpp"
+
+#include <fstream>
+#include <iostream>
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <trace.bin>" << std::endl;
+        return 2;
+    }
+
+    std::ifstream in(argv[1], std::ios::in | std::ios::binary);
+    if (!in.is_open())
+    {
+        std::cerr << "Cannot open " << argv[1] << std::endl;
+        return 1;
+    }
+
+    if (!PAL::detail::decode_binary_trace(in, std::cout))
+    {
+        std::cerr << "Not a binary trace, or the trace is truncated" << std::endl;
+        return 1;
+    }
+    return 0;
+}